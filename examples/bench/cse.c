@@ -0,0 +1,23 @@
+// Benchmark: subexpressões repetidas num laço quente (-O as calcula uma vez)
+int kernel(int n) {
+    int acc = 0;
+    int a = 0;
+    int b = 0;
+    int i = 0;
+    while (i < n) {
+        int d = (a * b + a) * (a * b + a) + (a * b + a) * (a * b + b) + (a * b + b) * (a * b + b);
+        int e = ((a + b) * (a - b) + (a + b)) * ((a + b) * (a - b) - (a - b));
+        acc = (acc + d - e + (a + b) * (a - b) * 5) % 1000003;
+        a = a + 1;
+        if (a == 97) a = 0;
+        b = b + 3;
+        if (b > 88) b = b - 89;
+        i = i + 1;
+    }
+    return acc;
+}
+
+int main() {
+    printf("%d\n", kernel(20000000));
+    return 0;
+}
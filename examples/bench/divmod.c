@@ -0,0 +1,37 @@
+// Benchmark: divisões, restos e multiplicações por constantes (dígitos
+// decimais, hash módulo primo); -O troca o idiv por número mágico e o
+// imul por shl/lea
+int digit_sum(int n) {
+    int sum = 0;
+    while (n != 0) {
+        sum = sum + n % 10;
+        n = n / 10;
+    }
+    return sum;
+}
+
+int reverse(int n) {
+    int r = 0;
+    while (n > 0) {
+        r = r * 10 + n % 10;
+        n = n / 10;
+    }
+    return r;
+}
+
+int main() {
+    int seed = 7;
+    int sums = 0;
+    int reversed = 0;
+    int buckets = 0;
+    int i = 0;
+    while (i < 1000000) {
+        seed = (seed * 1103 + 12345) % 1000003;
+        sums = sums + digit_sum(seed * 9 - 4000000);
+        reversed = (reversed + reverse(seed)) % 65521;
+        buckets = buckets + seed % 97 / 8 + seed / 3 % 7;
+        i = i + 1;
+    }
+    printf("%d %d %d\n", sums, reversed, buckets);
+    return 0;
+}
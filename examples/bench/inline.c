@@ -0,0 +1,35 @@
+// Benchmark: funções auxiliares pequenas chamadas dentro de laços quentes
+// (-O expande as chamadas e dobra as constantes dos argumentos)
+int square(int x) {
+    return x * x;
+}
+
+int max(int a, int b) {
+    if (a > b) return a;
+    return b;
+}
+
+int iabs(int x) {
+    if (x < 0) return -x;
+    return x;
+}
+
+int clamp(int v, int lo, int hi) {
+    return max(lo, v < hi ? v : hi);
+}
+
+int kernel(int n) {
+    int acc = 0;
+    int i = 0;
+    while (i < n) {
+        int d = i % 2001 - 1000;
+        acc = (acc + square(d) % 97 + iabs(d) + clamp(d, -300, 300) + max(d, 7)) % 1000003;
+        i = i + 1;
+    }
+    return acc;
+}
+
+int main() {
+    printf("%d\n", kernel(20000000));
+    return 0;
+}
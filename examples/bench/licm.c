@@ -0,0 +1,24 @@
+// Benchmark: expressões invariantes e chamadas puras dentro de laços
+// quentes (-O as calcula uma vez, antes de cada laço)
+int limit(int n, int k) {
+    return n * k - k;
+}
+
+int kernel(int n, int k, char* text) {
+    int acc = 0;
+    int i = 0;
+    while (i < limit(n, k) / k) {
+        int j = 0;
+        while (j < strlen(text)) {
+            acc = (acc + (n * k + 3) * (k - 1) + (n + k) * j + n / k) % 1000003;
+            j = j + 1;
+        }
+        i = i + 1;
+    }
+    return acc;
+}
+
+int main() {
+    printf("%d\n", kernel(1000000, 7, "invariantes"));
+    return 0;
+}
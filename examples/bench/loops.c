@@ -0,0 +1,20 @@
+// Benchmark: laços contados com produtos do contador (-O troca as
+// multiplicações por somas e desenrola o laço interno)
+int kernel(int n, int stride) {
+    int acc = 0;
+    int round = 0;
+    while (round < n) {
+        int i;
+        for (i = 0; i < 16; i = i + 1) {
+            acc = acc + i * 37 - stride;
+        }
+        acc = acc % 65536 + round * stride;
+        round = round + 1;
+    }
+    return acc;
+}
+
+int main() {
+    printf("%d\n", kernel(3000000, 12));
+    return 0;
+}
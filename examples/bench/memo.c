@@ -0,0 +1,23 @@
+// Benchmark: recursões puras com subproblemas repetidos
+// (-fmemoize guarda os resultados e torna cada uma linear:
+//  bench-codegen <compilador> -c "-O" -c "-O -fmemoize" examples/bench/memo.c)
+int fib(int n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+int binom(int n, int k) {
+    if (k == 0 || k == n) return 1;
+    return (binom(n - 1, k - 1) + binom(n - 1, k)) % 1000003;
+}
+
+int main() {
+    int acc = 0;
+    int i = 0;
+    while (i < 4) {
+        acc = (acc + fib(28 + i) + binom(20 + i, 10)) % 1000003;
+        i = i + 1;
+    }
+    printf("%d\n", acc);
+    return 0;
+}
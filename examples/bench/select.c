@@ -0,0 +1,25 @@
+// Benchmark: escolhas dependentes de dados pseudoaleatórios, que o
+// preditor de desvios não acerta (-O as troca por cmov/setcc)
+int main() {
+    int seed = 12345;
+    int low = 0;
+    int high = 0;
+    int above = 0;
+    int i = 0;
+    while (i < 2000000) {
+        seed = (seed * 1103 + 12345) % 1000003;
+        int v = seed % 1000;
+        int clamped = v;
+        if (v < 100) clamped = 100;
+        if (v > 900) clamped = 900;
+        if (v < 500) {
+            low = low + clamped;
+        } else {
+            high = high + clamped;
+        }
+        above = above + (v > 700 ? 1 : 0);
+        i = i + 1;
+    }
+    printf("%d %d %d\n", low % 1000003, high % 1000003, above);
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Benchmark: despacho de switch num interpretador de brinquedo, com casos
+// densos (tabela de saltos), caracteres esparsos (teste de bits) e
+// valores espalhados (busca binária)
+int step(int op, int acc) {
+    switch (op) {
+        case 0: return acc + 1;
+        case 1: return acc - 3;
+        case 2: return acc * 3 % 1000003;
+        case 3: return acc + 7;
+        case 4: return acc / 2;
+        case 5: return acc + 11;
+        case 6: return acc - 1;
+        case 7: return acc * 5 % 1000003;
+        case 8: return acc + 13;
+        case 9: return acc + 17;
+    }
+    return acc;
+}
+
+int kind(int c) {
+    switch (c) {
+        case ' ': case '\t': case '\n':
+            return 1;
+        case '(': case ')': case '*': case '+': case '-': case '/':
+            return 2;
+    }
+    return 0;
+}
+
+int code(int x) {
+    switch (x) {
+        case 3: return 1;
+        case 170: return 2;
+        case 1024: return 3;
+        case 4100: return 4;
+        case 9000: return 5;
+        case 20011: return 6;
+        case 65536: return 7;
+        case 99999: return 8;
+    }
+    return 0;
+}
+
+int main() {
+    int acc = 1;
+    int i = 0;
+    while (i < 3000000) {
+        acc = step((acc + i) % 10, acc);
+        acc = acc + kind(i % 64) + code(i % 100003);
+        i = i + 1;
+    }
+    printf("%d\n", acc);
+    return 0;
+}
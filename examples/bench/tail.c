@@ -0,0 +1,32 @@
+// Benchmark: recursões de cauda profundas, direta e mútua
+// (-O recomeça o corpo da função ou salta para a outra sem novo frame)
+int gcd(int a, int b) {
+    if (b == 0) return a;
+    return gcd(b, a % b);
+}
+
+int sum_to(int n, int acc) {
+    if (n == 0) return acc;
+    return sum_to(n - 1, (acc + n * n) % 1000003);
+}
+
+int is_odd(int n) {
+    if (n == 0) return 0;
+    return is_even(n - 1);
+}
+
+int is_even(int n) {
+    if (n == 0) return 1;
+    return is_odd(n - 1);
+}
+
+int main() {
+    int acc = 0;
+    int i = 0;
+    while (i < 200) {
+        acc = (acc + sum_to(100000 + i, 0) + is_even(100000 + i) + gcd(1071 * i + 1, 462)) % 1000003;
+        i = i + 1;
+    }
+    printf("%d\n", acc);
+    return 0;
+}
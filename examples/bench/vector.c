@@ -0,0 +1,27 @@
+// Benchmark: reduções sobre o contador em laços longos (-O executa 4
+// voltas por instrução com SSE2, ou 8 com -mavx2, e combina as lanes na saída)
+int kernel(int n, int k) {
+    int sum = 0;
+    int squares = 0;
+    int hi = -2147483647;
+    int lo = 2147483647;
+    int i;
+    for (i = 0; i < n; i = i + 1) {
+        sum = sum + i * k - 3;
+        squares = squares + (i - k) * (i + k);
+        if (i * 7 - i * i > hi) hi = i * 7 - i * i;
+        if (k * i - 5 < lo) lo = k * i - 5;
+    }
+    return sum + squares + hi - lo;
+}
+
+int main() {
+    int acc = 0;
+    int round = 0;
+    while (round < 40) {
+        acc = (acc + kernel(1000000 + round, 3 + round)) % 1000003;
+        round = round + 1;
+    }
+    printf("%d\n", acc);
+    return 0;
+}
@@ -0,0 +1,25 @@
+// Expressões float que a dobra de constantes calcula em tempo de
+// compilação: a saída com -O0 e com -O tem de ser a mesma
+#include <stdio.h>
+
+const float TERCO = 0.333333333;
+
+float escala(float x) {
+    return x * 0.1;
+}
+
+int main() {
+    float decimo = 0.1;
+    float soma = 0.1 + 0.2;
+    float mistura = 7 / 2 + 0.7;
+    int igual = 0.1 + 0.2 == 0.3;
+    int trunc = 2.9 * 3;
+
+    printf("%d %d\n", igual, 0.1 + 0.2 > 0.3);
+    printf("%.17g %.17g\n", 0.1 + 0.2, 1.0 / 3 * 3 - 1);
+    printf("%.17g %.17g\n", decimo + 0.2, decimo * 10 - 1);
+    printf("%.17g %.17g %.17g\n", soma, mistura, TERCO * 3);
+    printf("%d %d\n", trunc, -2.5 * 2 < -4.99999999);
+    printf("%.17g %.17g\n", escala(0.3 - 0.1), 16777216.0 + 0.5 - 16777216.0);
+    return 0;
+}
@@ -0,0 +1,22 @@
+// Rótulos de case são expressões constantes inteiras, não só literais
+#include <stdio.h>
+
+int classifica(int x) {
+    switch (x) {
+        case -2147483647 - 1: return 1;
+        case 4 * 4: return 2;
+        case 'a' + 1: return 3;
+        case (3 > 2) ? 7 : 8: return 4;
+        case -(5 * 2) % 4: return 5;
+        case ~0: return 6;
+        case 100 / 7 + (2 && 0): return 7;
+        default: return 0;
+    }
+}
+
+int main() {
+    printf("%d %d %d %d\n", classifica(-2147483647 - 1), classifica(16), classifica(98), classifica(7));
+    printf("%d %d %d\n", classifica(-2), classifica(-1), classifica(14));
+    printf("%d %d %d\n", classifica(8), classifica(0), classifica(2147483647));
+    return 0;
+}
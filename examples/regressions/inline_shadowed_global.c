@@ -0,0 +1,23 @@
+// Corpo expandido que lê uma global: no backend C os nomes saem como
+// texto, então um local de quem chama com o mesmo nome não pode capturar
+// a leitura
+#include <stdio.h>
+
+int g = 100;
+
+int rdg(int a) {
+    return a + g;
+}
+
+int main() {
+    int s = 0;
+    int g = 5;
+    int i = 0;
+    while (i < 3) {
+        g = g + i;
+        s = s + rdg(i) + g;
+        i = i + 1;
+    }
+    printf("%d %d\n", s, g);
+    return 0;
+}
@@ -0,0 +1,20 @@
+// Recursão de cauda que vira laço no backend C com -O: os temporários do
+// laço não podem repetir o nome de um temporário do otimizador
+// ((n - 1) é subexpressão comum e vira _temp_N)
+#include <stdio.h>
+
+int f(int n, int a) {
+    if (n == 0) return a;
+    return f(n - 1, ((n - 1) * 3 + a) % 1000);
+}
+
+int g(int n, int a, int b) {
+    if (n <= 0) return a + b;
+    return g(n - 1, (n - 1) * 2 + b, (n - 1) * 2 - a);
+}
+
+int main() {
+    printf("%d\n", f(10, 1));
+    printf("%d\n", g(12, 1, 2));
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include <limits.h>
+#include <string.h>
+#include "arith_lowering.h"
+
+// ============================================================
+// Divisão
+// ============================================================
+
+// Menor s tal que M = floor(2^(32+s) / d) + 1 cabe em 32 bits e o erro
+// e = M * d - 2^(32+s) satisfaz e * limit < 2^(32+s). Com isso,
+// floor(n * M / 2^(32+s)) = floor(n / d) para 0 <= n < limit, e para
+// -limit <= n < 0 dá floor(n / d) - 1 quando d divide n, o que a
+// correção de +1 dos negativos transforma no truncamento. Para d que
+// não é potência de 2, s = floor(log2 d) sempre serve.
+static int find_magic(unsigned long long d, unsigned long long limit, DivisionPlan* plan) {
+    for (int s = 0; s < 32; s++) {
+        unsigned long long power = 1ULL << (32 + s);
+        unsigned long long multiplier = power / d + 1;
+        if (multiplier >> 32) return 0;
+        if ((multiplier * d - power) * limit < power) {
+            plan->multiplier = multiplier;
+            plan->shift = 32 + s;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int arith_division_plan(long divisor, int non_negative, DivisionPlan* plan) {
+    if (divisor == 0 || divisor <= INT_MIN || divisor > INT_MAX) return 0;
+
+    memset(plan, 0, sizeof(DivisionPlan));
+    plan->divisor = divisor;
+    plan->non_negative = non_negative;
+    if (divisor == 1) {
+        plan->kind = DIVISION_IDENTITY;
+        return 1;
+    }
+    if (divisor == -1) {
+        plan->kind = DIVISION_NEGATE;
+        return 1;
+    }
+
+    unsigned long long magnitude = divisor < 0 ? -divisor : divisor;
+    plan->negative = divisor < 0;
+    if ((magnitude & (magnitude - 1)) == 0) {
+        plan->kind = DIVISION_SHIFT;
+        while ((1ULL << plan->shift) < magnitude) plan->shift++;
+        return 1;
+    }
+
+    plan->kind = DIVISION_MAGIC;
+    return find_magic(magnitude, non_negative ? (1ULL << 31) - 1 : 1ULL << 31, plan);
+}
+
+// Quociente por |d|, antes da troca de sinal
+static unsigned int magnitude_quotient(const DivisionPlan* plan, int dividend) {
+    unsigned int n = (unsigned int)dividend;
+    switch (plan->kind) {
+        case DIVISION_SHIFT:
+            // movl %eax,%ecx; sarl $31,%ecx; shrl $(32-k),%ecx; addl %ecx,%eax; sarl $k,%eax
+            if (!plan->non_negative) n += (unsigned int)(dividend >> 31) >> (32 - plan->shift);
+            return (unsigned int)((int)n >> plan->shift);
+
+        case DIVISION_MAGIC: {
+            // movslq %eax,%rdx; imulq M,%rdx; sarq $shift,%rdx; (+1 se n < 0)
+            long long product = (long long)dividend * (long long)plan->multiplier;
+            if (plan->non_negative) return (unsigned int)((unsigned long long)product >> plan->shift);
+            return (unsigned int)(product >> plan->shift) - (unsigned int)(dividend >> 31);
+        }
+
+        default:
+            return n;
+    }
+}
+
+int arith_divide(const DivisionPlan* plan, int dividend) {
+    unsigned int quotient = magnitude_quotient(plan, dividend);
+    if (plan->kind == DIVISION_NEGATE || plan->negative) quotient = 0u - quotient;
+    return (int)quotient;
+}
+
+// O resto tem o sinal do dividendo e não depende do sinal do divisor
+int arith_remainder(const DivisionPlan* plan, int dividend) {
+    if (plan->kind == DIVISION_IDENTITY || plan->kind == DIVISION_NEGATE) return 0;
+    if (plan->kind == DIVISION_SHIFT && plan->non_negative) {
+        return (int)((unsigned int)dividend & ((1u << plan->shift) - 1));
+    }
+    unsigned int magnitude = (unsigned int)(plan->divisor < 0 ? -plan->divisor : plan->divisor);
+    return (int)((unsigned int)dividend - magnitude_quotient(plan, dividend) * magnitude);
+}
+
+// ============================================================
+// Multiplicação
+// ============================================================
+
+static unsigned int apply_step(MultiplyStep step, unsigned int value, unsigned int original) {
+    switch (step.kind) {
+        case MULTIPLY_SHIFT: return value << step.amount;
+        case MULTIPLY_LEA: return value + value * (unsigned int)step.amount;
+        case MULTIPLY_LEA_ORIGINAL: return original + value * (unsigned int)step.amount;
+        case MULTIPLY_ADD_ORIGINAL: return value + original;
+        case MULTIPLY_SUB_ORIGINAL: return value - original;
+        default: return 0u - value;
+    }
+}
+
+static int reads_original(MultiplyStep step) {
+    return step.kind == MULTIPLY_LEA_ORIGINAL || step.kind == MULTIPLY_ADD_ORIGINAL ||
+           step.kind == MULTIPLY_SUB_ORIGINAL;
+}
+
+static int candidate_steps(MultiplyStep* steps) {
+    int count = 0;
+    for (int k = 1; k < 32; k++) steps[count++] = (MultiplyStep){MULTIPLY_SHIFT, k};
+    for (int scale = 2; scale <= 8; scale *= 2) {
+        steps[count++] = (MultiplyStep){MULTIPLY_LEA, scale};
+        steps[count++] = (MultiplyStep){MULTIPLY_LEA_ORIGINAL, scale};
+    }
+    steps[count++] = (MultiplyStep){MULTIPLY_ADD_ORIGINAL, 0};
+    steps[count++] = (MultiplyStep){MULTIPLY_SUB_ORIGINAL, 0};
+    steps[count++] = (MultiplyStep){MULTIPLY_NEGATE, 0};
+    return count;
+}
+
+// Busca exaustiva pela sequência mais curta (aplicada a x = 1, o valor
+// final é o multiplicador); no empate, a que não precisa da cópia de x
+int arith_multiply_plan(long multiplier, MultiplyPlan* plan) {
+    if (multiplier < INT_MIN || multiplier > INT_MAX) return 0;
+
+    memset(plan, 0, sizeof(MultiplyPlan));
+    plan->multiplier = multiplier;
+    unsigned int target = (unsigned int)multiplier;
+    if (target == 1) return 1;
+
+    MultiplyStep steps[48];
+    int count = candidate_steps(steps);
+
+    for (int i = 0; i < count; i++) {
+        if (apply_step(steps[i], 1, 1) == target && (plan->step_count == 0 || !reads_original(steps[i]))) {
+            plan->step_count = 1;
+            plan->steps[0] = steps[i];
+            plan->uses_original = reads_original(steps[i]);
+        }
+    }
+    if (plan->step_count) return 1;
+
+    for (int i = 0; i < count; i++) {
+        unsigned int first = apply_step(steps[i], 1, 1);
+        for (int j = 0; j < count; j++) {
+            if (apply_step(steps[j], first, 1) != target) continue;
+            int original = reads_original(steps[i]) || reads_original(steps[j]);
+            if (plan->step_count && (original || !plan->uses_original)) continue;
+            plan->step_count = 2;
+            plan->steps[0] = steps[i];
+            plan->steps[1] = steps[j];
+            plan->uses_original = original;
+        }
+    }
+    return plan->step_count > 0;
+}
+
+int arith_multiply(const MultiplyPlan* plan, int value) {
+    unsigned int result = (unsigned int)value;
+    for (int i = 0; i < plan->step_count; i++) {
+        result = apply_step(plan->steps[i], result, (unsigned int)value);
+    }
+    return (int)result;
+}
@@ -0,0 +1,73 @@
+#ifndef ARITH_LOWERING_H
+#define ARITH_LOWERING_H
+
+// ------------------------------------------------------------
+// Aritmética com operando constante no assembly (-O)
+//
+// Divisão e resto por constante viram uma multiplicação pelo "número
+// mágico" M ~ 2^(32+s) / |d| seguida de deslocamento (Granlund e
+// Montgomery): o produto de 64 bits n * M, deslocado de 32 + s, é o
+// quociente arredondado para baixo; para dividendos negativos soma-se 1,
+// o que dá o truncamento do C. Quando o dividendo é sabidamente não
+// negativo, a sequência "sem sinal" dispensa essa correção. Divisores
+// ±2^k usam só deslocamentos, e o resto sai de n - q * |d|.
+//
+// Multiplicação por constante pequena vira até dois passos de shl, lea
+// e add/sub com o valor original, mais rápidos que o imul.
+//
+// arith_divide, arith_remainder e arith_multiply executam em C as
+// mesmas operações de 32/64 bits que o gerador emite para um plano; o
+// teste (test_arith_lowering.c) as compara com / , % e * do C.
+// ------------------------------------------------------------
+
+#define ARITH_MAX_MULTIPLY_STEPS 2    // Três passos de 1 ciclo já empatam com o imul
+
+typedef enum {
+    DIVISION_IDENTITY,     // d = 1
+    DIVISION_NEGATE,       // d = -1
+    DIVISION_SHIFT,        // |d| = 2^shift
+    DIVISION_MAGIC         // (n * multiplier) >> shift
+} DivisionKind;
+
+typedef struct DivisionPlan {
+    DivisionKind kind;
+    long divisor;
+    int negative;                  // Divisor negativo: o quociente de |d| troca de sinal
+    int non_negative;              // Dividendo >= 0: sem correção para negativos
+    int shift;                     // SHIFT: k; MAGIC: 32 + s
+    unsigned long long multiplier; // MAGIC: menor que 2^32
+} DivisionPlan;
+
+typedef enum {
+    MULTIPLY_SHIFT,        // a <<= amount
+    MULTIPLY_LEA,          // a += a * amount (amount 2, 4 ou 8)
+    MULTIPLY_LEA_ORIGINAL, // a = x + a * amount
+    MULTIPLY_ADD_ORIGINAL, // a += x
+    MULTIPLY_SUB_ORIGINAL, // a -= x
+    MULTIPLY_NEGATE        // a = -a
+} MultiplyStepKind;
+
+typedef struct MultiplyStep {
+    MultiplyStepKind kind;
+    int amount;
+} MultiplyStep;
+
+typedef struct MultiplyPlan {
+    long multiplier;
+    int step_count;
+    MultiplyStep steps[ARITH_MAX_MULTIPLY_STEPS];
+    int uses_original;             // Algum passo lê x: copiar antes de começar
+} MultiplyPlan;
+
+// 0 para divisores que ficam com o idiv (0 e INT_MIN)
+int arith_division_plan(long divisor, int non_negative, DivisionPlan* plan);
+
+// 0 quando nenhuma sequência de até ARITH_MAX_MULTIPLY_STEPS passos serve
+int arith_multiply_plan(long multiplier, MultiplyPlan* plan);
+
+// Execução das sequências emitidas (para os testes)
+int arith_divide(const DivisionPlan* plan, int dividend);
+int arith_remainder(const DivisionPlan* plan, int dividend);
+int arith_multiply(const MultiplyPlan* plan, int value);
+
+#endif
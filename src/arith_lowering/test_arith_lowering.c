@@ -0,0 +1,132 @@
+#include <limits.h>
+#include <stdio.h>
+#include "arith_lowering.h"
+
+// Confere as sequências de arith_lowering com /, % e * do C. Para cada
+// divisor, os dividendos são as bordas do intervalo de 32 bits, os
+// arredores de zero, os múltiplos de d (e vizinhos) mais próximos das
+// bordas, onde o erro do número mágico é maior, e uma varredura
+// pseudoaleatória.
+
+#define EDGE_RANGE 512
+#define EDGE_MULTIPLES 64
+#define RANDOM_SAMPLES 2048
+
+static long checks = 0;
+static int failures = 0;
+
+static void report(const char* what, long operand, int value, long expected, long got) {
+    if (failures++ < 20) {
+        printf("FALHA: %d %s %ld: esperado %ld, obtido %ld\n", value, what, operand, expected, got);
+    }
+}
+
+static void check_division(const DivisionPlan* plan, int n) {
+    long d = plan->divisor;
+    if (plan->non_negative && n < 0) return;
+    if (d == -1 && n == INT_MIN) return;  // Estouro: indefinido no C
+    checks++;
+    if (arith_divide(plan, n) != n / d) report(plan->non_negative ? "/u" : "/", d, n, n / d, arith_divide(plan, n));
+    if (arith_remainder(plan, n) != n % d) report(plan->non_negative ? "%u" : "%", d, n, n % d, arith_remainder(plan, n));
+}
+
+static unsigned int next_random(unsigned int* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed ^ (*seed >> 16);
+}
+
+static void test_divisor(long d, int non_negative) {
+    DivisionPlan plan;
+    if (!arith_division_plan(d, non_negative, &plan)) {
+        printf("FALHA: sem plano para o divisor %ld\n", d);
+        failures++;
+        return;
+    }
+
+    for (long n = -EDGE_RANGE; n <= EDGE_RANGE; n++) check_division(&plan, (int)n);
+    for (long i = 0; i < EDGE_RANGE; i++) {
+        check_division(&plan, (int)(INT_MIN + i));
+        check_division(&plan, (int)(INT_MAX - i));
+    }
+
+    long magnitude = d < 0 ? -d : d;
+    long top = (long)INT_MAX / magnitude;
+    for (long k = top; k > top - EDGE_MULTIPLES && k >= 0; k--) {
+        for (long delta = -1; delta <= 1; delta++) {
+            long high = k * magnitude + delta;
+            long low = -k * magnitude + delta;
+            if (high <= INT_MAX) check_division(&plan, (int)high);
+            if (low >= INT_MIN) check_division(&plan, (int)low);
+        }
+    }
+
+    unsigned int seed = (unsigned int)d;
+    for (int i = 0; i < RANDOM_SAMPLES; i++) check_division(&plan, (int)next_random(&seed));
+}
+
+static void test_multiplier(long c) {
+    MultiplyPlan plan;
+    if (!arith_multiply_plan(c, &plan)) return;
+
+    static const int values[] = {0, 1, -1, 2, -2, 3, 7, -7, 100, -100, 12345, -12345, 65535, 65536,
+                                 1 << 20, INT_MAX, INT_MIN, INT_MAX - 1, INT_MIN + 1};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        int expected = (int)((unsigned int)values[i] * (unsigned int)c);
+        checks++;
+        if (arith_multiply(&plan, values[i]) != expected) report("*", c, values[i], expected, arith_multiply(&plan, values[i]));
+    }
+}
+
+int main(void) {
+    printf("=== TESTE DA ARITMÉTICA COM CONSTANTES ===\n");
+
+    // Todos os divisores pequenos, as potências de 2, vizinhos delas e as
+    // bordas do int (INT_MIN fica com o idiv)
+    int divisors = 0;
+    for (long d = -4096; d <= 4096; d++) {
+        if (d == 0) continue;
+        test_divisor(d, 0);
+        test_divisor(d, 1);
+        divisors++;
+    }
+    for (int k = 12; k < 31; k++) {
+        long around[] = {(1L << k) - 1, 1L << k, (1L << k) + 1, 3L << (k - 1), (1L << k) / 3 * 2 + 1};
+        for (size_t i = 0; i < sizeof(around) / sizeof(around[0]); i++) {
+            if (around[i] > INT_MAX) continue;
+            test_divisor(around[i], 0);
+            test_divisor(-around[i], 0);
+            test_divisor(around[i], 1);
+            divisors += 2;
+        }
+    }
+    long extremes[] = {INT_MAX, INT_MAX - 1, INT_MIN + 1, 1000000007L, 2147483629L, -1000000007L, 641, 6700417};
+    for (size_t i = 0; i < sizeof(extremes) / sizeof(extremes[0]); i++) {
+        test_divisor(extremes[i], 0);
+        if (extremes[i] > 0) test_divisor(extremes[i], 1);
+        divisors++;
+    }
+
+    DivisionPlan plan;
+    if (arith_division_plan(0, 0, &plan) || arith_division_plan(INT_MIN, 0, &plan)) {
+        printf("FALHA: divisores 0 e INT_MIN deveriam ficar com o idiv\n");
+        failures++;
+    }
+
+    int multipliers = 0;
+    for (long c = -4096; c <= 4096; c++) {
+        MultiplyPlan multiply;
+        if (arith_multiply_plan(c, &multiply)) multipliers++;
+        test_multiplier(c);
+    }
+    long wide[] = {INT_MAX, INT_MIN, 1L << 30, -(1L << 30), (1L << 30) + 1, (1L << 31) - 2};
+    for (size_t i = 0; i < sizeof(wide) / sizeof(wide[0]); i++) test_multiplier(wide[i]);
+
+    printf("Divisores: %d, multiplicadores com sequência: %d, verificações: %ld\n",
+           divisors, multipliers, checks);
+    if (failures) {
+        printf("%d falhas\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
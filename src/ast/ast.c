@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 
 ASTNode *ast_create_node(ASTNodeType type)
 {
@@ -16,6 +18,12 @@ ASTNode *ast_create_node(ASTNodeType type)
     node->children = NULL;
     node->child_count = 0;
     node->child_capacity = 0;
+    node->ref.symbol = NULL;
+    node->ref.builtin = NULL;
+    node->ref.depth = -1;
+    node->ref.slot = -1;
+    node->type_id = -1;
+    node->profile_point = -1;
 
     // Inicializar dados específicos com zeros
     memset(&node->data, 0, sizeof(node->data));
@@ -130,7 +138,7 @@ void ast_destroy(ASTNode *node)
         node->children = NULL;
     }
 
-    // Destruir dados específicos
+    // Destruir dados específicos (inclusive subárvores fora de children)
     switch (node->type)
     {
     case AST_FUNCTION_DECLARATION:
@@ -139,6 +147,8 @@ void ast_destroy(ASTNode *node)
             free(node->data.function_decl.name);
             node->data.function_decl.name = NULL;
         }
+        ast_destroy(node->data.function_decl.parameters);
+        ast_destroy(node->data.function_decl.body);
         break;
 
     case AST_VARIABLE_DECLARATION:
@@ -147,6 +157,60 @@ void ast_destroy(ASTNode *node)
             free(node->data.var_decl.name);
             node->data.var_decl.name = NULL;
         }
+        ast_destroy(node->data.var_decl.initializer);
+        ast_destroy(node->data.var_decl.array_size);
+        break;
+
+    case AST_PARAMETER:
+        free(node->data.parameter.name);
+        break;
+
+    case AST_BINARY_EXPRESSION:
+    case AST_ASSIGNMENT_EXPRESSION:
+        ast_destroy(node->data.binary_expr.left);
+        ast_destroy(node->data.binary_expr.right);
+        break;
+
+    case AST_UNARY_EXPRESSION:
+        ast_destroy(node->data.unary_expr.operand);
+        break;
+
+    case AST_TERNARY_EXPRESSION:
+        ast_destroy(node->data.ternary_expr.condition);
+        ast_destroy(node->data.ternary_expr.true_expr);
+        ast_destroy(node->data.ternary_expr.false_expr);
+        break;
+
+    case AST_IF_STATEMENT:
+        ast_destroy(node->data.if_stmt.condition);
+        ast_destroy(node->data.if_stmt.then_stmt);
+        ast_destroy(node->data.if_stmt.else_stmt);
+        break;
+
+    case AST_WHILE_STATEMENT:
+    case AST_DO_WHILE_STATEMENT:
+        ast_destroy(node->data.while_stmt.condition);
+        ast_destroy(node->data.while_stmt.body);
+        break;
+
+    case AST_FOR_STATEMENT:
+        ast_destroy(node->data.for_stmt.init);
+        ast_destroy(node->data.for_stmt.condition);
+        ast_destroy(node->data.for_stmt.update);
+        ast_destroy(node->data.for_stmt.body);
+        break;
+
+    case AST_SWITCH_STATEMENT:
+        ast_destroy(node->data.switch_stmt.expression);
+        ast_destroy(node->data.switch_stmt.cases);
+        break;
+
+    case AST_CASE_STATEMENT:
+        ast_destroy(node->data.case_stmt.value);
+        break;
+
+    case AST_RETURN_STATEMENT:
+        ast_destroy(node->data.return_stmt.expression);
         break;
 
     case AST_STRUCT_DECLARATION:
@@ -227,6 +291,135 @@ void ast_destroy(ASTNode *node)
     free(node);
 }
 
+static char *clone_text(const char *text)
+{
+    return text ? strdup(text) : NULL;
+}
+
+// Cópia profunda: subárvores e textos próprios duplicados (os mesmos que
+// ast_destroy libera); referências a símbolos e tipos são compartilhadas
+ASTNode *ast_clone(const ASTNode *node)
+{
+    if (!node)
+        return NULL;
+
+    ASTNode *copy = malloc(sizeof(ASTNode));
+    *copy = *node;
+    copy->children = NULL;
+    copy->child_count = 0;
+    copy->child_capacity = 0;
+    for (int i = 0; i < node->child_count; i++)
+    {
+        ast_add_child(copy, ast_clone(node->children[i]));
+    }
+
+    switch (node->type)
+    {
+    case AST_FUNCTION_DECLARATION:
+        copy->data.function_decl.name = clone_text(node->data.function_decl.name);
+        copy->data.function_decl.parameters = ast_clone(node->data.function_decl.parameters);
+        copy->data.function_decl.body = ast_clone(node->data.function_decl.body);
+        break;
+
+    case AST_VARIABLE_DECLARATION:
+        copy->data.var_decl.name = clone_text(node->data.var_decl.name);
+        copy->data.var_decl.initializer = ast_clone(node->data.var_decl.initializer);
+        copy->data.var_decl.array_size = ast_clone(node->data.var_decl.array_size);
+        break;
+
+    case AST_PARAMETER:
+        copy->data.parameter.name = clone_text(node->data.parameter.name);
+        break;
+
+    case AST_BINARY_EXPRESSION:
+    case AST_ASSIGNMENT_EXPRESSION:
+        copy->data.binary_expr.left = ast_clone(node->data.binary_expr.left);
+        copy->data.binary_expr.right = ast_clone(node->data.binary_expr.right);
+        break;
+
+    case AST_UNARY_EXPRESSION:
+        copy->data.unary_expr.operand = ast_clone(node->data.unary_expr.operand);
+        break;
+
+    case AST_TERNARY_EXPRESSION:
+        copy->data.ternary_expr.condition = ast_clone(node->data.ternary_expr.condition);
+        copy->data.ternary_expr.true_expr = ast_clone(node->data.ternary_expr.true_expr);
+        copy->data.ternary_expr.false_expr = ast_clone(node->data.ternary_expr.false_expr);
+        break;
+
+    case AST_IF_STATEMENT:
+        copy->data.if_stmt.condition = ast_clone(node->data.if_stmt.condition);
+        copy->data.if_stmt.then_stmt = ast_clone(node->data.if_stmt.then_stmt);
+        copy->data.if_stmt.else_stmt = ast_clone(node->data.if_stmt.else_stmt);
+        break;
+
+    case AST_WHILE_STATEMENT:
+    case AST_DO_WHILE_STATEMENT:
+        copy->data.while_stmt.condition = ast_clone(node->data.while_stmt.condition);
+        copy->data.while_stmt.body = ast_clone(node->data.while_stmt.body);
+        break;
+
+    case AST_FOR_STATEMENT:
+        copy->data.for_stmt.init = ast_clone(node->data.for_stmt.init);
+        copy->data.for_stmt.condition = ast_clone(node->data.for_stmt.condition);
+        copy->data.for_stmt.update = ast_clone(node->data.for_stmt.update);
+        copy->data.for_stmt.body = ast_clone(node->data.for_stmt.body);
+        break;
+
+    case AST_SWITCH_STATEMENT:
+        copy->data.switch_stmt.expression = ast_clone(node->data.switch_stmt.expression);
+        copy->data.switch_stmt.cases = ast_clone(node->data.switch_stmt.cases);
+        break;
+
+    case AST_CASE_STATEMENT:
+        copy->data.case_stmt.value = ast_clone(node->data.case_stmt.value);
+        break;
+
+    case AST_RETURN_STATEMENT:
+        copy->data.return_stmt.expression = ast_clone(node->data.return_stmt.expression);
+        break;
+
+    case AST_STRUCT_DECLARATION:
+        copy->data.struct_decl.name = clone_text(node->data.struct_decl.name);
+        break;
+
+    case AST_ENUM_DECLARATION:
+        copy->data.enum_decl.name = clone_text(node->data.enum_decl.name);
+        break;
+
+    case AST_FUNCTION_CALL:
+        copy->data.function_call.name = clone_text(node->data.function_call.name);
+        break;
+
+    case AST_MEMBER_ACCESS:
+        copy->data.member_access.member = clone_text(node->data.member_access.member);
+        break;
+
+    case AST_IDENTIFIER:
+        copy->data.identifier.name = clone_text(node->data.identifier.name);
+        break;
+
+    case AST_NUMBER_LITERAL:
+    case AST_FLOAT_LITERAL:
+    case AST_STRING_LITERAL:
+    case AST_CHAR_LITERAL:
+        copy->data.literal.value = clone_text(node->data.literal.value);
+        break;
+
+    case AST_PREPROCESSOR_DIRECTIVE:
+    case AST_INCLUDE_DIRECTIVE:
+    case AST_DEFINE_DIRECTIVE:
+        copy->data.preprocessor.directive = clone_text(node->data.preprocessor.directive);
+        copy->data.preprocessor.content = clone_text(node->data.preprocessor.content);
+        break;
+
+    default:
+        break;
+    }
+
+    return copy;
+}
+
 static void print_indent(int indent)
 {
     for (int i = 0; i < indent; i++)
@@ -437,6 +630,196 @@ const char *data_type_to_string(DataType type)
     }
 }
 
+int data_type_size(DataType type)
+{
+    switch (type)
+    {
+    case TYPE_VOID:
+        return 0;
+    case TYPE_CHAR:
+        return 1;
+    case TYPE_INT:
+    case TYPE_FLOAT:
+    case TYPE_ENUM:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+// Valor de um literal de caractere guardado com o texto bruto ('a', '\n')
+int ast_char_literal_value(const char *text)
+{
+    if (!text || !text[0])
+        return 0;
+    if (text[0] != '\\')
+        return (unsigned char)text[0];
+
+    switch (text[1])
+    {
+    case 'n':
+        return '\n';
+    case 't':
+        return '\t';
+    case 'r':
+        return '\r';
+    case '0':
+        return '\0';
+    default:
+        return (unsigned char)text[1];
+    }
+}
+
+// Valor de uma expressão constante inteira simples (literal inteiro ou de
+// caractere, possivelmente com sinal), usada nos rótulos de case
+int ast_integer_constant(const ASTNode *node, long *value)
+{
+    if (!node)
+        return 0;
+
+    switch (node->type)
+    {
+    case AST_NUMBER_LITERAL:
+        if (node->data_type == TYPE_FLOAT || strpbrk(node->data.literal.value, ".eE"))
+            return 0;
+        *value = strtol(node->data.literal.value, NULL, 10);
+        return 1;
+    case AST_CHAR_LITERAL:
+        *value = ast_char_literal_value(node->data.literal.value);
+        return 1;
+    case AST_UNARY_EXPRESSION:
+        if (node->data.unary_expr.operator == UNARY_MINUS &&
+            ast_integer_constant(node->data.unary_expr.operand, value))
+        {
+            *value = -*value;
+            return 1;
+        }
+        if (node->data.unary_expr.operator == UNARY_PLUS)
+            return ast_integer_constant(node->data.unary_expr.operand, value);
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+// Operador binário sobre int de 32 bits com a semântica de C; falha no
+// que C deixa indefinido (divisão por zero, overflow da divisão,
+// deslocamentos fora do intervalo)
+int ast_evaluate_int_binary(TokenType op, int a, int b, int *result)
+{
+    uint32_t ua = (uint32_t)a;
+    uint32_t ub = (uint32_t)b;
+
+    switch (op)
+    {
+    case TOKEN_PLUS:          *result = (int)(ua + ub); return 1;
+    case TOKEN_MINUS:         *result = (int)(ua - ub); return 1;
+    case TOKEN_MULTIPLY:      *result = (int)(ua * ub); return 1;
+    case TOKEN_DIVIDE:
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return 0;
+        *result = a / b;
+        return 1;
+    case TOKEN_MODULO:
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return 0;
+        *result = a % b;
+        return 1;
+    case TOKEN_BITWISE_AND:   *result = a & b; return 1;
+    case TOKEN_BITWISE_OR:    *result = a | b; return 1;
+    case TOKEN_BITWISE_XOR:   *result = a ^ b; return 1;
+    case TOKEN_LEFT_SHIFT:
+        if (b < 0 || b > 31 || a < 0)
+            return 0;
+        *result = (int)(ua << b);
+        return 1;
+    case TOKEN_RIGHT_SHIFT:
+        if (b < 0 || b > 31)
+            return 0;
+        *result = a >> b;
+        return 1;
+    case TOKEN_EQUAL:         *result = a == b; return 1;
+    case TOKEN_NOT_EQUAL:     *result = a != b; return 1;
+    case TOKEN_LESS:          *result = a < b; return 1;
+    case TOKEN_GREATER:       *result = a > b; return 1;
+    case TOKEN_LESS_EQUAL:    *result = a <= b; return 1;
+    case TOKEN_GREATER_EQUAL: *result = a >= b; return 1;
+    case TOKEN_AND:           *result = a && b; return 1;
+    case TOKEN_OR:            *result = a || b; return 1;
+    default:
+        return 0;
+    }
+}
+
+static int fits_int(long value)
+{
+    return value >= INT_MIN && value <= INT_MAX;
+}
+
+// Expressão constante inteira (rótulos de case): literais combinados por
+// operadores unários, binários e ?:, avaliados em int como a dobra de
+// constantes avalia
+int ast_constant_expression(const ASTNode *node, long *value)
+{
+    if (!node)
+        return 0;
+    if (ast_integer_constant(node, value))
+        return 1;
+
+    long left, right;
+    int result;
+    switch (node->type)
+    {
+    case AST_UNARY_EXPRESSION:
+        if (!ast_constant_expression(node->data.unary_expr.operand, &left) || !fits_int(left))
+            return 0;
+        switch (node->data.unary_expr.operator)
+        {
+        case UNARY_PLUS:
+            *value = left;
+            return 1;
+        case UNARY_MINUS:
+            if (left == INT_MIN)
+                return 0;
+            *value = -left;
+            return 1;
+        case UNARY_NOT:
+            *value = !left;
+            return 1;
+        case UNARY_BITWISE_NOT:
+            *value = ~(int)left;
+            return 1;
+        default:
+            return 0;
+        }
+    case AST_BINARY_EXPRESSION:
+    {
+        TokenType op = node->data.binary_expr.operator;
+        if (!ast_constant_expression(node->data.binary_expr.left, &left) || !fits_int(left))
+            return 0;
+        // Curto-circuito: o operando direito pode nem ser avaliável
+        if ((op == TOKEN_AND && !left) || (op == TOKEN_OR && left))
+        {
+            *value = op == TOKEN_OR;
+            return 1;
+        }
+        if (!ast_constant_expression(node->data.binary_expr.right, &right) || !fits_int(right) ||
+            !ast_evaluate_int_binary(op, (int)left, (int)right, &result))
+            return 0;
+        *value = result;
+        return 1;
+    }
+    case AST_TERNARY_EXPRESSION:
+        if (!ast_constant_expression(node->data.ternary_expr.condition, &left))
+            return 0;
+        return ast_constant_expression(left ? node->data.ternary_expr.true_expr
+                                            : node->data.ternary_expr.false_expr,
+                                       value);
+    default:
+        return 0;
+    }
+}
+
 const char *unary_operator_to_string(UnaryOperator op)
 {
     switch (op)
@@ -3,6 +3,8 @@
 
 #include "lexer.h"
 
+struct Symbol;
+
 // Tipos de nós da AST baseados na gramática fornecida
 typedef enum {
     // Programa e declarações
@@ -109,6 +111,7 @@ typedef enum {
 typedef struct {
     char* name;
     DataType param_type;
+    int pointer_level;
 } ASTParameter;
 
 typedef struct {
@@ -123,6 +126,10 @@ typedef struct {
     struct ASTNode* parameters;
     struct ASTNode* body;
     int is_variadic;
+    int pointer_level;  // Nível de ponteiro do tipo de retorno
+    int local_count;  // Slots locais (parâmetros + variáveis), preenchido na análise semântica
+    int frame_size;   // Bytes de pilha ocupados pelos locais
+    int memoized;     // -fmemoize: chamadas passam por uma tabela de resultados
 } ASTFunctionDecl;
 
 typedef struct {
@@ -160,6 +167,7 @@ typedef struct {
     struct ASTNode* condition;
     struct ASTNode* true_expr;
     struct ASTNode* false_expr;
+    int branchless;  // Seleção sem desvio (if-conversion com -O, ver optimizer.h)
 } ASTTernaryExpr;
 
 typedef struct {
@@ -218,6 +226,14 @@ typedef struct {
     char* value;
 } ASTLiteral;
 
+// Referência a símbolo resolvida pela análise semântica
+typedef struct SymbolRef {
+    struct Symbol* symbol;  // NULL se o nó não referencia símbolo do programa
+    const struct Symbol* builtin;  // Built-in da tabela estática (symbol fica NULL)
+    int depth;              // Nível do escopo onde o símbolo foi declarado (0 = global)
+    int slot;               // Índice do slot no frame da função (-1 para globais e funções)
+} SymbolRef;
+
 // Estrutura do nó AST
 typedef struct ASTNode {
     ASTNodeType type;
@@ -227,6 +243,9 @@ typedef struct ASTNode {
     struct ASTNode** children;
     int child_count;
     int child_capacity;
+    SymbolRef ref;      // Preenchido pela análise semântica
+    int type_id;        // TypeId canônico (ver type_table.h), preenchido pela análise semântica
+    int profile_point;  // Ponto do perfil de execução (ver profile.h), -1 se não é medido
     
     // Dados específicos do nó
     union {
@@ -257,9 +276,15 @@ typedef struct ASTNode {
 ASTNode* ast_create_node(ASTNodeType type);
 void ast_add_child(ASTNode* parent, ASTNode* child);
 void ast_destroy(ASTNode* node);
+ASTNode* ast_clone(const ASTNode* node);
 void ast_print(ASTNode* node, int indent);
 const char* ast_node_type_to_string(ASTNodeType type);
 const char* data_type_to_string(DataType type);
+int data_type_size(DataType type);
+int ast_char_literal_value(const char* text);
+int ast_integer_constant(const ASTNode* node, long* value);
+int ast_evaluate_int_binary(TokenType op, int a, int b, int* result);
+int ast_constant_expression(const ASTNode* node, long* value);
 const char* unary_operator_to_string(UnaryOperator op);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lexer.h"
+#include "parser.h"
+#include "semantic.h"
+#include "ir.h"
+#include "cfg.h"
+
+// ------------------------------------------------------------
+// Benchmark das análises de CFG
+//
+// Gera funções com milhares de blocos (if/else, while com break e
+// switch em sequência), constrói a IR e mede a árvore de dominadores,
+// a vivacidade e as definições alcançantes. Nos tamanhos menores a
+// dominância é conferida contra o algoritmo iterativo ingênuo.
+// ------------------------------------------------------------
+
+#define REPETITIONS 5
+#define CHECK_LIMIT 5000   // Blocos até onde a conferência O(n²) é feita
+
+typedef struct Buffer {
+    char* data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+static void buffer_append(Buffer* buffer, const char* text) {
+    size_t length = strlen(text);
+    if (buffer->length + length + 1 > buffer->capacity) {
+        buffer->capacity = (buffer->length + length + 1) * 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+    memcpy(buffer->data + buffer->length, text, length + 1);
+    buffer->length += length;
+}
+
+static char* generate_source(int units) {
+    Buffer buffer = {0};
+    char line[256];
+
+    buffer_append(&buffer, "int g;\nint bench(int x) {\n    int y = x;\n    int z = 0;\n");
+    for (int i = 0; i < units; i++) {
+        snprintf(line, sizeof(line),
+                 "    if (y > %d) { y = y - %d; } else { z = z + y; }\n"
+                 "    while (y > %d) { y = y - 3; if (y == %d) break; z = z + 1; }\n"
+                 "    switch (z) { case 1: y = y + 1; break; case 2: g = y; default: z = z - 1; }\n",
+                 i, i % 7, i % 11, i % 5);
+        buffer_append(&buffer, line);
+    }
+    buffer_append(&buffer, "    g = z;\n    return y + z;\n}\n");
+    return buffer.data;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Dom(b) = {b} ∪ ⋂ Dom(p), iterado até o ponto fixo
+static int check_dominators(IRFunction* function, const DominatorTree* tree) {
+    int n = function->block_count;
+    BitSet* dom = malloc(n * sizeof(BitSet));
+    BitSet next;
+    bitset_init(&next, n);
+
+    for (int b = 0; b < n; b++) {
+        bitset_init(&dom[b], n);
+        if (b == 0) {
+            bitset_set(&dom[b], 0);
+        } else {
+            for (int i = 0; i < n; i++) bitset_set(&dom[b], i);
+        }
+    }
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 1; i < tree->rpo_count; i++) {
+            int b = tree->rpo[i];
+            IRBlock* block = function->blocks[b];
+            int first = 1;
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (!dominator_tree_reachable(tree, pred)) continue;
+                if (first) {
+                    bitset_copy(&next, &dom[pred]);
+                    first = 0;
+                } else {
+                    for (int w = 0; w < next.word_count; w++) next.words[w] &= dom[pred].words[w];
+                }
+            }
+            bitset_set(&next, b);
+            if (!bitset_equal(&next, &dom[b])) {
+                bitset_copy(&dom[b], &next);
+                changed = 1;
+            }
+        }
+    }
+
+    int ok = 1;
+    for (int i = 0; i < tree->rpo_count && ok; i++) {
+        int b = tree->rpo[i];
+        for (int a = 0; a < n; a++) {
+            int expected = dominator_tree_reachable(tree, a) && bitset_test(&dom[b], a);
+            if (dominator_tree_dominates(tree, a, b) != expected) {
+                fprintf(stderr, "Divergência: bb%d domina bb%d? esperado %d\n", a, b, expected);
+                ok = 0;
+                break;
+            }
+        }
+    }
+
+    for (int b = 0; b < n; b++) bitset_free(&dom[b]);
+    free(dom);
+    bitset_free(&next);
+    return ok;
+}
+
+static int run(int units) {
+    char* source = generate_source(units);
+    Lexer* lexer = lexer_create(source);
+    Parser* parser = parser_create(lexer);
+    ASTNode* ast = parser_parse(parser);
+    if (parser->has_error) {
+        fprintf(stderr, "Erro sintático: %s\n", parser->error_message);
+        return 0;
+    }
+
+    SemanticAnalyzer* analyzer = semantic_analyzer_create();
+    if (!semantic_analyze(analyzer, ast)) {
+        fprintf(stderr, "Erro semântico: %s\n", analyzer->error_message);
+        return 0;
+    }
+
+    IRModule* module = ir_build_module(ast, analyzer->symbol_table);
+    IRFunction* function = module->functions[0];
+    double dominators = 0, liveness = 0, reaching = 0;
+    int dominator_passes = 0, liveness_steps = 0, reaching_steps = 0;
+    int ok = 1;
+
+    for (int r = 0; r < REPETITIONS; r++) {
+        double start = now_ms();
+        DominatorTree* tree = dominator_tree_build(function);
+        double after_tree = now_ms();
+        DataflowResult* live = liveness_compute(function, tree);
+        double after_live = now_ms();
+        ReachingDefinitions* definitions = reaching_definitions_compute(function, tree);
+        double after_reaching = now_ms();
+
+        dominators += after_tree - start;
+        liveness += after_live - after_tree;
+        reaching += after_reaching - after_live;
+        dominator_passes = tree->iterations;
+        liveness_steps = live->iterations;
+        reaching_steps = definitions->result.iterations;
+
+        if (r == 0) {
+            char error[256];
+            if (!ir_verify(function, error, sizeof(error)) ||
+                !ir_verify_dominance(function, tree, error, sizeof(error))) {
+                fprintf(stderr, "IR inválida: %s\n", error);
+                ok = 0;
+            }
+            if (function->block_count <= CHECK_LIMIT && !check_dominators(function, tree)) {
+                ok = 0;
+            }
+        }
+
+        reaching_definitions_destroy(definitions);
+        liveness_destroy(live);
+        dominator_tree_destroy(tree);
+    }
+
+    printf("%7d %8d %9.3f (%d) %10.3f (%6d) %10.3f (%6d)  %s\n",
+           function->block_count, function->value_count,
+           dominators / REPETITIONS, dominator_passes,
+           liveness / REPETITIONS, liveness_steps,
+           reaching / REPETITIONS, reaching_steps,
+           function->block_count > CHECK_LIMIT ? "-" : (ok ? "ok" : "FALHOU"));
+
+    ir_module_destroy(module);
+    semantic_analyzer_destroy(analyzer);
+    ast_destroy(ast);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    free(source);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int sizes[] = {75, 150, 300, 600};
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+    int ok = 1;
+
+    // Um argumento opcional substitui a lista de tamanhos (em unidades)
+    if (argc == 2) {
+        sizes[0] = atoi(argv[1]);
+        size_count = 1;
+    }
+
+    printf("=== BENCHMARK DE CFG (média de %d execuções, ms) ===\n", REPETITIONS);
+    printf(" blocos  valores  dominadores   vivacidade         def. alcançantes   conferência\n");
+    for (int i = 0; i < size_count; i++) {
+        ok &= run(sizes[i]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,584 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cfg.h"
+
+// ============================================================
+// Conjuntos de bits
+// ============================================================
+
+#define WORD_BITS ((int)(sizeof(unsigned long) * 8))
+
+void bitset_init(BitSet* set, int size) {
+    set->size = size;
+    set->word_count = (size + WORD_BITS - 1) / WORD_BITS;
+    set->words = calloc(set->word_count > 0 ? set->word_count : 1, sizeof(unsigned long));
+}
+
+void bitset_free(BitSet* set) {
+    free(set->words);
+    set->words = NULL;
+    set->size = 0;
+    set->word_count = 0;
+}
+
+void bitset_clear_all(BitSet* set) {
+    memset(set->words, 0, set->word_count * sizeof(unsigned long));
+}
+
+static void bitset_fill(BitSet* set) {
+    memset(set->words, 0xFF, set->word_count * sizeof(unsigned long));
+    int tail = set->size % WORD_BITS;
+    if (tail > 0) {
+        set->words[set->word_count - 1] = (1UL << tail) - 1;
+    }
+}
+
+void bitset_set(BitSet* set, int bit) {
+    set->words[bit / WORD_BITS] |= 1UL << (bit % WORD_BITS);
+}
+
+void bitset_clear(BitSet* set, int bit) {
+    set->words[bit / WORD_BITS] &= ~(1UL << (bit % WORD_BITS));
+}
+
+int bitset_test(const BitSet* set, int bit) {
+    return (set->words[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1UL;
+}
+
+void bitset_copy(BitSet* dst, const BitSet* src) {
+    memcpy(dst->words, src->words, src->word_count * sizeof(unsigned long));
+}
+
+int bitset_equal(const BitSet* a, const BitSet* b) {
+    return memcmp(a->words, b->words, a->word_count * sizeof(unsigned long)) == 0;
+}
+
+int bitset_count(const BitSet* set) {
+    int count = 0;
+    for (int i = 0; i < set->word_count; i++) {
+        count += __builtin_popcountl(set->words[i]);
+    }
+    return count;
+}
+
+static void bitset_union_with(BitSet* dst, const BitSet* src) {
+    for (int i = 0; i < dst->word_count; i++) {
+        dst->words[i] |= src->words[i];
+    }
+}
+
+static void bitset_intersect_with(BitSet* dst, const BitSet* src) {
+    for (int i = 0; i < dst->word_count; i++) {
+        dst->words[i] &= src->words[i];
+    }
+}
+
+// dst = gen ∪ (src − kill); retorna 1 se dst mudou
+static int bitset_transfer(BitSet* dst, const BitSet* gen, const BitSet* src, const BitSet* kill) {
+    int changed = 0;
+    for (int i = 0; i < dst->word_count; i++) {
+        unsigned long word = gen->words[i] | (src->words[i] & ~kill->words[i]);
+        changed |= word != dst->words[i];
+        dst->words[i] = word;
+    }
+    return changed;
+}
+
+// ============================================================
+// Dominadores
+// ============================================================
+
+// Pós-ordem reversa dos blocos alcançáveis (DFS iterativa)
+static void compute_rpo(IRFunction* function, DominatorTree* tree) {
+    int n = function->block_count;
+    int* stack = malloc(n * sizeof(int));
+    int* next_successor = calloc(n, sizeof(int));
+    int* postorder = malloc(n * sizeof(int));
+    char* visited = calloc(n, 1);
+    int top = 0;
+    int count = 0;
+
+    stack[top++] = 0;
+    visited[0] = 1;
+    while (top > 0) {
+        int block = stack[top - 1];
+        int successors[2];
+        int successor_count = ir_block_successors(function, function->blocks[block], successors);
+
+        if (next_successor[block] < successor_count) {
+            int successor = successors[next_successor[block]++];
+            if (!visited[successor]) {
+                visited[successor] = 1;
+                stack[top++] = successor;
+            }
+        } else {
+            postorder[count++] = block;
+            top--;
+        }
+    }
+
+    tree->rpo_count = count;
+    for (int i = 0; i < n; i++) {
+        tree->rpo_index[i] = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        tree->rpo[i] = postorder[count - 1 - i];
+        tree->rpo_index[tree->rpo[i]] = i;
+    }
+
+    free(stack);
+    free(next_successor);
+    free(postorder);
+    free(visited);
+}
+
+static int intersect(const DominatorTree* tree, int a, int b) {
+    while (a != b) {
+        while (tree->rpo_index[a] > tree->rpo_index[b]) a = tree->idom[a];
+        while (tree->rpo_index[b] > tree->rpo_index[a]) b = tree->idom[b];
+    }
+    return a;
+}
+
+// Numeração pré/pós-ordem da árvore: a domina b se o intervalo de b
+// está contido no de a
+static void number_tree(DominatorTree* tree) {
+    int n = tree->block_count;
+    int* child_start = calloc(n + 1, sizeof(int));
+    int* children = malloc((n > 0 ? n : 1) * sizeof(int));
+    int* fill = malloc((n + 1) * sizeof(int));
+    int* stack = malloc((n > 0 ? n : 1) * sizeof(int));
+    int* next_child = malloc((n > 0 ? n : 1) * sizeof(int));
+
+    for (int i = 0; i < n; i++) {
+        tree->preorder[i] = -1;
+        tree->postorder[i] = -1;
+        if (i != 0 && tree->idom[i] >= 0) child_start[tree->idom[i] + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        child_start[i + 1] += child_start[i];
+    }
+    memcpy(fill, child_start, (n + 1) * sizeof(int));
+    for (int i = 0; i < tree->rpo_count; i++) {
+        int block = tree->rpo[i];
+        if (block != 0) children[fill[tree->idom[block]]++] = block;
+    }
+
+    int top = 0;
+    int pre = 0;
+    int post = 0;
+    if (n > 0) {
+        stack[top++] = 0;
+        next_child[0] = child_start[0];
+        tree->preorder[0] = pre++;
+    }
+    while (top > 0) {
+        int block = stack[top - 1];
+        if (next_child[block] < child_start[block + 1]) {
+            int child = children[next_child[block]++];
+            tree->preorder[child] = pre++;
+            next_child[child] = child_start[child];
+            stack[top++] = child;
+        } else {
+            tree->postorder[block] = post++;
+            top--;
+        }
+    }
+
+    free(child_start);
+    free(children);
+    free(fill);
+    free(stack);
+    free(next_child);
+}
+
+DominatorTree* dominator_tree_build(IRFunction* function) {
+    int n = function->block_count;
+    DominatorTree* tree = calloc(1, sizeof(DominatorTree));
+    tree->block_count = n;
+    tree->idom = malloc((n > 0 ? n : 1) * sizeof(int));
+    tree->rpo = malloc((n > 0 ? n : 1) * sizeof(int));
+    tree->rpo_index = malloc((n > 0 ? n : 1) * sizeof(int));
+    tree->preorder = malloc((n > 0 ? n : 1) * sizeof(int));
+    tree->postorder = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (n == 0) return tree;
+
+    compute_rpo(function, tree);
+    for (int i = 0; i < n; i++) {
+        tree->idom[i] = -1;
+    }
+    tree->idom[0] = 0;
+
+    // Em pós-ordem reversa, poucos passos bastam para o ponto fixo
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        tree->iterations++;
+        for (int i = 1; i < tree->rpo_count; i++) {
+            int block = tree->rpo[i];
+            IRBlock* info = function->blocks[block];
+            int new_idom = -1;
+
+            for (int p = 0; p < info->pred_count; p++) {
+                int pred = info->preds[p];
+                if (tree->idom[pred] < 0) continue;
+                new_idom = new_idom < 0 ? pred : intersect(tree, pred, new_idom);
+            }
+            if (tree->idom[block] != new_idom) {
+                tree->idom[block] = new_idom;
+                changed = 1;
+            }
+        }
+    }
+
+    number_tree(tree);
+    return tree;
+}
+
+void dominator_tree_destroy(DominatorTree* tree) {
+    if (!tree) return;
+    free(tree->idom);
+    free(tree->rpo);
+    free(tree->rpo_index);
+    free(tree->preorder);
+    free(tree->postorder);
+    free(tree);
+}
+
+int dominator_tree_reachable(const DominatorTree* tree, int block) {
+    return block >= 0 && block < tree->block_count && tree->rpo_index[block] >= 0;
+}
+
+int dominator_tree_dominates(const DominatorTree* tree, int a, int b) {
+    if (!dominator_tree_reachable(tree, a) || !dominator_tree_reachable(tree, b)) return 0;
+    return tree->preorder[a] <= tree->preorder[b] && tree->postorder[b] <= tree->postorder[a];
+}
+
+int ir_verify_dominance(IRFunction* function, const DominatorTree* tree, char* error, int size) {
+    for (int b = 0; b < function->block_count; b++) {
+        if (!dominator_tree_reachable(tree, b)) continue;
+        IRBlock* block = function->blocks[b];
+
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            for (int j = 0; j < instr->operand_count; j++) {
+                IRInstr* def = function->values[instr->operands[j]];
+                int use_block = instr->op == IR_PHI ? block->preds[j] : b;
+
+                if (instr->op == IR_PHI && !dominator_tree_reachable(tree, use_block)) continue;
+                if (def->block == use_block && instr->op != IR_PHI) continue;
+                if (!dominator_tree_dominates(tree, def->block, use_block)) {
+                    snprintf(error, size, "v%d: definição de v%d (bb%d) não domina o uso em bb%d",
+                             instr->id, def->id, def->block, use_block);
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+// ============================================================
+// Fluxo de dados
+// ============================================================
+
+void dataflow_problem_init(DataflowProblem* problem, IRFunction* function,
+                           DataflowDirection direction, DataflowMeet meet, int universe) {
+    int n = function->block_count;
+    problem->direction = direction;
+    problem->meet = meet;
+    problem->universe = universe;
+    problem->gen = malloc((n > 0 ? n : 1) * sizeof(BitSet));
+    problem->kill = malloc((n > 0 ? n : 1) * sizeof(BitSet));
+    problem->extra = NULL;
+    for (int i = 0; i < n; i++) {
+        bitset_init(&problem->gen[i], universe);
+        bitset_init(&problem->kill[i], universe);
+    }
+}
+
+void dataflow_problem_free(DataflowProblem* problem, int block_count) {
+    for (int i = 0; i < block_count; i++) {
+        bitset_free(&problem->gen[i]);
+        bitset_free(&problem->kill[i]);
+        if (problem->extra) bitset_free(&problem->extra[i]);
+    }
+    free(problem->gen);
+    free(problem->kill);
+    free(problem->extra);
+}
+
+void dataflow_result_free(DataflowResult* result) {
+    for (int i = 0; i < result->block_count; i++) {
+        bitset_free(&result->in[i]);
+        bitset_free(&result->out[i]);
+    }
+    free(result->in);
+    free(result->out);
+    result->in = NULL;
+    result->out = NULL;
+}
+
+// Lista de trabalho circular: cada bloco aparece no máximo uma vez
+typedef struct Worklist {
+    int* items;
+    char* queued;
+    int head;
+    int count;
+    int capacity;
+} Worklist;
+
+static void worklist_push(Worklist* list, int block) {
+    if (list->queued[block]) return;
+    list->queued[block] = 1;
+    list->items[(list->head + list->count) % list->capacity] = block;
+    list->count++;
+}
+
+static int worklist_pop(Worklist* list) {
+    int block = list->items[list->head];
+    list->head = (list->head + 1) % list->capacity;
+    list->count--;
+    list->queued[block] = 0;
+    return block;
+}
+
+// Ponto fixo sobre os blocos alcançáveis, na ordem que propaga mais
+// informação por passo: pós-ordem reversa para frente, pós-ordem para trás
+void dataflow_solve(IRFunction* function, const DominatorTree* tree,
+                    const DataflowProblem* problem, DataflowResult* result) {
+    int n = function->block_count;
+    int forward = problem->direction == DATAFLOW_FORWARD;
+    int intersection = problem->meet == DATAFLOW_INTERSECTION;
+
+    result->block_count = n;
+    result->iterations = 0;
+    result->in = malloc((n > 0 ? n : 1) * sizeof(BitSet));
+    result->out = malloc((n > 0 ? n : 1) * sizeof(BitSet));
+    for (int i = 0; i < n; i++) {
+        bitset_init(&result->in[i], problem->universe);
+        bitset_init(&result->out[i], problem->universe);
+        // Interseção parte do topo (tudo) para convergir ao maior ponto fixo
+        if (intersection && dominator_tree_reachable(tree, i)) {
+            bitset_fill(forward ? &result->out[i] : &result->in[i]);
+        }
+    }
+
+    Worklist list;
+    list.capacity = n > 0 ? n : 1;
+    list.items = malloc(list.capacity * sizeof(int));
+    list.queued = calloc(list.capacity, 1);
+    list.head = 0;
+    list.count = 0;
+    for (int i = 0; i < tree->rpo_count; i++) {
+        worklist_push(&list, tree->rpo[forward ? i : tree->rpo_count - 1 - i]);
+    }
+
+    BitSet meet;
+    bitset_init(&meet, problem->universe);
+
+    while (list.count > 0) {
+        int b = worklist_pop(&list);
+        IRBlock* block = function->blocks[b];
+        int successors[2];
+        int successor_count = ir_block_successors(function, block, successors);
+        int* neighbors = forward ? block->preds : successors;
+        int neighbor_count = forward ? block->pred_count : successor_count;
+        BitSet* neighbor_sets = forward ? result->out : result->in;
+        int first = 1;
+
+        result->iterations++;
+        bitset_clear_all(&meet);
+        for (int i = 0; i < neighbor_count; i++) {
+            int neighbor = neighbors[i];
+            if (!dominator_tree_reachable(tree, neighbor)) continue;
+            if (first) {
+                bitset_copy(&meet, &neighbor_sets[neighbor]);
+                first = 0;
+            } else if (intersection) {
+                bitset_intersect_with(&meet, &neighbor_sets[neighbor]);
+            } else {
+                bitset_union_with(&meet, &neighbor_sets[neighbor]);
+            }
+        }
+        if (problem->extra) {
+            bitset_union_with(&meet, &problem->extra[b]);
+        }
+
+        BitSet* meet_side = forward ? &result->in[b] : &result->out[b];
+        BitSet* transfer_side = forward ? &result->out[b] : &result->in[b];
+        bitset_copy(meet_side, &meet);
+        if (!bitset_transfer(transfer_side, &problem->gen[b], meet_side, &problem->kill[b])) {
+            continue;
+        }
+
+        // O resultado do bloco mudou: os vizinhos na direção do fluxo são revistos
+        if (forward) {
+            for (int i = 0; i < successor_count; i++) worklist_push(&list, successors[i]);
+        } else {
+            for (int i = 0; i < block->pred_count; i++) {
+                if (dominator_tree_reachable(tree, block->preds[i])) {
+                    worklist_push(&list, block->preds[i]);
+                }
+            }
+        }
+    }
+
+    bitset_free(&meet);
+    free(list.items);
+    free(list.queued);
+}
+
+// ------------------------------------------------------------
+// Vivacidade
+// ------------------------------------------------------------
+
+DataflowResult* liveness_compute(IRFunction* function, const DominatorTree* tree) {
+    int n = function->block_count;
+    DataflowProblem problem;
+    dataflow_problem_init(&problem, function, DATAFLOW_BACKWARD, DATAFLOW_UNION,
+                          function->value_count);
+    problem.extra = malloc((n > 0 ? n : 1) * sizeof(BitSet));
+    for (int i = 0; i < n; i++) {
+        bitset_init(&problem.extra[i], function->value_count);
+    }
+
+    // gen: usos cuja definição está em outro bloco (dentro do bloco a
+    // definição precede o uso); kill: valores definidos no bloco
+    for (int b = 0; b < n; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            if (instr->type != IR_TYPE_VOID) {
+                bitset_set(&problem.kill[b], instr->id);
+            }
+            for (int j = 0; j < instr->operand_count; j++) {
+                int operand = instr->operands[j];
+                if (instr->op == IR_PHI) {
+                    bitset_set(&problem.extra[block->preds[j]], operand);
+                } else if (function->values[operand]->block != b) {
+                    bitset_set(&problem.gen[b], operand);
+                }
+            }
+        }
+    }
+
+    DataflowResult* result = malloc(sizeof(DataflowResult));
+    dataflow_solve(function, tree, &problem, result);
+    dataflow_problem_free(&problem, n);
+    return result;
+}
+
+void liveness_destroy(DataflowResult* liveness) {
+    if (!liveness) return;
+    dataflow_result_free(liveness);
+    free(liveness);
+}
+
+// ------------------------------------------------------------
+// Definições alcançantes de memória
+// ------------------------------------------------------------
+
+// Endereço identificável de um STORE: a global (símbolo) ou o ALLOCA.
+// Endereços calculados (aritmética de ponteiros) não têm chave.
+static const void* store_location(IRFunction* function, IRInstr* store) {
+    IRInstr* address = function->values[store->operands[0]];
+    if (address->op == IR_GLOBAL) return address->symbol;
+    if (address->op == IR_ALLOCA) return address;
+    return NULL;
+}
+
+ReachingDefinitions* reaching_definitions_compute(IRFunction* function, const DominatorTree* tree) {
+    int n = function->block_count;
+    ReachingDefinitions* definitions = calloc(1, sizeof(ReachingDefinitions));
+    int* store_index = malloc((function->value_count + 1) * sizeof(int));
+
+    for (int b = 0; b < n; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            if (instr->op == IR_STORE) definitions->store_count++;
+        }
+    }
+    definitions->stores = malloc((definitions->store_count + 1) * sizeof(int));
+
+    // Locais distintos e o conjunto de definições de cada um
+    const void** locations = malloc((definitions->store_count + 1) * sizeof(void*));
+    int* store_location_index = malloc((definitions->store_count + 1) * sizeof(int));
+    int location_count = 0;
+    int count = 0;
+    for (int b = 0; b < n; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            if (instr->op != IR_STORE) continue;
+
+            const void* location = store_location(function, instr);
+            int index = -1;
+            if (location) {
+                for (int l = 0; l < location_count; l++) {
+                    if (locations[l] == location) {
+                        index = l;
+                        break;
+                    }
+                }
+                if (index < 0) {
+                    index = location_count;
+                    locations[location_count++] = location;
+                }
+            }
+            store_index[instr->id] = count;
+            store_location_index[count] = index;
+            definitions->stores[count++] = instr->id;
+        }
+    }
+
+    BitSet* location_sets = malloc((location_count > 0 ? location_count : 1) * sizeof(BitSet));
+    for (int l = 0; l < location_count; l++) {
+        bitset_init(&location_sets[l], count);
+    }
+    for (int s = 0; s < count; s++) {
+        if (store_location_index[s] >= 0) bitset_set(&location_sets[store_location_index[s]], s);
+    }
+
+    DataflowProblem problem;
+    dataflow_problem_init(&problem, function, DATAFLOW_FORWARD, DATAFLOW_UNION, count);
+    for (int b = 0; b < n; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            if (instr->op != IR_STORE) continue;
+
+            int s = store_index[instr->id];
+            int location = store_location_index[s];
+            if (location >= 0) {
+                // A nova definição substitui as anteriores do mesmo endereço
+                for (int w = 0; w < problem.gen[b].word_count; w++) {
+                    problem.gen[b].words[w] &= ~location_sets[location].words[w];
+                    problem.kill[b].words[w] |= location_sets[location].words[w];
+                }
+            }
+            bitset_set(&problem.gen[b], s);
+        }
+    }
+
+    dataflow_solve(function, tree, &problem, &definitions->result);
+
+    dataflow_problem_free(&problem, n);
+    for (int l = 0; l < location_count; l++) {
+        bitset_free(&location_sets[l]);
+    }
+    free(location_sets);
+    free(locations);
+    free(store_location_index);
+    free(store_index);
+    return definitions;
+}
+
+void reaching_definitions_destroy(ReachingDefinitions* definitions) {
+    if (!definitions) return;
+    dataflow_result_free(&definitions->result);
+    free(definitions->stores);
+    free(definitions);
+}
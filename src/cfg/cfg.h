@@ -0,0 +1,109 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "ir.h"
+
+// ------------------------------------------------------------
+// Análises sobre o grafo de fluxo de controle da IR
+//
+// Os blocos básicos e as arestas vêm da construção da IR (ir.c); aqui
+// ficam a árvore de dominadores e um resolvedor genérico de fluxo de
+// dados sobre vetores de bits, com vivacidade e definições alcançantes
+// como primeiros clientes.
+// ------------------------------------------------------------
+
+// Conjunto de bits de tamanho fixo
+typedef struct BitSet {
+    unsigned long* words;
+    int size;              // Número de bits
+    int word_count;
+} BitSet;
+
+void bitset_init(BitSet* set, int size);
+void bitset_free(BitSet* set);
+void bitset_clear_all(BitSet* set);
+void bitset_set(BitSet* set, int bit);
+void bitset_clear(BitSet* set, int bit);
+int bitset_test(const BitSet* set, int bit);
+void bitset_copy(BitSet* dst, const BitSet* src);
+int bitset_equal(const BitSet* a, const BitSet* b);
+int bitset_count(const BitSet* set);
+
+// Árvore de dominadores (Cooper, Harvey e Kennedy, "A Simple, Fast
+// Dominance Algorithm"). Blocos inalcançáveis a partir da entrada não
+// pertencem à árvore: idom = -1 e não dominam nem são dominados.
+typedef struct DominatorTree {
+    int block_count;
+    int* idom;             // Dominador imediato (a entrada é o próprio idom)
+    int* rpo;              // Blocos alcançáveis em pós-ordem reversa
+    int rpo_count;
+    int* rpo_index;        // Posição de cada bloco em rpo (-1 se inalcançável)
+    int* preorder;         // Numeração da árvore: consulta de dominância em O(1)
+    int* postorder;
+    int iterations;        // Passadas até o ponto fixo
+} DominatorTree;
+
+DominatorTree* dominator_tree_build(IRFunction* function);
+void dominator_tree_destroy(DominatorTree* tree);
+int dominator_tree_dominates(const DominatorTree* tree, int a, int b);
+int dominator_tree_reachable(const DominatorTree* tree, int block);
+
+// Definições devem dominar seus usos (operandos de phi: o fim do
+// predecessor correspondente). Retorna 0 e descreve a primeira violação.
+int ir_verify_dominance(IRFunction* function, const DominatorTree* tree, char* error, int size);
+
+// Resolvedor de fluxo de dados por lista de trabalho. Cada bloco tem
+// gen/kill; a função de transferência é gen ∪ (entrada − kill). O meet
+// combina os vizinhos (sucessores para análises para trás) por união
+// (problemas "may") ou interseção ("must").
+typedef enum {
+    DATAFLOW_FORWARD,
+    DATAFLOW_BACKWARD
+} DataflowDirection;
+
+typedef enum {
+    DATAFLOW_UNION,
+    DATAFLOW_INTERSECTION
+} DataflowMeet;
+
+typedef struct DataflowProblem {
+    DataflowDirection direction;
+    DataflowMeet meet;
+    int universe;          // Bits de cada conjunto
+    BitSet* gen;           // Por bloco
+    BitSet* kill;          // Por bloco
+    BitSet* extra;         // Somado ao meet de cada bloco (NULL = nenhum)
+} DataflowProblem;
+
+typedef struct DataflowResult {
+    BitSet* in;            // Início de cada bloco
+    BitSet* out;           // Fim de cada bloco
+    int block_count;
+    int iterations;        // Blocos processados até o ponto fixo
+} DataflowResult;
+
+void dataflow_problem_init(DataflowProblem* problem, IRFunction* function,
+                           DataflowDirection direction, DataflowMeet meet, int universe);
+void dataflow_problem_free(DataflowProblem* problem, int block_count);
+void dataflow_solve(IRFunction* function, const DominatorTree* tree,
+                    const DataflowProblem* problem, DataflowResult* result);
+void dataflow_result_free(DataflowResult* result);
+
+// Vivacidade dos valores SSA: bit v = valor vN. Operandos de phi são
+// usados no fim do predecessor correspondente.
+DataflowResult* liveness_compute(IRFunction* function, const DominatorTree* tree);
+
+// Definições alcançantes de memória: bit i = i-ésimo STORE da função
+// (ordem dos blocos). Um STORE mata os demais para o mesmo endereço
+// (mesma global ou mesmo ALLOCA); os demais são "may".
+typedef struct ReachingDefinitions {
+    DataflowResult result;
+    int* stores;           // Valor de cada definição
+    int store_count;
+} ReachingDefinitions;
+
+ReachingDefinitions* reaching_definitions_compute(IRFunction* function, const DominatorTree* tree);
+void reaching_definitions_destroy(ReachingDefinitions* definitions);
+void liveness_destroy(DataflowResult* liveness);
+
+#endif
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------
+// Benchmark do código gerado
+//
+// Compila cada programa para assembly x86-64 com cada configuração de
+// flags, monta com o gcc e mede a execução (o menor tempo entre as
+// repetições, menos sensível à carga da máquina). O tempo de compilação
+// (o menor entre as mesmas repetições) é o custo da configuração. Também conta as instruções
+// do .s (todas e as que ficam dentro de laços), as instruções executadas
+// pelo código gerado (numa cópia instrumentada, sem contar a libc) e
+// confere se todas as configurações imprimem a mesma saída.
+// Uso: bench-codegen <compilador> [-c "<flags>"]... programa.c...
+// Sem -c, compara o código sem otimização com -O.
+// ------------------------------------------------------------
+
+#define REPETITIONS 5
+#define MAX_CONFIGS 16
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static char* read_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = malloc(size + 1);
+    size_t length = fread(data, 1, size, file);
+    data[length] = '\0';
+    fclose(file);
+    return data;
+}
+
+typedef struct Label {
+    char name[64];
+    int position;          // Índice da instrução seguinte ao rótulo
+} Label;
+
+// Linhas indentadas que não são diretivas nem rótulos. As que ficam
+// entre um rótulo e um salto para trás até ele estão dentro de um laço:
+// é o código que executa a cada volta.
+static int count_instructions(const char* path, int* in_loops) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    char line[512];
+    int count = 0;
+    Label* labels = NULL;
+    int label_count = 0;
+    int label_capacity = 0;
+    int* loop_start = NULL;   // Por instrução: início do laço que ela fecha (-1 se nenhum)
+    int capacity = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        if (!isspace((unsigned char)line[0])) {
+            char* colon = strchr(line, ':');
+            if (colon && colon - line < (int)sizeof(labels->name)) {
+                if (label_count == label_capacity) {
+                    label_capacity = label_capacity ? label_capacity * 2 : 64;
+                    labels = realloc(labels, label_capacity * sizeof(Label));
+                }
+                memcpy(labels[label_count].name, line, colon - line);
+                labels[label_count].name[colon - line] = '\0';
+                labels[label_count].position = count;
+                label_count++;
+            }
+            continue;
+        }
+        const char* text = line;
+        while (isspace((unsigned char)*text)) text++;
+        if (*text == '\0' || *text == '.' || *text == '#') continue;
+        if (strchr(text, ':') && !strchr(text, ' ')) continue;
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            loop_start = realloc(loop_start, capacity * sizeof(int));
+        }
+        loop_start[count] = -1;
+        char mnemonic[32], target[64];
+        if (text[0] == 'j' && sscanf(text, "%31s %63s", mnemonic, target) == 2) {
+            for (int i = 0; i < label_count; i++) {
+                if (strcmp(labels[i].name, target) == 0) {
+                    loop_start[count] = labels[i].position;
+                    break;
+                }
+            }
+        }
+        count++;
+    }
+    fclose(file);
+
+    // Laços aninhados se sobrepõem: marca cada instrução uma vez
+    char* inside = calloc(count > 0 ? count : 1, 1);
+    for (int i = 0; i < count; i++) {
+        for (int j = loop_start[i]; j >= 0 && j <= i; j++) inside[j] = 1;
+    }
+    *in_loops = 0;
+    for (int i = 0; i < count; i++) *in_loops += inside[i];
+
+    free(inside);
+    free(loop_start);
+    free(labels);
+    return count;
+}
+
+typedef struct Line {
+    char* text;
+    int is_instruction;
+    int starts_block;      // Um bloco básico começa logo depois desta linha
+} Line;
+
+// Cópia do .s que soma, na entrada de cada bloco básico (depois de um
+// rótulo ou de um salto condicional), o número de instruções do bloco num
+// contador global. pushfq/popfq preservam as flags, que podem estar vivas
+// entre um salto condicional e o seguinte. Ao sair, o programa imprime o
+// total no descritor 3.
+static int instrument_assembly(const char* input, const char* output) {
+    FILE* file = fopen(input, "r");
+    if (!file) return 0;
+    Line* lines = NULL;
+    int count = 0;
+    int capacity = 0;
+    char buffer[512];
+    int in_text = 0;
+
+    while (fgets(buffer, sizeof(buffer), file)) {
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            lines = realloc(lines, capacity * sizeof(Line));
+        }
+        Line* line = &lines[count++];
+        line->text = strdup(buffer);
+        line->is_instruction = 0;
+        line->starts_block = 0;
+
+        const char* text = buffer;
+        while (isspace((unsigned char)*text)) text++;
+        if (strncmp(text, ".text", 5) == 0 || strncmp(text, ".section .text", 14) == 0) {
+            in_text = 1;
+        } else if (strncmp(text, ".data", 5) == 0 || strncmp(text, ".section", 8) == 0) {
+            in_text = 0;
+        }
+        if (!in_text) continue;
+
+        if (!isspace((unsigned char)buffer[0])) {
+            line->starts_block = strchr(buffer, ':') != NULL;
+        } else if (*text != '\0' && *text != '.' && *text != '#' && !(strchr(text, ':') && !strchr(text, ' '))) {
+            line->is_instruction = 1;
+            line->starts_block = text[0] == 'j' && strncmp(text, "jmp", 3) != 0;
+        }
+    }
+    fclose(file);
+
+    FILE* out = fopen(output, "w");
+    if (!out) return 0;
+    for (int i = 0; i < count; i++) {
+        fputs(lines[i].text, out);
+        if (!lines[i].starts_block) continue;
+
+        int size = 0;
+        for (int j = i + 1; j < count && !(j > i + 1 && lines[j - 1].starts_block); j++) {
+            size += lines[j].is_instruction;
+        }
+        if (size > 0) fprintf(out, "    pushfq\n    addq $%d, __bench_count(%%rip)\n    popfq\n", size);
+    }
+    fputs("    .data\n    .align 8\n__bench_count:\n    .quad 0\n"
+          "    .section .rodata\n__bench_format:\n    .string \"%ld\\n\"\n"
+          "    .text\n__bench_report:\n    push %rbp\n    mov %rsp, %rbp\n"
+          "    movq __bench_count(%rip), %rdx\n    leaq __bench_format(%rip), %rsi\n"
+          "    movl $3, %edi\n    movl $0, %eax\n    call dprintf\n    leave\n    ret\n"
+          "    .section .fini_array,\"aw\"\n    .align 8\n    .quad __bench_report\n", out);
+    fclose(out);
+
+    for (int i = 0; i < count; i++) free(lines[i].text);
+    free(lines);
+    return 1;
+}
+
+static int run_command(const char* command) {
+    int status = system(command);
+    return status == 0;
+}
+
+// Retorna a saída do programa (NULL se algo falhou) e o menor tempo
+static char* measure(const char* compiler, const char* flags, const char* program,
+                     const char* workdir, int* instructions, int* in_loops, long* executed, double* best,
+                     double* compile_ms) {
+    char command[4096];
+    char assembly[512], binary[512], output[512], counted[512], total[512];
+    snprintf(assembly, sizeof(assembly), "%s/bench.s", workdir);
+    snprintf(binary, sizeof(binary), "%s/bench", workdir);
+    snprintf(output, sizeof(output), "%s/bench.out", workdir);
+    snprintf(counted, sizeof(counted), "%s/bench-count.s", workdir);
+    snprintf(total, sizeof(total), "%s/bench.count", workdir);
+
+    snprintf(command, sizeof(command), "%s -S %s %s -o %s > /dev/null", compiler, flags, program, assembly);
+    for (int r = 0; r < REPETITIONS; r++) {
+        double start = now_ms();
+        if (!run_command(command)) return NULL;
+        double elapsed = now_ms() - start;
+        if (r == 0 || elapsed < *compile_ms) *compile_ms = elapsed;
+    }
+    snprintf(command, sizeof(command), "gcc %s -o %s", assembly, binary);
+    if (!run_command(command)) return NULL;
+    *instructions = count_instructions(assembly, in_loops);
+
+    // Instruções executadas: uma execução da cópia instrumentada
+    *executed = -1;
+    if (instrument_assembly(assembly, counted)) {
+        snprintf(command, sizeof(command), "gcc %s -o %s && %s > /dev/null 3> %s", counted, binary, binary, total);
+        char* text = run_command(command) ? read_file(total) : NULL;
+        if (text) *executed = atol(text);
+        free(text);
+        snprintf(command, sizeof(command), "gcc %s -o %s", assembly, binary);
+        if (!run_command(command)) return NULL;
+    }
+
+    snprintf(command, sizeof(command), "%s > %s", binary, output);
+    for (int r = 0; r < REPETITIONS; r++) {
+        double start = now_ms();
+        if (!run_command(command)) return NULL;
+        double elapsed = now_ms() - start;
+        if (r == 0 || elapsed < *best) *best = elapsed;
+    }
+    return read_file(output);
+}
+
+int main(int argc, char* argv[]) {
+    const char* configs[MAX_CONFIGS];
+    int config_count = 0;
+    const char* programs[256];
+    int program_count = 0;
+
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s <compilador> [-c \"<flags>\"]... programa.c...\n", argv[0]);
+        return 1;
+    }
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc && config_count < MAX_CONFIGS) {
+            configs[config_count++] = argv[++i];
+        } else if (program_count < 256) {
+            programs[program_count++] = argv[i];
+        }
+    }
+    if (config_count == 0) {
+        configs[config_count++] = "";
+        configs[config_count++] = "-O";
+    }
+
+    char workdir[] = "/tmp/bench-codegen-XXXXXX";
+    if (!mkdtemp(workdir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    int ok = 1;
+    printf("=== BENCHMARK DO CÓDIGO GERADO (assembly, melhor de %d execuções) ===\n", REPETITIONS);
+    printf("%-28s %-16s %12s %10s %14s %12s %12s %8s  %s\n", "programa", "flags", "compilação", "instruções",
+           "em laços", "executadas", "tempo (ms)", "ganho", "saída");
+    for (int p = 0; p < program_count; p++) {
+        const char* name = strrchr(programs[p], '/') ? strrchr(programs[p], '/') + 1 : programs[p];
+        char* reference = NULL;
+        double baseline = 0;
+
+        for (int c = 0; c < config_count; c++) {
+            int instructions = 0;
+            int in_loops = 0;
+            long executed = -1;
+            double best = 0;
+            double compile_ms = 0;
+            char* output = measure(argv[1], configs[c], programs[p], workdir, &instructions, &in_loops,
+                                   &executed, &best, &compile_ms);
+            if (!output) {
+                printf("%-28s %-16s %12s %12s %10s %14s %12s %8s  FALHOU\n", name, configs[c], "-", "-", "-", "-",
+                       "-", "-");
+                ok = 0;
+                continue;
+            }
+
+            const char* status = "ok";
+            if (!reference) {
+                reference = output;
+                baseline = best;
+            } else {
+                if (strcmp(reference, output) != 0) {
+                    status = "DIVERGENTE";
+                    ok = 0;
+                }
+                free(output);
+            }
+            printf("%-28s %-16s %12.1f %12d %10d %14ld %12.1f %7.2fx  %s\n", name,
+                   configs[c][0] ? configs[c] : "(nenhuma)", compile_ms, instructions, in_loops, executed, best,
+                   best > 0 ? baseline / best : 0.0, status);
+        }
+        free(reference);
+    }
+
+    char command[512];
+    snprintf(command, sizeof(command), "rm -rf %s", workdir);
+    run_command(command);
+    return ok ? 0 : 1;
+}
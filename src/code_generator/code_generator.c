@@ -3,6 +3,27 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <limits.h>
+
+// Registradores de argumentos inteiros da convenção System V
+static const char* arg_registers_64[] = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+static const char* arg_registers_32[] = {"%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d"};
+static const char* arg_registers_8[] = {"%dil", "%sil", "%dl", "%cl", "%r8b", "%r9b"};
+#define MAX_INT_ARGS 6
+#define MAX_FLOAT_ARGS 8
+
+static void c_statement(CodeGenerator* gen, ASTNode* node);
+static void c_expression(CodeGenerator* gen, ASTNode* node);
+static void asm_statement(CodeGenerator* gen, ASTNode* node);
+static void asm_expression(CodeGenerator* gen, ASTNode* node);
+static void bc_statement(CodeGenerator* gen, ASTNode* node);
+static void bc_expression(CodeGenerator* gen, ASTNode* node);
+static void asm_expression_store(CodeGenerator* gen, DataType value_type, Symbol* symbol);
+static void bc_convert(CodeGenerator* gen, DataType from, DataType to);
+static void print_selection_stats(CodeGenerator* gen);
+static int select_initializer(CodeGenerator* gen, Symbol* symbol, ASTNode* init);
+static ASTNode* tail_call(CodeGenerator* gen, ASTNode* node);
+static void asm_cold_blocks(CodeGenerator* gen, int in_cold_section);
 
 CodeGenerator* code_generator_create(const char* output_filename, OutputType type) {
     CodeGenerator* gen = malloc(sizeof(CodeGenerator));
@@ -11,59 +32,440 @@ CodeGenerator* code_generator_create(const char* output_filename, OutputType typ
         free(gen);
         return NULL;
     }
-    
+
     gen->output_type = type;
     gen->symbol_table = NULL;
     gen->label_counter = 0;
-    gen->temp_counter = 0;
-    gen->current_offset = 0;
     gen->current_function = NULL;
-    
+    gen->current_return_type = TYPE_VOID;
+    gen->indent_level = 0;
+    gen->stack_depth = 0;
+    gen->break_label = NULL;
+    gen->continue_label = NULL;
+    gen->return_label = NULL;
+    gen->literals = NULL;
+    gen->literal_count = 0;
+    gen->literal_capacity = 0;
+    gen->allocate_registers = 0;
+    gen->locals_in_registers = 0;
+    gen->locals_spilled = 0;
+    gen->memory_locals = 0;
+    gen->spill_slots = 0;
+    gen->select_instructions = 0;
+    gen->selected_trees = 0;
+    gen->selection_cost = 0;
+    memset(gen->rule_hits, 0, sizeof(gen->rule_hits));
+    gen->peephole = 0;
+    memset(&gen->peephole_stats, 0, sizeof(gen->peephole_stats));
+    gen->tail_calls = 0;
+    gen->tail_jumps = 0;
+    gen->tail_loops = 0;
+    gen->allocation = NULL;
+    gen->body_label = NULL;
+    gen->tail_function = NULL;
+    gen->loop_depth = 0;
+    gen->vector_width = 0;
+    gen->vectorized_loops = 0;
+    gen->vector_reductions = 0;
+    gen->vector_lanes_used = 0;
+    gen->profile = NULL;
+    gen->cold_blocks = NULL;
+    gen->cold_block_count = 0;
+    gen->cold_block_capacity = 0;
+    gen->switch_statements = 0;
+    gen->switch_tables = 0;
+    gen->switch_bitsets = 0;
+    gen->switch_compares = 0;
+    gen->switch_searches = 0;
+    gen->switch_lookups = 0;
+    gen->jump_tables = NULL;
+    gen->jump_table_count = 0;
+    gen->jump_table_capacity = 0;
+    gen->select_moves = 0;
+    gen->select_sets = 0;
+    gen->magic_divisions = 0;
+    gen->shift_divisions = 0;
+    gen->multiply_chains = 0;
+    gen->memoized_functions = 0;
+
     return gen;
 }
 
+void code_generator_print_stats(CodeGenerator* generator) {
+    if (!generator) return;
+    if (generator->tail_calls) {
+        printf("\n=== CHAMADAS DE CAUDA ===\n");
+        printf("Chamadas que reaproveitam o frame: %d\n", generator->tail_jumps);
+        printf("Recursões de cauda transformadas em laço: %d\n", generator->tail_loops);
+    }
+    if (generator->switch_statements) {
+        printf("\n=== SWITCH ===\n");
+        printf("Switches: %d\n", generator->switch_statements);
+        if (generator->output_type == OUTPUT_BYTECODE) {
+            printf("TABLESWITCH: %d, LOOKUPSWITCH: %d\n", generator->switch_tables, generator->switch_lookups);
+        } else {
+            printf("Clusters: %d tabelas de salto, %d testes de bits, %d casos isolados\n",
+                   generator->switch_tables, generator->switch_bitsets, generator->switch_compares);
+            printf("Comparações da busca binária: %d\n", generator->switch_searches);
+        }
+    }
+    if (generator->select_moves + generator->select_sets > 0) {
+        printf("\n=== SELEÇÕES SEM DESVIO ===\n");
+        if (generator->output_type == OUTPUT_BYTECODE) {
+            printf("ISELECT: %d\n", generator->select_moves);
+        } else {
+            printf("cmov: %d, setcc: %d\n", generator->select_moves, generator->select_sets);
+        }
+    }
+    if (generator->memoized_functions) {
+        printf("\n=== MEMOIZAÇÃO ===\n");
+        printf("Funções com tabela de resultados: %d (%d entradas cada)\n", generator->memoized_functions,
+               MEMO_TABLE_ENTRIES);
+    }
+    if (generator->output_type != OUTPUT_ASSEMBLY) return;
+
+    if (generator->allocate_registers) {
+        printf("\n=== ALOCAÇÃO DE REGISTRADORES ===\n");
+        printf("Locais em registradores: %d\n", generator->locals_in_registers);
+        printf("Locais no frame: %d (%d candidatas a registrador), em %d slots após a coloração\n",
+               generator->memory_locals, generator->locals_spilled, generator->spill_slots);
+    }
+    if (generator->select_instructions) {
+        print_selection_stats(generator);
+    }
+    if (generator->magic_divisions + generator->shift_divisions + generator->multiply_chains > 0) {
+        printf("\n=== ARITMÉTICA COM CONSTANTES ===\n");
+        printf("Divisões/restos: %d por número mágico, %d por deslocamento\n",
+               generator->magic_divisions, generator->shift_divisions);
+        printf("Multiplicações por shl/lea/add: %d\n", generator->multiply_chains);
+    }
+    if (generator->vector_width) {
+        printf("\n=== VETORIZAÇÃO ===\n");
+        printf("Laços vetorizados: %d (%d reduções, %s com %d lanes de 32 bits)\n",
+               generator->vectorized_loops, generator->vector_reductions,
+               generator->vector_width == 8 ? "AVX2" : "SSE2", generator->vector_width);
+    }
+    if (generator->peephole) {
+        peephole_print_stats(&generator->peephole_stats);
+    }
+}
+
 void code_generator_destroy(CodeGenerator* generator) {
     if (generator) {
         if (generator->output_file) {
             fclose(generator->output_file);
         }
         free(generator->current_function);
+        free(generator->return_label);
+        free(generator->body_label);
+        free(generator->literals);
+        free(generator->cold_blocks);
+        for (int i = 0; i < generator->jump_table_count; i++) {
+            free(generator->jump_tables[i]);
+        }
+        free(generator->jump_tables);
         free(generator);
     }
 }
 
+// ============================================================
+// Utilitários comuns
+// ============================================================
+
+static const char* binary_operator_symbol(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "+";
+        case TOKEN_MINUS: return "-";
+        case TOKEN_MULTIPLY: return "*";
+        case TOKEN_DIVIDE: return "/";
+        case TOKEN_MODULO: return "%";
+        case TOKEN_EQUAL: return "==";
+        case TOKEN_NOT_EQUAL: return "!=";
+        case TOKEN_LESS: return "<";
+        case TOKEN_GREATER: return ">";
+        case TOKEN_LESS_EQUAL: return "<=";
+        case TOKEN_GREATER_EQUAL: return ">=";
+        case TOKEN_AND: return "&&";
+        case TOKEN_OR: return "||";
+        case TOKEN_BITWISE_AND: return "&";
+        case TOKEN_BITWISE_OR: return "|";
+        case TOKEN_BITWISE_XOR: return "^";
+        case TOKEN_LEFT_SHIFT: return "<<";
+        case TOKEN_RIGHT_SHIFT: return ">>";
+        case TOKEN_COMMA: return ",";
+        default: return "?";
+    }
+}
+
+static int is_comparison_operator(TokenType op) {
+    return op == TOKEN_EQUAL || op == TOKEN_NOT_EQUAL ||
+           op == TOKEN_LESS || op == TOKEN_GREATER ||
+           op == TOKEN_LESS_EQUAL || op == TOKEN_GREATER_EQUAL;
+}
+
+// Literais de string chegam do lexer com os escapes já processados
+static void emit_escaped_string(CodeGenerator* gen, const char* value) {
+    fputc('"', gen->output_file);
+    for (const unsigned char* p = (const unsigned char*)value; *p; p++) {
+        switch (*p) {
+            case '\n': fputs("\\n", gen->output_file); break;
+            case '\t': fputs("\\t", gen->output_file); break;
+            case '\\': fputs("\\\\", gen->output_file); break;
+            case '"': fputs("\\\"", gen->output_file); break;
+            default:
+                if (*p < 32) {
+                    fprintf(gen->output_file, "\\%03o", *p);
+                } else {
+                    fputc(*p, gen->output_file);
+                }
+                break;
+        }
+    }
+    fputc('"', gen->output_file);
+}
+
+// Literais de char chegam com o texto original entre aspas simples
+static void emit_indent(CodeGenerator* gen) {
+    for (int i = 0; i < gen->indent_level; i++) {
+        fputs("    ", gen->output_file);
+    }
+}
+
+static int is_float_type(DataType type) {
+    return type == TYPE_FLOAT;
+}
+
+// Ponteiros e arrays (que decaem para ponteiro) ocupam 64 bits
+static int is_address_type(DataType type) {
+    return type == TYPE_POINTER || type == TYPE_ARRAY;
+}
+
+// Tamanho do elemento apontado, usado para escalar a aritmética de ponteiros
+static int pointee_size(CodeGenerator* gen, TypeId id) {
+    const TypeInfo* info = type_info(gen->symbol_table->types, id);
+    if (!info || (info->kind != TYPEKIND_POINTER && info->kind != TYPEKIND_ARRAY)) return 1;
+
+    int size = type_size(gen->symbol_table->types, info->element);
+    return size > 0 ? size : 1;
+}
+
+// Emite "tipo nome" com a sintaxe de declarador C (ponteiros e dimensão)
+static void emit_c_declarator(CodeGenerator* gen, TypeId id, const char* name) {
+    TypeTable* types = gen->symbol_table->types;
+    const TypeInfo* info = type_info(types, id);
+    char buffer[256];
+
+    if (info && info->kind == TYPEKIND_ARRAY) {
+        type_to_string(types, info->element, buffer, sizeof(buffer));
+        emit_code(gen, "%s %s[%d]", buffer, name, info->count);
+    } else {
+        type_to_string(types, id, buffer, sizeof(buffer));
+        emit_code(gen, "%s %s", buffer, name);
+    }
+}
+
+// ============================================================
+// Perfil de execução
+//
+// Com -fprofile-generate cada ponto (profile.h) tem dois contadores de
+// 64 bits seguidos: _profile_counts no C, .Lprofile_counts no assembly e
+// COUNT <contador> no bytecode. Ao terminar, o programa grava o arquivo
+// de perfil com uma linha por ponto.
+// ============================================================
+
+// Primeiro contador do ponto do nó; -1 sem instrumentação ou sem ponto
+static int profile_counter(CodeGenerator* gen, const ASTNode* node) {
+    if (!gen->profile || !gen->profile->generate_path || !node || node->profile_point < 0) return -1;
+    return node->profile_point * PROFILE_COUNTERS;
+}
+
+static void c_count(CodeGenerator* gen, int counter) {
+    if (counter < 0) return;
+    emit_indent(gen);
+    emit_code(gen, "_profile_counts[%d]++;\n", counter);
+}
+
+// Segundo contador de um desvio: vezes em que a condição deu verdadeiro
+static int profile_taken(int counter) {
+    return counter >= 0 ? counter + 1 : -1;
+}
+
+static void asm_count(CodeGenerator* gen, int counter) {
+    if (counter >= 0) emit_code(gen, "    incq .Lprofile_counts+%d(%%rip)\n", counter * 8);
+}
+
+static void bc_count(CodeGenerator* gen, int counter) {
+    if (counter >= 0) emit_code(gen, "COUNT %d\n", counter);
+}
+
+// Destrutor que grava o perfil ao fim da execução
+static void c_profile_writer(CodeGenerator* gen) {
+    int count = gen->profile->count;
+    emit_code(gen, "\nstatic const char* const _profile_keys[%d] = {\n", count);
+    for (int i = 0; i < count; i++) {
+        char key[320];
+        profile_point_key(&gen->profile->points[i], key, sizeof(key));
+        emit_code(gen, "    \"%s\",\n", key);
+    }
+    emit_code(gen, "};\n\n");
+    emit_code(gen, "__attribute__((destructor)) static void _profile_write(void) {\n");
+    emit_code(gen, "    FILE* file = fopen(");
+    emit_escaped_string(gen, gen->profile->generate_path);
+    emit_code(gen, ", \"w\");\n");
+    emit_code(gen, "    if (!file) return;\n");
+    emit_code(gen, "    for (int i = 0; i < %d; i++) {\n", count);
+    emit_code(gen, "        fprintf(file, \"%%s %%lu %%lu\\n\", _profile_keys[i], "
+                   "_profile_counts[%d * i], _profile_counts[%d * i + 1]);\n",
+              PROFILE_COUNTERS, PROFILE_COUNTERS);
+    emit_code(gen, "    }\n");
+    emit_code(gen, "    fclose(file);\n");
+    emit_code(gen, "}\n");
+}
+
+// Os contadores ficam em .bss, as chaves numa tabela de ponteiros e a
+// função que grava o arquivo é registrada em .fini_array, que a libc
+// percorre depois do retorno de main ou de exit()
+static void asm_profile_writer(CodeGenerator* gen) {
+    int count = gen->profile->count;
+    emit_code(gen, ".text\n.Lprofile_write:\n");
+    emit_code(gen, "    push %%rbp\n    mov %%rsp, %%rbp\n    push %%rbx\n    push %%r12\n");
+    emit_code(gen, "    leaq .Lprofile_path(%%rip), %%rdi\n    leaq .Lprofile_mode(%%rip), %%rsi\n");
+    emit_code(gen, "    call fopen\n    testq %%rax, %%rax\n    je .Lprofile_done\n");
+    emit_code(gen, "    movq %%rax, %%rbx\n    xorl %%r12d, %%r12d\n");
+    emit_code(gen, ".Lprofile_next:\n");
+    emit_code(gen, "    movq %%rbx, %%rdi\n    leaq .Lprofile_format(%%rip), %%rsi\n");
+    emit_code(gen, "    leaq .Lprofile_keys(%%rip), %%rax\n    movq (%%rax,%%r12,8), %%rdx\n");
+    // PROFILE_COUNTERS contadores de 8 bytes por ponto
+    emit_code(gen, "    movq %%r12, %%rax\n    shlq $4, %%rax\n    leaq .Lprofile_counts(%%rip), %%r8\n");
+    emit_code(gen, "    movq (%%r8,%%rax), %%rcx\n    movq 8(%%r8,%%rax), %%r8\n");
+    emit_code(gen, "    movl $0, %%eax\n    call fprintf\n");
+    emit_code(gen, "    incq %%r12\n    cmpq $%d, %%r12\n    jl .Lprofile_next\n", count);
+    emit_code(gen, "    movq %%rbx, %%rdi\n    call fclose\n");
+    emit_code(gen, ".Lprofile_done:\n    pop %%r12\n    pop %%rbx\n    pop %%rbp\n    ret\n\n");
+
+    emit_code(gen, ".section .fini_array,\"aw\"\n    .align 8\n    .quad .Lprofile_write\n");
+    emit_code(gen, ".bss\n    .align 8\n.Lprofile_counts:\n    .zero %d\n", count * PROFILE_COUNTERS * 8);
+    emit_code(gen, ".section .data.rel.ro,\"aw\"\n    .align 8\n.Lprofile_keys:\n");
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, "    .quad .LPK%d\n", i);
+    }
+    emit_code(gen, ".section .rodata\n.Lprofile_path:\n    .string ");
+    emit_escaped_string(gen, gen->profile->generate_path);
+    emit_code(gen, "\n.Lprofile_mode:\n    .string \"w\"\n");
+    emit_code(gen, ".Lprofile_format:\n    .string \"%%s %%lu %%lu\\n\"\n");
+    for (int i = 0; i < count; i++) {
+        char key[320];
+        profile_point_key(&gen->profile->points[i], key, sizeof(key));
+        emit_code(gen, ".LPK%d:\n    .string \"%s\"\n", i, key);
+    }
+}
+
+// ============================================================
+// Entrada
+// ============================================================
+
 int generate_code(CodeGenerator* generator, ASTNode* ast, SymbolTable* symbols) {
     if (!generator || !ast) return 0;
-    
+
     generator->symbol_table = symbols;
-    
+    int instrument = generator->profile && generator->profile->generate_path && generator->profile->count > 0;
+    if (generator->profile && !instrument) generator->profile->generate_path = NULL;
+
     // Cabeçalho do arquivo gerado
     switch (generator->output_type) {
         case OUTPUT_C:
             emit_comment(generator, "Código C gerado pelo compilador");
             emit_code(generator, "#include <stdio.h>\n");
-            emit_code(generator, "#include <stdlib.h>\n\n");
+            emit_code(generator, "#include <stdlib.h>\n");
+            emit_code(generator, "#include <string.h>\n\n");
+            if (instrument) {
+                emit_code(generator, "static unsigned long _profile_counts[%d];\n\n",
+                          generator->profile->count * PROFILE_COUNTERS);
+            }
             break;
-            
+
         case OUTPUT_ASSEMBLY:
             emit_comment(generator, "Assembly x86-64 gerado pelo compilador");
-            emit_code(generator, ".section .text\n");
-            emit_code(generator, ".global _start\n\n");
+            emit_code(generator, ".text\n\n");
             break;
-            
+
         case OUTPUT_BYTECODE:
             emit_comment(generator, "Bytecode gerado pelo compilador");
+            if (instrument) {
+                // Tabela dos pontos; o contador k pertence ao ponto k / 2
+                emit_code(generator, "PROFILE ");
+                emit_escaped_string(generator, generator->profile->generate_path);
+                emit_code(generator, " %d\n", generator->profile->count);
+                for (int i = 0; i < generator->profile->count; i++) {
+                    char key[320];
+                    profile_point_key(&generator->profile->points[i], key, sizeof(key));
+                    emit_code(generator, "POINT %d %s\n", i * PROFILE_COUNTERS, key);
+                }
+                emit_code(generator, "\n");
+            }
             break;
     }
-    
+
     generate_program(generator, ast);
+    if (instrument && generator->output_type == OUTPUT_C) c_profile_writer(generator);
+    if (instrument && generator->output_type == OUTPUT_ASSEMBLY) asm_profile_writer(generator);
+
+    // Literais de string e float referenciados pelo assembly
+    if (generator->output_type == OUTPUT_ASSEMBLY &&
+        (generator->literal_count > 0 || generator->vector_lanes_used || generator->jump_table_count > 0)) {
+        emit_code(generator, ".section .rodata\n");
+        if (generator->jump_table_count > 0) emit_code(generator, "    .align 4\n");
+        for (int i = 0; i < generator->jump_table_count; i++) {
+            emit_code(generator, "%s", generator->jump_tables[i]);
+        }
+        if (generator->vector_lanes_used) {
+            // Deslocamento de cada lane do contador vetorizado
+            emit_code(generator, "    .align 32\n.Lvector_lanes:\n    .long 0, 1, 2, 3, 4, 5, 6, 7\n");
+        }
+        for (int i = 0; i < generator->literal_count; i++) {
+            ASTNode* literal = generator->literals[i];
+            if (literal->type == AST_STRING_LITERAL) {
+                emit_code(generator, ".LS%d:\n    .string ", i);
+                emit_escaped_string(generator, literal->data.literal.value);
+                emit_code(generator, "\n");
+            } else {
+                emit_code(generator, "    .align 4\n.LF%d:\n    .float %s\n", i,
+                          literal->data.literal.value);
+            }
+        }
+    }
+    if (generator->output_type == OUTPUT_ASSEMBLY) {
+        emit_code(generator, "    .section .note.GNU-stack,\"\",@progbits\n");
+    }
+
     return 1;
 }
 
 void generate_program(CodeGenerator* gen, ASTNode* node) {
+    // Em C, protótipos permitem chamadas a funções definidas mais adiante
+    if (gen->output_type == OUTPUT_C) {
+        int has_prototypes = 0;
+        for (int i = 0; i < node->child_count; i++) {
+            ASTNode* child = node->children[i];
+            if (child->type != AST_FUNCTION_DECLARATION) continue;
+
+            emit_c_declarator(gen, child->type_id, child->data.function_decl.name);
+            emit_code(gen, "(");
+            ASTNode* params = child->data.function_decl.parameters;
+            for (int j = 0; params && j < params->child_count; j++) {
+                if (j > 0) emit_code(gen, ", ");
+                emit_c_declarator(gen, params->children[j]->type_id,
+                                  params->children[j]->data.parameter.name);
+            }
+            emit_code(gen, ");\n");
+            has_prototypes = 1;
+        }
+        if (has_prototypes) emit_code(gen, "\n");
+    }
+
     for (int i = 0; i < node->child_count; i++) {
         ASTNode* child = node->children[i];
-        
+
         switch (child->type) {
             case AST_FUNCTION_DECLARATION:
                 generate_function_declaration(gen, child);
@@ -77,216 +479,3557 @@ void generate_program(CodeGenerator* gen, ASTNode* node) {
     }
 }
 
+// ============================================================
+// Funções
+// ============================================================
+
+// Restaura os registradores preservados e desfaz o frame
+static void asm_leave_frame(CodeGenerator* gen) {
+    RegisterAllocation* allocation = gen->allocation;
+    for (int r = 0; allocation && r < CALLEE_SAVED_COUNT; r++) {
+        if (allocation->save_offsets[r]) {
+            emit_code(gen, "    movq %d(%%rbp), %s\n", allocation->save_offsets[r], register_name(r, TYPE_POINTER));
+        }
+    }
+    emit_code(gen, "    leave\n");
+}
+
+static void asm_function_declaration(CodeGenerator* gen, ASTNode* node) {
+    const char* func_name = gen->current_function;
+    int frame_size = node->data.function_decl.frame_size;
+    gen->stack_depth = 0;
+
+    // Com -O, locais em registradores e um frame refeito pelo alocador
+    RegisterAllocation* allocation = NULL;
+    if (gen->allocate_registers) {
+        allocation = register_allocation_create(node, gen->symbol_table->types);
+        frame_size = allocation->frame_size;
+        gen->locals_in_registers += allocation->in_registers;
+        gen->locals_spilled += allocation->spilled;
+        gen->memory_locals += allocation->memory_locals;
+        gen->spill_slots += allocation->spill_slots;
+    }
+    frame_size = (frame_size + 15) / 16 * 16;
+
+    free(gen->return_label);
+    gen->return_label = generate_label(gen, "return");
+
+    // Com o peephole, o texto da função vai para a memória e só chega ao
+    // arquivo depois de passar pelas regras
+    FILE* file = gen->output_file;
+    char* text = NULL;
+    size_t text_size = 0;
+    int cold = profile_never_executed(gen->profile, node);
+    if (cold) {
+        emit_code(gen, ".section .text.unlikely,\"ax\",@progbits\n");
+        gen->profile->cold_functions++;
+    }
+    if (gen->peephole) {
+        gen->output_file = open_memstream(&text, &text_size);
+    }
+
+    emit_code(gen, "    .globl %s\n", func_name);
+    emit_code(gen, "%s:\n", func_name);
+    emit_code(gen, "    push %%rbp\n");
+    emit_code(gen, "    mov %%rsp, %%rbp\n");
+    if (frame_size > 0) {
+        emit_code(gen, "    sub $%d, %%rsp\n", frame_size);
+    }
+    for (int r = 0; allocation && r < CALLEE_SAVED_COUNT; r++) {
+        if (allocation->save_offsets[r]) {
+            emit_code(gen, "    movq %s, %d(%%rbp)\n", register_name(r, TYPE_POINTER), allocation->save_offsets[r]);
+        }
+    }
+
+    // A recursão de cauda volta para cá com os argumentos novos nos
+    // registradores, reaproveitando o frame
+    free(gen->body_label);
+    gen->body_label = generate_label(gen, "body");
+    gen->allocation = allocation;
+    if (gen->tail_calls) emit_code(gen, ".L%s:\n", gen->body_label);
+    asm_count(gen, profile_counter(gen, node));
+
+    // Copiar parâmetros dos registradores para seus slots; os que não
+    // couberam nos registradores chegam na pilha a partir de 16(%rbp)
+    ASTNode* params = node->data.function_decl.parameters;
+    int int_index = 0;
+    int float_index = 0;
+    int stack_offset = 16;
+    for (int i = 0; params && i < params->child_count; i++) {
+        Symbol* symbol = params->children[i]->ref.symbol;
+        if (!symbol) continue;
+        int offset = symbol->info.variable.offset;
+
+        if (is_float_type(symbol->type)) {
+            if (float_index < MAX_FLOAT_ARGS) {
+                emit_code(gen, "    movss %%xmm%d, %d(%%rbp)\n", float_index, offset);
+            } else {
+                // Os xmm de argumento já foram todos copiados
+                emit_code(gen, "    movss %d(%%rbp), %%xmm0\n", stack_offset);
+                emit_code(gen, "    movss %%xmm0, %d(%%rbp)\n", offset);
+                stack_offset += 8;
+            }
+            float_index++;
+        } else {
+            int reg = symbol->info.variable.reg;
+            if (int_index < MAX_INT_ARGS && reg != NO_REGISTER) {
+                if (symbol->type == TYPE_CHAR) {
+                    emit_code(gen, "    movsbl %s, %s\n", arg_registers_8[int_index], register_name(reg, TYPE_INT));
+                } else if (symbol->type == TYPE_POINTER) {
+                    emit_code(gen, "    movq %s, %s\n", arg_registers_64[int_index], register_name(reg, TYPE_POINTER));
+                } else {
+                    emit_code(gen, "    movl %s, %s\n", arg_registers_32[int_index], register_name(reg, TYPE_INT));
+                }
+            } else if (int_index < MAX_INT_ARGS) {
+                if (symbol->type == TYPE_CHAR) {
+                    emit_code(gen, "    movb %s, %d(%%rbp)\n", arg_registers_8[int_index], offset);
+                } else if (symbol->type == TYPE_POINTER) {
+                    emit_code(gen, "    movq %s, %d(%%rbp)\n", arg_registers_64[int_index], offset);
+                } else {
+                    emit_code(gen, "    movl %s, %d(%%rbp)\n", arg_registers_32[int_index], offset);
+                }
+            } else if (reg != NO_REGISTER) {
+                if (symbol->type == TYPE_CHAR) {
+                    emit_code(gen, "    movsbl %d(%%rbp), %s\n", stack_offset, register_name(reg, TYPE_INT));
+                } else if (symbol->type == TYPE_POINTER) {
+                    emit_code(gen, "    movq %d(%%rbp), %s\n", stack_offset, register_name(reg, TYPE_POINTER));
+                } else {
+                    emit_code(gen, "    movl %d(%%rbp), %s\n", stack_offset, register_name(reg, TYPE_INT));
+                }
+                stack_offset += 8;
+            } else {
+                // Memória para memória passa por %rax
+                if (symbol->type == TYPE_CHAR) {
+                    emit_code(gen, "    movb %d(%%rbp), %%al\n    movb %%al, %d(%%rbp)\n", stack_offset, offset);
+                } else if (symbol->type == TYPE_POINTER) {
+                    emit_code(gen, "    movq %d(%%rbp), %%rax\n    movq %%rax, %d(%%rbp)\n", stack_offset, offset);
+                } else {
+                    emit_code(gen, "    movl %d(%%rbp), %%eax\n    movl %%eax, %d(%%rbp)\n", stack_offset, offset);
+                }
+                stack_offset += 8;
+            }
+            int_index++;
+        }
+    }
+
+    if (node->data.function_decl.body) {
+        generate_statement(gen, node->data.function_decl.body);
+    }
+
+    // Retorno implícito ao cair no fim da função
+    if (is_float_type(gen->current_return_type)) {
+        emit_code(gen, "    xorps %%xmm0, %%xmm0\n");
+    } else {
+        emit_code(gen, "    movl $0, %%eax\n");
+    }
+    emit_code(gen, ".L%s:\n", gen->return_label);
+    asm_leave_frame(gen);
+    emit_code(gen, "    ret\n\n");
+    asm_cold_blocks(gen, cold);
+    gen->allocation = NULL;
+    register_allocation_destroy(allocation);
+
+    if (gen->peephole) {
+        fclose(gen->output_file);
+        gen->output_file = file;
+        AsmList* list = asm_list_parse(text);
+        peephole_optimize(list, &gen->peephole_stats);
+        asm_list_write(list, file);
+        asm_list_destroy(list);
+        free(text);
+    }
+    if (cold) emit_code(gen, ".text\n\n");
+}
+
+// Há return f(...) da própria função fora de laços internos? Nesses o
+// continue do laço que substitui a chamada iria para o laço errado.
+static int has_self_tail_call(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_RETURN_STATEMENT: {
+            ASTNode* call = tail_call(gen, node);
+            return call && strcmp(call->data.function_call.name, gen->current_function) == 0;
+        }
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                if (has_self_tail_call(gen, node->children[i])) return 1;
+            }
+            return 0;
+        case AST_IF_STATEMENT:
+            return has_self_tail_call(gen, node->data.if_stmt.then_stmt) ||
+                   has_self_tail_call(gen, node->data.if_stmt.else_stmt);
+        case AST_SWITCH_STATEMENT:
+            return has_self_tail_call(gen, node->data.switch_stmt.cases);
+        default:
+            return 0;
+    }
+}
+
+// Alguma declaração do corpo esconde o parâmetro? A atribuição que
+// substitui a chamada iria para a variável local.
+static int declares_name(ASTNode* node, const char* name) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            return strcmp(node->data.var_decl.name, name) == 0;
+        case AST_IF_STATEMENT:
+            return declares_name(node->data.if_stmt.then_stmt, name) ||
+                   declares_name(node->data.if_stmt.else_stmt, name);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return declares_name(node->data.while_stmt.body, name);
+        case AST_FOR_STATEMENT:
+            return declares_name(node->data.for_stmt.init, name) ||
+                   declares_name(node->data.for_stmt.body, name);
+        case AST_SWITCH_STATEMENT:
+            return declares_name(node->data.switch_stmt.cases, name);
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                if (declares_name(node->children[i], name)) return 1;
+            }
+            return 0;
+    }
+}
+
+// Com -O, a recursão de cauda vira um laço sobre o corpo da função
+static int c_tail_loop(CodeGenerator* gen, ASTNode* node) {
+    ASTNode* body = node->data.function_decl.body;
+    if (!has_self_tail_call(gen, body)) return 0;
+
+    ASTNode* params = node->data.function_decl.parameters;
+    for (int i = 0; params && i < params->child_count; i++) {
+        if (declares_name(body, params->children[i]->data.parameter.name)) return 0;
+    }
+    return 1;
+}
+
+// return f(...) da própria função: os argumentos vão para temporários
+// (podem ler os parâmetros antigos), depois para os parâmetros, e o laço
+// recomeça. Argumento igual ao próprio parâmetro não muda nada.
+static void c_tail_recursion(CodeGenerator* gen, ASTNode* call) {
+    ASTNode* params = gen->tail_function->data.function_decl.parameters;
+    char** temps = calloc(call->child_count + 1, sizeof(char*));
+
+    emit_indent(gen);
+    emit_code(gen, "{\n");
+    gen->indent_level++;
+    c_count(gen, profile_counter(gen, call));
+    for (int i = 0; i < call->child_count; i++) {
+        ASTNode* param = params->children[i];
+        ASTNode* arg = call->children[i];
+        if (arg->type == AST_IDENTIFIER &&
+            strcmp(arg->data.identifier.name, param->data.parameter.name) == 0) continue;
+
+        temps[i] = generate_temp_var(gen);
+        emit_indent(gen);
+        emit_c_declarator(gen, param->type_id, temps[i]);
+        emit_code(gen, " = ");
+        c_expression(gen, arg);
+        emit_code(gen, ";\n");
+    }
+    for (int i = 0; i < call->child_count; i++) {
+        if (!temps[i]) continue;
+        emit_indent(gen);
+        emit_code(gen, "%s = %s;\n", params->children[i]->data.parameter.name, temps[i]);
+        free(temps[i]);
+    }
+    emit_indent(gen);
+    emit_code(gen, "continue;\n");
+    gen->indent_level--;
+    emit_indent(gen);
+    emit_code(gen, "}\n");
+    free(temps);
+    gen->tail_loops++;
+}
+
+// ------------------------------------------------------------
+// Memoização (-fmemoize)
+//
+// O corpo de f sai como _memo_corpo_f e f vira um invólucro sobre
+// _memo_tabela_f, de MEMO_TABLE_ENTRIES entradas {pronto, chaves[k],
+// valor}. O índice é h & (entradas - 1), com h = a0 e h = h * 31 + ai
+// para os demais argumentos; uma entrada ocupada por outros argumentos
+// é sobrescrita, então a tabela nunca cresce. As chamadas recursivas do
+// corpo vão para f e passam pela tabela.
+// ------------------------------------------------------------
+
+static void c_memo_wrapper(CodeGenerator* gen, ASTNode* node, const char* body_name) {
+    const char* name = node->data.function_decl.name;
+    ASTNode* params = node->data.function_decl.parameters;
+    int count = params->child_count;
+
+    emit_code(gen, "static struct { int pronto; int chaves[%d]; int valor; } _memo_tabela_%s[%d];\n\n",
+              count, name, MEMO_TABLE_ENTRIES);
+    emit_c_declarator(gen, node->type_id, name);
+    emit_code(gen, "(");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) emit_code(gen, ", ");
+        emit_c_declarator(gen, params->children[i]->type_id, params->children[i]->data.parameter.name);
+    }
+    emit_code(gen, ") {\n");
+
+    emit_code(gen, "    unsigned int _memo_i = (unsigned int)%s;\n", params->children[0]->data.parameter.name);
+    for (int i = 1; i < count; i++) {
+        emit_code(gen, "    _memo_i = _memo_i * 31u + (unsigned int)%s;\n", params->children[i]->data.parameter.name);
+    }
+    emit_code(gen, "    _memo_i &= %du;\n", MEMO_TABLE_ENTRIES - 1);
+    emit_code(gen, "    if (_memo_tabela_%s[_memo_i].pronto", name);
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, " && _memo_tabela_%s[_memo_i].chaves[%d] == %s", name, i,
+                  params->children[i]->data.parameter.name);
+    }
+    emit_code(gen, ") {\n        return _memo_tabela_%s[_memo_i].valor;\n    }\n", name);
+
+    emit_code(gen, "    int _memo_valor = %s(", body_name);
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, "%s%s", i > 0 ? ", " : "", params->children[i]->data.parameter.name);
+    }
+    emit_code(gen, ");\n");
+    emit_code(gen, "    _memo_tabela_%s[_memo_i].pronto = 1;\n", name);
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, "    _memo_tabela_%s[_memo_i].chaves[%d] = %s;\n", name, i,
+                  params->children[i]->data.parameter.name);
+    }
+    emit_code(gen, "    _memo_tabela_%s[_memo_i].valor = _memo_valor;\n", name);
+    emit_code(gen, "    return _memo_valor;\n}\n\n");
+}
+
+// Os argumentos chegam em registradores e voltam a eles para a chamada do
+// corpo; a entrada (%r11) e os argumentos ficam no frame durante ela
+static void asm_memo_wrapper(CodeGenerator* gen, ASTNode* node, const char* body_name) {
+    const char* name = node->data.function_decl.name;
+    int count = node->data.function_decl.parameters->child_count;
+    int stride = (count + 2) * 4;
+    char* miss_label = generate_label(gen, "memo_miss");
+
+    emit_code(gen, "    .local _memo_tabela_%s\n", name);
+    emit_code(gen, "    .comm _memo_tabela_%s, %d, 16\n", name, stride * MEMO_TABLE_ENTRIES);
+    emit_code(gen, "    .globl %s\n%s:\n", name, name);
+    emit_code(gen, "    push %%rbp\n    mov %%rsp, %%rbp\n    sub $32, %%rsp\n");
+
+    emit_code(gen, "    movl %s, %%eax\n", arg_registers_32[0]);
+    for (int i = 1; i < count; i++) {
+        emit_code(gen, "    imull $31, %%eax, %%eax\n    addl %s, %%eax\n", arg_registers_32[i]);
+    }
+    emit_code(gen, "    andl $%d, %%eax\n", MEMO_TABLE_ENTRIES - 1);
+    emit_code(gen, "    imull $%d, %%eax, %%eax\n", stride);
+    emit_code(gen, "    leaq _memo_tabela_%s(%%rip), %%r11\n    addq %%rax, %%r11\n", name);
+    emit_code(gen, "    cmpl $0, (%%r11)\n    je .L%s\n", miss_label);
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, "    cmpl %s, %d(%%r11)\n    jne .L%s\n", arg_registers_32[i], 4 * (i + 1), miss_label);
+    }
+    emit_code(gen, "    movl %d(%%r11), %%eax\n    leave\n    ret\n", 4 * (count + 1));
+
+    emit_code(gen, ".L%s:\n", miss_label);
+    emit_code(gen, "    movq %%r11, -8(%%rbp)\n");
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, "    movl %s, %d(%%rbp)\n", arg_registers_32[i], -12 - 4 * i);
+    }
+    emit_code(gen, "    movl $0, %%eax\n    call %s\n", body_name);
+    emit_code(gen, "    movq -8(%%rbp), %%r11\n");
+    for (int i = 0; i < count; i++) {
+        emit_code(gen, "    movl %d(%%rbp), %%ecx\n    movl %%ecx, %d(%%r11)\n", -12 - 4 * i, 4 * (i + 1));
+    }
+    emit_code(gen, "    movl %%eax, %d(%%r11)\n    movl $1, (%%r11)\n", 4 * (count + 1));
+    emit_code(gen, "    leave\n    ret\n\n");
+    free(miss_label);
+}
+
+static void bc_parameters(CodeGenerator* gen, ASTNode* params) {
+    for (int i = 0; params && i < params->child_count; i++) {
+        char type_name[256];
+        type_to_string(gen->symbol_table->types, params->children[i]->type_id, type_name, sizeof(type_name));
+        emit_code(gen, "PARAM %s %s %d\n", type_name, params->children[i]->data.parameter.name,
+                  params->children[i]->ref.slot);
+    }
+}
+
+static void bc_memo_wrapper(CodeGenerator* gen, ASTNode* node, const char* body_name) {
+    const char* name = node->data.function_decl.name;
+    ASTNode* params = node->data.function_decl.parameters;
+    int count = params->child_count;
+    char* miss_label = generate_label(gen, "memo_miss");
+
+    emit_code(gen, "MEMOTABLE _memo_tabela_%s %d %d\n", name, MEMO_TABLE_ENTRIES, count);
+    emit_code(gen, "FUNC %s %d\n", name, count);
+    bc_parameters(gen, params);
+    for (int i = 0; i < count; i++) emit_code(gen, "LOADL %d\n", params->children[i]->ref.slot);
+    emit_code(gen, "MEMOGET _memo_tabela_%s %d %s\nRETV\n%s:\n", name, count, miss_label, miss_label);
+    for (int i = 0; i < count; i++) emit_code(gen, "LOADL %d\n", params->children[i]->ref.slot);
+    emit_code(gen, "CALL %s %d\n", body_name, count);
+    for (int i = 0; i < count; i++) emit_code(gen, "LOADL %d\n", params->children[i]->ref.slot);
+    emit_code(gen, "MEMOPUT _memo_tabela_%s %d\nRETV\nENDFUNC\n\n", name, count);
+    free(miss_label);
+}
+
 void generate_function_declaration(CodeGenerator* gen, ASTNode* node) {
     const char* func_name = node->data.function_decl.name;
-    
+    char memo_body[256];
+    if (node->data.function_decl.memoized) {
+        snprintf(memo_body, sizeof(memo_body), "_memo_corpo_%s", func_name);
+        func_name = memo_body;
+    }
+
     free(gen->current_function);
     gen->current_function = strdup(func_name);
-    gen->current_offset = 0;
-    
+    gen->current_return_type = node->data_type;
+
     switch (gen->output_type) {
-        case OUTPUT_C:
-            emit_code(gen, "%s %s(", 
-                     data_type_to_string(node->data.function_decl.return_type),
-                     func_name);
-            
-            // Parâmetros (simplificado)
+        case OUTPUT_C: {
+            if (profile_never_executed(gen->profile, node)) {
+                emit_code(gen, "__attribute__((cold)) ");
+                gen->profile->cold_functions++;
+            }
+            emit_c_declarator(gen, node->type_id, func_name);
+            emit_code(gen, "(");
+
+            ASTNode* params = node->data.function_decl.parameters;
+            for (int i = 0; params && i < params->child_count; i++) {
+                if (i > 0) emit_code(gen, ", ");
+                emit_c_declarator(gen, params->children[i]->type_id,
+                                  params->children[i]->data.parameter.name);
+            }
             emit_code(gen, ") {\n");
-            
+
             // Corpo da função
-            if (node->data.function_decl.body) {
-                generate_statement(gen, node->data.function_decl.body);
+            gen->indent_level = 1;
+            gen->tail_function = c_tail_loop(gen, node) ? node : NULL;
+            gen->loop_depth = 0;
+            if (gen->tail_function) {
+                emit_code(gen, "    while (1) {\n");
+                gen->indent_level = 2;
+            }
+            // Cada volta do laço da recursão de cauda conta como uma entrada
+            c_count(gen, profile_counter(gen, node));
+            ASTNode* body = node->data.function_decl.body;
+            if (body && body->type == AST_COMPOUND_STATEMENT) {
+                for (int i = 0; i < body->child_count; i++) {
+                    generate_statement(gen, body->children[i]);
+                }
+            } else if (body) {
+                generate_statement(gen, body);
+            }
+            if (gen->tail_function) {
+                emit_code(gen, "        break;\n");
+                emit_code(gen, "    }\n");
+                gen->tail_function = NULL;
             }
-            
+            gen->indent_level = 0;
+
             emit_code(gen, "}\n\n");
             break;
-            
+        }
+
         case OUTPUT_ASSEMBLY:
-            emit_code(gen, "%s:\n", func_name);
-            emit_code(gen, "    push %%rbp\n");
-            emit_code(gen, "    mov %%rsp, %%rbp\n");
-            
-            if (node->data.function_decl.body) {
-                generate_statement(gen, node->data.function_decl.body);
-            }
-            
-            emit_code(gen, "    pop %%rbp\n");
-            emit_code(gen, "    ret\n\n");
+            asm_function_declaration(gen, node);
             break;
-            
-        case OUTPUT_BYTECODE:
-            emit_code(gen, "FUNC %s\n", func_name);
+
+        case OUTPUT_BYTECODE: {
+            emit_code(gen, "FUNC %s %d\n", func_name, node->data.function_decl.local_count);
+            bc_parameters(gen, node->data.function_decl.parameters);
+            bc_count(gen, profile_counter(gen, node));
             if (node->data.function_decl.body) {
                 generate_statement(gen, node->data.function_decl.body);
             }
             emit_code(gen, "ENDFUNC\n\n");
             break;
+        }
+    }
+
+    if (node->data.function_decl.memoized) {
+        switch (gen->output_type) {
+            case OUTPUT_C: c_memo_wrapper(gen, node, func_name); break;
+            case OUTPUT_ASSEMBLY: asm_memo_wrapper(gen, node, func_name); break;
+            case OUTPUT_BYTECODE: bc_memo_wrapper(gen, node, func_name); break;
+        }
+        gen->memoized_functions++;
+    }
+}
+
+// ============================================================
+// Variáveis
+// ============================================================
+
+// Valor de um inicializador global constante (literal, possivelmente negado)
+static ASTNode* constant_initializer(ASTNode* init, int* negate) {
+    *negate = 0;
+    if (init && init->type == AST_UNARY_EXPRESSION &&
+        init->data.unary_expr.operator == UNARY_MINUS) {
+        *negate = 1;
+        init = init->data.unary_expr.operand;
+    }
+    if (init && (init->type == AST_NUMBER_LITERAL || init->type == AST_FLOAT_LITERAL ||
+                 init->type == AST_CHAR_LITERAL)) {
+        return init;
+    }
+    return NULL;
+}
+
+static void asm_global_declaration(CodeGenerator* gen, ASTNode* node) {
+    const char* var_name = node->data.var_decl.name;
+    DataType type = node->data_type;
+    TypeTable* types = gen->symbol_table->types;
+    int negate = 0;
+    ASTNode* init = constant_initializer(node->data.var_decl.initializer, &negate);
+
+    if (node->data.var_decl.initializer && !init) {
+        emit_comment(gen, "Inicializador global não constante ignorado");
+    }
+
+    emit_code(gen, ".data\n");
+    if (type_alignment(types, node->type_id) > 1) {
+        emit_code(gen, "    .align %d\n", type_alignment(types, node->type_id));
+    }
+    emit_code(gen, "    .globl %s\n%s:\n", var_name, var_name);
+
+    if (type == TYPE_ARRAY) {
+        emit_code(gen, "    .zero %d\n", type_size(types, node->type_id));
+    } else if (is_float_type(type)) {
+        emit_code(gen, "    .float %s%s\n", negate ? "-" : "", init ? init->data.literal.value : "0");
+    } else {
+        long value = 0;
+        if (init && init->type == AST_CHAR_LITERAL) {
+            value = ast_char_literal_value(init->data.literal.value);
+        } else if (init) {
+            value = (long)strtod(init->data.literal.value, NULL);
+        }
+        if (negate) value = -value;
+
+        if (type == TYPE_CHAR) {
+            emit_code(gen, "    .byte %ld\n", value);
+        } else if (type == TYPE_POINTER) {
+            emit_code(gen, "    .quad %ld\n", value);
+        } else {
+            emit_code(gen, "    .long %ld\n", value);
+        }
     }
+    emit_code(gen, ".text\n\n");
 }
 
 void generate_variable_declaration(CodeGenerator* gen, ASTNode* node) {
     const char* var_name = node->data.var_decl.name;
-    
+    Symbol* symbol = node->ref.symbol;
+    int is_global = symbol && symbol->scope_level == 0;
+
     switch (gen->output_type) {
         case OUTPUT_C:
-            emit_code(gen, "    %s %s", 
-                     data_type_to_string(node->data.var_decl.var_type),
-                     var_name);
-            
+            emit_indent(gen);
+            if (node->data.var_decl.modifiers & MOD_CONST) emit_code(gen, "const ");
+            emit_c_declarator(gen, node->type_id, var_name);
+
             if (node->data.var_decl.initializer) {
                 emit_code(gen, " = ");
-                generate_expression(gen, node->data.var_decl.initializer);
+                c_expression(gen, node->data.var_decl.initializer);
             }
-            
+
             emit_code(gen, ";\n");
+            if (is_global) emit_code(gen, "\n");
             break;
-            
+
         case OUTPUT_ASSEMBLY:
-            gen->current_offset -= 8;  // Assumindo 8 bytes por variável
-            emit_comment(gen, "Declaração de variável");
-            emit_code(gen, "    # %s at offset %d\n", var_name, gen->current_offset);
-            
-            if (node->data.var_decl.initializer) {
-                generate_expression(gen, node->data.var_decl.initializer);
-                emit_code(gen, "    mov %%rax, %d(%%rbp)\n", gen->current_offset);
+            if (is_global || !symbol) {
+                asm_global_declaration(gen, node);
+                break;
+            }
+            if (symbol->info.variable.reg != NO_REGISTER) {
+                emit_code(gen, "    # %s in %s\n", var_name, register_name(symbol->info.variable.reg, symbol->type));
+            } else {
+                emit_code(gen, "    # %s at offset %d\n", var_name, symbol->info.variable.offset);
+            }
+
+            if (node->data.var_decl.initializer &&
+                !(gen->select_instructions && select_initializer(gen, symbol, node->data.var_decl.initializer))) {
+                asm_expression(gen, node->data.var_decl.initializer);
+                asm_expression_store(gen, node->data.var_decl.initializer->data_type, symbol);
             }
             break;
-            
-        case OUTPUT_BYTECODE:
-            emit_code(gen, "DECL %s %s\n", 
-                     data_type_to_string(node->data.var_decl.var_type),
-                     var_name);
-            
-            if (node->data.var_decl.initializer) {
-                generate_expression(gen, node->data.var_decl.initializer);
-                emit_code(gen, "STORE %s\n", var_name);
+
+        case OUTPUT_BYTECODE: {
+            char type_name[256];
+            type_to_string(gen->symbol_table->types, node->type_id, type_name, sizeof(type_name));
+            if (is_global || !symbol) {
+                emit_code(gen, "GLOBAL %s %s", type_name, var_name);
+            } else {
+                emit_code(gen, "DECL %s %s %d", type_name, var_name, symbol->info.variable.slot);
+            }
+
+            // Globais só aceitam valor inicial constante, gravado na própria declaração
+            if (is_global) {
+                int negate = 0;
+                ASTNode* init = constant_initializer(node->data.var_decl.initializer, &negate);
+                if (init && init->type == AST_CHAR_LITERAL) {
+                    emit_code(gen, " %d", ast_char_literal_value(init->data.literal.value));
+                } else if (init) {
+                    emit_code(gen, " %s%s", negate ? "-" : "", init->data.literal.value);
+                }
+            }
+            emit_code(gen, "\n");
+
+            if (node->data.var_decl.initializer && !is_global && symbol) {
+                bc_expression(gen, node->data.var_decl.initializer);
+                bc_convert(gen, node->data.var_decl.initializer->data_type, node->data_type);
+                emit_code(gen, "STOREL %d\n", symbol->info.variable.slot);
             }
             break;
+        }
     }
 }
 
+// ============================================================
+// Comandos
+// ============================================================
+
 void generate_statement(CodeGenerator* gen, ASTNode* node) {
     if (!node) return;
-    
-    switch (node->type) {
-        case AST_COMPOUND_STATEMENT:
-            for (int i = 0; i < node->child_count; i++) {
-                generate_statement(gen, node->children[i]);
-            }
+
+    switch (gen->output_type) {
+        case OUTPUT_C:
+            c_statement(gen, node);
             break;
-            
-        case AST_VARIABLE_DECLARATION:
-            generate_variable_declaration(gen, node);
+        case OUTPUT_ASSEMBLY:
+            asm_statement(gen, node);
             break;
-            
-        case AST_EXPRESSION_STATEMENT:
-            if (node->child_count > 0) {
-                generate_expression(gen, node->children[0]);
-                if (gen->output_type == OUTPUT_C) {
-                    emit_code(gen, ";\n");
-                }
-            }
+        case OUTPUT_BYTECODE:
+            bc_statement(gen, node);
             break;
-            
-        case AST_RETURN_STATEMENT:
-            if (gen->output_type == OUTPUT_C) {
-                emit_code(gen, "    return");
-                if (node->data.return_stmt.expression) {
-                    emit_code(gen, " ");
-                    generate_expression(gen, node->data.return_stmt.expression);
+    }
+}
+
+void generate_expression(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+
+    switch (gen->output_type) {
+        case OUTPUT_C:
+            c_expression(gen, node);
+            break;
+        case OUTPUT_ASSEMBLY:
+            asm_expression(gen, node);
+            break;
+        case OUTPUT_BYTECODE:
+            bc_expression(gen, node);
+            break;
+    }
+}
+
+// Salva e restaura os destinos de break/continue ao redor de um laço
+static void enter_loop(CodeGenerator* gen, char* break_label, char* continue_label,
+                       char** saved_break, char** saved_continue) {
+    *saved_break = gen->break_label;
+    *saved_continue = gen->continue_label;
+    gen->break_label = break_label;
+    gen->continue_label = continue_label;
+}
+
+static void exit_loop(CodeGenerator* gen, char* saved_break, char* saved_continue) {
+    gen->break_label = saved_break;
+    gen->continue_label = saved_continue;
+}
+
+// ------------------------------------------------------------
+// Backend C
+// ------------------------------------------------------------
+
+// Emite um comando como corpo de bloco, sem repetir as chaves de um bloco composto
+static void c_block_body(CodeGenerator* gen, ASTNode* node) {
+    gen->indent_level++;
+    if (node && node->type == AST_COMPOUND_STATEMENT) {
+        for (int i = 0; i < node->child_count; i++) {
+            c_statement(gen, node->children[i]);
+        }
+    } else {
+        c_statement(gen, node);
+    }
+    gen->indent_level--;
+}
+
+// Condição do comando com os contadores do desvio (-fprofile-generate)
+// e, se o perfil mostra tendência, __builtin_expect (-fprofile-use)
+static void c_condition(CodeGenerator* gen, ASTNode* statement, ASTNode* condition) {
+    if (!condition) return;
+    int counter = profile_counter(gen, statement);
+    int bias = profile_branch_bias(gen->profile, statement);
+
+    if (bias) {
+        emit_code(gen, "__builtin_expect(!!");
+        gen->profile->hinted_branches++;
+    }
+    if (counter >= 0) {
+        emit_code(gen, "(_profile_counts[%d]++, (", counter);
+        c_expression(gen, condition);
+        emit_code(gen, ") ? (_profile_counts[%d]++, 1) : 0)", profile_taken(counter));
+    } else {
+        c_expression(gen, condition);
+    }
+    if (bias) emit_code(gen, ", %d)", bias > 0);
+}
+
+static void c_statement(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_COMPOUND_STATEMENT:
+            emit_indent(gen);
+            emit_code(gen, "{\n");
+            c_block_body(gen, node);
+            emit_indent(gen);
+            emit_code(gen, "}\n");
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            generate_variable_declaration(gen, node);
+            break;
+
+        case AST_EXPRESSION_STATEMENT:
+            emit_indent(gen);
+            if (node->child_count > 0) {
+                ASTNode* expr = node->children[0];
+                // Atribuição no nível do comando dispensa parênteses
+                if (expr->type == AST_ASSIGNMENT_EXPRESSION) {
+                    c_expression(gen, expr->data.binary_expr.left);
+                    emit_code(gen, " = ");
+                    c_expression(gen, expr->data.binary_expr.right);
+                } else {
+                    c_expression(gen, expr);
                 }
-                emit_code(gen, ";\n");
             }
+            emit_code(gen, ";\n");
             break;
-            
-        case AST_IF_STATEMENT: {
-            char* else_label = generate_label(gen, "else");
-            char* end_label = generate_label(gen, "endif");
-            
-            if (gen->output_type == OUTPUT_C) {
-                emit_code(gen, "    if (");
-                generate_expression(gen, node->data.if_stmt.condition);
-                emit_code(gen, ") {\n");
-                generate_statement(gen, node->data.if_stmt.then_stmt);
-                
-                if (node->data.if_stmt.else_stmt) {
-                    emit_code(gen, "    } else {\n");
-                    generate_statement(gen, node->data.if_stmt.else_stmt);
+
+        case AST_RETURN_STATEMENT: {
+            ASTNode* call = gen->tail_function && gen->loop_depth == 0 ? tail_call(gen, node) : NULL;
+            if (call && strcmp(call->data.function_call.name, gen->current_function) == 0) {
+                c_tail_recursion(gen, call);
+                break;
+            }
+            emit_indent(gen);
+            emit_code(gen, "return");
+            if (node->data.return_stmt.expression) {
+                emit_code(gen, " ");
+                c_expression(gen, node->data.return_stmt.expression);
+            }
+            emit_code(gen, ";\n");
+            break;
+        }
+
+        case AST_IF_STATEMENT:
+            emit_indent(gen);
+            emit_code(gen, "if (");
+            c_condition(gen, node, node->data.if_stmt.condition);
+            emit_code(gen, ") {\n");
+            c_block_body(gen, node->data.if_stmt.then_stmt);
+
+            if (node->data.if_stmt.else_stmt) {
+                emit_indent(gen);
+                emit_code(gen, "} else {\n");
+                c_block_body(gen, node->data.if_stmt.else_stmt);
+            }
+            emit_indent(gen);
+            emit_code(gen, "}\n");
+            break;
+
+        case AST_WHILE_STATEMENT:
+            emit_indent(gen);
+            emit_code(gen, "while (");
+            c_condition(gen, node, node->data.while_stmt.condition);
+            emit_code(gen, ") {\n");
+            gen->loop_depth++;
+            c_block_body(gen, node->data.while_stmt.body);
+            gen->loop_depth--;
+            emit_indent(gen);
+            emit_code(gen, "}\n");
+            break;
+
+        case AST_DO_WHILE_STATEMENT:
+            emit_indent(gen);
+            emit_code(gen, "do {\n");
+            gen->loop_depth++;
+            c_block_body(gen, node->data.while_stmt.body);
+            gen->loop_depth--;
+            emit_indent(gen);
+            emit_code(gen, "} while (");
+            c_condition(gen, node, node->data.while_stmt.condition);
+            emit_code(gen, ");\n");
+            break;
+
+        case AST_FOR_STATEMENT: {
+            ASTNode* init = node->data.for_stmt.init;
+            emit_indent(gen);
+            emit_code(gen, "for (");
+            if (init && init->type == AST_VARIABLE_DECLARATION) {
+                if (init->data.var_decl.modifiers & MOD_CONST) emit_code(gen, "const ");
+                emit_c_declarator(gen, init->type_id, init->data.var_decl.name);
+                if (init->data.var_decl.initializer) {
+                    emit_code(gen, " = ");
+                    c_expression(gen, init->data.var_decl.initializer);
                 }
-                emit_code(gen, "    }\n");
+            } else if (init && init->child_count > 0) {
+                c_expression(gen, init->children[0]);
             }
-            
-            free(else_label);
-            free(end_label);
+            emit_code(gen, "; ");
+            c_condition(gen, node, node->data.for_stmt.condition);
+            emit_code(gen, "; ");
+            c_expression(gen, node->data.for_stmt.update);
+            emit_code(gen, ") {\n");
+            gen->loop_depth++;
+            c_block_body(gen, node->data.for_stmt.body);
+            gen->loop_depth--;
+            emit_indent(gen);
+            emit_code(gen, "}\n");
+            break;
+        }
+
+        case AST_SWITCH_STATEMENT: {
+            ASTNode* cases = node->data.switch_stmt.cases;
+            emit_indent(gen);
+            emit_code(gen, "switch (");
+            c_expression(gen, node->data.switch_stmt.expression);
+            emit_code(gen, ") {\n");
+            for (int i = 0; i < cases->child_count; i++) {
+                ASTNode* label = cases->children[i];
+                emit_indent(gen);
+                if (label->type == AST_CASE_STATEMENT) {
+                    emit_code(gen, "case ");
+                    c_expression(gen, label->data.case_stmt.value);
+                    emit_code(gen, ":");
+                } else {
+                    emit_code(gen, "default:");
+                }
+                // Em C99 um rótulo não pode preceder diretamente uma declaração
+                int starts_with_declaration = label->child_count > 0 &&
+                    label->children[0]->type == AST_VARIABLE_DECLARATION;
+                emit_code(gen, starts_with_declaration ? " ;\n" : "\n");
+
+                gen->indent_level++;
+                for (int j = 0; j < label->child_count; j++) {
+                    c_statement(gen, label->children[j]);
+                }
+                gen->indent_level--;
+            }
+            emit_indent(gen);
+            emit_code(gen, "}\n");
             break;
         }
-        
+
+        case AST_BREAK_STATEMENT:
+            emit_indent(gen);
+            emit_code(gen, "break;\n");
+            break;
+
+        case AST_CONTINUE_STATEMENT:
+            emit_indent(gen);
+            emit_code(gen, "continue;\n");
+            break;
+
         default:
             break;
     }
 }
 
-void generate_expression(CodeGenerator* gen, ASTNode* node) {
+static void c_expression(CodeGenerator* gen, ASTNode* node) {
     if (!node) return;
-    
+
     switch (node->type) {
         case AST_IDENTIFIER:
             emit_code(gen, "%s", node->data.identifier.name);
             break;
-            
+
         case AST_NUMBER_LITERAL:
-            emit_code(gen, "%s", node->data.literal.value);
+        case AST_FLOAT_LITERAL: {
+            // Literais negativos vêm do dobramento de constantes (-O). Com
+            // sufixo f, a conta é em float como no assembly e na dobra;
+            // sem ele o C faria em double
+            const char* text = node->data.literal.value;
+            const char* suffix = strpbrk(text, ".eE") ? "f" : "";
+            emit_code(gen, text[0] == '-' ? "(%s%s)" : "%s%s", text, suffix);
+            break;
+        }
+
+        case AST_CHAR_LITERAL:
+            emit_code(gen, "'%s'", node->data.literal.value);
             break;
-            
+
         case AST_STRING_LITERAL:
-            emit_code(gen, "\"%s\"", node->data.literal.value);
+            emit_escaped_string(gen, node->data.literal.value);
             break;
-            
+
         case AST_BINARY_EXPRESSION:
-            if (gen->output_type == OUTPUT_C) {
-                emit_code(gen, "(");
-                generate_expression(gen, node->data.binary_expr.left);
-                
-                switch (node->data.binary_expr.operator) {
-                    case TOKEN_PLUS: emit_code(gen, " + "); break;
-                    case TOKEN_MINUS: emit_code(gen, " - "); break;
-                    case TOKEN_MULTIPLY: emit_code(gen, " * "); break;
-                    case TOKEN_DIVIDE: emit_code(gen, " / "); break;
-                    case TOKEN_EQUAL: emit_code(gen, " == "); break;
-                    case TOKEN_NOT_EQUAL: emit_code(gen, " != "); break;
-                    case TOKEN_LESS: emit_code(gen, " < "); break;
-                    case TOKEN_GREATER: emit_code(gen, " > "); break;
-                    default: emit_code(gen, " ? "); break;
-                }
-                
-                generate_expression(gen, node->data.binary_expr.right);
-                emit_code(gen, ")");
+            emit_code(gen, "(");
+            c_expression(gen, node->data.binary_expr.left);
+            emit_code(gen, " %s ", binary_operator_symbol(node->data.binary_expr.operator));
+            c_expression(gen, node->data.binary_expr.right);
+            emit_code(gen, ")");
+            break;
+
+        case AST_ASSIGNMENT_EXPRESSION:
+            emit_code(gen, "(");
+            c_expression(gen, node->data.binary_expr.left);
+            emit_code(gen, " = ");
+            c_expression(gen, node->data.binary_expr.right);
+            emit_code(gen, ")");
+            break;
+
+        case AST_UNARY_EXPRESSION: {
+            UnaryOperator op = node->data.unary_expr.operator;
+            emit_code(gen, "(");
+            if (op == UNARY_POST_INCREMENT || op == UNARY_POST_DECREMENT) {
+                c_expression(gen, node->data.unary_expr.operand);
+                emit_code(gen, "%s", unary_operator_to_string(op));
+            } else {
+                emit_code(gen, "%s", unary_operator_to_string(op));
+                c_expression(gen, node->data.unary_expr.operand);
             }
+            emit_code(gen, ")");
             break;
-            
-        case AST_FUNCTION_CALL:
+        }
+
+        case AST_TERNARY_EXPRESSION:
+            emit_code(gen, "(");
+            c_expression(gen, node->data.ternary_expr.condition);
+            emit_code(gen, " ? ");
+            c_expression(gen, node->data.ternary_expr.true_expr);
+            emit_code(gen, " : ");
+            c_expression(gen, node->data.ternary_expr.false_expr);
+            emit_code(gen, ")");
+            break;
+
+        case AST_FUNCTION_CALL: {
+            int counter = profile_counter(gen, node);
+            if (counter >= 0) emit_code(gen, "(_profile_counts[%d]++, ", counter);
             emit_code(gen, "%s(", node->data.function_call.name);
             for (int i = 0; i < node->child_count; i++) {
                 if (i > 0) emit_code(gen, ", ");
-                generate_expression(gen, node->children[i]);
+                c_expression(gen, node->children[i]);
             }
             emit_code(gen, ")");
+            if (counter >= 0) emit_code(gen, ")");
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// ------------------------------------------------------------
+// Backend assembly x86-64 (AT&T, System V)
+//
+// Valores inteiros e char ficam em %eax (char estendido com sinal),
+// floats em %xmm0. Cada valor empilhado ocupa 8 bytes e é contado em
+// stack_depth para manter %rsp alinhado em 16 bytes nas chamadas.
+// ------------------------------------------------------------
+
+static int add_literal(CodeGenerator* gen, ASTNode* literal) {
+    if (gen->literal_count >= gen->literal_capacity) {
+        gen->literal_capacity = gen->literal_capacity == 0 ? 8 : gen->literal_capacity * 2;
+        gen->literals = realloc(gen->literals, gen->literal_capacity * sizeof(ASTNode*));
+    }
+    gen->literals[gen->literal_count] = literal;
+    return gen->literal_count++;
+}
+
+// Endereço de um símbolo: slot no frame para locais, rótulo para globais
+static void asm_symbol_address(Symbol* symbol, char* buffer, size_t size) {
+    if (symbol->scope_level == 0) {
+        snprintf(buffer, size, "%s(%%rip)", symbol->name);
+    } else {
+        snprintf(buffer, size, "%d(%%rbp)", symbol->info.variable.offset);
+    }
+}
+
+static void asm_load(CodeGenerator* gen, Symbol* symbol) {
+    char address[128];
+    int reg = symbol->scope_level > 0 ? symbol->info.variable.reg : NO_REGISTER;
+    if (reg != NO_REGISTER) {
+        // char fica no registrador já estendido com sinal
+        emit_code(gen, "    %s %s, %s\n", symbol->type == TYPE_POINTER ? "movq" : "movl",
+                  register_name(reg, symbol->type), symbol->type == TYPE_POINTER ? "%rax" : "%eax");
+        return;
+    }
+    asm_symbol_address(symbol, address, sizeof(address));
+
+    if (is_float_type(symbol->type)) {
+        emit_code(gen, "    movss %s, %%xmm0\n", address);
+    } else if (symbol->type == TYPE_CHAR) {
+        emit_code(gen, "    movsbl %s, %%eax\n", address);
+    } else if (symbol->type == TYPE_POINTER) {
+        emit_code(gen, "    movq %s, %%rax\n", address);
+    } else if (symbol->type == TYPE_ARRAY) {
+        // Array decai para o endereço do primeiro elemento
+        emit_code(gen, "    leaq %s, %%rax\n", address);
+    } else {
+        emit_code(gen, "    movl %s, %%eax\n", address);
+    }
+}
+
+static void asm_store(CodeGenerator* gen, Symbol* symbol) {
+    char address[128];
+    int reg = symbol->scope_level > 0 ? symbol->info.variable.reg : NO_REGISTER;
+    if (reg != NO_REGISTER) {
+        if (symbol->type == TYPE_CHAR) {
+            emit_code(gen, "    movsbl %%al, %s\n", register_name(reg, TYPE_INT));
+        } else if (symbol->type == TYPE_POINTER) {
+            emit_code(gen, "    movq %%rax, %s\n", register_name(reg, TYPE_POINTER));
+        } else {
+            emit_code(gen, "    movl %%eax, %s\n", register_name(reg, TYPE_INT));
+        }
+        return;
+    }
+    asm_symbol_address(symbol, address, sizeof(address));
+
+    if (is_float_type(symbol->type)) {
+        emit_code(gen, "    movss %%xmm0, %s\n", address);
+    } else if (symbol->type == TYPE_CHAR) {
+        emit_code(gen, "    movb %%al, %s\n", address);
+    } else if (symbol->type == TYPE_POINTER) {
+        emit_code(gen, "    movq %%rax, %s\n", address);
+    } else {
+        emit_code(gen, "    movl %%eax, %s\n", address);
+    }
+}
+
+static void asm_convert(CodeGenerator* gen, DataType from, DataType to) {
+    if (from == to || to == TYPE_VOID || from == TYPE_VOID) return;
+
+    if (is_float_type(from) && !is_float_type(to)) {
+        emit_code(gen, "    cvttss2si %%xmm0, %%eax\n");
+        if (to == TYPE_CHAR) emit_code(gen, "    movsbl %%al, %%eax\n");
+    } else if (!is_float_type(from) && is_float_type(to)) {
+        emit_code(gen, "    cvtsi2ssl %%eax, %%xmm0\n");
+    } else if (to == TYPE_CHAR) {
+        emit_code(gen, "    movsbl %%al, %%eax\n");
+    } else if (is_address_type(to) && !is_address_type(from)) {
+        emit_code(gen, "    movslq %%eax, %%rax\n");
+    }
+}
+
+// Converte o valor corrente para o tipo do símbolo e o grava
+static void asm_expression_store(CodeGenerator* gen, DataType value_type, Symbol* symbol) {
+    asm_convert(gen, value_type, symbol->type);
+    asm_store(gen, symbol);
+}
+
+static void asm_push(CodeGenerator* gen, DataType type) {
+    if (is_float_type(type)) {
+        emit_code(gen, "    sub $8, %%rsp\n");
+        emit_code(gen, "    movss %%xmm0, (%%rsp)\n");
+    } else {
+        emit_code(gen, "    push %%rax\n");
+    }
+    gen->stack_depth++;
+}
+
+// Desempilha para %rax/%xmm0 (ou %rcx/%xmm1 quando secondary)
+static void asm_pop(CodeGenerator* gen, DataType type, int secondary) {
+    if (is_float_type(type)) {
+        emit_code(gen, "    movss (%%rsp), %%xmm%d\n", secondary ? 1 : 0);
+        emit_code(gen, "    add $8, %%rsp\n");
+    } else {
+        emit_code(gen, "    pop %%r%s\n", secondary ? "cx" : "ax");
+    }
+    gen->stack_depth--;
+}
+
+// Desvia para label quando o valor corrente é zero (ou diferente de zero)
+static void asm_branch_on_value(CodeGenerator* gen, DataType type, const char* label, int when_true) {
+    if (is_float_type(type)) {
+        emit_code(gen, "    xorps %%xmm1, %%xmm1\n");
+        emit_code(gen, "    ucomiss %%xmm1, %%xmm0\n");
+        if (when_true) {
+            emit_code(gen, "    jp .L%s\n", label);
+            emit_code(gen, "    jne .L%s\n", label);
+        } else {
+            char* skip = generate_label(gen, "ordered");
+            emit_code(gen, "    jp .L%s\n", skip);
+            emit_code(gen, "    je .L%s\n", label);
+            emit_code(gen, ".L%s:\n", skip);
+            free(skip);
+        }
+    } else {
+        if (gen->select_instructions) {
+            emit_code(gen, "    %s\n", is_address_type(type) ? "testq %rax, %rax" : "testl %eax, %eax");
+        } else {
+            emit_code(gen, "    %s $0, %%%s\n", is_address_type(type) ? "cmpq" : "cmpl",
+                      is_address_type(type) ? "rax" : "eax");
+        }
+        emit_code(gen, "    %s .L%s\n", when_true ? "jne" : "je", label);
+    }
+}
+
+static void asm_logical(CodeGenerator* gen, ASTNode* node) {
+    int is_and = node->data.binary_expr.operator == TOKEN_AND;
+    char* short_label = generate_label(gen, is_and ? "and_false" : "or_true");
+    char* end_label = generate_label(gen, "logic_end");
+    ASTNode* left = node->data.binary_expr.left;
+    ASTNode* right = node->data.binary_expr.right;
+
+    asm_expression(gen, left);
+    asm_branch_on_value(gen, left->data_type, short_label, !is_and);
+    asm_expression(gen, right);
+    asm_branch_on_value(gen, right->data_type, short_label, !is_and);
+    emit_code(gen, "    movl $%d, %%eax\n", is_and ? 1 : 0);
+    emit_code(gen, "    jmp .L%s\n", end_label);
+    emit_code(gen, ".L%s:\n", short_label);
+    emit_code(gen, "    movl $%d, %%eax\n", is_and ? 0 : 1);
+    emit_code(gen, ".L%s:\n", end_label);
+
+    free(short_label);
+    free(end_label);
+}
+
+static void asm_float_compare(CodeGenerator* gen, TokenType op) {
+    switch (op) {
+        case TOKEN_LESS:
+            emit_code(gen, "    ucomiss %%xmm0, %%xmm1\n    seta %%al\n");
+            break;
+        case TOKEN_LESS_EQUAL:
+            emit_code(gen, "    ucomiss %%xmm0, %%xmm1\n    setae %%al\n");
+            break;
+        case TOKEN_GREATER:
+            emit_code(gen, "    ucomiss %%xmm1, %%xmm0\n    seta %%al\n");
+            break;
+        case TOKEN_GREATER_EQUAL:
+            emit_code(gen, "    ucomiss %%xmm1, %%xmm0\n    setae %%al\n");
+            break;
+        case TOKEN_EQUAL:
+            emit_code(gen, "    ucomiss %%xmm1, %%xmm0\n    sete %%al\n");
+            emit_code(gen, "    setnp %%cl\n    andb %%cl, %%al\n");
+            break;
+        default:
+            emit_code(gen, "    ucomiss %%xmm1, %%xmm0\n    setne %%al\n");
+            emit_code(gen, "    setp %%cl\n    orb %%cl, %%al\n");
+            break;
+    }
+    emit_code(gen, "    movzbl %%al, %%eax\n");
+}
+
+static void asm_int_binary(CodeGenerator* gen, TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: emit_code(gen, "    addl %%ecx, %%eax\n"); break;
+        case TOKEN_MINUS: emit_code(gen, "    subl %%ecx, %%eax\n"); break;
+        case TOKEN_MULTIPLY: emit_code(gen, "    imull %%ecx, %%eax\n"); break;
+        case TOKEN_DIVIDE:
+            emit_code(gen, "    cltd\n    idivl %%ecx\n");
+            break;
+        case TOKEN_MODULO:
+            emit_code(gen, "    cltd\n    idivl %%ecx\n    movl %%edx, %%eax\n");
+            break;
+        case TOKEN_BITWISE_AND: emit_code(gen, "    andl %%ecx, %%eax\n"); break;
+        case TOKEN_BITWISE_OR: emit_code(gen, "    orl %%ecx, %%eax\n"); break;
+        case TOKEN_BITWISE_XOR: emit_code(gen, "    xorl %%ecx, %%eax\n"); break;
+        case TOKEN_LEFT_SHIFT: emit_code(gen, "    sall %%cl, %%eax\n"); break;
+        case TOKEN_RIGHT_SHIFT: emit_code(gen, "    sarl %%cl, %%eax\n"); break;
+        default: {
+            const char* set = "setne";
+            switch (op) {
+                case TOKEN_EQUAL: set = "sete"; break;
+                case TOKEN_LESS: set = "setl"; break;
+                case TOKEN_GREATER: set = "setg"; break;
+                case TOKEN_LESS_EQUAL: set = "setle"; break;
+                case TOKEN_GREATER_EQUAL: set = "setge"; break;
+                default: break;
+            }
+            emit_code(gen, "    cmpl %%ecx, %%eax\n    %s %%al\n    movzbl %%al, %%eax\n", set);
+            break;
+        }
+    }
+}
+
+// Operando inteiro de aritmética de ponteiros: estende para 64 bits e escala
+static void asm_pointer_offset(CodeGenerator* gen, int scale) {
+    emit_code(gen, "    movslq %%eax, %%rax\n");
+    if (scale != 1) emit_code(gen, "    imulq $%d, %%rax\n", scale);
+}
+
+// Aritmética e comparações em que algum operando é ponteiro (64 bits)
+static void asm_pointer_binary(CodeGenerator* gen, ASTNode* node) {
+    TokenType op = node->data.binary_expr.operator;
+    ASTNode* left = node->data.binary_expr.left;
+    ASTNode* right = node->data.binary_expr.right;
+    int left_pointer = is_address_type(left->data_type);
+    int right_pointer = is_address_type(right->data_type);
+    int scale = pointee_size(gen, left_pointer ? left->type_id : right->type_id);
+    int offset_scale = op == TOKEN_PLUS || op == TOKEN_MINUS ? scale : 1;
+
+    asm_expression(gen, left);
+    if (!left_pointer) asm_pointer_offset(gen, offset_scale);
+    asm_push(gen, TYPE_POINTER);
+    asm_expression(gen, right);
+    if (!right_pointer) asm_pointer_offset(gen, offset_scale);
+    emit_code(gen, "    movq %%rax, %%rcx\n");
+    asm_pop(gen, TYPE_POINTER, 0);
+
+    if (op == TOKEN_PLUS) {
+        emit_code(gen, "    addq %%rcx, %%rax\n");
+    } else if (op == TOKEN_MINUS) {
+        emit_code(gen, "    subq %%rcx, %%rax\n");
+        // Diferença de ponteiros é medida em elementos
+        if (left_pointer && right_pointer && scale != 1) {
+            emit_code(gen, "    movq $%d, %%rcx\n    cqto\n    idivq %%rcx\n", scale);
+        }
+    } else {
+        const char* set = "setne";
+        switch (op) {
+            case TOKEN_EQUAL: set = "sete"; break;
+            case TOKEN_LESS: set = "setb"; break;
+            case TOKEN_GREATER: set = "seta"; break;
+            case TOKEN_LESS_EQUAL: set = "setbe"; break;
+            case TOKEN_GREATER_EQUAL: set = "setae"; break;
+            default: break;
+        }
+        emit_code(gen, "    cmpq %%rcx, %%rax\n    %s %%al\n    movzbl %%al, %%eax\n", set);
+    }
+}
+
+static void asm_binary(CodeGenerator* gen, ASTNode* node) {
+    TokenType op = node->data.binary_expr.operator;
+    ASTNode* left = node->data.binary_expr.left;
+    ASTNode* right = node->data.binary_expr.right;
+
+    if (op == TOKEN_AND || op == TOKEN_OR) {
+        asm_logical(gen, node);
+        return;
+    }
+    if (op == TOKEN_COMMA) {
+        asm_expression(gen, left);
+        asm_expression(gen, right);
+        return;
+    }
+
+    if (is_address_type(left->data_type) || is_address_type(right->data_type)) {
+        asm_pointer_binary(gen, node);
+        return;
+    }
+
+    // Comparações de floats produzem int, mas operam sobre floats
+    DataType operand_type = is_float_type(left->data_type) || is_float_type(right->data_type)
+                            ? TYPE_FLOAT : TYPE_INT;
+
+    asm_expression(gen, left);
+    asm_convert(gen, left->data_type, operand_type);
+    asm_push(gen, operand_type);
+    asm_expression(gen, right);
+    asm_convert(gen, right->data_type, operand_type);
+
+    if (is_float_type(operand_type)) {
+        emit_code(gen, "    movaps %%xmm0, %%xmm1\n");
+        asm_pop(gen, operand_type, 0);
+        if (is_comparison_operator(op)) {
+            asm_float_compare(gen, op);
+        } else {
+            const char* instr = "addss";
+            switch (op) {
+                case TOKEN_MINUS: instr = "subss"; break;
+                case TOKEN_MULTIPLY: instr = "mulss"; break;
+                case TOKEN_DIVIDE: instr = "divss"; break;
+                default: break;
+            }
+            emit_code(gen, "    %s %%xmm1, %%xmm0\n", instr);
+        }
+    } else {
+        emit_code(gen, "    movl %%eax, %%ecx\n");
+        asm_pop(gen, operand_type, 0);
+        asm_int_binary(gen, op);
+    }
+}
+
+static void asm_unary(CodeGenerator* gen, ASTNode* node) {
+    UnaryOperator op = node->data.unary_expr.operator;
+    ASTNode* operand = node->data.unary_expr.operand;
+    DataType type = operand->data_type;
+
+    switch (op) {
+        case UNARY_PLUS:
+            asm_expression(gen, operand);
+            break;
+
+        case UNARY_MINUS:
+            asm_expression(gen, operand);
+            if (is_float_type(type)) {
+                emit_code(gen, "    movd %%xmm0, %%eax\n");
+                emit_code(gen, "    xorl $0x80000000, %%eax\n");
+                emit_code(gen, "    movd %%eax, %%xmm0\n");
+            } else {
+                emit_code(gen, "    negl %%eax\n");
+            }
+            break;
+
+        case UNARY_NOT:
+            asm_expression(gen, operand);
+            if (is_float_type(type)) {
+                emit_code(gen, "    xorps %%xmm1, %%xmm1\n");
+                emit_code(gen, "    ucomiss %%xmm1, %%xmm0\n");
+                emit_code(gen, "    sete %%al\n    setnp %%cl\n    andb %%cl, %%al\n");
+            } else if (is_address_type(type)) {
+                emit_code(gen, "    cmpq $0, %%rax\n    sete %%al\n");
+            } else {
+                emit_code(gen, "    cmpl $0, %%eax\n    sete %%al\n");
+            }
+            emit_code(gen, "    movzbl %%al, %%eax\n");
+            break;
+
+        case UNARY_BITWISE_NOT:
+            asm_expression(gen, operand);
+            emit_code(gen, "    notl %%eax\n");
+            break;
+
+        case UNARY_PRE_INCREMENT:
+        case UNARY_PRE_DECREMENT:
+        case UNARY_POST_INCREMENT:
+        case UNARY_POST_DECREMENT: {
+            Symbol* symbol = operand->ref.symbol;
+            if (operand->type != AST_IDENTIFIER || !symbol) {
+                emit_comment(gen, "Incremento de l-value não suportado");
+                break;
+            }
+            int delta = (op == UNARY_PRE_INCREMENT || op == UNARY_POST_INCREMENT) ? 1 : -1;
+            int is_post = op == UNARY_POST_INCREMENT || op == UNARY_POST_DECREMENT;
+
+            asm_load(gen, symbol);
+            if (is_post) asm_push(gen, symbol->type);
+            if (is_float_type(symbol->type)) {
+                emit_code(gen, "    movl $%d, %%ecx\n", delta);
+                emit_code(gen, "    cvtsi2ssl %%ecx, %%xmm1\n");
+                emit_code(gen, "    addss %%xmm1, %%xmm0\n");
+            } else if (symbol->type == TYPE_POINTER) {
+                emit_code(gen, "    addq $%d, %%rax\n", delta * pointee_size(gen, symbol->type_id));
+            } else {
+                emit_code(gen, "    addl $%d, %%eax\n", delta);
+                asm_convert(gen, TYPE_INT, symbol->type);
+            }
+            asm_store(gen, symbol);
+            if (is_post) asm_pop(gen, symbol->type, 0);
             break;
-            
+        }
+
         default:
+            emit_comment(gen, "Operador unário não suportado");
             break;
     }
 }
 
+// Tipo com que o argumento é passado: o do parâmetro declarado (conversão
+// implícita) ou, na parte variádica, o do próprio argumento
+static DataType call_argument_type(CodeGenerator* gen, ASTNode* call, int index) {
+    const Symbol* function = symbol_ref_target(&call->ref);
+    if (function && function->kind == SYMBOL_FUNCTION &&
+        index < function->info.function.parameter_count) {
+        return type_data_type(gen->symbol_table->types,
+                              function->info.function.parameter_types[index]);
+    }
+    return call->children[index]->data_type;
+}
+
+// return f(...) que pode reaproveitar o frame da função atual (-O): f não
+// é variádica, devolve o tipo da função atual (nada a converter depois da
+// chamada) e recebe todos os argumentos em registradores
+static ASTNode* tail_call(CodeGenerator* gen, ASTNode* node) {
+    ASTNode* call = node->data.return_stmt.expression;
+    if (!gen->tail_calls || !call || call->type != AST_FUNCTION_CALL) return NULL;
+
+    const Symbol* function = symbol_ref_target(&call->ref);
+    if (!function || function->kind != SYMBOL_FUNCTION || function->info.function.is_variadic ||
+        call->data_type != gen->current_return_type) return NULL;
+
+    int int_count = 0;
+    int float_count = 0;
+    for (int i = 0; i < call->child_count; i++) {
+        if (is_float_type(call_argument_type(gen, call, i))) {
+            float_count++;
+        } else {
+            int_count++;
+        }
+    }
+    return int_count <= MAX_INT_ARGS && float_count <= MAX_FLOAT_ARGS ? call : NULL;
+}
+
+// Avalia os argumentos e os deixa nos registradores de argumento; os que
+// não cabem nos registradores vão para a pilha, o primeiro em (%rsp) no
+// momento do call. Retorna quantos foram em registradores xmm e, em
+// stack_slots, quantos slots de 8 bytes o chamador libera depois do call
+// (0 quando tudo coube nos registradores)
+static int asm_call_arguments(CodeGenerator* gen, ASTNode* node, int is_variadic, int* stack_slots) {
+    int argc = node->child_count;
+    int int_count = 0;
+    int float_count = 0;
+    int stack_count = 0;
+
+    // Argumentos avaliados da esquerda para a direita e empilhados
+    for (int i = 0; i < argc; i++) {
+        ASTNode* arg = node->children[i];
+        DataType arg_type = call_argument_type(gen, node, i);
+        asm_expression(gen, arg);
+        asm_convert(gen, arg->data_type, arg_type);
+        if (is_float_type(arg_type)) {
+            // Argumentos variádicos float são promovidos a double
+            if (is_variadic) {
+                emit_code(gen, "    cvtss2sd %%xmm0, %%xmm0\n");
+                emit_code(gen, "    sub $8, %%rsp\n    movsd %%xmm0, (%%rsp)\n");
+                gen->stack_depth++;
+            } else {
+                asm_push(gen, TYPE_FLOAT);
+            }
+            if (float_count++ >= MAX_FLOAT_ARGS) stack_count++;
+        } else {
+            asm_push(gen, TYPE_INT);
+            if (int_count++ >= MAX_INT_ARGS) stack_count++;
+        }
+    }
+    *stack_slots = 0;
+
+    if (stack_count == 0) {
+        // Desempilhar em ordem inversa para os registradores de argumento
+        int int_index = int_count;
+        int float_index = float_count;
+        for (int i = argc - 1; i >= 0; i--) {
+            if (is_float_type(call_argument_type(gen, node, i))) {
+                float_index--;
+                emit_code(gen, "    %s (%%rsp), %%xmm%d\n", is_variadic ? "movsd" : "movss", float_index);
+                emit_code(gen, "    add $8, %%rsp\n");
+            } else {
+                int_index--;
+                emit_code(gen, "    pop %s\n", arg_registers_64[int_index]);
+            }
+            gen->stack_depth--;
+        }
+        return float_count;
+    }
+
+    // Argumentos de pilha: o argumento i está em 8*(argc-1-i)(%rsp), na
+    // ordem inversa da exigida. São copiados do último para o primeiro,
+    // com um slot de alinhamento antes para que %rsp fique múltiplo de 16
+    // no call; os demais vão para os registradores sem desempilhar
+    int padding = (gen->stack_depth + stack_count) % 2;
+    if (padding) emit_code(gen, "    sub $8, %%rsp\n");
+    int copied = 0;
+    int int_index = int_count;
+    int float_index = float_count;
+    for (int i = argc - 1; i >= 0; i--) {
+        int on_stack = is_float_type(call_argument_type(gen, node, i)) ? --float_index >= MAX_FLOAT_ARGS
+                                                                      : --int_index >= MAX_INT_ARGS;
+        if (!on_stack) continue;
+        emit_code(gen, "    pushq %d(%%rsp)\n", 8 * (argc - 1 - i + padding + copied));
+        copied++;
+    }
+
+    int base = padding + stack_count;
+    int_index = 0;
+    float_index = 0;
+    for (int i = 0; i < argc; i++) {
+        int offset = 8 * (argc - 1 - i + base);
+        if (is_float_type(call_argument_type(gen, node, i))) {
+            if (float_index < MAX_FLOAT_ARGS) {
+                emit_code(gen, "    %s %d(%%rsp), %%xmm%d\n", is_variadic ? "movsd" : "movss", offset, float_index);
+            }
+            float_index++;
+        } else {
+            if (int_index < MAX_INT_ARGS) {
+                emit_code(gen, "    movq %d(%%rsp), %s\n", offset, arg_registers_64[int_index]);
+            }
+            int_index++;
+        }
+    }
+
+    gen->stack_depth += base;
+    *stack_slots = argc + base;
+    return float_count < MAX_FLOAT_ARGS ? float_count : MAX_FLOAT_ARGS;
+}
+
+static void asm_call(CodeGenerator* gen, ASTNode* node) {
+    const Symbol* function = symbol_ref_target(&node->ref);
+    int is_variadic = function && function->kind == SYMBOL_FUNCTION &&
+                      function->info.function.is_variadic;
+    asm_count(gen, profile_counter(gen, node));
+    int stack_slots;
+    int float_count = asm_call_arguments(gen, node, is_variadic, &stack_slots);
+
+    // Com argumentos na pilha o alinhamento já foi feito ao copiá-los
+    int needs_padding = stack_slots == 0 && gen->stack_depth % 2 != 0;
+    if (needs_padding) emit_code(gen, "    sub $8, %%rsp\n");
+    emit_code(gen, "    movl $%d, %%eax\n", float_count);
+    emit_code(gen, "    call %s\n", node->data.function_call.name);
+    if (needs_padding) emit_code(gen, "    add $8, %%rsp\n");
+    if (stack_slots) {
+        emit_code(gen, "    add $%d, %%rsp\n", 8 * stack_slots);
+        gen->stack_depth -= stack_slots;
+    }
+}
+
+// Chamada de cauda: com os argumentos nos registradores, a própria função
+// recomeça no corpo; outra função é alcançada por jmp depois de desfeito o
+// frame, e o seu ret volta direto para quem chamou a função atual
+static void asm_tail_call(CodeGenerator* gen, ASTNode* call) {
+    int stack_slots;
+    asm_count(gen, profile_counter(gen, call));
+    asm_call_arguments(gen, call, 0, &stack_slots);
+    if (strcmp(call->data.function_call.name, gen->current_function) == 0) {
+        emit_code(gen, "    jmp .L%s\n", gen->body_label);
+        gen->tail_loops++;
+    } else {
+        asm_leave_frame(gen);
+        emit_code(gen, "    jmp %s\n", call->data.function_call.name);
+        gen->tail_jumps++;
+    }
+}
+
+// ============================================================
+// Seleção de instruções (assembly, -O)
+//
+// Casamento de árvores no estilo BURS: uma passada de baixo para cima
+// rotula cada nó com o menor custo de derivá-lo em cada não-terminal da
+// gramática (x86_rules.def) e com a regra que o atinge; a redução desce
+// a partir do objetivo (reg, cond ou stmt) emitindo as regras
+// escolhidas. Nós fora da gramática (chamadas, divisões, floats,
+// ponteiros...) são folhas OUTRO, geradas por asm_expression.
+// ============================================================
+
+typedef enum {
+    NT_NONE = -1,
+    NT_REG,
+    NT_COND,
+    NT_STMT,
+    NT_IMM,
+    NT_LOC,
+    NT_MEM,
+    NT_PURE,
+    NT_OPERAND,
+    NT_INDEX,
+    NT_PAIR,
+    NT_ADDR,
+    NT_UPDATE,
+    NT_COUNT
+} Nonterminal;
+
+typedef enum {
+    OP_NONE,               // Regra de cadeia
+    OP_CONST,
+    OP_REGISTER,
+    OP_MEMORY,
+    OP_OTHER,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_COMPARE,
+    OP_ASSIGN,
+    OP_SEQUENCE            // Vírgula: o valor é o do lado direito
+} TreeOp;
+
+#define NO_MATCH (INT_MAX / 4)
+
+typedef struct MatchState {
+    ASTNode* node;
+    TreeOp op;
+    long value;            // OP_CONST
+    Symbol* symbol;        // OP_REGISTER e OP_MEMORY
+    struct MatchState* kids[2];
+    int cost[NT_COUNT];
+    int rule[NT_COUNT];
+} MatchState;
+
+typedef struct SelectionRuleInfo {
+    const char* pattern;
+    Nonterminal lhs;
+    TreeOp op;
+    Nonterminal kids[2];
+    int cost;
+    int (*condition)(const MatchState* state);
+} SelectionRuleInfo;
+
+// Condições das regras; o filho imm é sempre um OP_CONST
+static int is_scale(const MatchState* state) {
+    long k = state->kids[1]->value;
+    return k == 1 || k == 2 || k == 4 || k == 8;
+}
+
+static int is_lea_multiplier(const MatchState* state) {
+    long k = state->kids[1]->value;
+    return k == 3 || k == 5 || k == 9;
+}
+
+// Multiplicador com sequência de shl/lea/add de um passo ou de dois
+static int multiply_steps(const MatchState* constant) {
+    MultiplyPlan plan;
+    return arith_multiply_plan(constant->value, &plan) ? plan.step_count : -1;
+}
+
+static int is_short_multiplier(const MatchState* state) {
+    int steps = multiply_steps(state->kids[1]);
+    return steps == 0 || steps == 1;
+}
+
+static int is_chain_multiplier(const MatchState* state) {
+    return multiply_steps(state->kids[1]) == 2;
+}
+
+static int is_short_multiplier_swapped(const MatchState* state) {
+    int steps = multiply_steps(state->kids[0]);
+    return steps == 0 || steps == 1;
+}
+
+static int is_chain_multiplier_swapped(const MatchState* state) {
+    return multiply_steps(state->kids[0]) == 2;
+}
+
+static int is_lowered_divisor(const MatchState* state) {
+    DivisionPlan plan;
+    return arith_division_plan(state->kids[1]->value, 0, &plan);
+}
+
+static int is_zero(const MatchState* state) {
+    return state->kids[1]->value == 0;
+}
+
+static int is_negatable(const MatchState* state) {
+    return state->kids[1]->value != INT_MIN;
+}
+
+static int is_same_target(const MatchState* state) {
+    return state->kids[1]->kids[0] && state->kids[1]->kids[0]->symbol == state->kids[0]->symbol;
+}
+
+static const SelectionRuleInfo selection_rules[RULE_COUNT] = {
+#define RULE(id, pattern, lhs, op, left, right, cost, condition) \
+    {pattern, lhs, op, {left, right}, cost, condition},
+#include "x86_rules.def"
+#undef RULE
+};
+
+static int is_integer_value(const ASTNode* node) {
+    return node && (node->data_type == TYPE_INT || node->data_type == TYPE_CHAR);
+}
+
+// Locais int/char em registrador viram loc; ints no frame ou globais, mem
+static TreeOp classify_variable(Symbol* symbol, MatchState* state) {
+    if (!symbol || (symbol->kind != SYMBOL_VARIABLE && symbol->kind != SYMBOL_PARAMETER)) return OP_OTHER;
+    state->symbol = symbol;
+    if (symbol->scope_level > 0 && symbol->info.variable.reg != NO_REGISTER &&
+        (symbol->type == TYPE_INT || symbol->type == TYPE_CHAR)) {
+        return OP_REGISTER;
+    }
+    return symbol->type == TYPE_INT ? OP_MEMORY : OP_OTHER;
+}
+
+static TreeOp classify_node(ASTNode* node, MatchState* state) {
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_CHAR_LITERAL:
+        case AST_UNARY_EXPRESSION:
+            if (is_integer_value(node) && ast_integer_constant(node, &state->value) &&
+                state->value >= INT_MIN && state->value <= INT_MAX) {
+                return OP_CONST;
+            }
+            return OP_OTHER;
+
+        case AST_IDENTIFIER:
+            return classify_variable(node->ref.symbol, state);
+
+        case AST_BINARY_EXPRESSION: {
+            if (node->data.binary_expr.operator == TOKEN_COMMA) return OP_SEQUENCE;
+            if (!is_integer_value(node) || !is_integer_value(node->data.binary_expr.left) ||
+                !is_integer_value(node->data.binary_expr.right)) {
+                return OP_OTHER;
+            }
+            TokenType op = node->data.binary_expr.operator;
+            switch (op) {
+                case TOKEN_PLUS: return OP_ADD;
+                case TOKEN_MINUS: return OP_SUB;
+                case TOKEN_MULTIPLY: return OP_MUL;
+                case TOKEN_DIVIDE: return OP_DIV;
+                case TOKEN_MODULO: return OP_MOD;
+                case TOKEN_BITWISE_AND: return OP_AND;
+                case TOKEN_BITWISE_OR: return OP_OR;
+                case TOKEN_BITWISE_XOR: return OP_XOR;
+                default: return is_comparison_operator(op) ? OP_COMPARE : OP_OTHER;
+            }
+        }
+
+        case AST_ASSIGNMENT_EXPRESSION: {
+            ASTNode* target = node->data.binary_expr.left;
+            MatchState probe = {0};
+            if (target->type != AST_IDENTIFIER || !target->ref.symbol || target->ref.symbol->type != TYPE_INT ||
+                classify_variable(target->ref.symbol, &probe) == OP_OTHER ||
+                !is_integer_value(node->data.binary_expr.right)) {
+                return OP_OTHER;
+            }
+            return OP_ASSIGN;
+        }
+
+        default:
+            return OP_OTHER;
+    }
+}
+
+static MatchState* match_state_create(ASTNode* node) {
+    MatchState* state = calloc(1, sizeof(MatchState));
+    state->node = node;
+    for (int nt = 0; nt < NT_COUNT; nt++) {
+        state->cost[nt] = NO_MATCH;
+        state->rule[nt] = -1;
+    }
+    return state;
+}
+
+// Rotula um nó cujos filhos já foram rotulados
+static void match_rules(MatchState* state) {
+    for (int r = 0; r < RULE_COUNT; r++) {
+        const SelectionRuleInfo* rule = &selection_rules[r];
+        if (rule->op == OP_NONE || rule->op != state->op) continue;
+        int cost = rule->cost;
+        for (int k = 0; k < 2; k++) {
+            if (rule->kids[k] != NT_NONE) cost += state->kids[k]->cost[rule->kids[k]];
+        }
+        if (cost >= state->cost[rule->lhs] || (rule->condition && !rule->condition(state))) continue;
+        state->cost[rule->lhs] = cost;
+        state->rule[rule->lhs] = r;
+    }
+
+    // Fecho pelas regras de cadeia (custos positivos ou ciclos sem ganho: termina)
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int r = 0; r < RULE_COUNT; r++) {
+            const SelectionRuleInfo* rule = &selection_rules[r];
+            if (rule->op != OP_NONE) continue;
+            int cost = state->cost[rule->kids[0]] + rule->cost;
+            if (cost < state->cost[rule->lhs]) {
+                state->cost[rule->lhs] = cost;
+                state->rule[rule->lhs] = r;
+                changed = 1;
+            }
+        }
+    }
+}
+
+static MatchState* label_tree(ASTNode* node) {
+    MatchState* state = match_state_create(node);
+    state->op = classify_node(node, state);
+    if (state->op >= OP_ADD) {
+        state->kids[0] = label_tree(node->data.binary_expr.left);
+        state->kids[1] = label_tree(node->data.binary_expr.right);
+    }
+    match_rules(state);
+    return state;
+}
+
+static void match_state_destroy(MatchState* state) {
+    if (!state) return;
+    match_state_destroy(state->kids[0]);
+    match_state_destroy(state->kids[1]);
+    free(state);
+}
+
+// Texto de um operando imm, loc ou mem
+static void operand_text(const MatchState* state, char* buffer, size_t size) {
+    if (state->op == OP_CONST) {
+        snprintf(buffer, size, "$%ld", state->value);
+    } else if (state->op == OP_REGISTER) {
+        snprintf(buffer, size, "%s", register_name(state->symbol->info.variable.reg, TYPE_INT));
+    } else {
+        asm_symbol_address(state->symbol, buffer, size);
+    }
+}
+
+typedef struct LeaAddress {
+    const Symbol* base;
+    const Symbol* index;
+    int scale;
+    long displacement;
+} LeaAddress;
+
+static void build_address(const MatchState* state, Nonterminal nt, LeaAddress* address) {
+    switch (state->rule[nt]) {
+        case RULE_ADDR_PAIR:
+            build_address(state, NT_PAIR, address);
+            break;
+        case RULE_ADDR_DISPLACED:
+            build_address(state->kids[0], NT_PAIR, address);
+            address->displacement = state->kids[1]->value;
+            break;
+        case RULE_ADDR_NEGATIVE:
+            build_address(state->kids[0], NT_PAIR, address);
+            address->displacement = -state->kids[1]->value;
+            break;
+        case RULE_PAIR_INDEX:
+            build_address(state, NT_INDEX, address);
+            break;
+        case RULE_PAIR_BASE_INDEX:
+            build_address(state->kids[1], NT_INDEX, address);
+            address->base = state->kids[0]->symbol;
+            break;
+        case RULE_PAIR_INDEX_BASE:
+            build_address(state->kids[0], NT_INDEX, address);
+            address->base = state->kids[1]->symbol;
+            break;
+        case RULE_PAIR_MULTIPLIER:
+            address->base = address->index = state->kids[0]->symbol;
+            address->scale = (int)state->kids[1]->value - 1;
+            break;
+        case RULE_INDEX_LOC:
+            address->index = state->symbol;
+            address->scale = 1;
+            break;
+        case RULE_INDEX_SCALED:
+            address->index = state->kids[0]->symbol;
+            address->scale = (int)state->kids[1]->value;
+            break;
+        default:
+            break;
+    }
+}
+
+// Os registradores entram com 64 bits no endereço; o leal fica com os 32
+// bits baixos da soma, que não dependem da metade alta
+static void address_text(const MatchState* state, char* buffer, size_t size) {
+    LeaAddress address = {NULL, NULL, 1, 0};
+    build_address(state, NT_ADDR, &address);
+    if (!address.base && address.scale == 1) {
+        address.base = address.index;
+        address.index = NULL;
+    }
+
+    int length = 0;
+    if (address.displacement != 0) length += snprintf(buffer, size, "%ld", address.displacement);
+    length += snprintf(buffer + length, size - length, "(%s",
+                       address.base ? register_name(address.base->info.variable.reg, TYPE_POINTER) : "");
+    if (address.index) {
+        length += snprintf(buffer + length, size - length, ",%s,%d",
+                           register_name(address.index->info.variable.reg, TYPE_POINTER), address.scale);
+    }
+    snprintf(buffer + length, size - length, ")");
+}
+
+static const char* tree_op_mnemonic(TreeOp op) {
+    switch (op) {
+        case OP_ADD: return "addl";
+        case OP_SUB: return "subl";
+        case OP_MUL: return "imull";
+        case OP_AND: return "andl";
+        case OP_OR: return "orl";
+        case OP_XOR: return "xorl";
+        default: return "?";
+    }
+}
+
+// Sufixo do jcc/setcc de uma comparação com sinal
+static const char* comparison_condition(TokenType op) {
+    switch (op) {
+        case TOKEN_EQUAL: return "e";
+        case TOKEN_NOT_EQUAL: return "ne";
+        case TOKEN_LESS: return "l";
+        case TOKEN_GREATER: return "g";
+        case TOKEN_LESS_EQUAL: return "le";
+        default: return "ge";
+    }
+}
+
+static const char* negated_condition(const char* condition) {
+    static const char* const pairs[][2] = {
+        {"e", "ne"}, {"ne", "e"}, {"l", "ge"}, {"ge", "l"}, {"g", "le"}, {"le", "g"}
+    };
+    for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        if (strcmp(pairs[i][0], condition) == 0) return pairs[i][1];
+    }
+    return condition;
+}
+
+// a OP b com os operandos trocados: b OP' a
+static const char* mirrored_condition(const char* condition) {
+    if (strcmp(condition, "l") == 0) return "g";
+    if (strcmp(condition, "g") == 0) return "l";
+    if (strcmp(condition, "le") == 0) return "ge";
+    if (strcmp(condition, "ge") == 0) return "le";
+    return condition;
+}
+
+static void reduce(CodeGenerator* gen, MatchState* state, Nonterminal goal);
+
+// Operandos quaisquer: o esquerdo espera na pilha enquanto o direito é
+// calculado; termina com o esquerdo em %eax e o direito em %ecx
+static void reduce_both(CodeGenerator* gen, MatchState* state) {
+    reduce(gen, state->kids[0], NT_REG);
+    asm_push(gen, TYPE_INT);
+    reduce(gen, state->kids[1], NT_REG);
+    emit_code(gen, "    movl %%eax, %%ecx\n");
+    asm_pop(gen, TYPE_INT, 0);
+}
+
+// Valor que não pode ser negativo: constantes, comparações, and com uma
+// máscara não negativa, restos de não negativos e seus quocientes por
+// divisores positivos
+static int is_non_negative(const MatchState* state) {
+    switch (state->op) {
+        case OP_CONST: return state->value >= 0;
+        case OP_COMPARE: return 1;
+        case OP_AND: return is_non_negative(state->kids[0]) || is_non_negative(state->kids[1]);
+        case OP_MOD: return is_non_negative(state->kids[0]);
+        case OP_DIV:
+            return state->kids[1]->op == OP_CONST && state->kids[1]->value > 0 && is_non_negative(state->kids[0]);
+        default: return 0;
+    }
+}
+
+// %eax *= constante, pela sequência do plano; x fica em %ecx se algum
+// passo precisa dele
+static void asm_multiply_constant(CodeGenerator* gen, const MultiplyPlan* plan) {
+    if (plan->uses_original) emit_code(gen, "    movl %%eax, %%ecx\n");
+    for (int i = 0; i < plan->step_count; i++) {
+        MultiplyStep step = plan->steps[i];
+        switch (step.kind) {
+            case MULTIPLY_SHIFT:
+                if (step.amount == 1) emit_code(gen, "    addl %%eax, %%eax\n");
+                else emit_code(gen, "    sall $%d, %%eax\n", step.amount);
+                break;
+            case MULTIPLY_LEA: emit_code(gen, "    leal (%%rax,%%rax,%d), %%eax\n", step.amount); break;
+            case MULTIPLY_LEA_ORIGINAL: emit_code(gen, "    leal (%%rcx,%%rax,%d), %%eax\n", step.amount); break;
+            case MULTIPLY_ADD_ORIGINAL: emit_code(gen, "    addl %%ecx, %%eax\n"); break;
+            case MULTIPLY_SUB_ORIGINAL: emit_code(gen, "    subl %%ecx, %%eax\n"); break;
+            case MULTIPLY_NEGATE: emit_code(gen, "    negl %%eax\n"); break;
+        }
+    }
+    if (plan->step_count > 0) gen->multiply_chains++;
+}
+
+// %eax = %eax / d ou %eax % d, sem idiv; arith_divide e arith_remainder
+// descrevem as mesmas operações
+static void asm_divide_constant(CodeGenerator* gen, const DivisionPlan* plan, int remainder) {
+    long magnitude = plan->divisor < 0 ? -plan->divisor : plan->divisor;
+
+    switch (plan->kind) {
+        case DIVISION_IDENTITY:
+        case DIVISION_NEGATE:
+            if (remainder) emit_code(gen, "    movl $0, %%eax\n");
+            else if (plan->kind == DIVISION_NEGATE) emit_code(gen, "    negl %%eax\n");
+            return;
+
+        case DIVISION_SHIFT:
+            gen->shift_divisions++;
+            if (plan->non_negative) {
+                if (remainder) emit_code(gen, "    andl $%ld, %%eax\n", magnitude - 1);
+                else emit_code(gen, "    sarl $%d, %%eax\n", plan->shift);
+            } else {
+                // Negativos somam 2^k - 1 antes do deslocamento (truncamento)
+                emit_code(gen, "    movl %%eax, %%ecx\n");
+                if (plan->shift > 1) emit_code(gen, "    sarl $31, %%ecx\n");
+                emit_code(gen, "    shrl $%d, %%ecx\n", 32 - plan->shift);
+                if (remainder) {
+                    emit_code(gen, "    addl %%eax, %%ecx\n    andl $%ld, %%ecx\n    subl %%ecx, %%eax\n", -magnitude);
+                } else {
+                    emit_code(gen, "    addl %%ecx, %%eax\n    sarl $%d, %%eax\n", plan->shift);
+                }
+            }
+            break;
+
+        case DIVISION_MAGIC:
+            // Produto de 64 bits em %rdx; o dividendo continua em %eax
+            gen->magic_divisions++;
+            emit_code(gen, plan->non_negative ? "    movl %%eax, %%edx\n" : "    movslq %%eax, %%rdx\n");
+            if (plan->multiplier <= INT_MAX) {
+                emit_code(gen, "    imulq $%llu, %%rdx, %%rdx\n", plan->multiplier);
+            } else {
+                emit_code(gen, "    movl $%llu, %%ecx\n    imulq %%rcx, %%rdx\n", plan->multiplier);
+            }
+            if (plan->non_negative) {
+                emit_code(gen, "    shrq $%d, %%rdx\n", plan->shift);
+            } else {
+                emit_code(gen, "    sarq $%d, %%rdx\n", plan->shift);
+                emit_code(gen, "    movl %%eax, %%ecx\n    sarl $31, %%ecx\n    subl %%ecx, %%edx\n");
+            }
+            if (remainder) {
+                emit_code(gen, "    imull $%ld, %%edx\n    subl %%edx, %%eax\n", magnitude);
+            } else {
+                emit_code(gen, "    movl %%edx, %%eax\n");
+            }
+            break;
+    }
+    if (plan->negative && !remainder) emit_code(gen, "    negl %%eax\n");
+}
+
+// Deixa as flags prontas e devolve a condição em que o valor é verdadeiro
+static const char* reduce_condition(CodeGenerator* gen, MatchState* state) {
+    char operand[128], other[128];
+    int rule = state->rule[NT_COND];
+    const char* condition = state->op == OP_COMPARE
+                            ? comparison_condition(state->node->data.binary_expr.operator) : "ne";
+    gen->rule_hits[rule]++;
+
+    switch (rule) {
+        case RULE_COND_LOC:
+            operand_text(state, operand, sizeof(operand));
+            emit_code(gen, "    testl %s, %s\n", operand, operand);
+            break;
+        case RULE_COND_REG:
+            reduce(gen, state, NT_REG);
+            emit_code(gen, "    testl %%eax, %%eax\n");
+            break;
+        case RULE_COND_TEST_LOC:
+            operand_text(state->kids[0], operand, sizeof(operand));
+            emit_code(gen, "    testl %s, %s\n", operand, operand);
+            break;
+        case RULE_COND_TEST:
+            reduce(gen, state->kids[0], NT_REG);
+            emit_code(gen, "    testl %%eax, %%eax\n");
+            break;
+        case RULE_COND_COMPARE_LOC:
+        case RULE_COND_COMPARE_MEM:
+            operand_text(state->kids[0], operand, sizeof(operand));
+            operand_text(state->kids[1], other, sizeof(other));
+            emit_code(gen, "    cmpl %s, %s\n", other, operand);
+            break;
+        case RULE_COND_COMPARE:
+            reduce(gen, state->kids[0], NT_REG);
+            operand_text(state->kids[1], other, sizeof(other));
+            emit_code(gen, "    cmpl %s, %%eax\n", other);
+            break;
+        case RULE_COND_COMPARE_SWAPPED:
+            reduce(gen, state->kids[1], NT_REG);
+            operand_text(state->kids[0], other, sizeof(other));
+            emit_code(gen, "    cmpl %s, %%eax\n", other);
+            condition = mirrored_condition(condition);
+            break;
+        case RULE_COND_COMPARE_GENERIC:
+            reduce_both(gen, state);
+            emit_code(gen, "    cmpl %%ecx, %%eax\n");
+            break;
+        default:
+            break;
+    }
+    return condition;
+}
+
+static void reduce(CodeGenerator* gen, MatchState* state, Nonterminal goal) {
+    char operand[128], target[128];
+    int rule = state->rule[goal];
+    gen->rule_hits[rule]++;
+
+    switch (rule) {
+        case RULE_REG_OTHER:
+            asm_expression(gen, state->node);
+            break;
+
+        case RULE_REG_IMM:
+        case RULE_REG_LOC:
+        case RULE_REG_MEM:
+            operand_text(state, operand, sizeof(operand));
+            emit_code(gen, "    movl %s, %%eax\n", operand);
+            break;
+
+        case RULE_REG_ADDR:
+            address_text(state, operand, sizeof(operand));
+            emit_code(gen, "    leal %s, %%eax\n", operand);
+            break;
+
+        case RULE_REG_COND: {
+            const char* condition = reduce_condition(gen, state);
+            emit_code(gen, "    set%s %%al\n    movzbl %%al, %%eax\n", condition);
+            break;
+        }
+
+        case RULE_STMT_REG:
+            reduce(gen, state, NT_REG);
+            break;
+
+        case RULE_REG_ADD:
+        case RULE_REG_SUB:
+        case RULE_REG_MUL:
+        case RULE_REG_AND:
+        case RULE_REG_OR:
+        case RULE_REG_XOR:
+            reduce(gen, state->kids[0], NT_REG);
+            operand_text(state->kids[1], operand, sizeof(operand));
+            emit_code(gen, "    %s %s, %%eax\n", tree_op_mnemonic(state->op), operand);
+            break;
+
+        case RULE_REG_ADD_SWAPPED:
+        case RULE_REG_MUL_SWAPPED:
+        case RULE_REG_AND_SWAPPED:
+        case RULE_REG_OR_SWAPPED:
+        case RULE_REG_XOR_SWAPPED:
+            reduce(gen, state->kids[1], NT_REG);
+            operand_text(state->kids[0], operand, sizeof(operand));
+            emit_code(gen, "    %s %s, %%eax\n", tree_op_mnemonic(state->op), operand);
+            break;
+
+        case RULE_REG_MUL_SHORT:
+        case RULE_REG_MUL_CHAIN:
+        case RULE_REG_MUL_SHORT_SWAPPED:
+        case RULE_REG_MUL_CHAIN_SWAPPED: {
+            int swapped = rule == RULE_REG_MUL_SHORT_SWAPPED || rule == RULE_REG_MUL_CHAIN_SWAPPED;
+            MultiplyPlan plan;
+            reduce(gen, state->kids[swapped ? 1 : 0], NT_REG);
+            arith_multiply_plan(state->kids[swapped ? 0 : 1]->value, &plan);
+            asm_multiply_constant(gen, &plan);
+            break;
+        }
+
+        case RULE_REG_DIV_CONST:
+        case RULE_REG_MOD_CONST: {
+            DivisionPlan plan;
+            reduce(gen, state->kids[0], NT_REG);
+            arith_division_plan(state->kids[1]->value, is_non_negative(state->kids[0]), &plan);
+            asm_divide_constant(gen, &plan, rule == RULE_REG_MOD_CONST);
+            break;
+        }
+
+        case RULE_REG_ADD_GENERIC:
+        case RULE_REG_SUB_GENERIC:
+        case RULE_REG_MUL_GENERIC:
+        case RULE_REG_DIV_GENERIC:
+        case RULE_REG_MOD_GENERIC:
+        case RULE_REG_AND_GENERIC:
+        case RULE_REG_OR_GENERIC:
+        case RULE_REG_XOR_GENERIC:
+            reduce_both(gen, state);
+            asm_int_binary(gen, state->node->data.binary_expr.operator);
+            break;
+
+        case RULE_STMT_UPDATE_LOC:
+        case RULE_STMT_UPDATE_MEM: {
+            MatchState* update = state->kids[1];
+            gen->rule_hits[update->rule[NT_UPDATE]]++;
+            operand_text(state->kids[0], target, sizeof(target));
+            operand_text(update->kids[1], operand, sizeof(operand));
+            emit_code(gen, "    %s %s, %s\n", tree_op_mnemonic(update->op), operand, target);
+            break;
+        }
+
+        case RULE_STMT_ASSIGN_LOC:
+        case RULE_STMT_ASSIGN_MEM:
+            operand_text(state->kids[0], target, sizeof(target));
+            operand_text(state->kids[1], operand, sizeof(operand));
+            if (strcmp(target, operand) != 0) emit_code(gen, "    movl %s, %s\n", operand, target);
+            break;
+
+        case RULE_STMT_LEA_LOC:
+            operand_text(state->kids[0], target, sizeof(target));
+            address_text(state->kids[1], operand, sizeof(operand));
+            emit_code(gen, "    leal %s, %s\n", operand, target);
+            break;
+
+        case RULE_STMT_SEQUENCE:
+            reduce(gen, state->kids[0], NT_STMT);
+            reduce(gen, state->kids[1], NT_STMT);
+            break;
+
+        case RULE_REG_SEQUENCE:
+            reduce(gen, state->kids[0], NT_STMT);
+            reduce(gen, state->kids[1], NT_REG);
+            break;
+
+        case RULE_REG_ASSIGN_LOC:
+        case RULE_REG_ASSIGN_MEM:
+            reduce(gen, state->kids[1], NT_REG);
+            asm_store(gen, state->kids[0]->symbol);
+            break;
+
+        default:
+            emit_comment(gen, "Regra de seleção sem emissão");
+            break;
+    }
+}
+
+static void print_selection_stats(CodeGenerator* gen) {
+    printf("\n=== SELEÇÃO DE INSTRUÇÕES ===\n");
+    printf("Árvores cobertas: %d (custo total %d)\n", gen->selected_trees, gen->selection_cost);
+    for (int r = 0; r < RULE_COUNT; r++) {
+        if (gen->rule_hits[r] > 0) {
+            printf("  %s: %d\n", selection_rules[r].pattern, gen->rule_hits[r]);
+        }
+    }
+}
+
+// Cobre a árvore a partir do objetivo; devolve 0 (sem emitir nada) se a
+// raiz está fora da gramática
+static int select_tree(CodeGenerator* gen, ASTNode* node, Nonterminal goal) {
+    MatchState* state = label_tree(node);
+    int selected = state->op != OP_OTHER && state->cost[goal] < NO_MATCH;
+    if (selected) {
+        gen->selected_trees++;
+        gen->selection_cost += state->cost[goal];
+        reduce(gen, state, goal);
+    }
+    match_state_destroy(state);
+    return selected;
+}
+
+// Inicializador de uma local int: coberto como a atribuição local = valor
+static int select_initializer(CodeGenerator* gen, Symbol* symbol, ASTNode* init) {
+    if (symbol->type != TYPE_INT || !is_integer_value(init)) return 0;
+    MatchState* target = match_state_create(NULL);
+    target->op = classify_variable(symbol, target);
+    if (target->op == OP_OTHER) {
+        free(target);
+        return 0;
+    }
+    match_rules(target);
+
+    MatchState* state = match_state_create(NULL);
+    state->op = OP_ASSIGN;
+    state->kids[0] = target;
+    state->kids[1] = label_tree(init);
+    match_rules(state);
+    gen->selected_trees++;
+    gen->selection_cost += state->cost[NT_STMT];
+    reduce(gen, state, NT_STMT);
+    match_state_destroy(state);
+    return 1;
+}
+
+// Expressão avaliada só pelos efeitos (comando de expressão, passo do for)
+static void asm_effect(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+    if (!gen->select_instructions || !select_tree(gen, node, NT_STMT)) {
+        asm_expression(gen, node);
+    }
+}
+
+// Deixa nas flags uma condição inteira; devolve o sufixo do jcc/setcc/cmov
+// que a testa verdadeira
+static const char* asm_condition_flags(CodeGenerator* gen, ASTNode* condition) {
+    if (!gen->select_instructions) {
+        asm_expression(gen, condition);
+        emit_code(gen, "    testl %%eax, %%eax\n");
+        return "ne";
+    }
+    MatchState* state = label_tree(condition);
+    gen->selected_trees++;
+    gen->selection_cost += state->cost[NT_COND];
+    const char* flags = reduce_condition(gen, state);
+    match_state_destroy(state);
+    return flags;
+}
+
+// Desvia para label quando a condição é verdadeira (ou falsa). Com a
+// seleção de instruções, && e || viram saltos em curto-circuito, ! troca
+// o sentido e comparações inteiras terminam num cmp/test seguido do jcc.
+static void asm_branch_on_condition(CodeGenerator* gen, ASTNode* condition, const char* label, int when_true) {
+    if (gen->select_instructions) {
+        if (condition->type == AST_BINARY_EXPRESSION &&
+            (condition->data.binary_expr.operator == TOKEN_AND || condition->data.binary_expr.operator == TOKEN_OR)) {
+            int is_and = condition->data.binary_expr.operator == TOKEN_AND;
+            if (is_and != when_true) {
+                // && falso ou || verdadeiro: qualquer um dos lados decide
+                asm_branch_on_condition(gen, condition->data.binary_expr.left, label, when_true);
+                asm_branch_on_condition(gen, condition->data.binary_expr.right, label, when_true);
+            } else {
+                char* skip = generate_label(gen, "cond_skip");
+                asm_branch_on_condition(gen, condition->data.binary_expr.left, skip, !when_true);
+                asm_branch_on_condition(gen, condition->data.binary_expr.right, label, when_true);
+                emit_code(gen, ".L%s:\n", skip);
+                free(skip);
+            }
+            return;
+        }
+        if (condition->type == AST_UNARY_EXPRESSION && condition->data.unary_expr.operator == UNARY_NOT) {
+            asm_branch_on_condition(gen, condition->data.unary_expr.operand, label, !when_true);
+            return;
+        }
+        if (is_integer_value(condition)) {
+            const char* jump = asm_condition_flags(gen, condition);
+            emit_code(gen, "    j%s .L%s\n", when_true ? jump : negated_condition(jump), label);
+            return;
+        }
+    }
+    asm_expression(gen, condition);
+    asm_branch_on_value(gen, condition->data_type, label, when_true);
+}
+
+// Ternário branchless (-O): os dois lados são calculados antes da
+// condição e o cmov escolhe. Um lado simples (constante, local em
+// registrador, int na memória) vai direto para o cmov depois da
+// comparação, já que mov não mexe nas flags; os outros esperam na pilha.
+// Escolher entre 1 e 0 é só um setcc.
+static void asm_select(CodeGenerator* gen, ASTNode* node) {
+    ASTNode* arms[2] = { node->data.ternary_expr.true_expr, node->data.ternary_expr.false_expr };
+    MatchState* states[2];
+    int pushed[2];
+    for (int i = 0; i < 2; i++) {
+        states[i] = label_tree(arms[i]);
+        pushed[i] = arms[i]->data_type != node->data_type ||
+                    (states[i]->op != OP_CONST && states[i]->op != OP_REGISTER && states[i]->op != OP_MEMORY);
+        if (pushed[i]) {
+            asm_expression(gen, arms[i]);
+            asm_convert(gen, arms[i]->data_type, node->data_type);
+            asm_push(gen, TYPE_INT);
+        }
+    }
+
+    const char* condition = asm_condition_flags(gen, node->data.ternary_expr.condition);
+    char operand[128];
+    if (!pushed[0] && !pushed[1] && states[0]->op == OP_CONST && states[1]->op == OP_CONST &&
+        (states[0]->value == 0 || states[0]->value == 1) && states[0]->value + states[1]->value == 1) {
+        emit_code(gen, "    set%s %%al\n    movzbl %%al, %%eax\n",
+                  states[0]->value ? condition : negated_condition(condition));
+        gen->select_sets++;
+    } else {
+        // O falso fica em %eax e o verdadeiro o substitui
+        if (pushed[1]) asm_pop(gen, TYPE_INT, 0);
+        if (pushed[0]) asm_pop(gen, TYPE_INT, 1);
+        if (!pushed[1]) {
+            operand_text(states[1], operand, sizeof(operand));
+            emit_code(gen, "    movl %s, %%eax\n", operand);
+        }
+        if (pushed[0]) {
+            strcpy(operand, "%ecx");
+        } else if (states[0]->op == OP_CONST) {
+            emit_code(gen, "    movl $%ld, %%ecx\n", states[0]->value);
+            strcpy(operand, "%ecx");
+        } else {
+            operand_text(states[0], operand, sizeof(operand));
+        }
+        emit_code(gen, "    cmov%s %s, %%eax\n", condition, operand);
+        gen->select_moves++;
+    }
+
+    match_state_destroy(states[0]);
+    match_state_destroy(states[1]);
+}
+
+static void asm_expression(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+    if (gen->select_instructions && select_tree(gen, node, NT_REG)) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            if (node->ref.symbol) {
+                asm_load(gen, node->ref.symbol);
+            }
+            break;
+
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+            if (is_float_type(node->data_type)) {
+                int index = add_literal(gen, node);
+                emit_code(gen, "    movss .LF%d(%%rip), %%xmm0\n", index);
+            } else {
+                emit_code(gen, "    movl $%s, %%eax\n", node->data.literal.value);
+            }
+            break;
+
+        case AST_CHAR_LITERAL:
+            emit_code(gen, "    movl $%d, %%eax\n", ast_char_literal_value(node->data.literal.value));
+            break;
+
+        case AST_STRING_LITERAL: {
+            int index = add_literal(gen, node);
+            emit_code(gen, "    leaq .LS%d(%%rip), %%rax\n", index);
+            break;
+        }
+
+        case AST_BINARY_EXPRESSION:
+            asm_binary(gen, node);
+            break;
+
+        case AST_UNARY_EXPRESSION:
+            asm_unary(gen, node);
+            break;
+
+        case AST_ASSIGNMENT_EXPRESSION: {
+            ASTNode* target = node->data.binary_expr.left;
+            ASTNode* value = node->data.binary_expr.right;
+            if (target->type != AST_IDENTIFIER || !target->ref.symbol) {
+                emit_comment(gen, "Atribuição a l-value não suportada");
+                break;
+            }
+            asm_expression(gen, value);
+            asm_expression_store(gen, value->data_type, target->ref.symbol);
+            break;
+        }
+
+        case AST_TERNARY_EXPRESSION: {
+            if (node->data.ternary_expr.branchless && is_integer_value(node)) {
+                asm_select(gen, node);
+                break;
+            }
+            char* else_label = generate_label(gen, "cond_else");
+            char* end_label = generate_label(gen, "cond_end");
+            ASTNode* condition = node->data.ternary_expr.condition;
+
+            asm_branch_on_condition(gen, condition, else_label, 0);
+            asm_expression(gen, node->data.ternary_expr.true_expr);
+            asm_convert(gen, node->data.ternary_expr.true_expr->data_type, node->data_type);
+            emit_code(gen, "    jmp .L%s\n", end_label);
+            emit_code(gen, ".L%s:\n", else_label);
+            asm_expression(gen, node->data.ternary_expr.false_expr);
+            asm_convert(gen, node->data.ternary_expr.false_expr->data_type, node->data_type);
+            emit_code(gen, ".L%s:\n", end_label);
+
+            free(else_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_FUNCTION_CALL:
+            asm_call(gen, node);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Teste de um cluster com o valor em %eax; se não acertar, segue adiante
+static void asm_switch_cluster(CodeGenerator* gen, const SwitchPlan* plan, const SwitchCluster* cluster,
+                               char** labels, const char* default_label) {
+    if (cluster->kind == CLUSTER_SINGLE) {
+        emit_code(gen, "    cmpl $%ld, %%eax\n", cluster->low);
+        emit_code(gen, "    je .L%s\n", labels[plan->cases[cluster->first].target]);
+        gen->switch_compares++;
+        return;
+    }
+
+    // Índice = valor - low, sem sinal: abaixo de low dá um número grande
+    char* skip_label = generate_label(gen, "switchskip");
+    emit_code(gen, "    movl %%eax, %%ecx\n    subl $%ld, %%ecx\n", cluster->low);
+    emit_code(gen, "    cmpl $%ld, %%ecx\n    ja .L%s\n", cluster->high - cluster->low, skip_label);
+
+    if (cluster->kind == CLUSTER_TABLE) {
+        // Entradas relativas ao início da tabela, como no código PIC do gcc
+        char* table_label = generate_label(gen, "switchtable");
+        emit_code(gen, "    leaq .L%s(%%rip), %%rdx\n", table_label);
+        emit_code(gen, "    movslq (%%rdx,%%rcx,4), %%rcx\n    addq %%rdx, %%rcx\n    jmp *%%rcx\n");
+
+        char* text = NULL;
+        size_t text_size = 0;
+        FILE* table = open_memstream(&text, &text_size);
+        fprintf(table, ".L%s:\n", table_label);
+        int next = cluster->first;
+        for (long value = cluster->low; value <= cluster->high; value++) {
+            const char* target = default_label;
+            if (plan->cases[next].value == value) target = labels[plan->cases[next++].target];
+            fprintf(table, "    .long .L%s-.L%s\n", target, table_label);
+        }
+        fclose(table);
+
+        if (gen->jump_table_count == gen->jump_table_capacity) {
+            gen->jump_table_capacity = gen->jump_table_capacity ? gen->jump_table_capacity * 2 : 4;
+            gen->jump_tables = realloc(gen->jump_tables, gen->jump_table_capacity * sizeof(char*));
+        }
+        gen->jump_tables[gen->jump_table_count++] = text;
+        gen->switch_tables++;
+        free(table_label);
+    } else {
+        // Um bit por valor do intervalo, uma máscara por destino
+        int targets[SWITCH_MAX_BITSET_TARGETS];
+        int target_count = switch_cluster_targets(plan, cluster, targets, SWITCH_MAX_BITSET_TARGETS);
+        for (int t = 0; t < target_count; t++) {
+            unsigned long long mask = switch_bitset_mask(plan, cluster, targets[t]);
+            if (mask <= 0xffffffffULL) {
+                emit_code(gen, "    movl $%llu, %%edx\n", mask);
+            } else {
+                emit_code(gen, "    movabsq $%llu, %%rdx\n", mask);
+            }
+            emit_code(gen, "    btq %%rcx, %%rdx\n    jc .L%s\n", labels[targets[t]]);
+        }
+        emit_code(gen, "    jmp .L%s\n", default_label);
+        gen->switch_bitsets++;
+    }
+    emit_code(gen, ".L%s:\n", skip_label);
+    free(skip_label);
+}
+
+// Busca binária sobre os clusters [first, last], que estão em ordem de
+// valor; poucos clusters são testados em sequência
+static void asm_switch_search(CodeGenerator* gen, const SwitchPlan* plan, int first, int last,
+                              char** labels, const char* default_label) {
+    if (last - first + 1 <= SWITCH_LINEAR_CLUSTERS) {
+        for (int i = first; i <= last; i++) {
+            asm_switch_cluster(gen, plan, &plan->clusters[i], labels, default_label);
+        }
+        emit_code(gen, "    jmp .L%s\n", default_label);
+        return;
+    }
+
+    int middle = (first + last + 1) / 2;
+    char* left_label = generate_label(gen, "switchleft");
+    emit_code(gen, "    cmpl $%ld, %%eax\n    jl .L%s\n", plan->clusters[middle].low, left_label);
+    gen->switch_searches++;
+    asm_switch_search(gen, plan, middle, last, labels, default_label);
+    emit_code(gen, ".L%s:\n", left_label);
+    asm_switch_search(gen, plan, first, middle - 1, labels, default_label);
+    free(left_label);
+}
+
+// Switch: o despacho segue o plano de clusters (switch_lowering.h); cada
+// rótulo recebe um label e o corpo é emitido em sequência, de modo que a
+// execução cai para o seguinte
+static void asm_switch(CodeGenerator* gen, ASTNode* node) {
+    ASTNode* cases = node->data.switch_stmt.cases;
+    char** labels = malloc((cases->child_count + 1) * sizeof(char*));
+    char* end_label = generate_label(gen, "endswitch");
+    char* saved_break;
+    char* saved_continue;
+
+    for (int i = 0; i < cases->child_count; i++) {
+        labels[i] = generate_label(gen, "case");
+    }
+    SwitchPlan* plan = switch_plan_create(node);
+    const char* default_label = plan->default_target >= 0 ? labels[plan->default_target] : end_label;
+
+    asm_expression(gen, node->data.switch_stmt.expression);
+    asm_switch_search(gen, plan, 0, plan->cluster_count - 1, labels, default_label);
+    gen->switch_statements++;
+    switch_plan_destroy(plan);
+
+    // continue dentro do switch continua valendo para o laço externo
+    enter_loop(gen, end_label, gen->continue_label, &saved_break, &saved_continue);
+    for (int i = 0; i < cases->child_count; i++) {
+        ASTNode* label = cases->children[i];
+        emit_code(gen, ".L%s:\n", labels[i]);
+        for (int j = 0; j < label->child_count; j++) {
+            asm_statement(gen, label->children[j]);
+        }
+        free(labels[i]);
+    }
+    exit_loop(gen, saved_break, saved_continue);
+    emit_code(gen, ".L%s:\n", end_label);
+
+    free(labels);
+    free(end_label);
+}
+
+// ============================================================
+// Vetorização (assembly, -O)
+//
+// Os laços reconhecidos por vector_loop_analyze ganham, entre o início
+// do for e o laço escalar, um laço que executa gen->vector_width voltas
+// por vez: o contador vira um vetor de lanes (i, i+1, ...), cada
+// acumulador um vetor de somas parciais (ou de máximos/mínimos), e as
+// folhas invariantes são replicadas em registradores antes do laço.
+// Registradores: 0 o contador, 1 o passo, depois os acumuladores, os
+// invariantes e, por fim, os de trabalho das expressões.
+// ============================================================
+
+#define VECTOR_COUNTER 0
+#define VECTOR_STEP 1
+#define VECTOR_FIRST_ACCUMULATOR 2
+
+// dst = dst op src (no AVX2, a forma VEX de três operandos sobre ymm)
+static void vector_op(CodeGenerator* gen, const char* op, int src, int dst) {
+    if (gen->vector_width == 8) {
+        emit_code(gen, "    v%s %%ymm%d, %%ymm%d, %%ymm%d\n", op, src, dst, dst);
+    } else {
+        emit_code(gen, "    %s %%xmm%d, %%xmm%d\n", op, src, dst);
+    }
+}
+
+static void vector_move(CodeGenerator* gen, int src, int dst) {
+    if (src == dst) return;
+    if (gen->vector_width == 8) {
+        emit_code(gen, "    vmovdqa %%ymm%d, %%ymm%d\n", src, dst);
+    } else {
+        emit_code(gen, "    movdqa %%xmm%d, %%xmm%d\n", src, dst);
+    }
+}
+
+static void vector_shuffle(CodeGenerator* gen, int order, int src, int dst) {
+    if (gen->vector_width == 8) {
+        emit_code(gen, "    vpshufd $0x%02x, %%ymm%d, %%ymm%d\n", order, src, dst);
+    } else {
+        emit_code(gen, "    pshufd $0x%02x, %%xmm%d, %%xmm%d\n", order, src, dst);
+    }
+}
+
+// %eax em todas as lanes
+static void vector_broadcast(CodeGenerator* gen, int reg) {
+    if (gen->vector_width == 8) {
+        emit_code(gen, "    vmovd %%eax, %%xmm%d\n", reg);
+        emit_code(gen, "    vpbroadcastd %%xmm%d, %%ymm%d\n", reg, reg);
+    } else {
+        emit_code(gen, "    movd %%eax, %%xmm%d\n", reg);
+        vector_shuffle(gen, 0x00, reg, reg);
+    }
+}
+
+// dst = dst * src lane a lane. O SSE2 só multiplica as lanes pares em
+// 64 bits (pmuludq): as ímpares descem 32 bits, e os produtos baixos
+// das duas metades são intercalados de volta. Um src replicado (uniform)
+// já tem o mesmo valor nas lanes pares e dispensa o deslocamento.
+static void vector_multiply(CodeGenerator* gen, int src, int dst, int scratch, int uniform) {
+    if (gen->vector_width == 8) {
+        vector_op(gen, "pmulld", src, dst);
+        return;
+    }
+    int odd = scratch;
+    int odd_src = src;
+    vector_move(gen, dst, odd);
+    emit_code(gen, "    psrlq $32, %%xmm%d\n", odd);
+    if (!uniform) {
+        odd_src = scratch + 1;
+        vector_move(gen, src, odd_src);
+        emit_code(gen, "    psrlq $32, %%xmm%d\n", odd_src);
+    }
+    vector_op(gen, "pmuludq", odd_src, odd);
+    vector_op(gen, "pmuludq", src, dst);
+    vector_shuffle(gen, 0x08, dst, dst);
+    vector_shuffle(gen, 0x08, odd, odd);
+    vector_op(gen, "punpckldq", odd, dst);
+}
+
+// dst = max(dst, src) ou min(dst, src). Sem pmaxsd no SSE2, a máscara
+// do pcmpgtd escolhe entre as duas (src é destruído).
+static void vector_extreme(CodeGenerator* gen, ReductionKind kind, int src, int dst, int scratch) {
+    if (gen->vector_width == 8) {
+        vector_op(gen, kind == REDUCTION_MAX ? "pmaxsd" : "pminsd", src, dst);
+        return;
+    }
+    // scratch: lanes em que src vence
+    if (kind == REDUCTION_MAX) {
+        vector_move(gen, src, scratch);
+        vector_op(gen, "pcmpgtd", dst, scratch);
+    } else {
+        vector_move(gen, dst, scratch);
+        vector_op(gen, "pcmpgtd", src, scratch);
+    }
+    vector_op(gen, "pand", scratch, src);
+    vector_op(gen, "pandn", dst, scratch);
+    vector_op(gen, "por", src, scratch);
+    vector_move(gen, scratch, dst);
+}
+
+static int vector_is_leaf(const VectorLoop* loop, const ASTNode* node) {
+    return node->type == AST_IDENTIFIER || vector_invariant_index(loop, node) >= 0;
+}
+
+static int vector_leaf_register(const VectorLoop* loop, const ASTNode* leaf) {
+    if (leaf->type == AST_IDENTIFIER) {
+        if (leaf->ref.symbol == loop->counter) return VECTOR_COUNTER;
+        for (int i = 0; i < loop->reduction_count; i++) {
+            if (loop->reductions[i].accumulator == leaf->ref.symbol) return VECTOR_FIRST_ACCUMULATOR + i;
+        }
+    }
+    return VECTOR_FIRST_ACCUMULATOR + loop->reduction_count + vector_invariant_index(loop, leaf);
+}
+
+// Calcula a expressão em dst; usa os registradores seguintes como
+// trabalho, na ordem de vector_expression_temporaries
+static void vector_expression(CodeGenerator* gen, const VectorLoop* loop, const ASTNode* node, int dst) {
+    if (vector_is_leaf(loop, node)) {
+        vector_move(gen, vector_leaf_register(loop, node), dst);
+        return;
+    }
+    if (node->type == AST_UNARY_EXPRESSION) {
+        vector_expression(gen, loop, node->data.unary_expr.operand, dst);
+        vector_op(gen, "pxor", dst + 1, dst + 1);
+        vector_op(gen, "psubd", dst, dst + 1);
+        vector_move(gen, dst + 1, dst);
+        return;
+    }
+
+    // Entre duas folhas, a invariante fica como fonte (3 * i vira i * 3)
+    TokenType op = node->data.binary_expr.operator;
+    const ASTNode* left = node->data.binary_expr.left;
+    const ASTNode* right = node->data.binary_expr.right;
+    if (op != TOKEN_MINUS && vector_is_leaf(loop, left) && vector_is_leaf(loop, right) &&
+        vector_invariant_index(loop, left) >= 0) {
+        const ASTNode* swap = left;
+        left = right;
+        right = swap;
+    }
+
+    int src = dst + 1;
+    vector_expression(gen, loop, left, dst);
+    if (vector_is_leaf(loop, right)) {
+        src = vector_leaf_register(loop, right);
+    } else {
+        vector_expression(gen, loop, right, src);
+    }
+    switch (op) {
+        case TOKEN_PLUS: vector_op(gen, "paddd", src, dst); break;
+        case TOKEN_MINUS: vector_op(gen, "psubd", src, dst); break;
+        default:
+            vector_multiply(gen, src, dst, src == dst + 1 ? dst + 2 : dst + 1,
+                            vector_invariant_index(loop, right) >= 0);
+            break;
+    }
+}
+
+static int vector_reads(const ASTNode* node, const Symbol* symbol) {
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return node->ref.symbol == symbol;
+        case AST_UNARY_EXPRESSION:
+            return vector_reads(node->data.unary_expr.operand, symbol);
+        case AST_BINARY_EXPRESSION:
+            return vector_reads(node->data.binary_expr.left, symbol) ||
+                   vector_reads(node->data.binary_expr.right, symbol);
+        default:
+            return 0;
+    }
+}
+
+// Soma ou subtrai o termo no acumulador
+static void vector_add_term(CodeGenerator* gen, const VectorLoop* loop, const ASTNode* term,
+                            const char* op, int accumulator, int dst) {
+    if (vector_is_leaf(loop, term)) {
+        vector_op(gen, op, vector_leaf_register(loop, term), accumulator);
+    } else {
+        vector_expression(gen, loop, term, dst);
+        vector_op(gen, op, dst, accumulator);
+    }
+}
+
+// acc = ... + acc + ...: percorre o caminho até o acumulador somando
+// (ou subtraindo) os outros termos direto nele
+static void vector_accumulate(CodeGenerator* gen, const VectorLoop* loop, const Reduction* reduction,
+                              const ASTNode* node, int accumulator, int dst) {
+    if (node->type == AST_IDENTIFIER && node->ref.symbol == reduction->accumulator) return;
+
+    const ASTNode* left = node->data.binary_expr.left;
+    const ASTNode* right = node->data.binary_expr.right;
+    if (node->data.binary_expr.operator == TOKEN_MINUS) {
+        vector_accumulate(gen, loop, reduction, left, accumulator, dst);
+        vector_add_term(gen, loop, right, "psubd", accumulator, dst);
+        return;
+    }
+    int on_left = vector_reads(left, reduction->accumulator);
+    const ASTNode* path = on_left ? left : right;
+    const ASTNode* term = on_left ? right : left;
+    vector_accumulate(gen, loop, reduction, path, accumulator, dst);
+    vector_add_term(gen, loop, term, "paddd", accumulator, dst);
+}
+
+// Combina as lanes de reg na lane 0 e grava no acumulador escalar
+static void vector_horizontal(CodeGenerator* gen, const Reduction* reduction, int reg, int scratch) {
+    if (gen->vector_width == 8) {
+        emit_code(gen, "    vextracti128 $1, %%ymm%d, %%xmm%d\n", reg, scratch);
+    }
+    for (int step = gen->vector_width == 8 ? 0 : 1; step < 3; step++) {
+        if (step > 0) vector_shuffle(gen, step == 1 ? 0x4e : 0xb1, reg, scratch);
+        if (reduction->kind == REDUCTION_SUM) {
+            vector_op(gen, "paddd", scratch, reg);
+        } else {
+            vector_extreme(gen, reduction->kind, scratch, reg, scratch + 1);
+        }
+    }
+    emit_code(gen, "    %smovd %%xmm%d, %%eax\n", gen->vector_width == 8 ? "v" : "", reg);
+    asm_store(gen, reduction->accumulator);
+}
+
+static void asm_vector_loop(CodeGenerator* gen, const VectorLoop* loop) {
+    int lanes = gen->vector_width;
+    int first_invariant = VECTOR_FIRST_ACCUMULATOR + loop->reduction_count;
+    int first_temporary = first_invariant + loop->invariant_count;
+    char* loop_label = generate_label(gen, "vector");
+    char* exit_label = generate_label(gen, "endvector");
+
+    for (int i = 0; i < loop->invariant_count; i++) {
+        ASTNode* leaf = loop->invariants[i];
+        long value;
+        if (ast_integer_constant(leaf, &value)) {
+            emit_code(gen, "    movl $%ld, %%eax\n", value);
+        } else {
+            asm_load(gen, leaf->ref.symbol);
+        }
+        vector_broadcast(gen, first_invariant + i);
+    }
+    // Somas parciais começam com o valor atual na lane 0 (movd zera as
+    // outras); máximo e mínimo, com ele em todas
+    for (int i = 0; i < loop->reduction_count; i++) {
+        const Reduction* reduction = &loop->reductions[i];
+        asm_load(gen, reduction->accumulator);
+        if (reduction->kind == REDUCTION_SUM) {
+            emit_code(gen, "    %smovd %%eax, %%xmm%d\n", lanes == 8 ? "v" : "", VECTOR_FIRST_ACCUMULATOR + i);
+        } else {
+            vector_broadcast(gen, VECTOR_FIRST_ACCUMULATOR + i);
+        }
+    }
+    emit_code(gen, "    movl $%d, %%eax\n", lanes);
+    vector_broadcast(gen, VECTOR_STEP);
+
+    // Um vetor inteiro cabe enquanto i + lanes - 1 < B: o limite de i
+    // fica em %rdx, e i em %rcx, com 64 bits para não transbordar
+    long bound;
+    long adjust = loop->inclusive - (lanes - 1);
+    if (ast_integer_constant(loop->bound, &bound)) {
+        emit_code(gen, "    movq $%ld, %%rdx\n", bound + adjust);
+    } else {
+        asm_load(gen, loop->bound->ref.symbol);
+        emit_code(gen, "    movslq %%eax, %%rdx\n");
+        emit_code(gen, "    addq $%ld, %%rdx\n", adjust);
+    }
+    asm_load(gen, loop->counter);
+    emit_code(gen, "    movslq %%eax, %%rcx\n");
+    vector_broadcast(gen, VECTOR_COUNTER);
+    if (lanes == 8) {
+        emit_code(gen, "    vpaddd .Lvector_lanes(%%rip), %%ymm%d, %%ymm%d\n", VECTOR_COUNTER, VECTOR_COUNTER);
+    } else {
+        emit_code(gen, "    paddd .Lvector_lanes(%%rip), %%xmm%d\n", VECTOR_COUNTER);
+    }
+    gen->vector_lanes_used = 1;
+
+    emit_code(gen, ".L%s:\n", loop_label);
+    emit_code(gen, "    cmpq %%rdx, %%rcx\n");
+    emit_code(gen, "    jge .L%s\n", exit_label);
+    for (int i = 0; i < loop->reduction_count; i++) {
+        const Reduction* reduction = &loop->reductions[i];
+        int accumulator = VECTOR_FIRST_ACCUMULATOR + i;
+        if (reduction->kind == REDUCTION_SUM) {
+            vector_accumulate(gen, loop, reduction, reduction->value, accumulator, first_temporary);
+        } else {
+            vector_expression(gen, loop, reduction->value, first_temporary);
+            vector_extreme(gen, reduction->kind, first_temporary, accumulator, first_temporary + 1);
+        }
+    }
+    vector_op(gen, "paddd", VECTOR_STEP, VECTOR_COUNTER);
+    emit_code(gen, "    addq $%d, %%rcx\n", lanes);
+    emit_code(gen, "    jmp .L%s\n", loop_label);
+
+    emit_code(gen, ".L%s:\n", exit_label);
+    emit_code(gen, "    movl %%ecx, %%eax\n");
+    asm_store(gen, loop->counter);
+    for (int i = 0; i < loop->reduction_count; i++) {
+        vector_horizontal(gen, &loop->reductions[i], VECTOR_FIRST_ACCUMULATOR + i, first_invariant);
+    }
+    if (lanes == 8) emit_code(gen, "    vzeroupper\n");
+
+    gen->vectorized_loops++;
+    gen->vector_reductions += loop->reduction_count;
+    free(loop_label);
+    free(exit_label);
+}
+
+// ============================================================
+// Blocos frios (assembly, -fprofile-use)
+// ============================================================
+
+static char* copy_label(const char* label) {
+    return label ? strdup(label) : NULL;
+}
+
+// O lado do if que quase nunca roda sai da linha: a condição desvia para
+// ele e o lado frequente segue direto, sem saltos. O bloco raro é emitido
+// depois do epílogo e volta com jmp para depois do if.
+static void asm_cold_if(CodeGenerator* gen, ASTNode* node, int rare_is_then) {
+    char* cold_label = generate_label(gen, "cold");
+    char* resume_label = generate_label(gen, "resume");
+    int counter = profile_counter(gen, node);
+
+    asm_count(gen, counter);
+    asm_branch_on_condition(gen, node->data.if_stmt.condition, cold_label, rare_is_then);
+    if (rare_is_then) {
+        asm_statement(gen, node->data.if_stmt.else_stmt);
+    } else {
+        asm_count(gen, profile_taken(counter));
+        asm_statement(gen, node->data.if_stmt.then_stmt);
+    }
+    emit_code(gen, ".L%s:\n", resume_label);
+
+    if (gen->cold_block_count == gen->cold_block_capacity) {
+        gen->cold_block_capacity = gen->cold_block_capacity ? gen->cold_block_capacity * 2 : 8;
+        gen->cold_blocks = realloc(gen->cold_blocks, gen->cold_block_capacity * sizeof(ColdBlock));
+    }
+    ColdBlock* block = &gen->cold_blocks[gen->cold_block_count++];
+    block->label = cold_label;
+    block->statement = rare_is_then ? node->data.if_stmt.then_stmt : node->data.if_stmt.else_stmt;
+    block->resume_label = resume_label;
+    block->break_label = copy_label(gen->break_label);
+    block->continue_label = copy_label(gen->continue_label);
+    block->counter = rare_is_then ? profile_taken(counter) : -1;
+    gen->profile->cold_blocks++;
+}
+
+// Depois do epílogo; um bloco frio pode abrir outros, que entram na fila
+static void asm_cold_blocks(CodeGenerator* gen, int in_cold_section) {
+    if (gen->cold_block_count == 0) return;
+    if (!in_cold_section) emit_code(gen, ".section .text.unlikely,\"ax\",@progbits\n");
+
+    for (int i = 0; i < gen->cold_block_count; i++) {
+        ColdBlock block = gen->cold_blocks[i];
+        gen->break_label = block.break_label;
+        gen->continue_label = block.continue_label;
+        emit_code(gen, ".L%s:\n", block.label);
+        asm_count(gen, block.counter);
+        asm_statement(gen, block.statement);
+        emit_code(gen, "    jmp .L%s\n", block.resume_label);
+        free(block.label);
+        free(block.resume_label);
+        free(block.break_label);
+        free(block.continue_label);
+    }
+    gen->break_label = NULL;
+    gen->continue_label = NULL;
+    gen->cold_block_count = 0;
+    if (!in_cold_section) emit_code(gen, ".text\n\n");
+}
+
+static void asm_statement(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                asm_statement(gen, node->children[i]);
+            }
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            generate_variable_declaration(gen, node);
+            break;
+
+        case AST_EXPRESSION_STATEMENT:
+            if (node->child_count > 0) {
+                asm_effect(gen, node->children[0]);
+            }
+            break;
+
+        case AST_RETURN_STATEMENT: {
+            ASTNode* value = node->data.return_stmt.expression;
+            ASTNode* call = gen->stack_depth == 0 ? tail_call(gen, node) : NULL;
+            if (call) {
+                asm_tail_call(gen, call);
+                break;
+            }
+            if (value) {
+                asm_expression(gen, value);
+                asm_convert(gen, value->data_type, gen->current_return_type);
+            }
+            emit_code(gen, "    jmp .L%s\n", gen->return_label);
+            break;
+        }
+
+        case AST_IF_STATEMENT: {
+            // Com perfil, o lado raro (o then, ou o else de um then
+            // frequente) vai para fora da linha
+            int bias = profile_branch_bias(gen->profile, node);
+            if (bias < 0 || (bias > 0 && node->data.if_stmt.else_stmt)) {
+                asm_cold_if(gen, node, bias < 0);
+                break;
+            }
+
+            // Sem else, o rótulo de saída é o próprio "else"
+            char* else_label = generate_label(gen, "else");
+            char* end_label = node->data.if_stmt.else_stmt ? generate_label(gen, "endif") : NULL;
+            ASTNode* condition = node->data.if_stmt.condition;
+            int counter = profile_counter(gen, node);
+
+            asm_count(gen, counter);
+            asm_branch_on_condition(gen, condition, else_label, 0);
+            asm_count(gen, profile_taken(counter));
+            asm_statement(gen, node->data.if_stmt.then_stmt);
+            if (end_label) {
+                emit_code(gen, "    jmp .L%s\n", end_label);
+            }
+            emit_code(gen, ".L%s:\n", else_label);
+            if (end_label) {
+                asm_statement(gen, node->data.if_stmt.else_stmt);
+                emit_code(gen, ".L%s:\n", end_label);
+            }
+
+            free(else_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_WHILE_STATEMENT: {
+            char* cond_label = generate_label(gen, "while");
+            char* end_label = generate_label(gen, "endwhile");
+            char* saved_break;
+            char* saved_continue;
+            ASTNode* condition = node->data.while_stmt.condition;
+            int counter = profile_counter(gen, node);
+
+            emit_code(gen, ".L%s:\n", cond_label);
+            asm_count(gen, counter);
+            asm_branch_on_condition(gen, condition, end_label, 0);
+            asm_count(gen, profile_taken(counter));
+
+            enter_loop(gen, end_label, cond_label, &saved_break, &saved_continue);
+            asm_statement(gen, node->data.while_stmt.body);
+            exit_loop(gen, saved_break, saved_continue);
+
+            emit_code(gen, "    jmp .L%s\n", cond_label);
+            emit_code(gen, ".L%s:\n", end_label);
+
+            free(cond_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_DO_WHILE_STATEMENT: {
+            char* body_label = generate_label(gen, "do");
+            char* cond_label = generate_label(gen, "docond");
+            char* end_label = generate_label(gen, "enddo");
+            char* saved_break;
+            char* saved_continue;
+            ASTNode* condition = node->data.while_stmt.condition;
+
+            emit_code(gen, ".L%s:\n", body_label);
+            enter_loop(gen, end_label, cond_label, &saved_break, &saved_continue);
+            asm_statement(gen, node->data.while_stmt.body);
+            exit_loop(gen, saved_break, saved_continue);
+
+            emit_code(gen, ".L%s:\n", cond_label);
+            int counter = profile_counter(gen, node);
+            if (counter >= 0) {
+                // A volta só é contada depois do teste
+                asm_count(gen, counter);
+                asm_branch_on_condition(gen, condition, end_label, 0);
+                asm_count(gen, profile_taken(counter));
+                emit_code(gen, "    jmp .L%s\n", body_label);
+            } else {
+                asm_branch_on_condition(gen, condition, body_label, 1);
+            }
+            emit_code(gen, ".L%s:\n", end_label);
+
+            free(body_label);
+            free(cond_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_FOR_STATEMENT: {
+            char* cond_label = generate_label(gen, "for");
+            char* step_label = generate_label(gen, "forstep");
+            char* end_label = generate_label(gen, "endfor");
+            char* saved_break;
+            char* saved_continue;
+            ASTNode* condition = node->data.for_stmt.condition;
+
+            asm_statement(gen, node->data.for_stmt.init);
+            // As voltas que não completam um vetor ficam com o laço escalar
+            VectorLoop vector;
+            if (gen->vector_width && vector_loop_analyze(node, &vector)) {
+                asm_vector_loop(gen, &vector);
+            }
+            emit_code(gen, ".L%s:\n", cond_label);
+            if (condition) {
+                int counter = profile_counter(gen, node);
+                asm_count(gen, counter);
+                asm_branch_on_condition(gen, condition, end_label, 0);
+                asm_count(gen, profile_taken(counter));
+            }
+
+            enter_loop(gen, end_label, step_label, &saved_break, &saved_continue);
+            asm_statement(gen, node->data.for_stmt.body);
+            exit_loop(gen, saved_break, saved_continue);
+
+            emit_code(gen, ".L%s:\n", step_label);
+            asm_effect(gen, node->data.for_stmt.update);
+            emit_code(gen, "    jmp .L%s\n", cond_label);
+            emit_code(gen, ".L%s:\n", end_label);
+
+            free(cond_label);
+            free(step_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_SWITCH_STATEMENT:
+            asm_switch(gen, node);
+            break;
+
+        case AST_BREAK_STATEMENT:
+            if (gen->break_label) emit_code(gen, "    jmp .L%s\n", gen->break_label);
+            break;
+
+        case AST_CONTINUE_STATEMENT:
+            if (gen->continue_label) emit_code(gen, "    jmp .L%s\n", gen->continue_label);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ------------------------------------------------------------
+// Backend bytecode (máquina de pilha)
+//
+// Instruções aritméticas são tipadas pelo prefixo I (int/char) ou F
+// (float); conversões explícitas (I2F, F2I, I2C) usam os tipos
+// anotados pela análise semântica. Locais e parâmetros são acessados
+// pelo slot no frame (LOADL/STOREL n); globais, pelo nome (LOAD/STORE).
+// Uma função memoizada tem a tabela declarada por MEMOTABLE nome
+// entradas k; MEMOGET nome k rótulo desempilha os k argumentos e empilha
+// o resultado guardado ou, se não há, salta para o rótulo; MEMOPUT nome
+// k desempilha os argumentos e o resultado, guarda-o e o empilha de novo.
+// ------------------------------------------------------------
+
+static char bc_type_prefix(DataType type) {
+    return is_float_type(type) ? 'F' : 'I';
+}
+
+static void bc_convert(CodeGenerator* gen, DataType from, DataType to) {
+    if (from == to || to == TYPE_VOID || from == TYPE_VOID) return;
+
+    if (is_float_type(from) && !is_float_type(to)) {
+        emit_code(gen, "F2I\n");
+        if (to == TYPE_CHAR) emit_code(gen, "I2C\n");
+    } else if (!is_float_type(from) && is_float_type(to)) {
+        emit_code(gen, "I2F\n");
+    } else if (to == TYPE_CHAR) {
+        emit_code(gen, "I2C\n");
+    }
+}
+
+// Leitura ou escrita de uma variável (op = "LOAD" ou "STORE")
+static void bc_variable_access(CodeGenerator* gen, const char* op, ASTNode* target) {
+    Symbol* symbol = target->type == AST_IDENTIFIER ? target->ref.symbol : NULL;
+    if (symbol && symbol->scope_level > 0 && target->ref.slot >= 0) {
+        emit_code(gen, "%sL %d\n", op, target->ref.slot);
+    } else {
+        emit_code(gen, "%s %s\n", op, target->type == AST_IDENTIFIER ? target->data.identifier.name : "?");
+    }
+}
+
+// Reduz o valor do topo da pilha a um int verdade (0 ou 1 para floats)
+static void bc_condition(CodeGenerator* gen, ASTNode* condition) {
+    bc_expression(gen, condition);
+    if (is_float_type(condition->data_type)) {
+        emit_code(gen, "PUSHF 0.0\nFNE\n");
+    }
+}
+
+static const char* bc_binary_opcode(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: return "ADD";
+        case TOKEN_MINUS: return "SUB";
+        case TOKEN_MULTIPLY: return "MUL";
+        case TOKEN_DIVIDE: return "DIV";
+        case TOKEN_MODULO: return "MOD";
+        case TOKEN_EQUAL: return "EQ";
+        case TOKEN_NOT_EQUAL: return "NE";
+        case TOKEN_LESS: return "LT";
+        case TOKEN_GREATER: return "GT";
+        case TOKEN_LESS_EQUAL: return "LE";
+        case TOKEN_GREATER_EQUAL: return "GE";
+        case TOKEN_BITWISE_AND: return "AND";
+        case TOKEN_BITWISE_OR: return "OR";
+        case TOKEN_BITWISE_XOR: return "XOR";
+        case TOKEN_LEFT_SHIFT: return "SHL";
+        case TOKEN_RIGHT_SHIFT: return "SHR";
+        default: return "NOP";
+    }
+}
+
+static void bc_expression(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            bc_variable_access(gen, "LOAD", node);
+            break;
+
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+            emit_code(gen, "%s %s\n", is_float_type(node->data_type) ? "PUSHF" : "PUSH",
+                      node->data.literal.value);
+            break;
+
+        case AST_CHAR_LITERAL:
+            emit_code(gen, "PUSH %d\n", ast_char_literal_value(node->data.literal.value));
+            break;
+
+        case AST_STRING_LITERAL:
+            emit_code(gen, "PUSHS ");
+            emit_escaped_string(gen, node->data.literal.value);
+            emit_code(gen, "\n");
+            break;
+
+        case AST_BINARY_EXPRESSION: {
+            TokenType op = node->data.binary_expr.operator;
+            ASTNode* left = node->data.binary_expr.left;
+            ASTNode* right = node->data.binary_expr.right;
+
+            if (op == TOKEN_AND || op == TOKEN_OR) {
+                char* short_label = generate_label(gen, op == TOKEN_AND ? "and_false" : "or_true");
+                char* end_label = generate_label(gen, "logic_end");
+                const char* jump = op == TOKEN_AND ? "JZ" : "JNZ";
+
+                bc_condition(gen, left);
+                emit_code(gen, "%s %s\n", jump, short_label);
+                bc_condition(gen, right);
+                emit_code(gen, "%s %s\n", jump, short_label);
+                emit_code(gen, "PUSH %d\nJMP %s\n", op == TOKEN_AND ? 1 : 0, end_label);
+                emit_code(gen, "%s:\nPUSH %d\n%s:\n", short_label, op == TOKEN_AND ? 0 : 1, end_label);
+
+                free(short_label);
+                free(end_label);
+                break;
+            }
+            if (op == TOKEN_COMMA) {
+                bc_expression(gen, left);
+                if (left->data_type != TYPE_VOID) emit_code(gen, "POP\n");
+                bc_expression(gen, right);
+                break;
+            }
+
+            // Aritmética de ponteiros: o deslocamento inteiro é escalado
+            // pelo tamanho do elemento (a diferença de ponteiros é dividida)
+            if (is_address_type(left->data_type) || is_address_type(right->data_type)) {
+                int left_pointer = is_address_type(left->data_type);
+                int right_pointer = is_address_type(right->data_type);
+                int scale = pointee_size(gen, left_pointer ? left->type_id : right->type_id);
+                int arithmetic = op == TOKEN_PLUS || op == TOKEN_MINUS;
+
+                bc_expression(gen, left);
+                if (!left_pointer && arithmetic && scale != 1) emit_code(gen, "PUSH %d\nIMUL\n", scale);
+                bc_expression(gen, right);
+                if (!right_pointer && arithmetic && scale != 1) emit_code(gen, "PUSH %d\nIMUL\n", scale);
+                emit_code(gen, "I%s\n", bc_binary_opcode(op));
+                if (left_pointer && right_pointer && op == TOKEN_MINUS && scale != 1) {
+                    emit_code(gen, "PUSH %d\nIDIV\n", scale);
+                }
+                break;
+            }
+
+            DataType operand_type = is_float_type(left->data_type) || is_float_type(right->data_type)
+                                    ? TYPE_FLOAT : TYPE_INT;
+            bc_expression(gen, left);
+            bc_convert(gen, left->data_type, operand_type);
+            bc_expression(gen, right);
+            bc_convert(gen, right->data_type, operand_type);
+            emit_code(gen, "%c%s\n", bc_type_prefix(operand_type), bc_binary_opcode(op));
+            break;
+        }
+
+        case AST_UNARY_EXPRESSION: {
+            UnaryOperator op = node->data.unary_expr.operator;
+            ASTNode* operand = node->data.unary_expr.operand;
+
+            switch (op) {
+                case UNARY_PLUS:
+                    bc_expression(gen, operand);
+                    break;
+                case UNARY_MINUS:
+                    bc_expression(gen, operand);
+                    emit_code(gen, "%cNEG\n", bc_type_prefix(operand->data_type));
+                    break;
+                case UNARY_NOT:
+                    bc_condition(gen, operand);
+                    emit_code(gen, "NOT\n");
+                    break;
+                case UNARY_BITWISE_NOT:
+                    bc_expression(gen, operand);
+                    emit_code(gen, "INOT\n");
+                    break;
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT: {
+                    char prefix = bc_type_prefix(operand->data_type);
+                    int is_post = op == UNARY_POST_INCREMENT || op == UNARY_POST_DECREMENT;
+                    int is_increment = op == UNARY_PRE_INCREMENT || op == UNARY_POST_INCREMENT;
+
+                    bc_variable_access(gen, "LOAD", operand);
+                    if (is_post) emit_code(gen, "DUP\n");
+                    int step = operand->data_type == TYPE_POINTER ? pointee_size(gen, operand->type_id) : 1;
+                    emit_code(gen, "%s %d\n%c%s\n", prefix == 'F' ? "PUSHF" : "PUSH", step, prefix,
+                              is_increment ? "ADD" : "SUB");
+                    bc_convert(gen, operand->data_type == TYPE_CHAR ? TYPE_INT : operand->data_type,
+                               operand->data_type);
+                    if (!is_post) emit_code(gen, "DUP\n");
+                    bc_variable_access(gen, "STORE", operand);
+                    break;
+                }
+                default:
+                    emit_code(gen, "NOP\n");
+                    break;
+            }
+            break;
+        }
+
+        case AST_ASSIGNMENT_EXPRESSION: {
+            ASTNode* target = node->data.binary_expr.left;
+            ASTNode* value = node->data.binary_expr.right;
+            bc_expression(gen, value);
+            bc_convert(gen, value->data_type, target->data_type);
+            emit_code(gen, "DUP\n");
+            bc_variable_access(gen, "STORE", target);
+            break;
+        }
+
+        case AST_TERNARY_EXPRESSION: {
+            if (node->data.ternary_expr.branchless) {
+                // ISELECT desempilha a condição, o falso e o verdadeiro
+                bc_expression(gen, node->data.ternary_expr.true_expr);
+                bc_convert(gen, node->data.ternary_expr.true_expr->data_type, node->data_type);
+                bc_expression(gen, node->data.ternary_expr.false_expr);
+                bc_convert(gen, node->data.ternary_expr.false_expr->data_type, node->data_type);
+                bc_condition(gen, node->data.ternary_expr.condition);
+                emit_code(gen, "ISELECT\n");
+                gen->select_moves++;
+                break;
+            }
+            char* else_label = generate_label(gen, "cond_else");
+            char* end_label = generate_label(gen, "cond_end");
+
+            bc_condition(gen, node->data.ternary_expr.condition);
+            emit_code(gen, "JZ %s\n", else_label);
+            bc_expression(gen, node->data.ternary_expr.true_expr);
+            bc_convert(gen, node->data.ternary_expr.true_expr->data_type, node->data_type);
+            emit_code(gen, "JMP %s\n%s:\n", end_label, else_label);
+            bc_expression(gen, node->data.ternary_expr.false_expr);
+            bc_convert(gen, node->data.ternary_expr.false_expr->data_type, node->data_type);
+            emit_code(gen, "%s:\n", end_label);
+
+            free(else_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_FUNCTION_CALL:
+            bc_count(gen, profile_counter(gen, node));
+            for (int i = 0; i < node->child_count; i++) {
+                bc_expression(gen, node->children[i]);
+                bc_convert(gen, node->children[i]->data_type, call_argument_type(gen, node, i));
+            }
+            emit_code(gen, "CALL %s %d\n", node->data.function_call.name, node->child_count);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void bc_switch(CodeGenerator* gen, ASTNode* node) {
+    ASTNode* cases = node->data.switch_stmt.cases;
+    char** labels = malloc((cases->child_count + 1) * sizeof(char*));
+    char* end_label = generate_label(gen, "endswitch");
+    char* saved_break;
+    char* saved_continue;
+
+    for (int i = 0; i < cases->child_count; i++) {
+        labels[i] = generate_label(gen, "case");
+    }
+    SwitchPlan* plan = switch_plan_create(node);
+    const char* default_label = plan->default_target >= 0 ? labels[plan->default_target] : end_label;
+
+    // Casos densos: TABLESWITCH low high default rótulo...; senão,
+    // LOOKUPSWITCH default n valor:rótulo... em ordem de valor
+    bc_expression(gen, node->data.switch_stmt.expression);
+    if (plan->cluster_count == 1 && plan->clusters[0].kind == CLUSTER_TABLE) {
+        const SwitchCluster* table = &plan->clusters[0];
+        emit_code(gen, "TABLESWITCH %ld %ld %s", table->low, table->high, default_label);
+        int next = 0;
+        for (long value = table->low; value <= table->high; value++) {
+            const char* target = default_label;
+            if (plan->cases[next].value == value) target = labels[plan->cases[next++].target];
+            emit_code(gen, " %s", target);
+        }
+        gen->switch_tables++;
+    } else {
+        emit_code(gen, "LOOKUPSWITCH %s %d", default_label, plan->case_count);
+        for (int i = 0; i < plan->case_count; i++) {
+            emit_code(gen, " %ld:%s", plan->cases[i].value, labels[plan->cases[i].target]);
+        }
+        gen->switch_lookups++;
+    }
+    emit_code(gen, "\n");
+    gen->switch_statements++;
+    switch_plan_destroy(plan);
+
+    enter_loop(gen, end_label, gen->continue_label, &saved_break, &saved_continue);
+    for (int i = 0; i < cases->child_count; i++) {
+        ASTNode* label = cases->children[i];
+        emit_code(gen, "%s:\n", labels[i]);
+        for (int j = 0; j < label->child_count; j++) {
+            bc_statement(gen, label->children[j]);
+        }
+        free(labels[i]);
+    }
+    exit_loop(gen, saved_break, saved_continue);
+    emit_code(gen, "%s:\n", end_label);
+
+    free(labels);
+    free(end_label);
+}
+
+static void bc_statement(CodeGenerator* gen, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                bc_statement(gen, node->children[i]);
+            }
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            generate_variable_declaration(gen, node);
+            break;
+
+        case AST_EXPRESSION_STATEMENT:
+            if (node->child_count > 0) {
+                bc_expression(gen, node->children[0]);
+                if (node->children[0]->data_type != TYPE_VOID) {
+                    emit_code(gen, "POP\n");
+                }
+            }
+            break;
+
+        case AST_RETURN_STATEMENT: {
+            ASTNode* value = node->data.return_stmt.expression;
+            ASTNode* call = tail_call(gen, node);
+            if (call) {
+                // CALL seguido de RETV, sem empilhar um novo frame
+                bc_count(gen, profile_counter(gen, call));
+                for (int i = 0; i < call->child_count; i++) {
+                    bc_expression(gen, call->children[i]);
+                    bc_convert(gen, call->children[i]->data_type, call_argument_type(gen, call, i));
+                }
+                emit_code(gen, "TAILCALL %s %d\n", call->data.function_call.name, call->child_count);
+                gen->tail_jumps++;
+            } else if (value) {
+                bc_expression(gen, value);
+                bc_convert(gen, value->data_type, gen->current_return_type);
+                emit_code(gen, "RETV\n");
+            } else {
+                emit_code(gen, "RET\n");
+            }
+            break;
+        }
+
+        case AST_IF_STATEMENT: {
+            char* else_label = generate_label(gen, "else");
+            char* end_label = node->data.if_stmt.else_stmt ? generate_label(gen, "endif") : NULL;
+
+            int counter = profile_counter(gen, node);
+
+            bc_count(gen, counter);
+            bc_condition(gen, node->data.if_stmt.condition);
+            emit_code(gen, "JZ %s\n", else_label);
+            bc_count(gen, profile_taken(counter));
+            bc_statement(gen, node->data.if_stmt.then_stmt);
+            if (end_label) {
+                emit_code(gen, "JMP %s\n", end_label);
+            }
+            emit_code(gen, "%s:\n", else_label);
+            if (end_label) {
+                bc_statement(gen, node->data.if_stmt.else_stmt);
+                emit_code(gen, "%s:\n", end_label);
+            }
+
+            free(else_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_WHILE_STATEMENT: {
+            char* cond_label = generate_label(gen, "while");
+            char* end_label = generate_label(gen, "endwhile");
+            char* saved_break;
+            char* saved_continue;
+
+            int counter = profile_counter(gen, node);
+
+            emit_code(gen, "%s:\n", cond_label);
+            bc_count(gen, counter);
+            bc_condition(gen, node->data.while_stmt.condition);
+            emit_code(gen, "JZ %s\n", end_label);
+            bc_count(gen, profile_taken(counter));
+
+            enter_loop(gen, end_label, cond_label, &saved_break, &saved_continue);
+            bc_statement(gen, node->data.while_stmt.body);
+            exit_loop(gen, saved_break, saved_continue);
+
+            emit_code(gen, "JMP %s\n%s:\n", cond_label, end_label);
+
+            free(cond_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_DO_WHILE_STATEMENT: {
+            char* body_label = generate_label(gen, "do");
+            char* cond_label = generate_label(gen, "docond");
+            char* end_label = generate_label(gen, "enddo");
+            char* saved_break;
+            char* saved_continue;
+
+            emit_code(gen, "%s:\n", body_label);
+            enter_loop(gen, end_label, cond_label, &saved_break, &saved_continue);
+            bc_statement(gen, node->data.while_stmt.body);
+            exit_loop(gen, saved_break, saved_continue);
+
+            int counter = profile_counter(gen, node);
+            emit_code(gen, "%s:\n", cond_label);
+            bc_count(gen, counter);
+            bc_condition(gen, node->data.while_stmt.condition);
+            emit_code(gen, "JZ %s\n", end_label);
+            bc_count(gen, profile_taken(counter));
+            emit_code(gen, "JMP %s\n%s:\n", body_label, end_label);
+
+            free(body_label);
+            free(cond_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_FOR_STATEMENT: {
+            char* cond_label = generate_label(gen, "for");
+            char* step_label = generate_label(gen, "forstep");
+            char* end_label = generate_label(gen, "endfor");
+            char* saved_break;
+            char* saved_continue;
+            ASTNode* update = node->data.for_stmt.update;
+
+            bc_statement(gen, node->data.for_stmt.init);
+            emit_code(gen, "%s:\n", cond_label);
+            if (node->data.for_stmt.condition) {
+                int counter = profile_counter(gen, node);
+                bc_count(gen, counter);
+                bc_condition(gen, node->data.for_stmt.condition);
+                emit_code(gen, "JZ %s\n", end_label);
+                bc_count(gen, profile_taken(counter));
+            }
+
+            enter_loop(gen, end_label, step_label, &saved_break, &saved_continue);
+            bc_statement(gen, node->data.for_stmt.body);
+            exit_loop(gen, saved_break, saved_continue);
+
+            emit_code(gen, "%s:\n", step_label);
+            if (update) {
+                bc_expression(gen, update);
+                if (update->data_type != TYPE_VOID) emit_code(gen, "POP\n");
+            }
+            emit_code(gen, "JMP %s\n%s:\n", cond_label, end_label);
+
+            free(cond_label);
+            free(step_label);
+            free(end_label);
+            break;
+        }
+
+        case AST_SWITCH_STATEMENT:
+            bc_switch(gen, node);
+            break;
+
+        case AST_BREAK_STATEMENT:
+            if (gen->break_label) emit_code(gen, "JMP %s\n", gen->break_label);
+            break;
+
+        case AST_CONTINUE_STATEMENT:
+            if (gen->continue_label) emit_code(gen, "JMP %s\n", gen->continue_label);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// ============================================================
+// Utilitários
+// ============================================================
+
 char* generate_label(CodeGenerator* gen, const char* prefix) {
     char* label = malloc(64);
     snprintf(label, 64, "%s_%d", prefix, gen->label_counter++);
     return label;
 }
 
+// O contador é o da tabela de símbolos, que os temporários do otimizador
+// também usam
 char* generate_temp_var(CodeGenerator* gen) {
     char* temp = malloc(32);
-    snprintf(temp, 32, "_temp_%d", gen->temp_counter++);
+    snprintf(temp, 32, "_temp_%d", gen->symbol_table->temp_counter++);
     return temp;
 }
 
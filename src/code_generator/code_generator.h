@@ -3,6 +3,16 @@
 
 #include "ast.h"
 #include "symbol_table.h"
+#include "register_allocator.h"
+#include "peephole.h"
+#include "vectorizer.h"
+#include "profile.h"
+#include "switch_lowering.h"
+#include "arith_lowering.h"
+
+// Entradas da tabela de resultados de uma função memoizada (-fmemoize);
+// potência de 2, indexada pelo hash dos argumentos
+#define MEMO_TABLE_ENTRIES 4096
 
 // Tipos de código de saída
 typedef enum {
@@ -11,21 +21,108 @@ typedef enum {
     OUTPUT_BYTECODE     // Bytecode personalizado
 } OutputType;
 
+// Regras da seleção de instruções do assembly (x86_rules.def)
+typedef enum {
+#define RULE(id, ...) RULE_##id,
+#include "x86_rules.def"
+#undef RULE
+    RULE_COUNT
+} SelectionRule;
+
+// Lado raro de um if, emitido depois do epílogo da função (-fprofile-use)
+typedef struct ColdBlock {
+    char* label;
+    ASTNode* statement;
+    char* resume_label;      // Volta para o código quente
+    char* break_label;       // Destinos de break/continue no ponto do if
+    char* continue_label;
+    int counter;             // Contador do ramo verdadeiro (-fprofile-generate), -1 se não há
+} ColdBlock;
+
 // Gerador de código
 typedef struct CodeGenerator {
     FILE* output_file;
     OutputType output_type;
     SymbolTable* symbol_table;
     int label_counter;
-    int temp_counter;
-    int current_offset;  // Para variáveis locais
     char* current_function;
+    DataType current_return_type;
+    int indent_level;        // Indentação do código C gerado
+    int stack_depth;         // Valores empilhados (alinhamento das chamadas em assembly)
+    char* break_label;       // Destino de 'break' no laço atual
+    char* continue_label;    // Destino de 'continue' no laço atual
+    char* return_label;      // Epílogo da função atual (assembly)
+    ASTNode** literals;      // Literais string/float emitidos em .rodata (assembly)
+    int literal_count;
+    int literal_capacity;
+
+    // Alocação de registradores no assembly (-O)
+    int allocate_registers;
+    int locals_in_registers;
+    int locals_spilled;      // Candidatas que ficaram no frame
+    int memory_locals;       // Locais no frame (spills e floats)
+    int spill_slots;         // Slots que elas ocupam após a coloração
+
+    // Seleção de instruções por casamento de árvores (-O)
+    int select_instructions;
+    int selected_trees;
+    int selection_cost;      // Soma dos custos das coberturas escolhidas
+    int rule_hits[RULE_COUNT];
+
+    // Peephole sobre o assembly de cada função (-O)
+    int peephole;
+    PeepholeStats peephole_stats;
+
+    // Chamadas de cauda (-O)
+    int tail_calls;
+    int tail_jumps;          // return f(...) que reaproveitam o frame (assembly/bytecode)
+    int tail_loops;          // Recursões de cauda que viraram laço
+    RegisterAllocation* allocation;  // Da função atual (assembly)
+    char* body_label;        // Início do corpo, depois do prólogo (assembly)
+    ASTNode* tail_function;  // Função cujo corpo virou laço (C)
+    int loop_depth;          // Laços abertos dentro dela (C)
+
+    // Vetorização de laços de redução no assembly (-O)
+    int vector_width;        // Lanes de 32 bits: 4 (SSE2), 8 (AVX2) ou 0 (desligada)
+    int vectorized_loops;
+    int vector_reductions;
+    int vector_lanes_used;   // .Lvector_lanes vai para .rodata
+
+    // Perfil de execução: contadores (-fprofile-generate) e layout/dicas (-fprofile-use)
+    Profile* profile;
+    ColdBlock* cold_blocks;  // Da função atual (assembly)
+    int cold_block_count;
+    int cold_block_capacity;
+
+    // Despacho dos switches (assembly e bytecode)
+    int switch_statements;
+    int switch_tables;       // Tabelas de salto (TABLESWITCH no bytecode)
+    int switch_bitsets;      // Testes de bits
+    int switch_compares;     // Casos isolados
+    int switch_searches;     // Comparações da busca binária entre clusters
+    int switch_lookups;      // LOOKUPSWITCH (bytecode)
+    char** jump_tables;      // Texto de cada tabela, emitido em .rodata (assembly)
+    int jump_table_count;
+    int jump_table_capacity;
+
+    // Ternários branchless (if-conversion com -O)
+    int select_moves;        // cmov (ISELECT no bytecode)
+    int select_sets;         // setcc: escolha entre 1 e 0
+
+    // Aritmética com operando constante (seleção de instruções, -O)
+    int magic_divisions;     // Divisões e restos por multiplicação
+    int shift_divisions;     // Por ±2^k: só deslocamentos
+    int multiply_chains;     // Multiplicações por shl/lea/add
+
+    // Funções com tabela de resultados (-fmemoize)
+    int memoized_functions;
 } CodeGenerator;
 
 // Funções principais
 CodeGenerator* code_generator_create(const char* output_filename, OutputType type);
 void code_generator_destroy(CodeGenerator* generator);
 int generate_code(CodeGenerator* generator, ASTNode* ast, SymbolTable* symbols);
+void code_generator_print_stats(CodeGenerator* generator);
 
 // Geração específica por tipo de nó
 void generate_program(CodeGenerator* gen, ASTNode* node);
@@ -0,0 +1,1816 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ir.h"
+
+// ============================================================
+// Estruturas básicas
+// ============================================================
+
+static const char* opcode_names[IR_OPCODE_COUNT] = {
+    "const", "fconst", "string", "undef", "param", "phi",
+    "add", "sub", "mul", "div", "mod",
+    "and", "or", "xor", "shl", "shr",
+    "neg", "not",
+    "fadd", "fsub", "fmul", "fdiv", "fneg",
+    "eq", "ne", "lt", "le", "gt", "ge",
+    "i2f", "f2i", "i2c", "i2p", "p2i",
+    "alloca", "global", "load", "store",
+    "call",
+    "jump", "br", "ret"
+};
+
+const char* ir_opcode_name(IROpcode op) {
+    return op >= 0 && op < IR_OPCODE_COUNT ? opcode_names[op] : "?";
+}
+
+const char* ir_type_name(IRType type) {
+    switch (type) {
+        case IR_TYPE_VOID: return "void";
+        case IR_TYPE_I8: return "i8";
+        case IR_TYPE_I32: return "i32";
+        case IR_TYPE_F32: return "f32";
+        case IR_TYPE_PTR: return "ptr";
+        default: return "?";
+    }
+}
+
+// Tipo do valor que representa um DataType (char é mantido em i32)
+IRType ir_type_of(DataType type) {
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_CHAR:
+            return IR_TYPE_I32;
+        case TYPE_FLOAT:
+            return IR_TYPE_F32;
+        case TYPE_POINTER:
+        case TYPE_ARRAY:
+            return IR_TYPE_PTR;
+        default:
+            return IR_TYPE_VOID;
+    }
+}
+
+// Largura do acesso à memória de um DataType
+static IRType memory_type_of(DataType type) {
+    return type == TYPE_CHAR ? IR_TYPE_I8 : ir_type_of(type);
+}
+
+int ir_is_terminator(IROpcode op) {
+    return op == IR_JUMP || op == IR_BRANCH || op == IR_RET;
+}
+
+static int is_compare(IROpcode op) {
+    return op >= IR_EQ && op <= IR_GE;
+}
+
+#define GROW(array, count, capacity, initial)                              \
+    do {                                                                   \
+        if ((count) >= (capacity)) {                                       \
+            (capacity) = (capacity) ? (capacity) * 2 : (initial);          \
+            (array) = realloc((array), (capacity) * sizeof(*(array)));     \
+        }                                                                  \
+    } while (0)
+
+IRInstr* ir_value(IRFunction* function, int id) {
+    if (id < 0 || id >= function->value_count) return NULL;
+    return function->values[id];
+}
+
+static IRFunction* function_create(const char* name, Symbol* symbol) {
+    IRFunction* function = calloc(1, sizeof(IRFunction));
+    function->name = strdup(name);
+    function->symbol = symbol;
+    return function;
+}
+
+static void instr_destroy(IRInstr* instr) {
+    if (!instr) return;
+    free(instr->operands);
+    free(instr->name);
+    free(instr);
+}
+
+static void block_destroy(IRBlock* block) {
+    if (!block) return;
+    free(block->instrs);
+    free(block->preds);
+    free(block->defs);
+    free(block->incomplete_phis);
+    free(block);
+}
+
+static void function_destroy(IRFunction* function) {
+    if (!function) return;
+    for (int i = 0; i < function->value_count; i++) {
+        instr_destroy(function->values[i]);
+    }
+    for (int i = 0; i < function->block_count; i++) {
+        block_destroy(function->blocks[i]);
+    }
+    free(function->values);
+    free(function->blocks);
+    free(function->definitions);
+    free(function->name);
+    free(function);
+}
+
+void ir_module_destroy(IRModule* module) {
+    if (!module) return;
+    for (int i = 0; i < module->function_count; i++) {
+        function_destroy(module->functions[i]);
+    }
+    free(module->functions);
+    free(module->globals);
+    free(module);
+}
+
+static int new_block(IRFunction* function) {
+    IRBlock* block = calloc(1, sizeof(IRBlock));
+    block->id = function->block_count;
+    if (function->variable_count > 0) {
+        block->defs = malloc(function->variable_count * sizeof(int));
+        for (int i = 0; i < function->variable_count; i++) {
+            block->defs[i] = -1;
+        }
+    }
+    GROW(function->blocks, function->block_count, function->block_capacity, 8);
+    function->blocks[function->block_count++] = block;
+    return block->id;
+}
+
+// Cria o valor sem inseri-lo em um bloco
+static IRInstr* new_instr(IRFunction* function, IROpcode op, IRType type) {
+    IRInstr* instr = calloc(1, sizeof(IRInstr));
+    instr->op = op;
+    instr->type = type;
+    instr->mem_type = IR_TYPE_VOID;
+    instr->id = function->value_count;
+    instr->block = -1;
+    instr->targets[0] = -1;
+    instr->targets[1] = -1;
+    instr->forward = -1;
+    GROW(function->values, function->value_count, function->value_capacity, 32);
+    function->values[function->value_count++] = instr;
+    return instr;
+}
+
+static void insert_instr(IRFunction* function, int block_id, int position, IRInstr* instr) {
+    IRBlock* block = function->blocks[block_id];
+    GROW(block->instrs, block->instr_count, block->instr_capacity, 8);
+    memmove(&block->instrs[position + 1], &block->instrs[position],
+            (block->instr_count - position) * sizeof(int));
+    block->instrs[position] = instr->id;
+    block->instr_count++;
+    instr->block = block_id;
+}
+
+static void add_operand(IRInstr* instr, int value) {
+    GROW(instr->operands, instr->operand_count, instr->operand_capacity, 2);
+    instr->operands[instr->operand_count++] = value;
+}
+
+static void add_edge(IRFunction* function, int from, int to) {
+    IRBlock* block = function->blocks[to];
+    GROW(block->preds, block->pred_count, block->pred_capacity, 2);
+    block->preds[block->pred_count++] = from;
+}
+
+int ir_block_terminator(IRFunction* function, IRBlock* block) {
+    if (block->instr_count == 0) return -1;
+    int last = block->instrs[block->instr_count - 1];
+    return ir_is_terminator(function->values[last]->op) ? last : -1;
+}
+
+int ir_block_successors(IRFunction* function, IRBlock* block, int successors[2]) {
+    int terminator = ir_block_terminator(function, block);
+    if (terminator < 0) return 0;
+
+    IRInstr* instr = function->values[terminator];
+    switch (instr->op) {
+        case IR_JUMP:
+            successors[0] = instr->targets[0];
+            return 1;
+        case IR_BRANCH:
+            successors[0] = instr->targets[0];
+            successors[1] = instr->targets[1];
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+void ir_remove_instr(IRFunction* function, int id) {
+    IRInstr* instr = ir_value(function, id);
+    if (!instr || instr->is_dead) return;
+
+    if (instr->block >= 0) {
+        IRBlock* block = function->blocks[instr->block];
+        for (int i = 0; i < block->instr_count; i++) {
+            if (block->instrs[i] == id) {
+                memmove(&block->instrs[i], &block->instrs[i + 1],
+                        (block->instr_count - i - 1) * sizeof(int));
+                block->instr_count--;
+                break;
+            }
+        }
+    }
+    instr->is_dead = 1;
+    instr->block = -1;
+}
+
+int ir_has_side_effects(IROpcode op) {
+    return op == IR_STORE || op == IR_CALL || ir_is_terminator(op);
+}
+
+// Marca a partir das instruções com efeito (store, call, terminadores) e
+// remove as demais que não alimentam nenhuma delas, inclusive ciclos de
+// phis de variáveis que só se realimentam. Retorna quantas saíram.
+int ir_remove_dead_values(IRFunction* function) {
+    char* useful = calloc(function->value_count + 1, 1);
+    int* worklist = malloc((function->value_count + 1) * sizeof(int));
+    int count = 0;
+    int removed = 0;
+
+    for (int b = 0; b < function->block_count; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            if (ir_has_side_effects(instr->op)) {
+                useful[instr->id] = 1;
+                worklist[count++] = instr->id;
+            }
+        }
+    }
+    while (count > 0) {
+        IRInstr* instr = function->values[worklist[--count]];
+        for (int j = 0; j < instr->operand_count; j++) {
+            int operand = instr->operands[j];
+            if (!useful[operand]) {
+                useful[operand] = 1;
+                worklist[count++] = operand;
+            }
+        }
+    }
+
+    for (int i = 0; i < function->value_count; i++) {
+        IRInstr* instr = function->values[i];
+        if (!instr->is_dead && !useful[i]) {
+            ir_remove_instr(function, i);
+            removed++;
+        }
+    }
+
+    free(useful);
+    free(worklist);
+    return removed;
+}
+
+void ir_replace_uses(IRFunction* function, int old_id, int new_id) {
+    for (int i = 0; i < function->value_count; i++) {
+        IRInstr* instr = function->values[i];
+        if (instr->is_dead) continue;
+        for (int j = 0; j < instr->operand_count; j++) {
+            if (instr->operands[j] == old_id) {
+                instr->operands[j] = new_id;
+            }
+        }
+    }
+}
+
+// Numeração densa: valores vivos recebem números consecutivos na ordem
+// dos blocos e as instruções removidas são liberadas
+void ir_renumber(IRFunction* function) {
+    int* mapping = malloc((function->value_count + 1) * sizeof(int));
+    IRInstr** values = malloc((function->value_count + 1) * sizeof(IRInstr*));
+    int count = 0;
+
+    for (int i = 0; i < function->value_count; i++) {
+        mapping[i] = -1;
+    }
+    for (int b = 0; b < function->block_count; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            IRInstr* instr = function->values[block->instrs[i]];
+            mapping[instr->id] = count;
+            values[count++] = instr;
+        }
+    }
+
+    for (int i = 0; i < function->value_count; i++) {
+        IRInstr* instr = function->values[i];
+        if (mapping[i] < 0) {
+            instr_destroy(instr);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        IRInstr* instr = values[i];
+        instr->id = i;
+        for (int j = 0; j < instr->operand_count; j++) {
+            instr->operands[j] = mapping[instr->operands[j]];
+        }
+    }
+    for (int b = 0; b < function->block_count; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            block->instrs[i] = mapping[block->instrs[i]];
+        }
+    }
+    for (int i = 0; i < function->definition_count; i++) {
+        IRDefinition* definition = &function->definitions[i];
+        if (definition->value >= 0) definition->value = mapping[definition->value];
+    }
+
+    free(function->values);
+    free(mapping);
+    function->values = values;
+    function->value_count = count;
+    function->value_capacity = count + 1;
+}
+
+// ============================================================
+// Construção (AST -> SSA)
+//
+// Algoritmo de Braun et al. ("Simple and Efficient Construction of SSA
+// Form"): a definição corrente de cada variável é mantida por bloco; uma
+// leitura sem definição local busca nos predecessores, criando phis nas
+// junções. Blocos ainda com predecessores desconhecidos (cabeçalhos de
+// laço) recebem phis incompletos, completados quando o bloco é selado.
+// Phis triviais são encaminhados ao valor que substituem.
+// ============================================================
+
+// Associação símbolo -> índice (endereçamento aberto)
+typedef struct SymbolIndex {
+    Symbol** keys;
+    int* values;
+    int capacity;
+} SymbolIndex;
+
+typedef struct IRBuilder {
+    IRModule* module;
+    IRFunction* function;
+    TypeTable* types;
+    int current;             // Bloco onde as instruções são emitidas
+    int break_target;        // Destinos do laço mais interno (-1 fora de laço)
+    int continue_target;
+    ASTNode* origin;         // Comando sendo traduzido
+    DataType return_type;    // Tipo de retorno da função corrente
+    SymbolIndex variables;   // Locais escalares -> variável SSA
+    SymbolIndex arrays;      // Arrays locais -> ALLOCA
+    IRType* variable_types;
+    int variable_capacity;
+} IRBuilder;
+
+static unsigned int symbol_hash(const Symbol* symbol, int capacity) {
+    uintptr_t key = (uintptr_t)symbol;
+    key ^= key >> 17;
+    key *= 0x9E3779B1u;
+    return (unsigned int)(key ^ (key >> 15)) & (unsigned int)(capacity - 1);
+}
+
+static int index_find(const SymbolIndex* index, const Symbol* symbol) {
+    if (!symbol || index->capacity == 0) return -1;
+    unsigned int slot = symbol_hash(symbol, index->capacity);
+    while (index->keys[slot]) {
+        if (index->keys[slot] == symbol) return index->values[slot];
+        slot = (slot + 1) & (unsigned int)(index->capacity - 1);
+    }
+    return -1;
+}
+
+static void index_reset(SymbolIndex* index, int expected) {
+    int capacity = 16;
+    while (capacity < expected * 2) capacity *= 2;
+    free(index->keys);
+    free(index->values);
+    index->keys = calloc(capacity, sizeof(Symbol*));
+    index->values = malloc(capacity * sizeof(int));
+    index->capacity = capacity;
+}
+
+static void index_insert(SymbolIndex* index, Symbol* symbol, int value) {
+    unsigned int slot = symbol_hash(symbol, index->capacity);
+    while (index->keys[slot] && index->keys[slot] != symbol) {
+        slot = (slot + 1) & (unsigned int)(index->capacity - 1);
+    }
+    index->keys[slot] = symbol;
+    index->values[slot] = value;
+}
+
+static void index_free(SymbolIndex* index) {
+    free(index->keys);
+    free(index->values);
+    index->keys = NULL;
+    index->values = NULL;
+    index->capacity = 0;
+}
+
+// Emite a instrução no fim do bloco corrente
+static IRInstr* emit(IRBuilder* b, IROpcode op, IRType type) {
+    IRInstr* instr = new_instr(b->function, op, type);
+    IRBlock* block = b->function->blocks[b->current];
+    insert_instr(b->function, b->current, block->instr_count, instr);
+    instr->origin = b->origin;
+    return instr;
+}
+
+static int emit_unary(IRBuilder* b, IROpcode op, IRType type, int operand) {
+    IRInstr* instr = emit(b, op, type);
+    add_operand(instr, operand);
+    return instr->id;
+}
+
+static int emit_binary(IRBuilder* b, IROpcode op, IRType type, int left, int right) {
+    IRInstr* instr = emit(b, op, type);
+    add_operand(instr, left);
+    add_operand(instr, right);
+    return instr->id;
+}
+
+static int emit_const(IRBuilder* b, IRType type, long value) {
+    IRInstr* instr = emit(b, IR_CONST, type);
+    instr->imm = value;
+    return instr->id;
+}
+
+static int emit_fconst(IRBuilder* b, float value) {
+    IRInstr* instr = emit(b, IR_FCONST, IR_TYPE_F32);
+    instr->fimm = value;
+    return instr->id;
+}
+
+// Bloco aberto por start_unreachable_block ainda sem código
+static int is_empty_unreachable(IRBuilder* b) {
+    IRBlock* block = b->function->blocks[b->current];
+    return b->current != 0 && block->pred_count == 0 && block->instr_count == 0;
+}
+
+static void emit_jump(IRBuilder* b, int target) {
+    // Nada a desviar: o bloco vazio é descartado em finish_ssa
+    if (is_empty_unreachable(b)) return;
+
+    IRInstr* instr = emit(b, IR_JUMP, IR_TYPE_VOID);
+    instr->targets[0] = target;
+    add_edge(b->function, b->current, target);
+}
+
+static void emit_branch(IRBuilder* b, int condition, int if_true, int if_false) {
+    IRInstr* instr = emit(b, IR_BRANCH, IR_TYPE_VOID);
+    add_operand(instr, condition);
+    instr->targets[0] = if_true;
+    instr->targets[1] = if_false;
+    add_edge(b->function, b->current, if_true);
+    add_edge(b->function, b->current, if_false);
+}
+
+// Valores do início do bloco de entrada (parâmetros, allocas, undef)
+static IRInstr* emit_at_entry(IRBuilder* b, IROpcode op, IRType type) {
+    IRFunction* function = b->function;
+    IRBlock* entry = function->blocks[0];
+    int position = 0;
+    while (position < entry->instr_count) {
+        IROpcode existing = function->values[entry->instrs[position]]->op;
+        if (existing != IR_PARAM && existing != IR_ALLOCA && existing != IR_UNDEF) break;
+        position++;
+    }
+    IRInstr* instr = new_instr(function, op, type);
+    insert_instr(function, 0, position, instr);
+    return instr;
+}
+
+static int resolve(IRFunction* function, int value) {
+    while (value >= 0 && function->values[value]->forward >= 0) {
+        value = function->values[value]->forward;
+    }
+    return value;
+}
+
+static IRInstr* new_phi(IRBuilder* b, int block_id, IRType type) {
+    IRFunction* function = b->function;
+    IRBlock* block = function->blocks[block_id];
+    int position = 0;
+    while (position < block->instr_count &&
+           function->values[block->instrs[position]]->op == IR_PHI) {
+        position++;
+    }
+    IRInstr* phi = new_instr(function, IR_PHI, type);
+    insert_instr(function, block_id, position, phi);
+    return phi;
+}
+
+static void write_variable(IRBuilder* b, int variable, int block_id, int value) {
+    b->function->blocks[block_id]->defs[variable] = value;
+}
+
+static int read_variable(IRBuilder* b, int variable, int block_id);
+
+static int try_remove_trivial_phi(IRBuilder* b, IRInstr* phi) {
+    IRFunction* function = b->function;
+    int same = -1;
+
+    for (int i = 0; i < phi->operand_count; i++) {
+        int operand = resolve(function, phi->operands[i]);
+        if (operand == same || operand == phi->id) continue;
+        if (same >= 0) return phi->id;
+        same = operand;
+    }
+    if (same < 0) {
+        // Phi inalcançável ou sem definição: o valor é indefinido
+        same = emit_at_entry(b, IR_UNDEF, phi->type)->id;
+    }
+    phi->forward = same;
+    ir_remove_instr(function, phi->id);
+    return same;
+}
+
+static int add_phi_operands(IRBuilder* b, int variable, IRInstr* phi) {
+    IRBlock* block = b->function->blocks[phi->block];
+    for (int i = 0; i < block->pred_count; i++) {
+        add_operand(phi, read_variable(b, variable, block->preds[i]));
+    }
+    return try_remove_trivial_phi(b, phi);
+}
+
+static int read_variable_recursive(IRBuilder* b, int variable, int block_id) {
+    IRBlock* block = b->function->blocks[block_id];
+    IRType type = b->variable_types[variable];
+    int value;
+
+    if (!block->sealed) {
+        IRInstr* phi = new_phi(b, block_id, type);
+        GROW(block->incomplete_phis, block->incomplete_count + 1, block->incomplete_capacity, 8);
+        block->incomplete_phis[block->incomplete_count++] = variable;
+        block->incomplete_phis[block->incomplete_count++] = phi->id;
+        value = phi->id;
+    } else if (block->pred_count == 0) {
+        value = emit_at_entry(b, IR_UNDEF, type)->id;
+    } else if (block->pred_count == 1) {
+        value = read_variable(b, variable, block->preds[0]);
+    } else {
+        IRInstr* phi = new_phi(b, block_id, type);
+        write_variable(b, variable, block_id, phi->id);
+        value = add_phi_operands(b, variable, phi);
+    }
+    write_variable(b, variable, block_id, value);
+    return value;
+}
+
+static int read_variable(IRBuilder* b, int variable, int block_id) {
+    int value = b->function->blocks[block_id]->defs[variable];
+    if (value >= 0) return resolve(b->function, value);
+    return read_variable_recursive(b, variable, block_id);
+}
+
+static void seal_block(IRBuilder* b, int block_id) {
+    IRBlock* block = b->function->blocks[block_id];
+    for (int i = 0; i < block->incomplete_count; i += 2) {
+        int variable = block->incomplete_phis[i];
+        IRInstr* phi = b->function->values[block->incomplete_phis[i + 1]];
+        add_phi_operands(b, variable, phi);
+    }
+    block->incomplete_count = 0;
+    block->sealed = 1;
+}
+
+// Bloco novo já selado (predecessor único conhecido ou nenhum)
+static int new_sealed_block(IRBuilder* b) {
+    int block = new_block(b->function);
+    b->function->blocks[block]->sealed = 1;
+    return block;
+}
+
+// Depois de um terminador, o código seguinte é inalcançável: continua
+// em um bloco sem predecessores
+static void start_unreachable_block(IRBuilder* b) {
+    b->current = new_sealed_block(b);
+}
+
+// ------------------------------------------------------------
+// Variáveis
+// ------------------------------------------------------------
+
+static int pointee_size(IRBuilder* b, TypeId id) {
+    const TypeInfo* info = type_info(b->types, id);
+    if (!info || (info->kind != TYPEKIND_POINTER && info->kind != TYPEKIND_ARRAY)) return 1;
+    int size = type_size(b->types, info->element);
+    return size > 0 ? size : 1;
+}
+
+static int variable_index(IRBuilder* b, Symbol* symbol) {
+    if (!symbol || symbol->scope_level == 0) return -1;
+    return index_find(&b->variables, symbol);
+}
+
+static int load_variable(IRBuilder* b, Symbol* symbol) {
+    int array = index_find(&b->arrays, symbol);
+    if (array >= 0) return array;
+
+    int variable = variable_index(b, symbol);
+    if (variable >= 0) return read_variable(b, variable, b->current);
+
+    if (!symbol) return emit_const(b, IR_TYPE_I32, 0);
+
+    // Global: endereço + leitura (arrays decaem para o endereço)
+    IRInstr* address = emit(b, IR_GLOBAL, IR_TYPE_PTR);
+    address->symbol = symbol;
+    address->name = strdup(symbol->name);
+    if (symbol->type == TYPE_ARRAY) return address->id;
+
+    IRInstr* load = emit(b, IR_LOAD, ir_type_of(symbol->type));
+    load->mem_type = memory_type_of(symbol->type);
+    add_operand(load, address->id);
+    return load->id;
+}
+
+static void store_variable(IRBuilder* b, Symbol* symbol, int value) {
+    int variable = variable_index(b, symbol);
+    if (variable >= 0) {
+        write_variable(b, variable, b->current, value);
+        return;
+    }
+    if (!symbol) return;
+
+    IRInstr* address = emit(b, IR_GLOBAL, IR_TYPE_PTR);
+    address->symbol = symbol;
+    address->name = strdup(symbol->name);
+
+    IRInstr* store = emit(b, IR_STORE, IR_TYPE_VOID);
+    store->mem_type = memory_type_of(symbol->type);
+    add_operand(store, address->id);
+    add_operand(store, value);
+}
+
+// Definições de variáveis SSA ficam registradas para os passos que
+// precisam voltar da IR para a AST (eliminação de atribuições mortas)
+static void record_definition(IRBuilder* b, Symbol* symbol, ASTNode* node, int value) {
+    if (variable_index(b, symbol) < 0 || value < 0) return;
+
+    IRFunction* function = b->function;
+    GROW(function->definitions, function->definition_count, function->definition_capacity, 16);
+    function->definitions[function->definition_count].node = node;
+    function->definitions[function->definition_count].value = value;
+    function->definition_count++;
+}
+
+// ------------------------------------------------------------
+// Expressões
+// ------------------------------------------------------------
+
+static int lower_expression(IRBuilder* b, ASTNode* node);
+
+static int is_float(DataType type) {
+    return type == TYPE_FLOAT;
+}
+
+static int is_address(DataType type) {
+    return type == TYPE_POINTER || type == TYPE_ARRAY;
+}
+
+// Conversões implícitas de C entre os tipos anotados pela análise semântica
+static int convert(IRBuilder* b, int value, DataType from, DataType to) {
+    if (value < 0 || from == to || from == TYPE_VOID || to == TYPE_VOID) return value;
+
+    if (is_address(to)) {
+        return is_address(from) ? value : emit_unary(b, IR_I2P, IR_TYPE_PTR, value);
+    }
+    if (is_address(from)) {
+        value = emit_unary(b, IR_P2I, IR_TYPE_I32, value);
+        from = TYPE_INT;
+    }
+    if (is_float(to)) {
+        return is_float(from) ? value : emit_unary(b, IR_I2F, IR_TYPE_F32, value);
+    }
+    if (is_float(from)) {
+        value = emit_unary(b, IR_F2I, IR_TYPE_I32, value);
+    }
+    if (to == TYPE_CHAR) {
+        value = emit_unary(b, IR_I2C, IR_TYPE_I32, value);
+    }
+    return value;
+}
+
+// Zero do tipo do valor (comparações com 0 em condições e '!')
+static int zero_of(IRBuilder* b, IRType type) {
+    return type == IR_TYPE_F32 ? emit_fconst(b, 0.0f) : emit_const(b, type, 0);
+}
+
+// Condição como i32 (0 = falso, qualquer outro = verdadeiro)
+static int lower_condition(IRBuilder* b, ASTNode* node) {
+    int value = lower_expression(b, node);
+    IRType type = b->function->values[value]->type;
+    if (type == IR_TYPE_I32) return value;
+    return emit_binary(b, IR_NE, IR_TYPE_I32, value, zero_of(b, type));
+}
+
+// Valor lógico normalizado para 0/1
+static int lower_boolean(IRBuilder* b, ASTNode* node) {
+    int value = lower_condition(b, node);
+    if (is_compare(b->function->values[value]->op)) return value;
+    return emit_binary(b, IR_NE, IR_TYPE_I32, value, emit_const(b, IR_TYPE_I32, 0));
+}
+
+static IROpcode binary_opcode(TokenType op, int is_float_operation) {
+    switch (op) {
+        case TOKEN_PLUS: return is_float_operation ? IR_FADD : IR_ADD;
+        case TOKEN_MINUS: return is_float_operation ? IR_FSUB : IR_SUB;
+        case TOKEN_MULTIPLY: return is_float_operation ? IR_FMUL : IR_MUL;
+        case TOKEN_DIVIDE: return is_float_operation ? IR_FDIV : IR_DIV;
+        case TOKEN_MODULO: return IR_MOD;
+        case TOKEN_BITWISE_AND: return IR_AND;
+        case TOKEN_BITWISE_OR: return IR_OR;
+        case TOKEN_BITWISE_XOR: return IR_XOR;
+        case TOKEN_LEFT_SHIFT: return IR_SHL;
+        case TOKEN_RIGHT_SHIFT: return IR_SHR;
+        case TOKEN_EQUAL: return IR_EQ;
+        case TOKEN_NOT_EQUAL: return IR_NE;
+        case TOKEN_LESS: return IR_LT;
+        case TOKEN_LESS_EQUAL: return IR_LE;
+        case TOKEN_GREATER: return IR_GT;
+        case TOKEN_GREATER_EQUAL: return IR_GE;
+        default: return IR_ADD;
+    }
+}
+
+// && e ||: o operando direito só é avaliado quando necessário
+static int lower_logical(IRBuilder* b, ASTNode* node) {
+    int is_and = node->data.binary_expr.operator == TOKEN_AND;
+    int left = lower_condition(b, node->data.binary_expr.left);
+    int short_value = emit_const(b, IR_TYPE_I32, is_and ? 0 : 1);
+    int short_block = b->current;
+
+    int right_block = new_sealed_block(b);
+    int join = new_block(b->function);
+    if (is_and) {
+        emit_branch(b, left, right_block, join);
+    } else {
+        emit_branch(b, left, join, right_block);
+    }
+
+    b->current = right_block;
+    int right = lower_boolean(b, node->data.binary_expr.right);
+    int right_end = b->current;
+    emit_jump(b, join);
+
+    seal_block(b, join);
+    b->current = join;
+    IRInstr* phi = new_phi(b, join, IR_TYPE_I32);
+    IRBlock* join_block = b->function->blocks[join];
+    for (int i = 0; i < join_block->pred_count; i++) {
+        add_operand(phi, join_block->preds[i] == short_block ? short_value : right);
+    }
+    (void)right_end;
+    return phi->id;
+}
+
+static int lower_pointer_binary(IRBuilder* b, ASTNode* node) {
+    TokenType op = node->data.binary_expr.operator;
+    ASTNode* left = node->data.binary_expr.left;
+    ASTNode* right = node->data.binary_expr.right;
+    int left_pointer = is_address(left->data_type);
+    int right_pointer = is_address(right->data_type);
+    int scale = pointee_size(b, left_pointer ? left->type_id : right->type_id);
+
+    int left_value = lower_expression(b, left);
+    int right_value = lower_expression(b, right);
+
+    // Comparação: o operando inteiro (ponteiro nulo) vira ponteiro
+    if (op != TOKEN_PLUS && op != TOKEN_MINUS) {
+        left_value = convert(b, left_value, left->data_type, TYPE_POINTER);
+        right_value = convert(b, right_value, right->data_type, TYPE_POINTER);
+        return emit_binary(b, binary_opcode(op, 0), IR_TYPE_I32, left_value, right_value);
+    }
+
+    // Diferença de ponteiros: bytes / tamanho do elemento
+    if (left_pointer && right_pointer) {
+        int difference = emit_binary(b, IR_SUB, IR_TYPE_PTR, left_value, right_value);
+        if (scale != 1) {
+            difference = emit_binary(b, IR_DIV, IR_TYPE_PTR, difference,
+                                     emit_const(b, IR_TYPE_PTR, scale));
+        }
+        return emit_unary(b, IR_P2I, IR_TYPE_I32, difference);
+    }
+
+    // Deslocamento: o inteiro é escalado pelo tamanho do elemento
+    int base = left_pointer ? left_value : right_value;
+    int offset = left_pointer ? right_value : left_value;
+    offset = emit_unary(b, IR_I2P, IR_TYPE_PTR, offset);
+    if (scale != 1) {
+        offset = emit_binary(b, IR_MUL, IR_TYPE_PTR, offset, emit_const(b, IR_TYPE_PTR, scale));
+    }
+    return emit_binary(b, op == TOKEN_PLUS ? IR_ADD : IR_SUB, IR_TYPE_PTR, base, offset);
+}
+
+static int lower_binary(IRBuilder* b, ASTNode* node) {
+    TokenType op = node->data.binary_expr.operator;
+    ASTNode* left = node->data.binary_expr.left;
+    ASTNode* right = node->data.binary_expr.right;
+
+    if (op == TOKEN_AND || op == TOKEN_OR) {
+        return lower_logical(b, node);
+    }
+    if (op == TOKEN_COMMA) {
+        lower_expression(b, left);
+        return lower_expression(b, right);
+    }
+    if (is_address(left->data_type) || is_address(right->data_type)) {
+        return lower_pointer_binary(b, node);
+    }
+
+    // Conversões aritméticas usuais: float domina, char promove para int
+    DataType operand_type = is_float(left->data_type) || is_float(right->data_type)
+                            ? TYPE_FLOAT : TYPE_INT;
+    int left_value = convert(b, lower_expression(b, left), left->data_type, operand_type);
+    int right_value = convert(b, lower_expression(b, right), right->data_type, operand_type);
+    IROpcode opcode = binary_opcode(op, is_float(operand_type));
+    IRType type = is_compare(opcode) ? IR_TYPE_I32 : ir_type_of(operand_type);
+    return emit_binary(b, opcode, type, left_value, right_value);
+}
+
+static int lower_increment(IRBuilder* b, ASTNode* node) {
+    UnaryOperator op = node->data.unary_expr.operator;
+    ASTNode* operand = node->data.unary_expr.operand;
+    Symbol* symbol = operand->type == AST_IDENTIFIER ? operand->ref.symbol : NULL;
+    int is_increment = op == UNARY_PRE_INCREMENT || op == UNARY_POST_INCREMENT;
+    int is_post = op == UNARY_POST_INCREMENT || op == UNARY_POST_DECREMENT;
+
+    int old_value = load_variable(b, symbol);
+    int new_value;
+    if (is_address(operand->data_type)) {
+        int step = emit_const(b, IR_TYPE_PTR, pointee_size(b, operand->type_id));
+        new_value = emit_binary(b, is_increment ? IR_ADD : IR_SUB, IR_TYPE_PTR, old_value, step);
+    } else if (is_float(operand->data_type)) {
+        new_value = emit_binary(b, is_increment ? IR_FADD : IR_FSUB, IR_TYPE_F32,
+                                old_value, emit_fconst(b, 1.0f));
+    } else {
+        new_value = emit_binary(b, is_increment ? IR_ADD : IR_SUB, IR_TYPE_I32,
+                                old_value, emit_const(b, IR_TYPE_I32, 1));
+        new_value = convert(b, new_value, TYPE_INT, operand->data_type);
+    }
+    store_variable(b, symbol, new_value);
+    return is_post ? old_value : new_value;
+}
+
+static int lower_unary(IRBuilder* b, ASTNode* node) {
+    ASTNode* operand = node->data.unary_expr.operand;
+
+    switch (node->data.unary_expr.operator) {
+        case UNARY_PLUS:
+            return convert(b, lower_expression(b, operand), operand->data_type, node->data_type);
+
+        case UNARY_MINUS: {
+            int value = convert(b, lower_expression(b, operand), operand->data_type, node->data_type);
+            return is_float(node->data_type) ? emit_unary(b, IR_FNEG, IR_TYPE_F32, value)
+                                             : emit_unary(b, IR_NEG, IR_TYPE_I32, value);
+        }
+
+        case UNARY_NOT: {
+            int value = lower_expression(b, operand);
+            IRType type = b->function->values[value]->type;
+            return emit_binary(b, IR_EQ, IR_TYPE_I32, value, zero_of(b, type));
+        }
+
+        case UNARY_BITWISE_NOT: {
+            int value = convert(b, lower_expression(b, operand), operand->data_type, TYPE_INT);
+            return emit_unary(b, IR_NOT, IR_TYPE_I32, value);
+        }
+
+        case UNARY_PRE_INCREMENT:
+        case UNARY_PRE_DECREMENT:
+        case UNARY_POST_INCREMENT:
+        case UNARY_POST_DECREMENT:
+            return lower_increment(b, node);
+
+        default:
+            return emit_const(b, IR_TYPE_I32, 0);
+    }
+}
+
+static int lower_ternary(IRBuilder* b, ASTNode* node) {
+    int condition = lower_condition(b, node->data.ternary_expr.condition);
+    int true_block = new_sealed_block(b);
+    int false_block = new_sealed_block(b);
+    int join = new_block(b->function);
+    emit_branch(b, condition, true_block, false_block);
+
+    b->current = true_block;
+    ASTNode* true_expr = node->data.ternary_expr.true_expr;
+    int true_value = convert(b, lower_expression(b, true_expr), true_expr->data_type, node->data_type);
+    int true_end = b->current;
+    emit_jump(b, join);
+
+    b->current = false_block;
+    ASTNode* false_expr = node->data.ternary_expr.false_expr;
+    int false_value = convert(b, lower_expression(b, false_expr), false_expr->data_type, node->data_type);
+    emit_jump(b, join);
+
+    seal_block(b, join);
+    b->current = join;
+    IRType type = ir_type_of(node->data_type);
+    if (type == IR_TYPE_VOID) return -1;
+
+    IRInstr* phi = new_phi(b, join, type);
+    IRBlock* join_block = b->function->blocks[join];
+    for (int i = 0; i < join_block->pred_count; i++) {
+        add_operand(phi, join_block->preds[i] == true_end ? true_value : false_value);
+    }
+    return phi->id;
+}
+
+static int lower_call(IRBuilder* b, ASTNode* node) {
+    const Symbol* function = symbol_ref_target(&node->ref);
+    int argc = node->child_count;
+    int* args = argc > 0 ? malloc(argc * sizeof(int)) : NULL;
+
+    // Argumentos fixos são convertidos para o tipo do parâmetro
+    for (int i = 0; i < argc; i++) {
+        ASTNode* arg = node->children[i];
+        DataType target = arg->data_type;
+        if (function && function->kind == SYMBOL_FUNCTION &&
+            i < function->info.function.parameter_count) {
+            target = type_data_type(b->types, function->info.function.parameter_types[i]);
+        }
+        args[i] = convert(b, lower_expression(b, arg), arg->data_type, target);
+    }
+
+    IRInstr* call = emit(b, IR_CALL, ir_type_of(node->data_type));
+    call->name = strdup(node->data.function_call.name);
+    call->symbol = function;
+    for (int i = 0; i < argc; i++) {
+        add_operand(call, args[i]);
+    }
+    free(args);
+    return call->id;
+}
+
+static int lower_expression(IRBuilder* b, ASTNode* node) {
+    if (!node) return -1;
+
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+            if (is_float(node->data_type)) {
+                return emit_fconst(b, strtof(node->data.literal.value, NULL));
+            }
+            return emit_const(b, IR_TYPE_I32, strtol(node->data.literal.value, NULL, 0));
+
+        case AST_CHAR_LITERAL:
+            return emit_const(b, IR_TYPE_I32, ast_char_literal_value(node->data.literal.value));
+
+        case AST_STRING_LITERAL: {
+            IRInstr* string = emit(b, IR_STRING, IR_TYPE_PTR);
+            string->name = strdup(node->data.literal.value);
+            return string->id;
+        }
+
+        case AST_IDENTIFIER:
+            return load_variable(b, node->ref.symbol);
+
+        case AST_BINARY_EXPRESSION:
+            return lower_binary(b, node);
+
+        case AST_ASSIGNMENT_EXPRESSION: {
+            ASTNode* target = node->data.binary_expr.left;
+            ASTNode* value = node->data.binary_expr.right;
+            Symbol* symbol = target->type == AST_IDENTIFIER ? target->ref.symbol : NULL;
+            int result = convert(b, lower_expression(b, value), value->data_type, target->data_type);
+            store_variable(b, symbol, result);
+            record_definition(b, symbol, node, result);
+            return result;
+        }
+
+        case AST_UNARY_EXPRESSION:
+            return lower_unary(b, node);
+
+        case AST_TERNARY_EXPRESSION:
+            return lower_ternary(b, node);
+
+        case AST_FUNCTION_CALL:
+            return lower_call(b, node);
+
+        default:
+            return emit_const(b, IR_TYPE_I32, 0);
+    }
+}
+
+// ------------------------------------------------------------
+// Comandos
+// ------------------------------------------------------------
+
+static void lower_statement(IRBuilder* b, ASTNode* node);
+
+static void lower_if(IRBuilder* b, ASTNode* node) {
+    int condition = lower_condition(b, node->data.if_stmt.condition);
+    int then_block = new_sealed_block(b);
+    int else_block = node->data.if_stmt.else_stmt ? new_sealed_block(b) : -1;
+    int join = new_block(b->function);
+    emit_branch(b, condition, then_block, else_block >= 0 ? else_block : join);
+
+    b->current = then_block;
+    lower_statement(b, node->data.if_stmt.then_stmt);
+    emit_jump(b, join);
+
+    if (else_block >= 0) {
+        b->current = else_block;
+        lower_statement(b, node->data.if_stmt.else_stmt);
+        emit_jump(b, join);
+    }
+
+    seal_block(b, join);
+    b->current = join;
+}
+
+static void lower_while(IRBuilder* b, ASTNode* node) {
+    int header = new_block(b->function);
+    emit_jump(b, header);
+
+    b->current = header;
+    b->origin = node;
+    int condition = lower_condition(b, node->data.while_stmt.condition);
+    int body = new_sealed_block(b);
+    int exit = new_block(b->function);
+    emit_branch(b, condition, body, exit);
+
+    int saved_break = b->break_target;
+    int saved_continue = b->continue_target;
+    b->break_target = exit;
+    b->continue_target = header;
+
+    b->current = body;
+    lower_statement(b, node->data.while_stmt.body);
+    emit_jump(b, header);
+
+    b->break_target = saved_break;
+    b->continue_target = saved_continue;
+
+    seal_block(b, header);
+    seal_block(b, exit);
+    b->current = exit;
+}
+
+static void lower_do_while(IRBuilder* b, ASTNode* node) {
+    int body = new_block(b->function);
+    int condition_block = new_block(b->function);
+    int exit = new_block(b->function);
+    emit_jump(b, body);
+
+    int saved_break = b->break_target;
+    int saved_continue = b->continue_target;
+    b->break_target = exit;
+    b->continue_target = condition_block;
+
+    b->current = body;
+    lower_statement(b, node->data.while_stmt.body);
+    emit_jump(b, condition_block);
+
+    b->break_target = saved_break;
+    b->continue_target = saved_continue;
+
+    seal_block(b, condition_block);
+    b->current = condition_block;
+    b->origin = node;
+    int condition = lower_condition(b, node->data.while_stmt.condition);
+    emit_branch(b, condition, body, exit);
+
+    seal_block(b, body);
+    seal_block(b, exit);
+    b->current = exit;
+}
+
+static void lower_for(IRBuilder* b, ASTNode* node) {
+    lower_statement(b, node->data.for_stmt.init);
+
+    int header = new_block(b->function);
+    emit_jump(b, header);
+
+    b->current = header;
+    b->origin = node;
+    int body = new_sealed_block(b);
+    int step = new_block(b->function);
+    int exit = new_block(b->function);
+    if (node->data.for_stmt.condition) {
+        int condition = lower_condition(b, node->data.for_stmt.condition);
+        emit_branch(b, condition, body, exit);
+    } else {
+        emit_jump(b, body);
+    }
+
+    int saved_break = b->break_target;
+    int saved_continue = b->continue_target;
+    b->break_target = exit;
+    b->continue_target = step;
+
+    b->current = body;
+    lower_statement(b, node->data.for_stmt.body);
+    emit_jump(b, step);
+
+    b->break_target = saved_break;
+    b->continue_target = saved_continue;
+
+    seal_block(b, step);
+    b->current = step;
+    b->origin = node;
+    lower_expression(b, node->data.for_stmt.update);
+    emit_jump(b, header);
+
+    seal_block(b, header);
+    seal_block(b, exit);
+    b->current = exit;
+}
+
+// Cadeia de comparações até o rótulo escolhido; os corpos ficam em blocos
+// consecutivos e cada um cai para o seguinte, como em C
+static void lower_switch(IRBuilder* b, ASTNode* node) {
+    ASTNode* cases = node->data.switch_stmt.cases;
+    int count = cases->child_count;
+    int* targets = malloc((count + 1) * sizeof(int));
+    int exit = new_block(b->function);
+    int default_target = exit;
+
+    ASTNode* expression = node->data.switch_stmt.expression;
+    int value = convert(b, lower_expression(b, expression), expression->data_type, TYPE_INT);
+
+    for (int i = 0; i < count; i++) {
+        targets[i] = new_block(b->function);
+        if (cases->children[i]->type == AST_DEFAULT_STATEMENT) {
+            default_target = targets[i];
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        long label;
+        ASTNode* label_node = cases->children[i];
+        if (label_node->type != AST_CASE_STATEMENT ||
+            !ast_constant_expression(label_node->data.case_stmt.value, &label)) {
+            continue;
+        }
+        int matches = emit_binary(b, IR_EQ, IR_TYPE_I32, value, emit_const(b, IR_TYPE_I32, label));
+        int next = new_sealed_block(b);
+        emit_branch(b, matches, targets[i], next);
+        b->current = next;
+    }
+    emit_jump(b, default_target);
+
+    int saved_break = b->break_target;
+    b->break_target = exit;
+    for (int i = 0; i < count; i++) {
+        ASTNode* label_node = cases->children[i];
+        seal_block(b, targets[i]);
+        b->current = targets[i];
+        for (int j = 0; j < label_node->child_count; j++) {
+            lower_statement(b, label_node->children[j]);
+        }
+        emit_jump(b, i + 1 < count ? targets[i + 1] : exit);
+    }
+    b->break_target = saved_break;
+
+    seal_block(b, exit);
+    b->current = exit;
+    free(targets);
+}
+
+static void lower_statement(IRBuilder* b, ASTNode* node) {
+    if (!node) return;
+    b->origin = node;
+
+    switch (node->type) {
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                lower_statement(b, node->children[i]);
+            }
+            break;
+
+        case AST_VARIABLE_DECLARATION: {
+            ASTNode* initializer = node->data.var_decl.initializer;
+            if (initializer && node->data_type != TYPE_ARRAY) {
+                int value = convert(b, lower_expression(b, initializer),
+                                    initializer->data_type, node->data_type);
+                store_variable(b, node->ref.symbol, value);
+                record_definition(b, node->ref.symbol, node, value);
+            }
+            break;
+        }
+
+        case AST_EXPRESSION_STATEMENT:
+            if (node->child_count > 0) {
+                lower_expression(b, node->children[0]);
+            }
+            break;
+
+        case AST_IF_STATEMENT:
+            lower_if(b, node);
+            break;
+
+        case AST_WHILE_STATEMENT:
+            lower_while(b, node);
+            break;
+
+        case AST_DO_WHILE_STATEMENT:
+            lower_do_while(b, node);
+            break;
+
+        case AST_FOR_STATEMENT:
+            lower_for(b, node);
+            break;
+
+        case AST_SWITCH_STATEMENT:
+            lower_switch(b, node);
+            break;
+
+        case AST_RETURN_STATEMENT: {
+            ASTNode* expression = node->data.return_stmt.expression;
+            IRInstr* ret;
+            if (expression) {
+                int value = convert(b, lower_expression(b, expression), expression->data_type,
+                                    b->return_type);
+                ret = emit(b, IR_RET, IR_TYPE_VOID);
+                if (value >= 0 && b->function->values[value]->type != IR_TYPE_VOID) {
+                    add_operand(ret, value);
+                }
+            } else {
+                ret = emit(b, IR_RET, IR_TYPE_VOID);
+            }
+            start_unreachable_block(b);
+            break;
+        }
+
+        case AST_BREAK_STATEMENT:
+            if (b->break_target >= 0) {
+                emit_jump(b, b->break_target);
+                start_unreachable_block(b);
+            }
+            break;
+
+        case AST_CONTINUE_STATEMENT:
+            if (b->continue_target >= 0) {
+                emit_jump(b, b->continue_target);
+                start_unreachable_block(b);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Registra as variáveis SSA e os arrays locais declarados no corpo
+static void collect_locals(IRBuilder* b, ASTNode* node, int* count) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                collect_locals(b, node->children[i], count);
+            }
+            break;
+
+        case AST_VARIABLE_DECLARATION: {
+            Symbol* symbol = node->ref.symbol;
+            if (!symbol) break;
+            if (node->data_type == TYPE_ARRAY) {
+                IRInstr* alloca = emit_at_entry(b, IR_ALLOCA, IR_TYPE_PTR);
+                alloca->imm = type_size(b->types, node->type_id);
+                alloca->name = strdup(symbol->name);
+                alloca->origin = node;
+                index_insert(&b->arrays, symbol, alloca->id);
+            } else {
+                GROW(b->variable_types, *count, b->variable_capacity, 16);
+                b->variable_types[*count] = ir_type_of(node->data_type);
+                index_insert(&b->variables, symbol, (*count)++);
+            }
+            break;
+        }
+
+        case AST_IF_STATEMENT:
+            collect_locals(b, node->data.if_stmt.then_stmt, count);
+            collect_locals(b, node->data.if_stmt.else_stmt, count);
+            break;
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            collect_locals(b, node->data.while_stmt.body, count);
+            break;
+
+        case AST_FOR_STATEMENT:
+            collect_locals(b, node->data.for_stmt.init, count);
+            collect_locals(b, node->data.for_stmt.body, count);
+            break;
+
+        case AST_SWITCH_STATEMENT:
+            collect_locals(b, node->data.switch_stmt.cases, count);
+            break;
+
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                collect_locals(b, node->children[i], count);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static int count_declarations(ASTNode* node) {
+    if (!node) return 0;
+    switch (node->type) {
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT: {
+            int count = 0;
+            for (int i = 0; i < node->child_count; i++) {
+                count += count_declarations(node->children[i]);
+            }
+            return count;
+        }
+        case AST_VARIABLE_DECLARATION:
+            return 1;
+        case AST_IF_STATEMENT:
+            return count_declarations(node->data.if_stmt.then_stmt) +
+                   count_declarations(node->data.if_stmt.else_stmt);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return count_declarations(node->data.while_stmt.body);
+        case AST_FOR_STATEMENT:
+            return count_declarations(node->data.for_stmt.init) +
+                   count_declarations(node->data.for_stmt.body);
+        case AST_SWITCH_STATEMENT:
+            return count_declarations(node->data.switch_stmt.cases);
+        default:
+            return 0;
+    }
+}
+
+// Descarta os blocos vazios e sem predecessores deixados depois de
+// return/break/continue, compactando a numeração dos blocos
+static void remove_empty_blocks(IRFunction* function) {
+    int* mapping = malloc(function->block_count * sizeof(int));
+    int count = 0;
+
+    for (int i = 0; i < function->block_count; i++) {
+        IRBlock* block = function->blocks[i];
+        if (i != 0 && block->instr_count == 0 && block->pred_count == 0) {
+            mapping[i] = -1;
+            block_destroy(block);
+            continue;
+        }
+        mapping[i] = count;
+        block->id = count;
+        function->blocks[count++] = block;
+    }
+    function->block_count = count;
+
+    for (int i = 0; i < count; i++) {
+        IRBlock* block = function->blocks[i];
+        for (int p = 0; p < block->pred_count; p++) {
+            block->preds[p] = mapping[block->preds[p]];
+        }
+        for (int j = 0; j < block->instr_count; j++) {
+            IRInstr* instr = function->values[block->instrs[j]];
+            instr->block = i;
+            for (int t = 0; t < 2; t++) {
+                if (instr->targets[t] >= 0) instr->targets[t] = mapping[instr->targets[t]];
+            }
+        }
+    }
+    free(mapping);
+}
+
+// Remove phis que se tornaram triviais depois de todos os blocos selados
+// e reescreve os operandos encaminhados
+static void finish_ssa(IRFunction* function) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < function->value_count; i++) {
+            IRInstr* phi = function->values[i];
+            if (phi->op != IR_PHI || phi->is_dead) continue;
+
+            int same = -1;
+            int trivial = 1;
+            for (int j = 0; j < phi->operand_count; j++) {
+                int operand = resolve(function, phi->operands[j]);
+                phi->operands[j] = operand;
+                if (operand == same || operand == phi->id) continue;
+                if (same >= 0) {
+                    trivial = 0;
+                    break;
+                }
+                same = operand;
+            }
+            if (trivial && same >= 0) {
+                phi->forward = same;
+                ir_remove_instr(function, phi->id);
+                changed = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < function->value_count; i++) {
+        IRInstr* instr = function->values[i];
+        if (instr->is_dead) continue;
+        for (int j = 0; j < instr->operand_count; j++) {
+            instr->operands[j] = resolve(function, instr->operands[j]);
+        }
+    }
+    for (int i = 0; i < function->definition_count; i++) {
+        function->definitions[i].value = resolve(function, function->definitions[i].value);
+    }
+
+    for (int i = 0; i < function->block_count; i++) {
+        IRBlock* block = function->blocks[i];
+        free(block->defs);
+        free(block->incomplete_phis);
+        block->defs = NULL;
+        block->incomplete_phis = NULL;
+        block->incomplete_count = 0;
+        block->incomplete_capacity = 0;
+    }
+    remove_empty_blocks(function);
+    ir_renumber(function);
+}
+
+static IRFunction* lower_function(IRBuilder* b, ASTNode* decl) {
+    Symbol* symbol = decl->ref.symbol;
+    ASTNode* params = decl->data.function_decl.parameters;
+    int param_count = params ? params->child_count : 0;
+    ASTNode* body = decl->data.function_decl.body;
+
+    IRFunction* function = function_create(decl->data.function_decl.name, symbol);
+    function->return_type = ir_type_of(decl->data_type);
+    function->param_count = param_count;
+    b->function = function;
+    b->return_type = decl->data_type;
+    b->break_target = -1;
+    b->continue_target = -1;
+    b->origin = decl;
+
+    int expected = param_count + count_declarations(body);
+    index_reset(&b->variables, expected);
+    index_reset(&b->arrays, expected);
+
+    // Número de variáveis antes dos blocos: cada bloco guarda suas definições
+    int count = 0;
+    for (int i = 0; i < param_count; i++) {
+        Symbol* param = params->children[i]->ref.symbol;
+        if (!param) continue;
+        GROW(b->variable_types, count, b->variable_capacity, 16);
+        b->variable_types[count] = ir_type_of(params->children[i]->data_type);
+        index_insert(&b->variables, param, count++);
+    }
+    function->variable_count = count + count_declarations(body);
+
+    b->current = new_sealed_block(b);
+    collect_locals(b, body, &count);
+    function->variable_count = count;
+
+    for (int i = 0; i < param_count; i++) {
+        ASTNode* param = params->children[i];
+        IRInstr* value = emit_at_entry(b, IR_PARAM, ir_type_of(param->data_type));
+        value->imm = i;
+        value->name = param->data.parameter.name ? strdup(param->data.parameter.name) : NULL;
+        value->origin = param;
+        int variable = variable_index(b, param->ref.symbol);
+        if (variable >= 0) write_variable(b, variable, 0, value->id);
+    }
+
+    lower_statement(b, body);
+
+    // Retorno implícito ao cair no fim da função (0 ou 0.0, como nos backends)
+    b->origin = decl;
+    if (!is_empty_unreachable(b)) {
+        int zero = function->return_type != IR_TYPE_VOID ? zero_of(b, function->return_type) : -1;
+        IRInstr* ret = emit(b, IR_RET, IR_TYPE_VOID);
+        if (zero >= 0) add_operand(ret, zero);
+    }
+
+    finish_ssa(function);
+    return function;
+}
+
+IRModule* ir_build_module(ASTNode* program, SymbolTable* symbols) {
+    IRModule* module = calloc(1, sizeof(IRModule));
+    module->symbol_table = symbols;
+    if (!program) return module;
+
+    IRBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.module = module;
+    builder.types = symbols->types;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+
+        if (decl->type == AST_FUNCTION_DECLARATION && decl->data.function_decl.body) {
+            IRFunction* function = lower_function(&builder, decl);
+            GROW(module->functions, module->function_count, module->function_capacity, 8);
+            module->functions[module->function_count++] = function;
+        } else if (decl->type == AST_VARIABLE_DECLARATION && decl->ref.symbol) {
+            GROW(module->globals, module->global_count, module->global_capacity, 8);
+            module->globals[module->global_count].symbol = decl->ref.symbol;
+            module->globals[module->global_count].decl = decl;
+            module->global_count++;
+        }
+    }
+
+    index_free(&builder.variables);
+    index_free(&builder.arrays);
+    free(builder.variable_types);
+    return module;
+}
+
+// ============================================================
+// Verificador
+// ============================================================
+
+#define VERIFY(condition, ...)                               \
+    do {                                                     \
+        if (!(condition)) {                                  \
+            snprintf(error, size, __VA_ARGS__);              \
+            return 0;                                        \
+        }                                                    \
+    } while (0)
+
+static int count_edges(const int* list, int count, int block) {
+    int edges = 0;
+    for (int i = 0; i < count; i++) {
+        if (list[i] == block) edges++;
+    }
+    return edges;
+}
+
+// Verifica a forma estrutural da função: blocos terminados, phis no início
+// e com um operando por predecessor, arestas consistentes, operandos
+// válidos e tipos coerentes. Retorna 0 e descreve o primeiro problema.
+int ir_verify(IRFunction* function, char* error, int size) {
+    int* position = malloc((function->value_count + 1) * sizeof(int));
+    for (int i = 0; i < function->value_count; i++) {
+        position[i] = -1;
+    }
+    for (int b = 0; b < function->block_count; b++) {
+        IRBlock* block = function->blocks[b];
+        for (int i = 0; i < block->instr_count; i++) {
+            position[block->instrs[i]] = i;
+        }
+    }
+
+    int ok = 1;
+    for (int b = 0; b < function->block_count && ok; b++) {
+        IRBlock* block = function->blocks[b];
+        ok = 0;
+
+        VERIFY(block->id == b, "bb%d: id inconsistente", b);
+        VERIFY(block->instr_count > 0, "bb%d: bloco vazio", b);
+        VERIFY(ir_block_terminator(function, block) >= 0, "bb%d: sem terminador", b);
+
+        int successors[2];
+        int successor_count = ir_block_successors(function, block, successors);
+        for (int s = 0; s < successor_count; s++) {
+            VERIFY(successors[s] >= 0 && successors[s] < function->block_count,
+                   "bb%d: destino inválido", b);
+            IRBlock* target = function->blocks[successors[s]];
+            VERIFY(count_edges(target->preds, target->pred_count, b) ==
+                   count_edges(successors, successor_count, successors[s]),
+                   "bb%d: aresta para bb%d ausente nos predecessores", b, successors[s]);
+        }
+        for (int p = 0; p < block->pred_count; p++) {
+            int pred = block->preds[p];
+            VERIFY(pred >= 0 && pred < function->block_count, "bb%d: predecessor inválido", b);
+            int pred_successors[2];
+            int pred_count = ir_block_successors(function, function->blocks[pred], pred_successors);
+            VERIFY(count_edges(pred_successors, pred_count, b) > 0,
+                   "bb%d: predecessor bb%d não desvia para o bloco", b, pred);
+        }
+
+        int in_phis = 1;
+        for (int i = 0; i < block->instr_count; i++) {
+            int id = block->instrs[i];
+            VERIFY(id >= 0 && id < function->value_count, "bb%d: instrução inválida", b);
+            IRInstr* instr = function->values[id];
+
+            VERIFY(!instr->is_dead, "v%d: instrução removida ainda no bloco", id);
+            VERIFY(instr->block == b, "v%d: bloco inconsistente", id);
+            VERIFY(!ir_is_terminator(instr->op) || i == block->instr_count - 1,
+                   "v%d: terminador no meio do bloco bb%d", id, b);
+
+            if (instr->op == IR_PHI) {
+                VERIFY(in_phis, "v%d: phi depois de instrução comum", id);
+                VERIFY(instr->operand_count == block->pred_count,
+                       "v%d: phi com %d operandos para %d predecessores",
+                       id, instr->operand_count, block->pred_count);
+            } else {
+                in_phis = 0;
+            }
+
+            for (int j = 0; j < instr->operand_count; j++) {
+                int operand = instr->operands[j];
+                VERIFY(operand >= 0 && operand < function->value_count,
+                       "v%d: operando %d inválido", id, j);
+                IRInstr* source = function->values[operand];
+                VERIFY(!source->is_dead && position[operand] >= 0,
+                       "v%d: usa valor removido v%d", id, operand);
+                VERIFY(source->type != IR_TYPE_VOID, "v%d: usa v%d, que não produz valor", id, operand);
+                if (instr->op != IR_PHI && source->block == b) {
+                    VERIFY(position[operand] < i, "v%d: usa v%d antes da definição", id, operand);
+                }
+            }
+
+            switch (instr->op) {
+                case IR_PHI:
+                    for (int j = 0; j < instr->operand_count; j++) {
+                        VERIFY(function->values[instr->operands[j]]->type == instr->type,
+                               "v%d: operando de phi com tipo diferente", id);
+                    }
+                    break;
+                case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_MOD:
+                case IR_AND: case IR_OR: case IR_XOR: case IR_SHL: case IR_SHR:
+                case IR_FADD: case IR_FSUB: case IR_FMUL: case IR_FDIV:
+                    VERIFY(instr->operand_count == 2, "v%d: aridade inválida", id);
+                    VERIFY(function->values[instr->operands[0]]->type == instr->type &&
+                           function->values[instr->operands[1]]->type == instr->type,
+                           "v%d: operandos com tipo diferente do resultado", id);
+                    break;
+                case IR_EQ: case IR_NE: case IR_LT: case IR_LE: case IR_GT: case IR_GE:
+                    VERIFY(instr->operand_count == 2, "v%d: aridade inválida", id);
+                    VERIFY(function->values[instr->operands[0]]->type ==
+                           function->values[instr->operands[1]]->type,
+                           "v%d: comparação entre tipos diferentes", id);
+                    break;
+                case IR_LOAD:
+                    VERIFY(instr->operand_count == 1 &&
+                           function->values[instr->operands[0]]->type == IR_TYPE_PTR,
+                           "v%d: load sem endereço", id);
+                    break;
+                case IR_STORE:
+                    VERIFY(instr->operand_count == 2 &&
+                           function->values[instr->operands[0]]->type == IR_TYPE_PTR,
+                           "v%d: store sem endereço", id);
+                    break;
+                case IR_BRANCH:
+                    VERIFY(instr->operand_count == 1 &&
+                           function->values[instr->operands[0]]->type == IR_TYPE_I32,
+                           "v%d: condição de desvio deve ser i32", id);
+                    break;
+                case IR_RET:
+                    VERIFY((instr->operand_count == 0) == (function->return_type == IR_TYPE_VOID) &&
+                           (instr->operand_count == 0 ||
+                            function->values[instr->operands[0]]->type == function->return_type),
+                           "v%d: retorno incompatível com a função", id);
+                    break;
+                default:
+                    break;
+            }
+        }
+        ok = 1;
+    }
+
+    free(position);
+    return ok;
+}
+
+// ============================================================
+// Impressão textual (--ir)
+// ============================================================
+
+static void dump_string(FILE* out, const char* value) {
+    fputc('"', out);
+    for (const unsigned char* p = (const unsigned char*)value; *p; p++) {
+        switch (*p) {
+            case '\n': fputs("\\n", out); break;
+            case '\t': fputs("\\t", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '"': fputs("\\\"", out); break;
+            default:
+                if (*p < 32) {
+                    fprintf(out, "\\%03o", *p);
+                } else {
+                    fputc(*p, out);
+                }
+                break;
+        }
+    }
+    fputc('"', out);
+}
+
+static void dump_instr(IRFunction* function, IRInstr* instr, FILE* out) {
+    fprintf(out, "    ");
+    if (instr->type != IR_TYPE_VOID) {
+        fprintf(out, "v%d = ", instr->id);
+    }
+
+    switch (instr->op) {
+        case IR_CONST:
+            fprintf(out, "const %s %ld", ir_type_name(instr->type), instr->imm);
+            break;
+        case IR_FCONST:
+            fprintf(out, "fconst %.9g", instr->fimm);
+            break;
+        case IR_STRING:
+            fprintf(out, "string ");
+            dump_string(out, instr->name);
+            break;
+        case IR_UNDEF:
+            fprintf(out, "undef %s", ir_type_name(instr->type));
+            break;
+        case IR_PARAM:
+            fprintf(out, "param %s %ld", ir_type_name(instr->type), instr->imm);
+            if (instr->name) fprintf(out, "    ; %s", instr->name);
+            break;
+        case IR_PHI: {
+            IRBlock* block = function->blocks[instr->block];
+            fprintf(out, "phi %s ", ir_type_name(instr->type));
+            for (int i = 0; i < instr->operand_count; i++) {
+                fprintf(out, "%s[v%d, bb%d]", i > 0 ? ", " : "", instr->operands[i],
+                        i < block->pred_count ? block->preds[i] : -1);
+            }
+            break;
+        }
+        case IR_ALLOCA:
+            fprintf(out, "alloca %ld", instr->imm);
+            if (instr->name) fprintf(out, "    ; %s", instr->name);
+            break;
+        case IR_GLOBAL:
+            fprintf(out, "global @%s", instr->name);
+            break;
+        case IR_LOAD:
+            fprintf(out, "load.%s v%d", ir_type_name(instr->mem_type), instr->operands[0]);
+            break;
+        case IR_STORE:
+            fprintf(out, "store.%s v%d, v%d", ir_type_name(instr->mem_type),
+                    instr->operands[0], instr->operands[1]);
+            break;
+        case IR_CALL:
+            fprintf(out, "call %s %s(", ir_type_name(instr->type), instr->name);
+            for (int i = 0; i < instr->operand_count; i++) {
+                fprintf(out, "%sv%d", i > 0 ? ", " : "", instr->operands[i]);
+            }
+            fprintf(out, ")");
+            break;
+        case IR_JUMP:
+            fprintf(out, "jump bb%d", instr->targets[0]);
+            break;
+        case IR_BRANCH:
+            fprintf(out, "br v%d, bb%d, bb%d", instr->operands[0], instr->targets[0], instr->targets[1]);
+            break;
+        case IR_RET:
+            fprintf(out, "ret");
+            if (instr->operand_count > 0) fprintf(out, " v%d", instr->operands[0]);
+            break;
+        default: {
+            // Operações: comparações mostram o tipo dos operandos
+            IRType shown = instr->type;
+            if (is_compare(instr->op) && instr->operand_count > 0) {
+                shown = function->values[instr->operands[0]]->type;
+            }
+            fprintf(out, "%s %s ", ir_opcode_name(instr->op), ir_type_name(shown));
+            for (int i = 0; i < instr->operand_count; i++) {
+                fprintf(out, "%sv%d", i > 0 ? ", " : "", instr->operands[i]);
+            }
+            break;
+        }
+    }
+    fprintf(out, "\n");
+}
+
+void ir_dump_function(IRFunction* function, FILE* out) {
+    fprintf(out, "function %s(", function->name);
+    IRBlock* entry = function->block_count > 0 ? function->blocks[0] : NULL;
+    int printed = 0;
+    for (int i = 0; entry && i < entry->instr_count; i++) {
+        IRInstr* param = function->values[entry->instrs[i]];
+        if (param->op != IR_PARAM) continue;
+        fprintf(out, "%s%s v%d", printed++ > 0 ? ", " : "", ir_type_name(param->type), param->id);
+    }
+    fprintf(out, ") -> %s\n", ir_type_name(function->return_type));
+
+    for (int b = 0; b < function->block_count; b++) {
+        IRBlock* block = function->blocks[b];
+        fprintf(out, "bb%d:", b);
+        if (block->pred_count > 0) {
+            fprintf(out, "    ; preds:");
+            for (int i = 0; i < block->pred_count; i++) {
+                fprintf(out, " bb%d", block->preds[i]);
+            }
+        }
+        fprintf(out, "\n");
+        for (int i = 0; i < block->instr_count; i++) {
+            dump_instr(function, function->values[block->instrs[i]], out);
+        }
+    }
+    fprintf(out, "\n");
+}
+
+void ir_dump_module(IRModule* module, FILE* out) {
+    for (int i = 0; i < module->global_count; i++) {
+        IRGlobal* global = &module->globals[i];
+        char type_name[256];
+        type_to_string(module->symbol_table->types, global->symbol->type_id, type_name,
+                       sizeof(type_name));
+        fprintf(out, "global @%s: %s\n", global->symbol->name, type_name);
+    }
+    if (module->global_count > 0) fprintf(out, "\n");
+
+    for (int i = 0; i < module->function_count; i++) {
+        ir_dump_function(module->functions[i], out);
+    }
+}
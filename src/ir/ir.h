@@ -0,0 +1,166 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "symbol_table.h"
+
+// ------------------------------------------------------------
+// Representação intermediária de três endereços em forma SSA
+//
+// Cada função é um grafo de blocos básicos. Cada instrução que produz
+// valor é identificada por um número denso (vN); os operandos referenciam
+// esses números. Variáveis locais escalares viram valores SSA (com nós
+// phi nas junções); globais e arrays locais são acessados por LOAD/STORE.
+// ------------------------------------------------------------
+
+// Tipos dos valores. Valores char são mantidos como i32 já truncados;
+// I8 só aparece como largura de acesso em LOAD/STORE.
+typedef enum {
+    IR_TYPE_VOID,
+    IR_TYPE_I8,
+    IR_TYPE_I32,
+    IR_TYPE_F32,
+    IR_TYPE_PTR
+} IRType;
+
+typedef enum {
+    // Valores
+    IR_CONST,      // imm (i32 ou ptr)
+    IR_FCONST,     // fimm
+    IR_STRING,     // Endereço de literal string (name)
+    IR_UNDEF,      // Leitura de variável não inicializada
+    IR_PARAM,      // Parâmetro imm
+    IR_PHI,        // Um operando por predecessor, na ordem de preds
+
+    // Aritmética inteira (i32 ou ptr)
+    IR_ADD, IR_SUB, IR_MUL, IR_DIV, IR_MOD,
+    IR_AND, IR_OR, IR_XOR, IR_SHL, IR_SHR,
+    IR_NEG, IR_NOT,
+
+    // Aritmética float
+    IR_FADD, IR_FSUB, IR_FMUL, IR_FDIV, IR_FNEG,
+
+    // Comparações (resultado i32 0/1; operandos i32, ptr ou f32)
+    IR_EQ, IR_NE, IR_LT, IR_LE, IR_GT, IR_GE,
+
+    // Conversões
+    IR_I2F,        // i32 -> f32
+    IR_F2I,        // f32 -> i32 (truncamento)
+    IR_I2C,        // i32 -> i32 com extensão de sinal dos 8 bits baixos
+    IR_I2P,        // i32 -> ptr (extensão de sinal)
+    IR_P2I,        // ptr -> i32 (truncamento)
+
+    // Memória
+    IR_ALLOCA,     // Endereço de imm bytes no frame (arrays locais)
+    IR_GLOBAL,     // Endereço da variável global (symbol)
+    IR_LOAD,       // operands[0] = endereço; mem_type = largura
+    IR_STORE,      // operands[0] = endereço, operands[1] = valor
+
+    // Chamadas
+    IR_CALL,       // name/symbol; operands = argumentos
+
+    // Terminadores
+    IR_JUMP,       // targets[0]
+    IR_BRANCH,     // operands[0] != 0 ? targets[0] : targets[1]
+    IR_RET,        // operands[0] opcional
+
+    IR_OPCODE_COUNT
+} IROpcode;
+
+typedef struct IRInstr {
+    IROpcode op;
+    IRType type;           // Tipo do resultado (VOID se não produz valor)
+    IRType mem_type;       // LOAD/STORE: largura do acesso
+    int id;                // Número do valor
+    int block;             // Bloco que contém a instrução
+    int* operands;
+    int operand_count;
+    int operand_capacity;
+    int targets[2];        // JUMP/BRANCH: blocos de destino
+    long imm;              // CONST: valor; ALLOCA: bytes; PARAM: índice
+    float fimm;            // FCONST
+    char* name;            // STRING: texto; GLOBAL/CALL: nome
+    const Symbol* symbol;  // GLOBAL/CALL
+    int forward;           // Phi trivial substituído por outro valor (-1 se não)
+    int is_dead;           // Removida da função
+    ASTNode* origin;       // Nó da AST que originou a instrução
+} IRInstr;
+
+typedef struct IRBlock {
+    int id;
+    int* instrs;           // Phis primeiro, terminador por último
+    int instr_count;
+    int instr_capacity;
+    int* preds;
+    int pred_count;
+    int pred_capacity;
+    int sealed;            // Todos os predecessores conhecidos (construção SSA)
+    int* defs;             // Definição corrente de cada variável (construção SSA)
+    int* incomplete_phis;  // Pares (variável, phi) pendentes até o bloco ser selado
+    int incomplete_count;
+    int incomplete_capacity;
+} IRBlock;
+
+// Atribuição a uma variável SSA: liga o nó da AST ao valor atribuído
+typedef struct IRDefinition {
+    ASTNode* node;         // Atribuição ou declaração com inicializador
+    int value;
+} IRDefinition;
+
+typedef struct IRFunction {
+    char* name;
+    Symbol* symbol;
+    IRType return_type;
+    int param_count;
+    IRInstr** values;      // Indexado pelo número do valor
+    int value_count;
+    int value_capacity;
+    IRBlock** blocks;      // blocks[0] é a entrada
+    int block_count;
+    int block_capacity;
+    int variable_count;    // Variáveis SSA (construção)
+    IRDefinition* definitions;
+    int definition_count;
+    int definition_capacity;
+} IRFunction;
+
+typedef struct IRGlobal {
+    Symbol* symbol;
+    ASTNode* decl;         // Declaração (inicializador constante)
+} IRGlobal;
+
+typedef struct IRModule {
+    IRFunction** functions;
+    int function_count;
+    int function_capacity;
+    IRGlobal* globals;
+    int global_count;
+    int global_capacity;
+    SymbolTable* symbol_table;
+} IRModule;
+
+// Construção a partir da AST analisada
+IRModule* ir_build_module(ASTNode* program, SymbolTable* symbols);
+void ir_module_destroy(IRModule* module);
+
+// Manipulação
+IRInstr* ir_value(IRFunction* function, int id);
+int ir_block_terminator(IRFunction* function, IRBlock* block);
+int ir_block_successors(IRFunction* function, IRBlock* block, int successors[2]);
+void ir_remove_instr(IRFunction* function, int id);
+void ir_replace_uses(IRFunction* function, int old_id, int new_id);
+int ir_remove_dead_values(IRFunction* function);
+void ir_renumber(IRFunction* function);
+
+// Verificação e depuração
+int ir_verify(IRFunction* function, char* error, int size);
+void ir_dump_function(IRFunction* function, FILE* out);
+void ir_dump_module(IRModule* module, FILE* out);
+const char* ir_opcode_name(IROpcode op);
+const char* ir_type_name(IRType type);
+IRType ir_type_of(DataType type);
+int ir_is_terminator(IROpcode op);
+int ir_has_side_effects(IROpcode op);
+
+#endif
@@ -6,6 +6,11 @@
 #include "semantic.h"
 #include "error_handler.h"
 #include "code_generator.h"
+#include "optimizer.h"
+#include "ir.h"
+#include "cfg.h"
+#include "profile.h"
+#include "pass_manager.h"
 
 typedef struct CompilerOptions {
     char* input_file;
@@ -15,7 +20,16 @@ typedef struct CompilerOptions {
     int show_tokens;
     int show_ast;
     int show_symbols;
-    int optimize;
+    int show_ir;
+    OptimizationLevel level;  // -O0, -O1, -O2 (-O) ou -Os
+    int pass_flags[PASS_COUNT];  // -f<passe> = 1, -fno-<passe> = -1, nível = 0
+    int time_passes;    // --time-passes
+    int unroll_factor;  // -funroll=N (-1 = padrão do otimizador)
+    int inline_limit;   // -finline-limit=N (-1 = padrão do otimizador)
+    int avx2;           // -mavx2: laços vetorizados com 8 lanes
+    char* profile_generate;  // -fprofile-generate[=arquivo]
+    char* profile_use;       // -fprofile-use[=arquivo]
+    int jobs;  // Threads da análise semântica (0 = um por núcleo)
 } CompilerOptions;
 
 char* read_file(const char* filename) {
@@ -48,14 +62,29 @@ void print_usage(const char* program_name) {
     printf("  --tokens        Mostrar tokens\n");
     printf("  --ast           Mostrar AST\n");
     printf("  --symbols       Mostrar tabela de símbolos\n");
-    printf("  -O              Otimizar código\n");
+    printf("  --ir            Mostrar representação intermediária (SSA)\n");
+    printf("  -O0, -O1, -O2, -Os Nível de otimização (-O = -O2; padrão: -O0)\n");
+    printf("  -funroll=<n>    Fator de desenrolamento de laços com -O (padrão: %d; 1 desliga)\n",
+           DEFAULT_UNROLL_FACTOR);
+    printf("  -finline-limit=<n> Tamanho máximo (nós) de uma função expandida com -O (padrão: %d; 0 desliga)\n",
+           DEFAULT_INLINE_LIMIT);
+    printf("  -mavx2          Vetorizar com AVX2 (8 lanes) em vez de SSE2 (4) no assembly com -O\n");
+    printf("  -f<passe>, -fno-<passe> Ligar ou desligar um passe do nível (lista abaixo)\n");
+    printf("  --time-passes   Tempo e memória de cada passe e fase\n");
+    printf("  -fprofile-generate[=<arquivo>] Contar desvios e chamadas; o programa grava o perfil ao sair (padrão: %s)\n",
+           PROFILE_DEFAULT_FILE);
+    printf("  -fprofile-use[=<arquivo>] Usar o perfil gravado no layout, nas dicas de desvio e no inlining\n");
+    printf("  -j <n>          Threads da análise semântica (padrão: núcleos)\n");
     printf("  -h, --help      Mostrar esta ajuda\n");
+    pass_manager_print_passes();
 }
 
 CompilerOptions parse_arguments(int argc, char* argv[]) {
     CompilerOptions options = {0};
     options.output_type = OUTPUT_C;
     options.output_file = "output.c";
+    options.unroll_factor = -1;
+    options.inline_limit = -1;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -83,8 +112,36 @@ CompilerOptions parse_arguments(int argc, char* argv[]) {
             options.show_ast = 1;
         } else if (strcmp(argv[i], "--symbols") == 0) {
             options.show_symbols = 1;
-        } else if (strcmp(argv[i], "-O") == 0) {
-            options.optimize = 1;
+        } else if (strcmp(argv[i], "--ir") == 0) {
+            options.show_ir = 1;
+        } else if (pass_manager_parse_level(argv[i], &options.level)) {
+            continue;
+        } else if (strcmp(argv[i], "--time-passes") == 0) {
+            options.time_passes = 1;
+        } else if (strncmp(argv[i], "-funroll=", 9) == 0) {
+            options.unroll_factor = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "-finline-limit=", 15) == 0) {
+            options.inline_limit = atoi(argv[i] + 15);
+        } else if (strcmp(argv[i], "-mavx2") == 0) {
+            options.avx2 = 1;
+        } else if (strcmp(argv[i], "-fprofile-generate") == 0) {
+            options.profile_generate = PROFILE_DEFAULT_FILE;
+        } else if (strncmp(argv[i], "-fprofile-generate=", 19) == 0) {
+            options.profile_generate = argv[i] + 19;
+        } else if (strcmp(argv[i], "-fprofile-use") == 0) {
+            options.profile_use = PROFILE_DEFAULT_FILE;
+        } else if (strncmp(argv[i], "-fprofile-use=", 14) == 0) {
+            options.profile_use = argv[i] + 14;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            options.jobs = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "-f", 2) == 0) {
+            int enable = strncmp(argv[i], "-fno-", 5) != 0;
+            int pass = pass_lookup(argv[i] + (enable ? 2 : 5));
+            if (pass < 0) {
+                fprintf(stderr, "Aviso: passe desconhecido em %s (ignorado)\n", argv[i]);
+            } else {
+                options.pass_flags[pass] = enable ? 1 : -1;
+            }
         } else if (argv[i][0] != '-') {
             options.input_file = argv[i];
         }
@@ -171,6 +228,17 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Pipeline de otimização: o nível e depois as flags -f, na ordem da
+    // tabela de passes, independente da ordem na linha de comando
+    PassManager* passes = pass_manager_create(options.level);
+    for (int p = 0; p < PASS_COUNT; p++) {
+        if (options.pass_flags[p]) pass_manager_set(passes, (PassId)p, options.pass_flags[p] > 0);
+    }
+    if (options.profile_generate) {
+        pass_manager_exclude_uninstrumentable(passes);
+    }
+    passes->time_passes = options.time_passes;
+    
     // Criar gerenciador de erros
     ErrorHandler* error_handler = error_handler_create();
     error_handler_set_file(error_handler, options.input_file);
@@ -178,6 +246,7 @@ int main(int argc, char* argv[]) {
     // Ler arquivo fonte
     char* source = read_file(options.input_file);
     if (!source) {
+        pass_manager_destroy(passes);
         error_handler_destroy(error_handler);
         return 1;
     }
@@ -213,7 +282,9 @@ int main(int argc, char* argv[]) {
         printf(" [%d:%d]\n", parser->current_token.line, parser->current_token.column);
     }
     
+    PassTimer phase = pass_timer_start();
     ASTNode* ast = parser_parse(parser);
+    pass_manager_record(passes, "parser", "fase", phase);
     
     if (parser->has_error) {
         printf("ERRO NO PARSER: %s\n", parser->error_message);
@@ -224,6 +295,7 @@ int main(int argc, char* argv[]) {
         parser_destroy(parser);
         lexer_destroy(lexer);
         free(source);
+        pass_manager_destroy(passes);
         error_handler_destroy(error_handler);
         return 1;
     }
@@ -248,10 +320,20 @@ int main(int argc, char* argv[]) {
     }
     
     SemanticAnalyzer* analyzer = semantic_analyzer_create();
+    analyzer->thread_count = options.jobs;
     
-    if (!semantic_analyze(analyzer, ast)) {
+    phase = pass_timer_start();
+    int semantic_ok = semantic_analyze(analyzer, ast);
+    pass_manager_record(passes, "semântica", "fase", phase);
+    if (!semantic_ok) {
         printf("ERRO SEMÂNTICO: %s\n", analyzer->error_message);
-        report_semantic_error(error_handler, analyzer->error_message, 0, 0);
+        for (int i = 0; i < analyzer->diagnostic_count; i++) {
+            SemanticDiagnostic* diagnostic = &analyzer->diagnostics[i];
+            if (diagnostic->is_error) {
+                report_semantic_error(error_handler, diagnostic->message,
+                                      diagnostic->line, diagnostic->column);
+            }
+        }
         error_handler_print_errors(error_handler);
         
         semantic_analyzer_destroy(analyzer);
@@ -259,6 +341,7 @@ int main(int argc, char* argv[]) {
         parser_destroy(parser);
         lexer_destroy(lexer);
         free(source);
+        pass_manager_destroy(passes);
         error_handler_destroy(error_handler);
         return 1;
     }
@@ -271,6 +354,70 @@ int main(int argc, char* argv[]) {
         printf("✅ Análise semântica concluída com sucesso!\n\n");
     }
     
+    // Pontos do perfil numerados antes de -O, para que as chaves sejam as
+    // mesmas na compilação instrumentada e na que usa o perfil
+    Profile* profile = NULL;
+    if (options.profile_generate || options.profile_use) {
+        profile = profile_create(ast);
+        profile->generate_path = options.profile_generate;
+        if (options.profile_use && !profile_load(profile, options.profile_use)) {
+            fprintf(stderr, "Aviso: perfil %s não pôde ser lido; compilando sem ele\n", options.profile_use);
+        }
+    }
+    
+    // Fase 3.5: Otimização (-O1, -O2, -Os)
+    int run_optimizer = 0;
+    for (int p = 0; p < PASS_COUNT; p++) {
+        if (pass_table[p].run && pass_enabled(passes, (PassId)p)) run_optimizer = 1;
+    }
+    if (run_optimizer) {
+        if (options.verbose) {
+            printf("=== INICIANDO OTIMIZAÇÃO ===\n");
+        }
+        
+        Optimizer* optimizer = optimizer_create(analyzer->symbol_table);
+        if (options.unroll_factor >= 0) optimizer->unroll_factor = options.unroll_factor;
+        if (options.inline_limit >= 0) optimizer->inline_limit = options.inline_limit;
+        optimizer->vectorize = options.output_type == OUTPUT_ASSEMBLY && pass_enabled(passes, PASS_VECTORIZE);
+        optimizer->profile = profile;
+        pass_manager_run(passes, optimizer, ast);
+        
+        if (options.verbose) {
+            optimizer_print_stats(optimizer);
+            printf("✅ Otimização concluída!\n\n");
+        } else if (pass_enabled(passes, PASS_MEMOIZE)) {
+            optimizer_print_memoization(optimizer);
+        }
+        optimizer_destroy(optimizer);
+    }
+    if (options.verbose) {
+        pass_manager_print_pipeline(passes);
+    }
+    
+    // Representação intermediária (--ir)
+    if (options.show_ir) {
+        IRModule* module = ir_build_module(ast, analyzer->symbol_table);
+        
+        for (int i = 0; i < module->function_count; i++) {
+            char error[256];
+            IRFunction* function = module->functions[i];
+            if (!ir_verify(function, error, sizeof(error))) {
+                fprintf(stderr, "Erro na IR de '%s': %s\n", function->name, error);
+                continue;
+            }
+            
+            DominatorTree* tree = dominator_tree_build(function);
+            if (!ir_verify_dominance(function, tree, error, sizeof(error))) {
+                fprintf(stderr, "Erro na IR de '%s': %s\n", function->name, error);
+            }
+            dominator_tree_destroy(tree);
+        }
+        
+        printf("=== REPRESENTAÇÃO INTERMEDIÁRIA ===\n");
+        ir_dump_module(module, stdout);
+        ir_module_destroy(module);
+    }
+    
     // Fase 4: Geração de Código
     if (options.verbose) {
         printf("=== INICIANDO GERAÇÃO DE CÓDIGO ===\n");
@@ -279,17 +426,32 @@ int main(int argc, char* argv[]) {
     CodeGenerator* generator = code_generator_create(options.output_file, options.output_type);
     if (!generator) {
         fprintf(stderr, "Erro: Não foi possível criar arquivo de saída\n");
+        profile_destroy(profile);
         semantic_analyzer_destroy(analyzer);
         if (ast) ast_destroy(ast);
         parser_destroy(parser);
         lexer_destroy(lexer);
         free(source);
+        pass_manager_destroy(passes);
         error_handler_destroy(error_handler);
         return 1;
     }
     
-    if (generate_code(generator, ast, analyzer->symbol_table)) {
+    generator->allocate_registers = pass_enabled(passes, PASS_REGALLOC);
+    generator->select_instructions = pass_enabled(passes, PASS_ISEL);
+    generator->peephole = pass_enabled(passes, PASS_PEEPHOLE);
+    generator->tail_calls = pass_enabled(passes, PASS_TAIL_CALLS);
+    if (pass_enabled(passes, PASS_VECTORIZE)) {
+        generator->vector_width = options.avx2 ? 8 : 4;
+    }
+    generator->profile = profile;
+    phase = pass_timer_start();
+    int generated = generate_code(generator, ast, analyzer->symbol_table);
+    pass_manager_record(passes, "geração de código", "fase", phase);
+    if (generated) {
         if (options.verbose) {
+            code_generator_print_stats(generator);
+            profile_print_stats(profile);
             printf("✅ Código gerado com sucesso em: %s\n", options.output_file);
         }
     } else {
@@ -298,12 +460,16 @@ int main(int argc, char* argv[]) {
     
     // Limpeza
     code_generator_destroy(generator);
+    profile_destroy(profile);
     semantic_analyzer_destroy(analyzer);
     if (ast) ast_destroy(ast);
     parser_destroy(parser);
     lexer_destroy(lexer);
     free(source);
     
+    pass_manager_print_timings(passes);
+    pass_manager_destroy(passes);
+    
     // Relatório final
     if (options.verbose || error_handler_has_errors(error_handler)) {
         error_handler_print_summary(error_handler);
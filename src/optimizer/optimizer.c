@@ -0,0 +1,5715 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include "optimizer.h"
+#include "ir.h"
+#include "cfg.h"
+#include "vectorizer.h"
+
+Optimizer* optimizer_create(SymbolTable* symbols) {
+    Optimizer* optimizer = malloc(sizeof(Optimizer));
+    if (!optimizer) return NULL;
+
+    optimizer->symbol_table = symbols;
+    optimizer->binding_count = 0;
+    optimizer->binding_capacity = 64;
+    optimizer->bindings = calloc(optimizer->binding_capacity, sizeof(ConstantBinding));
+    optimizer->folded_expressions = 0;
+    optimizer->propagated_constants = 0;
+    optimizer->removed_statements = 0;
+    optimizer->removed_stores = 0;
+    optimizer->removals = NULL;
+    optimizer->removal_count = 0;
+    optimizer->removal_capacity = 0;
+    optimizer->current_function = NULL;
+    optimizer->reused_expressions = 0;
+    optimizer->temporaries = 0;
+    optimizer->hoisted_expressions = 0;
+    optimizer->hoisted_temporaries = 0;
+    optimizer->unroll_factor = DEFAULT_UNROLL_FACTOR;
+    optimizer->unrolled_loops = 0;
+    optimizer->reduced_products = 0;
+    optimizer->induction_temporaries = 0;
+    optimizer->replaced_tests = 0;
+    optimizer->inline_limit = DEFAULT_INLINE_LIMIT;
+    optimizer->inlined_calls = 0;
+    optimizer->inline_decisions = NULL;
+    optimizer->inline_decision_counts = NULL;
+    optimizer->inline_decision_count = 0;
+    optimizer->inline_decision_capacity = 0;
+    optimizer->profile = NULL;
+    optimizer->vectorize = 0;
+    optimizer->branchless_selects = 0;
+    optimizer->converted_branches = 0;
+    optimizer->predictable_branches = 0;
+    optimizer->expensive_selects = 0;
+    optimizer->memoized_functions = 0;
+    optimizer->memo_decisions = NULL;
+    optimizer->memo_decision_count = 0;
+    optimizer->memo_decision_capacity = 0;
+
+    return optimizer;
+}
+
+void optimizer_destroy(Optimizer* optimizer) {
+    if (!optimizer) return;
+
+    for (int i = 0; i < optimizer->binding_capacity; i++) {
+        if (optimizer->bindings[i].symbol) {
+            ast_destroy(optimizer->bindings[i].literal);
+        }
+    }
+    free(optimizer->bindings);
+    for (int i = 0; i < optimizer->removal_count; i++) {
+        free(optimizer->removals[i]);
+    }
+    free(optimizer->removals);
+    for (int i = 0; i < optimizer->inline_decision_count; i++) {
+        free(optimizer->inline_decisions[i]);
+    }
+    free(optimizer->inline_decisions);
+    free(optimizer->inline_decision_counts);
+    for (int i = 0; i < optimizer->memo_decision_count; i++) {
+        free(optimizer->memo_decisions[i]);
+    }
+    free(optimizer->memo_decisions);
+    free(optimizer);
+}
+
+// ------------------------------------------------------------
+// Valores constantes
+// ------------------------------------------------------------
+
+static int is_arithmetic(DataType type) {
+    return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_CHAR;
+}
+
+// Extrai o valor de um literal numérico (retorna 0 se o nó não for constante)
+int optimizer_constant_value(ASTNode* node, ConstantValue* value) {
+    if (!node) return 0;
+    const char* text = node->data.literal.value;
+
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+            if (!text) return 0;
+            if (node->type == AST_FLOAT_LITERAL || strchr(text, '.')) {
+                value->type = TYPE_FLOAT;
+                value->float_value = strtof(text, NULL);
+                value->int_value = 0;
+            } else {
+                long parsed = strtol(text, NULL, 0);
+                if (parsed > INT_MAX || parsed < INT_MIN) return 0;
+                value->type = TYPE_INT;
+                value->int_value = (int)parsed;
+                value->float_value = 0.0f;
+            }
+            return 1;
+
+        case AST_CHAR_LITERAL:
+            if (!text) return 0;
+            value->type = TYPE_CHAR;
+            value->int_value = ast_char_literal_value(text);
+            value->float_value = 0.0f;
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+// Conversão implícita de C entre tipos aritméticos; falha quando o
+// resultado seria indefinido (float fora do intervalo de int)
+static int convert_constant(ConstantValue* value, DataType target) {
+    if (!is_arithmetic(target)) return 0;
+
+    if (target == TYPE_FLOAT) {
+        if (value->type != TYPE_FLOAT) {
+            value->float_value = (float)value->int_value;
+        }
+    } else {
+        if (value->type == TYPE_FLOAT) {
+            float f = value->float_value;
+            if (!(f > (float)INT_MIN - 1.0f && f < (float)INT_MAX)) return 0;
+            value->int_value = (int)f;
+        }
+        if (target == TYPE_CHAR) {
+            value->int_value = (signed char)value->int_value;
+        }
+    }
+    value->type = target;
+    return 1;
+}
+
+static int constant_truth(const ConstantValue* value) {
+    return value->type == TYPE_FLOAT ? value->float_value != 0.0f : value->int_value != 0;
+}
+
+// Cria o literal que representa o valor, com o tipo do nó substituído.
+// INT_MIN não tem literal em C (seria -(2147483648), um long) e não é dobrado.
+static ASTNode* make_literal(const ConstantValue* value, const ASTNode* original) {
+    char text[64];
+
+    if (value->type == TYPE_FLOAT) {
+        if (!isfinite(value->float_value)) return NULL;
+        snprintf(text, sizeof(text), "%.9g", value->float_value);
+        if (!strpbrk(text, ".e")) {
+            strcat(text, ".0");
+        }
+    } else {
+        if (value->int_value == INT_MIN) return NULL;
+        snprintf(text, sizeof(text), "%d", value->int_value);
+    }
+
+    ASTNode* literal = ast_create_node(value->type == TYPE_FLOAT ? AST_FLOAT_LITERAL
+                                                                 : AST_NUMBER_LITERAL);
+    literal->data.literal.value = strdup(text);
+    literal->data_type = value->type;
+    literal->type_id = type_primitive(value->type);
+    if (original) {
+        literal->line = original->line;
+        literal->column = original->column;
+    }
+    return literal;
+}
+
+// Substitui *slot pelo valor convertido para o tipo do nó original
+static int replace_with_constant(Optimizer* optimizer, ASTNode** slot, ConstantValue value) {
+    ASTNode* node = *slot;
+    if (!convert_constant(&value, node->data_type)) return 0;
+
+    ASTNode* literal = make_literal(&value, node);
+    if (!literal) return 0;
+
+    ast_destroy(node);
+    *slot = literal;
+    optimizer->folded_expressions++;
+    return 1;
+}
+
+// ------------------------------------------------------------
+// Avaliação de operadores (semântica de C; a de int, de 32 bits, é
+// ast_evaluate_int_binary, compartilhada com os rótulos de case)
+// ------------------------------------------------------------
+
+static int evaluate_float_binary(TokenType op, float a, float b, ConstantValue* result) {
+    result->type = TYPE_FLOAT;
+    switch (op) {
+        case TOKEN_PLUS:     result->float_value = a + b; break;
+        case TOKEN_MINUS:    result->float_value = a - b; break;
+        case TOKEN_MULTIPLY: result->float_value = a * b; break;
+        case TOKEN_DIVIDE:
+            if (b == 0.0f) return 0;
+            result->float_value = a / b;
+            break;
+        default:
+            // Comparações produzem int
+            result->type = TYPE_INT;
+            switch (op) {
+                case TOKEN_EQUAL:         result->int_value = a == b; break;
+                case TOKEN_NOT_EQUAL:     result->int_value = a != b; break;
+                case TOKEN_LESS:          result->int_value = a < b; break;
+                case TOKEN_GREATER:       result->int_value = a > b; break;
+                case TOKEN_LESS_EQUAL:    result->int_value = a <= b; break;
+                case TOKEN_GREATER_EQUAL: result->int_value = a >= b; break;
+                default:
+                    return 0;
+            }
+            return 1;
+    }
+    return isfinite(result->float_value);
+}
+
+static void fold_expression(Optimizer* optimizer, ASTNode** slot);
+
+static void fold_binary(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* node = *slot;
+    ASTBinaryExpr* binary = &node->data.binary_expr;
+
+    fold_expression(optimizer, &binary->left);
+    fold_expression(optimizer, &binary->right);
+
+    ConstantValue left, right, result;
+    int left_constant = optimizer_constant_value(binary->left, &left);
+    int right_constant = optimizer_constant_value(binary->right, &right);
+
+    // Vírgula: um operando esquerdo constante não tem efeito
+    if (binary->operator == TOKEN_COMMA) {
+        if (left_constant && binary->right->data_type == node->data_type) {
+            ASTNode* kept = binary->right;
+            binary->right = NULL;
+            ast_destroy(node);
+            *slot = kept;
+            optimizer->folded_expressions++;
+        }
+        return;
+    }
+
+    // Curto-circuito: basta o operando esquerdo para decidir
+    if (binary->operator == TOKEN_AND || binary->operator == TOKEN_OR) {
+        if (!left_constant) return;
+        int decided = binary->operator == TOKEN_AND ? !constant_truth(&left)
+                                                    : constant_truth(&left);
+        result.type = TYPE_INT;
+        if (decided) {
+            result.int_value = binary->operator == TOKEN_OR;
+        } else if (right_constant) {
+            result.int_value = constant_truth(&right);
+        } else {
+            return;
+        }
+        replace_with_constant(optimizer, slot, result);
+        return;
+    }
+
+    if (!left_constant || !right_constant) return;
+
+    // Conversões aritméticas usuais: float domina, char promove para int
+    DataType common = (left.type == TYPE_FLOAT || right.type == TYPE_FLOAT) ? TYPE_FLOAT : TYPE_INT;
+    if (!convert_constant(&left, common) || !convert_constant(&right, common)) return;
+
+    if (common == TYPE_FLOAT) {
+        if (!evaluate_float_binary(binary->operator, left.float_value, right.float_value, &result)) {
+            return;
+        }
+    } else {
+        result.type = TYPE_INT;
+        if (!ast_evaluate_int_binary(binary->operator, left.int_value, right.int_value,
+                                     &result.int_value)) {
+            return;
+        }
+    }
+    replace_with_constant(optimizer, slot, result);
+}
+
+static void fold_unary(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* node = *slot;
+    ASTUnaryExpr* unary = &node->data.unary_expr;
+
+    // Operandos de ++, -- e & são lvalues e não podem ser substituídos
+    switch (unary->operator) {
+        case UNARY_PRE_INCREMENT:
+        case UNARY_PRE_DECREMENT:
+        case UNARY_POST_INCREMENT:
+        case UNARY_POST_DECREMENT:
+        case UNARY_ADDRESS:
+            return;
+        default:
+            break;
+    }
+
+    fold_expression(optimizer, &unary->operand);
+
+    ConstantValue value;
+    if (!optimizer_constant_value(unary->operand, &value)) return;
+    if (value.type == TYPE_CHAR) {
+        convert_constant(&value, TYPE_INT);
+    }
+
+    switch (unary->operator) {
+        case UNARY_PLUS:
+            break;
+        case UNARY_MINUS:
+            if (value.type == TYPE_FLOAT) {
+                value.float_value = -value.float_value;
+            } else {
+                if (value.int_value == INT_MIN) return;
+                value.int_value = -value.int_value;
+            }
+            break;
+        case UNARY_NOT:
+            value.int_value = !constant_truth(&value);
+            value.type = TYPE_INT;
+            break;
+        case UNARY_BITWISE_NOT:
+            if (value.type == TYPE_FLOAT) return;
+            value.int_value = ~value.int_value;
+            break;
+        default:
+            return;
+    }
+    replace_with_constant(optimizer, slot, value);
+}
+
+static void fold_ternary(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* node = *slot;
+    ASTTernaryExpr* ternary = &node->data.ternary_expr;
+
+    fold_expression(optimizer, &ternary->condition);
+    fold_expression(optimizer, &ternary->true_expr);
+    fold_expression(optimizer, &ternary->false_expr);
+
+    ConstantValue condition;
+    if (!optimizer_constant_value(ternary->condition, &condition)) return;
+
+    ASTNode** chosen = constant_truth(&condition) ? &ternary->true_expr : &ternary->false_expr;
+    ConstantValue value;
+    if (optimizer_constant_value(*chosen, &value)) {
+        replace_with_constant(optimizer, slot, value);
+    } else if ((*chosen)->type_id == node->type_id) {
+        // O ramo escolhido já tem o tipo do resultado: basta promovê-lo
+        ASTNode* kept = *chosen;
+        *chosen = NULL;
+        ast_destroy(node);
+        *slot = kept;
+        optimizer->folded_expressions++;
+    }
+}
+
+// ------------------------------------------------------------
+// Propagação de constantes
+// ------------------------------------------------------------
+
+static unsigned int binding_hash(const Symbol* symbol, int capacity) {
+    uintptr_t key = (uintptr_t)symbol;
+    key ^= key >> 17;
+    key *= 0x9E3779B1u;
+    return (unsigned int)(key ^ (key >> 15)) & (unsigned int)(capacity - 1);
+}
+
+static ConstantBinding* find_binding(Optimizer* optimizer, const Symbol* symbol) {
+    unsigned int index = binding_hash(symbol, optimizer->binding_capacity);
+    while (optimizer->bindings[index].symbol) {
+        if (optimizer->bindings[index].symbol == symbol) {
+            return &optimizer->bindings[index];
+        }
+        index = (index + 1) & (unsigned int)(optimizer->binding_capacity - 1);
+    }
+    return &optimizer->bindings[index];
+}
+
+static void bind_constant(Optimizer* optimizer, Symbol* symbol, ASTNode* literal) {
+    // Mantém a ocupação abaixo de 1/2
+    if ((optimizer->binding_count + 1) * 2 > optimizer->binding_capacity) {
+        ConstantBinding* old = optimizer->bindings;
+        int old_capacity = optimizer->binding_capacity;
+
+        optimizer->binding_capacity *= 2;
+        optimizer->bindings = calloc(optimizer->binding_capacity, sizeof(ConstantBinding));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].symbol) {
+                *find_binding(optimizer, old[i].symbol) = old[i];
+            }
+        }
+        free(old);
+    }
+
+    ConstantBinding* binding = find_binding(optimizer, symbol);
+    binding->symbol = symbol;
+    binding->literal = literal;
+    optimizer->binding_count++;
+}
+
+// Locais nunca modificados e globais const com inicializador constante
+// têm o mesmo valor em todos os usos
+static int is_propagatable(const Symbol* symbol) {
+    if (!symbol || symbol->kind != SYMBOL_VARIABLE) return 0;
+    if (!is_arithmetic(symbol->type)) return 0;
+    if (symbol->scope_level > 0) return !symbol->info.variable.is_modified;
+    return symbol->info.variable.is_const;
+}
+
+static void record_declaration(Optimizer* optimizer, ASTNode* decl) {
+    Symbol* symbol = decl->ref.symbol;
+    ConstantValue value;
+
+    if (!is_propagatable(symbol)) return;
+    if (!optimizer_constant_value(decl->data.var_decl.initializer, &value)) return;
+    if (!convert_constant(&value, symbol->type)) return;
+
+    ASTNode* literal = make_literal(&value, decl);
+    if (literal) {
+        bind_constant(optimizer, symbol, literal);
+    }
+}
+
+static void propagate_identifier(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node->ref.symbol || optimizer->binding_count == 0) return;
+
+    ConstantBinding* binding = find_binding(optimizer, node->ref.symbol);
+    if (!binding->symbol) return;
+
+    ConstantValue value;
+    optimizer_constant_value(binding->literal, &value);
+    if (!convert_constant(&value, node->data_type)) return;
+
+    ASTNode* literal = make_literal(&value, node);
+    if (!literal) return;
+
+    ast_destroy(node);
+    *slot = literal;
+    optimizer->propagated_constants++;
+}
+
+// ------------------------------------------------------------
+// Percurso da AST
+// ------------------------------------------------------------
+
+static void fold_expression(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            propagate_identifier(optimizer, slot);
+            break;
+
+        case AST_BINARY_EXPRESSION:
+            fold_binary(optimizer, slot);
+            break;
+
+        case AST_UNARY_EXPRESSION:
+            fold_unary(optimizer, slot);
+            break;
+
+        case AST_TERNARY_EXPRESSION:
+            fold_ternary(optimizer, slot);
+            break;
+
+        case AST_ASSIGNMENT_EXPRESSION:
+            // O lado esquerdo é lvalue: só o valor atribuído é dobrado
+            fold_expression(optimizer, &node->data.binary_expr.right);
+            break;
+
+        case AST_FUNCTION_CALL:
+            for (int i = 0; i < node->child_count; i++) {
+                fold_expression(optimizer, &node->children[i]);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void fold_statement(Optimizer* optimizer, ASTNode* stmt) {
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                fold_statement(optimizer, stmt->children[i]);
+            }
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            if (stmt->data.var_decl.initializer) {
+                fold_expression(optimizer, &stmt->data.var_decl.initializer);
+                record_declaration(optimizer, stmt);
+            }
+            break;
+
+        case AST_EXPRESSION_STATEMENT:
+            if (stmt->child_count > 0) {
+                fold_expression(optimizer, &stmt->children[0]);
+            }
+            break;
+
+        case AST_IF_STATEMENT:
+            fold_expression(optimizer, &stmt->data.if_stmt.condition);
+            fold_statement(optimizer, stmt->data.if_stmt.then_stmt);
+            fold_statement(optimizer, stmt->data.if_stmt.else_stmt);
+            break;
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            fold_expression(optimizer, &stmt->data.while_stmt.condition);
+            fold_statement(optimizer, stmt->data.while_stmt.body);
+            break;
+
+        case AST_FOR_STATEMENT:
+            fold_statement(optimizer, stmt->data.for_stmt.init);
+            fold_expression(optimizer, &stmt->data.for_stmt.condition);
+            fold_expression(optimizer, &stmt->data.for_stmt.update);
+            fold_statement(optimizer, stmt->data.for_stmt.body);
+            break;
+
+        case AST_SWITCH_STATEMENT:
+            fold_expression(optimizer, &stmt->data.switch_stmt.expression);
+            fold_statement(optimizer, stmt->data.switch_stmt.cases);
+            break;
+
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                fold_statement(optimizer, stmt->children[i]);
+            }
+            break;
+
+        case AST_RETURN_STATEMENT:
+            fold_expression(optimizer, &stmt->data.return_stmt.expression);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Dobramento e propagação de constantes. As declarações são visitadas na
+// ordem do programa, então cada uso encontra o valor já registrado.
+void fold_constants(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type == AST_FUNCTION_DECLARATION) {
+            fold_statement(optimizer, decl->data.function_decl.body);
+        } else {
+            fold_statement(optimizer, decl);
+        }
+    }
+}
+
+// ------------------------------------------------------------
+// Eliminação de código morto
+// ------------------------------------------------------------
+
+static void record_removal(Optimizer* optimizer, const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (optimizer->removal_count >= optimizer->removal_capacity) {
+        optimizer->removal_capacity = optimizer->removal_capacity ? optimizer->removal_capacity * 2 : 16;
+        optimizer->removals = realloc(optimizer->removals, optimizer->removal_capacity * sizeof(char*));
+    }
+    optimizer->removals[optimizer->removal_count++] = strdup(text);
+}
+
+static const char* statement_name(const ASTNode* stmt) {
+    switch (stmt->type) {
+        case AST_VARIABLE_DECLARATION: return "declaração";
+        case AST_EXPRESSION_STATEMENT: return "expressão";
+        case AST_COMPOUND_STATEMENT: return "bloco";
+        case AST_IF_STATEMENT: return "if";
+        case AST_WHILE_STATEMENT: return "while";
+        case AST_DO_WHILE_STATEMENT: return "do-while";
+        case AST_FOR_STATEMENT: return "for";
+        case AST_SWITCH_STATEMENT: return "switch";
+        case AST_RETURN_STATEMENT: return "return";
+        case AST_BREAK_STATEMENT: return "break";
+        case AST_CONTINUE_STATEMENT: return "continue";
+        default: return "comando";
+    }
+}
+
+// Expressões sem chamadas, atribuições ou incrementos podem ser descartadas
+static int has_side_effects(const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL:
+        case AST_ASSIGNMENT_EXPRESSION:
+            return 1;
+
+        case AST_UNARY_EXPRESSION:
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT:
+                    return 1;
+                default:
+                    return has_side_effects(node->data.unary_expr.operand);
+            }
+
+        case AST_BINARY_EXPRESSION:
+            return has_side_effects(node->data.binary_expr.left) ||
+                   has_side_effects(node->data.binary_expr.right);
+
+        case AST_TERNARY_EXPRESSION:
+            return has_side_effects(node->data.ternary_expr.condition) ||
+                   has_side_effects(node->data.ternary_expr.true_expr) ||
+                   has_side_effects(node->data.ternary_expr.false_expr);
+
+        default:
+            return 0;
+    }
+}
+
+static int constant_condition(ASTNode* condition, int* truth) {
+    ConstantValue value;
+    if (!condition || !optimizer_constant_value(condition, &value)) return 0;
+    *truth = constant_truth(&value);
+    return 1;
+}
+
+// O controle pode seguir para o comando seguinte? (return, break e
+// continue desviam; um if desvia quando os dois ramos desviam)
+static int falls_through(const ASTNode* stmt) {
+    if (!stmt) return 1;
+
+    switch (stmt->type) {
+        case AST_RETURN_STATEMENT:
+        case AST_BREAK_STATEMENT:
+        case AST_CONTINUE_STATEMENT:
+            return 0;
+
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                if (!falls_through(stmt->children[i])) return 0;
+            }
+            return 1;
+
+        case AST_IF_STATEMENT:
+            return !stmt->data.if_stmt.else_stmt ||
+                   falls_through(stmt->data.if_stmt.then_stmt) ||
+                   falls_through(stmt->data.if_stmt.else_stmt);
+
+        default:
+            return 1;
+    }
+}
+
+static void remove_unreachable(Optimizer* optimizer, ASTNode** slot);
+
+// Posições que exigem um comando (ramos, corpos de laço) recebem um
+// bloco vazio quando o comando original desaparece
+static void remove_unreachable_required(Optimizer* optimizer, ASTNode** slot) {
+    remove_unreachable(optimizer, slot);
+    if (!*slot) {
+        *slot = ast_create_node(AST_COMPOUND_STATEMENT);
+    }
+}
+
+// Remove os comandos que seguem um desvio incondicional na lista.
+// Nos rótulos de switch as declarações continuam visíveis nos rótulos
+// seguintes: são mantidas, sem o inicializador.
+static void remove_unreachable_list(Optimizer* optimizer, ASTNode* list, int keep_declarations) {
+    int count = 0;
+    int reachable = 1;
+
+    for (int i = 0; i < list->child_count; i++) {
+        ASTNode* child = list->children[i];
+
+        if (!reachable) {
+            if (keep_declarations && child->type == AST_VARIABLE_DECLARATION) {
+                ast_destroy(child->data.var_decl.initializer);
+                child->data.var_decl.initializer = NULL;
+                list->children[count++] = child;
+                continue;
+            }
+            record_removal(optimizer, "%s: %s inalcançável", optimizer->current_function,
+                           statement_name(child));
+            optimizer->removed_statements++;
+            ast_destroy(child);
+            continue;
+        }
+
+        remove_unreachable(optimizer, &child);
+        if (!child) continue;
+        list->children[count++] = child;
+        reachable = falls_through(child);
+    }
+    list->child_count = count;
+}
+
+// Simplifica o comando em *slot; *slot fica NULL se ele desaparecer
+static void remove_unreachable(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+    int truth;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+            remove_unreachable_list(optimizer, stmt, 0);
+            break;
+
+        case AST_IF_STATEMENT: {
+            if (!constant_condition(stmt->data.if_stmt.condition, &truth)) {
+                remove_unreachable_required(optimizer, &stmt->data.if_stmt.then_stmt);
+                remove_unreachable(optimizer, &stmt->data.if_stmt.else_stmt);
+                break;
+            }
+
+            // Só o ramo escolhido pela condição constante permanece
+            ASTNode** taken = truth ? &stmt->data.if_stmt.then_stmt : &stmt->data.if_stmt.else_stmt;
+            ASTNode* discarded = truth ? stmt->data.if_stmt.else_stmt : stmt->data.if_stmt.then_stmt;
+            ASTNode* branch = *taken;
+            *taken = NULL;
+            if (discarded) {
+                record_removal(optimizer, "%s: ramo %s de if com condição constante",
+                               optimizer->current_function, truth ? "else" : "then");
+                optimizer->removed_statements++;
+            }
+            ast_destroy(stmt);
+            *slot = branch;
+            remove_unreachable(optimizer, slot);
+            break;
+        }
+
+        case AST_WHILE_STATEMENT:
+            if (constant_condition(stmt->data.while_stmt.condition, &truth) && !truth) {
+                record_removal(optimizer, "%s: while com condição falsa", optimizer->current_function);
+                optimizer->removed_statements++;
+                ast_destroy(stmt);
+                *slot = NULL;
+                break;
+            }
+            remove_unreachable_required(optimizer, &stmt->data.while_stmt.body);
+            break;
+
+        case AST_DO_WHILE_STATEMENT:
+            remove_unreachable_required(optimizer, &stmt->data.while_stmt.body);
+            break;
+
+        case AST_FOR_STATEMENT:
+            if (constant_condition(stmt->data.for_stmt.condition, &truth) && !truth) {
+                // A inicialização ainda executa, no escopo próprio do for
+                ASTNode* init = stmt->data.for_stmt.init;
+                stmt->data.for_stmt.init = NULL;
+                record_removal(optimizer, "%s: for com condição falsa", optimizer->current_function);
+                optimizer->removed_statements++;
+                ast_destroy(stmt);
+                *slot = NULL;
+                if (init) {
+                    *slot = ast_create_node(AST_COMPOUND_STATEMENT);
+                    ast_add_child(*slot, init);
+                }
+                break;
+            }
+            remove_unreachable_required(optimizer, &stmt->data.for_stmt.body);
+            break;
+
+        case AST_SWITCH_STATEMENT: {
+            ASTNode* cases = stmt->data.switch_stmt.cases;
+            for (int i = 0; cases && i < cases->child_count; i++) {
+                remove_unreachable_list(optimizer, cases->children[i], 1);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// ------------------------------------------------------------
+// Atribuições mortas (vivacidade sobre a IR)
+// ------------------------------------------------------------
+
+// Conjunto ordenado de ponteiros (nós da AST, símbolos) para busca binária
+typedef struct PointerSet {
+    const void** items;
+    int count;
+    int capacity;
+} PointerSet;
+
+static int compare_pointers(const void* a, const void* b) {
+    uintptr_t left = (uintptr_t)*(const void* const*)a;
+    uintptr_t right = (uintptr_t)*(const void* const*)b;
+    return left < right ? -1 : left > right;
+}
+
+static void pointer_set_add(PointerSet* set, const void* item) {
+    if (set->count >= set->capacity) {
+        set->capacity = set->capacity ? set->capacity * 2 : 16;
+        set->items = realloc(set->items, set->capacity * sizeof(void*));
+    }
+    set->items[set->count++] = item;
+}
+
+static void pointer_set_sort(PointerSet* set) {
+    if (set->count > 1) {
+        qsort(set->items, set->count, sizeof(void*), compare_pointers);
+    }
+}
+
+static int pointer_set_contains(const PointerSet* set, const void* item) {
+    return set->count > 0 &&
+           bsearch(&item, set->items, set->count, sizeof(void*), compare_pointers) != NULL;
+}
+
+// Em SSA a definição é morta quando o valor foi descartado por não
+// alimentar nenhum efeito, ou quando não está vivo na saída do bloco que
+// o define nem é usado depois dele no próprio bloco
+static int value_is_dead(IRFunction* function, const DataflowResult* liveness, int value) {
+    IRInstr* instr = function->values[value];
+    if (instr->is_dead) return 1;
+    if (bitset_test(&liveness->out[instr->block], value)) return 0;
+
+    IRBlock* block = function->blocks[instr->block];
+    int after = 0;
+    for (int i = 0; i < block->instr_count; i++) {
+        IRInstr* user = function->values[block->instrs[i]];
+        if (user == instr) {
+            after = 1;
+            continue;
+        }
+        if (!after) continue;
+        for (int j = 0; j < user->operand_count; j++) {
+            if (user->operands[j] == value) return 0;
+        }
+    }
+    return 1;
+}
+
+static void collect_dead_definitions(Optimizer* optimizer, ASTNode* program, PointerSet* dead) {
+    IRModule* module = ir_build_module(program, optimizer->symbol_table);
+
+    dead->count = 0;
+    for (int f = 0; f < module->function_count; f++) {
+        IRFunction* function = module->functions[f];
+        if (function->definition_count == 0) continue;
+
+        ir_remove_dead_values(function);
+        DominatorTree* tree = dominator_tree_build(function);
+        DataflowResult* liveness = liveness_compute(function, tree);
+        for (int i = 0; i < function->definition_count; i++) {
+            IRDefinition* definition = &function->definitions[i];
+            if (definition->value < 0 || !value_is_dead(function, liveness, definition->value)) {
+                continue;
+            }
+            pointer_set_add(dead, definition->node);
+        }
+        liveness_destroy(liveness);
+        dominator_tree_destroy(tree);
+    }
+    ir_module_destroy(module);
+    pointer_set_sort(dead);
+}
+
+static const char* assigned_name(const ASTNode* assignment) {
+    const ASTNode* target = assignment->data.binary_expr.left;
+    return target->type == AST_IDENTIFIER && target->data.identifier.name
+               ? target->data.identifier.name : "?";
+}
+
+// Atribuição morta: sobra só o lado direito, se ele tiver efeitos.
+// Retorna a expressão que substitui a atribuição (NULL se nenhuma).
+static ASTNode* strip_assignment(Optimizer* optimizer, ASTNode* assignment) {
+    ASTNode* value = NULL;
+    if (has_side_effects(assignment->data.binary_expr.right)) {
+        value = assignment->data.binary_expr.right;
+        assignment->data.binary_expr.right = NULL;
+    }
+    record_removal(optimizer, "%s: atribuição morta a '%s'", optimizer->current_function,
+                   assigned_name(assignment));
+    optimizer->removed_stores++;
+    ast_destroy(assignment);
+    return value;
+}
+
+static int remove_dead_stores(Optimizer* optimizer, ASTNode** slot, const PointerSet* dead);
+
+static int remove_dead_stores_required(Optimizer* optimizer, ASTNode** slot, const PointerSet* dead) {
+    int removed = remove_dead_stores(optimizer, slot, dead);
+    if (!*slot) {
+        *slot = ast_create_node(AST_COMPOUND_STATEMENT);
+    }
+    return removed;
+}
+
+static int remove_dead_stores_list(Optimizer* optimizer, ASTNode* list, const PointerSet* dead) {
+    int removed = 0;
+    int count = 0;
+    for (int i = 0; i < list->child_count; i++) {
+        ASTNode* child = list->children[i];
+        removed += remove_dead_stores(optimizer, &child, dead);
+        if (child) list->children[count++] = child;
+    }
+    list->child_count = count;
+    return removed;
+}
+
+// Retorna quantas atribuições foram removidas; *slot fica NULL se o
+// comando inteiro desaparecer
+static int remove_dead_stores(Optimizer* optimizer, ASTNode** slot, const PointerSet* dead) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return 0;
+    int removed = 0;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            return remove_dead_stores_list(optimizer, stmt, dead);
+
+        case AST_VARIABLE_DECLARATION: {
+            ASTNode* initializer = stmt->data.var_decl.initializer;
+            if (initializer && !has_side_effects(initializer) && pointer_set_contains(dead, stmt)) {
+                record_removal(optimizer, "%s: inicializador morto de '%s'",
+                               optimizer->current_function, stmt->data.var_decl.name);
+                optimizer->removed_stores++;
+                ast_destroy(initializer);
+                stmt->data.var_decl.initializer = NULL;
+                return 1;
+            }
+            return 0;
+        }
+
+        case AST_EXPRESSION_STATEMENT: {
+            if (stmt->child_count == 0 || !pointer_set_contains(dead, stmt->children[0])) return 0;
+            ASTNode* value = strip_assignment(optimizer, stmt->children[0]);
+            if (value) {
+                stmt->children[0] = value;
+            } else {
+                stmt->child_count = 0;
+                ast_destroy(stmt);
+                *slot = NULL;
+            }
+            return 1;
+        }
+
+        case AST_IF_STATEMENT:
+            removed += remove_dead_stores_required(optimizer, &stmt->data.if_stmt.then_stmt, dead);
+            removed += remove_dead_stores(optimizer, &stmt->data.if_stmt.else_stmt, dead);
+            return removed;
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return remove_dead_stores_required(optimizer, &stmt->data.while_stmt.body, dead);
+
+        case AST_FOR_STATEMENT: {
+            ASTNode* update = stmt->data.for_stmt.update;
+            if (update && pointer_set_contains(dead, update)) {
+                stmt->data.for_stmt.update = strip_assignment(optimizer, update);
+                removed++;
+            }
+            removed += remove_dead_stores(optimizer, &stmt->data.for_stmt.init, dead);
+            removed += remove_dead_stores_required(optimizer, &stmt->data.for_stmt.body, dead);
+            return removed;
+        }
+
+        case AST_SWITCH_STATEMENT:
+            return remove_dead_stores(optimizer, &stmt->data.switch_stmt.cases, dead);
+
+        default:
+            return 0;
+    }
+}
+
+// ------------------------------------------------------------
+// Declarações sem uso
+// ------------------------------------------------------------
+
+static void collect_references(const ASTNode* node, PointerSet* references) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            if (node->ref.symbol) pointer_set_add(references, node->ref.symbol);
+            return;
+
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            collect_references(node->data.binary_expr.left, references);
+            collect_references(node->data.binary_expr.right, references);
+            return;
+
+        case AST_UNARY_EXPRESSION:
+            collect_references(node->data.unary_expr.operand, references);
+            return;
+
+        case AST_TERNARY_EXPRESSION:
+            collect_references(node->data.ternary_expr.condition, references);
+            collect_references(node->data.ternary_expr.true_expr, references);
+            collect_references(node->data.ternary_expr.false_expr, references);
+            return;
+
+        case AST_VARIABLE_DECLARATION:
+            collect_references(node->data.var_decl.initializer, references);
+            collect_references(node->data.var_decl.array_size, references);
+            return;
+
+        case AST_IF_STATEMENT:
+            collect_references(node->data.if_stmt.condition, references);
+            collect_references(node->data.if_stmt.then_stmt, references);
+            collect_references(node->data.if_stmt.else_stmt, references);
+            return;
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            collect_references(node->data.while_stmt.condition, references);
+            collect_references(node->data.while_stmt.body, references);
+            return;
+
+        case AST_FOR_STATEMENT:
+            collect_references(node->data.for_stmt.init, references);
+            collect_references(node->data.for_stmt.condition, references);
+            collect_references(node->data.for_stmt.update, references);
+            collect_references(node->data.for_stmt.body, references);
+            return;
+
+        case AST_SWITCH_STATEMENT:
+            collect_references(node->data.switch_stmt.expression, references);
+            collect_references(node->data.switch_stmt.cases, references);
+            return;
+
+        case AST_RETURN_STATEMENT:
+            collect_references(node->data.return_stmt.expression, references);
+            return;
+
+        case AST_FUNCTION_CALL: {
+            const Symbol* function = symbol_ref_target(&node->ref);
+            if (function) pointer_set_add(references, function);
+            for (int i = 0; i < node->child_count; i++) {
+                collect_references(node->children[i], references);
+            }
+            return;
+        }
+
+        default:
+            // Blocos, rótulos de case e comandos de expressão
+            for (int i = 0; i < node->child_count; i++) {
+                collect_references(node->children[i], references);
+            }
+            return;
+    }
+}
+
+// Remove declarações de locais que ninguém mais referencia (e os blocos
+// que ficaram vazios), sobras das atribuições e ramos eliminados
+static void remove_unused_declarations(Optimizer* optimizer, ASTNode* list,
+                                       const PointerSet* references) {
+    int count = 0;
+    for (int i = 0; i < list->child_count; i++) {
+        ASTNode* child = list->children[i];
+
+        switch (child->type) {
+            case AST_COMPOUND_STATEMENT:
+                remove_unused_declarations(optimizer, child, references);
+                if (child->child_count == 0) {
+                    ast_destroy(child);
+                    continue;
+                }
+                break;
+
+            case AST_VARIABLE_DECLARATION:
+                if (!pointer_set_contains(references, child->ref.symbol) &&
+                    !has_side_effects(child->data.var_decl.initializer)) {
+                    record_removal(optimizer, "%s: declaração sem uso de '%s'",
+                                   optimizer->current_function, child->data.var_decl.name);
+                    optimizer->removed_statements++;
+                    ast_destroy(child);
+                    continue;
+                }
+                break;
+
+            case AST_IF_STATEMENT:
+                if (child->data.if_stmt.then_stmt->type == AST_COMPOUND_STATEMENT) {
+                    remove_unused_declarations(optimizer, child->data.if_stmt.then_stmt, references);
+                }
+                if (child->data.if_stmt.else_stmt &&
+                    child->data.if_stmt.else_stmt->type == AST_COMPOUND_STATEMENT) {
+                    remove_unused_declarations(optimizer, child->data.if_stmt.else_stmt, references);
+                }
+                break;
+
+            case AST_WHILE_STATEMENT:
+            case AST_DO_WHILE_STATEMENT:
+                if (child->data.while_stmt.body->type == AST_COMPOUND_STATEMENT) {
+                    remove_unused_declarations(optimizer, child->data.while_stmt.body, references);
+                }
+                break;
+
+            case AST_FOR_STATEMENT:
+                if (child->data.for_stmt.body->type == AST_COMPOUND_STATEMENT) {
+                    remove_unused_declarations(optimizer, child->data.for_stmt.body, references);
+                }
+                break;
+
+            default:
+                break;
+        }
+        list->children[count++] = child;
+    }
+    list->child_count = count;
+}
+
+// Código inalcançável (depois de return/break/continue, ramos com
+// condição constante) e atribuições a locais que nunca são lidas. A
+// remoção de uma atribuição pode matar as que a alimentavam, então a
+// vivacidade é recalculada até nada mais mudar. Por fim saem as
+// declarações que ficaram sem uso.
+void eliminate_dead_code(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+        optimizer->current_function = decl->data.function_decl.name;
+        remove_unreachable_list(optimizer, decl->data.function_decl.body, 0);
+    }
+
+    PointerSet dead = {0};
+    int removed = 1;
+    while (removed > 0) {
+        collect_dead_definitions(optimizer, program, &dead);
+        if (dead.count == 0) break;
+
+        removed = 0;
+        for (int i = 0; i < program->child_count; i++) {
+            ASTNode* decl = program->children[i];
+            if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+            optimizer->current_function = decl->data.function_decl.name;
+            removed += remove_dead_stores_list(optimizer, decl->data.function_decl.body, &dead);
+        }
+    }
+    free(dead.items);
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+
+        PointerSet references = {0};
+        collect_references(decl->data.function_decl.body, &references);
+        pointer_set_sort(&references);
+        optimizer->current_function = decl->data.function_decl.name;
+        remove_unused_declarations(optimizer, decl->data.function_decl.body, &references);
+        free(references.items);
+    }
+    optimizer->current_function = NULL;
+}
+
+// ------------------------------------------------------------
+// Temporários do otimizador
+//
+// LICM e CSE guardam valores em locais novos. Os backends trabalham
+// sobre a AST: o temporário é um local comum, com slot no frame,
+// símbolo na tabela e declaração no início do corpo da função.
+// ------------------------------------------------------------
+
+// Globais e estáticas podem mudar em qualquer chamada
+static int is_shared_variable(const Symbol* symbol) {
+    return symbol->kind == SYMBOL_VARIABLE &&
+           (symbol->scope_level == 0 || symbol->info.variable.is_static);
+}
+
+// Chamada que pode escrever na memória (função impura ou desconhecida)
+static int call_writes_memory(const ASTNode* call) {
+    const Symbol* function = symbol_ref_target(&call->ref);
+    return !function || function->kind != SYMBOL_FUNCTION ||
+           function->info.function.purity == FUNCTION_IMPURE;
+}
+
+// Variáveis atribuídas (e declaradas) numa expressão ou comando; has_calls
+// indica que algo nele pode escrever na memória: chamada impura ou
+// atribuição por outro caminho que não uma variável
+static void collect_assignments(const ASTNode* node, PointerSet* assigned, int* has_calls) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_ASSIGNMENT_EXPRESSION:
+            if (node->data.binary_expr.left->type == AST_IDENTIFIER &&
+                node->data.binary_expr.left->ref.symbol) {
+                pointer_set_add(assigned, node->data.binary_expr.left->ref.symbol);
+            } else {
+                *has_calls = 1;
+            }
+            collect_assignments(node->data.binary_expr.left, assigned, has_calls);
+            collect_assignments(node->data.binary_expr.right, assigned, has_calls);
+            return;
+
+        case AST_BINARY_EXPRESSION:
+            collect_assignments(node->data.binary_expr.left, assigned, has_calls);
+            collect_assignments(node->data.binary_expr.right, assigned, has_calls);
+            return;
+
+        case AST_UNARY_EXPRESSION: {
+            const ASTNode* operand = node->data.unary_expr.operand;
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT:
+                    if (operand->type == AST_IDENTIFIER && operand->ref.symbol) {
+                        pointer_set_add(assigned, operand->ref.symbol);
+                    } else {
+                        *has_calls = 1;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            collect_assignments(operand, assigned, has_calls);
+            return;
+        }
+
+        case AST_TERNARY_EXPRESSION:
+            collect_assignments(node->data.ternary_expr.condition, assigned, has_calls);
+            collect_assignments(node->data.ternary_expr.true_expr, assigned, has_calls);
+            collect_assignments(node->data.ternary_expr.false_expr, assigned, has_calls);
+            return;
+
+        case AST_FUNCTION_CALL:
+            if (call_writes_memory(node)) *has_calls = 1;
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            if (node->ref.symbol) pointer_set_add(assigned, node->ref.symbol);
+            collect_assignments(node->data.var_decl.initializer, assigned, has_calls);
+            return;
+
+        case AST_IF_STATEMENT:
+            collect_assignments(node->data.if_stmt.condition, assigned, has_calls);
+            collect_assignments(node->data.if_stmt.then_stmt, assigned, has_calls);
+            collect_assignments(node->data.if_stmt.else_stmt, assigned, has_calls);
+            return;
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            collect_assignments(node->data.while_stmt.condition, assigned, has_calls);
+            collect_assignments(node->data.while_stmt.body, assigned, has_calls);
+            return;
+
+        case AST_FOR_STATEMENT:
+            collect_assignments(node->data.for_stmt.init, assigned, has_calls);
+            collect_assignments(node->data.for_stmt.condition, assigned, has_calls);
+            collect_assignments(node->data.for_stmt.update, assigned, has_calls);
+            collect_assignments(node->data.for_stmt.body, assigned, has_calls);
+            return;
+
+        case AST_SWITCH_STATEMENT:
+            collect_assignments(node->data.switch_stmt.expression, assigned, has_calls);
+            collect_assignments(node->data.switch_stmt.cases, assigned, has_calls);
+            return;
+
+        case AST_RETURN_STATEMENT:
+            collect_assignments(node->data.return_stmt.expression, assigned, has_calls);
+            return;
+
+        default:
+            break;
+    }
+
+    for (int i = 0; i < node->child_count; i++) {
+        collect_assignments(node->children[i], assigned, has_calls);
+    }
+}
+
+static void insert_children(ASTNode* list, int index, ASTNode** items, int count) {
+    if (list->child_count + count > list->child_capacity) {
+        list->child_capacity = (list->child_count + count) * 2;
+        list->children = realloc(list->children, list->child_capacity * sizeof(ASTNode*));
+    }
+    memmove(&list->children[index + count], &list->children[index],
+            (list->child_count - index) * sizeof(ASTNode*));
+    memcpy(&list->children[index], items, count * sizeof(ASTNode*));
+    list->child_count += count;
+}
+
+
+static ASTNode* make_variable_reference(Symbol* symbol, const ASTNode* origin) {
+    ASTNode* node = ast_create_node(AST_IDENTIFIER);
+    node->data.identifier.name = strdup(symbol->name);
+    node->data_type = symbol->type;
+    node->type_id = symbol->type_id;
+    node->line = origin->line;
+    node->column = origin->column;
+    node->ref.symbol = symbol;
+    node->ref.depth = symbol->scope_level;
+    node->ref.slot = symbol->info.variable.slot;
+    return node;
+}
+
+static ASTNode* make_temporary_assignment(Symbol* temporary, ASTNode* value) {
+    ASTNode* node = ast_create_node(AST_ASSIGNMENT_EXPRESSION);
+    node->data.binary_expr.operator = TOKEN_ASSIGN;
+    node->data.binary_expr.left = make_variable_reference(temporary, value);
+    node->data.binary_expr.right = value;
+    node->data_type = temporary->type;
+    node->type_id = temporary->type_id;
+    node->line = value->line;
+    node->column = value->column;
+    return node;
+}
+
+// Numerado pelo contador da tabela de símbolos, o mesmo de
+// generate_temp_var: o C gerado nunca repete um _temp_N. O slot vem
+// depois, em allocate_temporary, só para os temporários que ficarem
+static Symbol* create_temporary_symbol(Optimizer* optimizer, const ASTNode* expression) {
+    char name[32];
+    snprintf(name, sizeof(name), "_temp_%d", optimizer->symbol_table->temp_counter++);
+    Symbol* symbol = symbol_create_variable(name, expression->data_type, expression->line, expression->column);
+    symbol->type_id = expression->type_id;
+    symbol->scope_level = 1;
+    symbol->info.variable.is_initialized = 1;
+    symbol->info.variable.is_modified = 1;
+    return symbol;
+}
+
+static void allocate_temporary(Optimizer* optimizer, ASTNode* decl, Symbol* symbol) {
+    ASTFunctionDecl* function = &decl->data.function_decl;
+    TypeTable* types = optimizer->symbol_table->types;
+    int size = type_size(types, symbol->type_id);
+    int align = type_alignment(types, symbol->type_id);
+    function->frame_size = (function->frame_size + size + align - 1) / align * align;
+    symbol->info.variable.slot = function->local_count++;
+    symbol->info.variable.offset = -function->frame_size;
+}
+
+// Símbolos na tabela (escopo da função) e declarações no início do corpo
+static void declare_temporaries(Optimizer* optimizer, ASTNode* decl, Symbol** temporaries, int count) {
+    ASTFunctionDecl* function = &decl->data.function_decl;
+    SymbolTable* table = optimizer->symbol_table;
+    if (count == 0) return;
+
+    ASTNode** declarations = malloc(count * sizeof(ASTNode*));
+    symbol_table_enter_scope(table, function->name);
+    for (int i = 0; i < count; i++) {
+        Symbol* symbol = temporaries[i];
+        symbol_table_insert(table, symbol);
+
+        ASTNode* declaration = ast_create_node(AST_VARIABLE_DECLARATION);
+        declaration->data.var_decl.name = strdup(symbol->name);
+        declaration->data.var_decl.var_type = symbol->type;
+        declaration->data_type = symbol->type;
+        declaration->type_id = symbol->type_id;
+        declaration->line = symbol->line;
+        declaration->column = symbol->column;
+        declaration->ref.symbol = symbol;
+        declaration->ref.depth = symbol->scope_level;
+        declaration->ref.slot = symbol->info.variable.slot;
+        declarations[i] = declaration;
+    }
+    symbol_table_exit_scope(table);
+    insert_children(function->body, 0, declarations, count);
+    free(declarations);
+}
+
+// ------------------------------------------------------------
+// Subexpressões comuns (numeração de valores)
+//
+// Cada expressão recebe um número de valor: variáveis pelo valor que
+// guardam no ponto, literais pelo texto e operações pela tupla
+// (operador, tipo, operandos), buscada numa tabela de hash. Uma operação
+// cujo valor já foi calculado num ponto que domina o atual vira a
+// leitura de um temporário. A disponibilidade segue os escopos da AST,
+// que no código estruturado coincidem com a árvore de dominadores: o
+// que foi calculado num ramo, corpo de laço ou rótulo de case deixa de
+// valer ao sair dele.
+// ------------------------------------------------------------
+
+// Laço que o backend assembly vai vetorizar: os passes que reescrevem o
+// corpo (subexpressões, desenrolamento e induções) o deixam no formato
+// que o vetorizador reconhece
+static int left_for_vectorizer(const Optimizer* optimizer, ASTNode* loop) {
+    VectorLoop info;
+    return optimizer->vectorize && vector_loop_analyze(loop, &info);
+}
+
+typedef struct ValueKey {
+    char* text;
+    int value;
+} ValueKey;
+
+typedef struct SymbolValue {
+    Symbol* symbol;
+    int value;
+} SymbolValue;
+
+typedef struct AvailableExpression {
+    int value;
+    ASTNode** slot;        // Primeira ocorrência (NULL depois de ganhar temporário)
+    Symbol* temporary;
+    Symbol* holder;        // Local que recebeu o valor na primeira ocorrência
+    int expression;        // Expressão completa onde foi calculada
+    int conditional;       // Calculada só num trecho condicional (&&, ||, ?:)
+} AvailableExpression;
+
+typedef struct AssignmentLog {
+    Symbol* symbol;
+    int previous;
+} AssignmentLog;
+
+typedef struct ScopeMark {
+    int entries;
+    int declared;
+} ScopeMark;
+
+typedef struct ValueNumbering {
+    Optimizer* optimizer;
+
+    // Chaves textuais das operações e literais: endereçamento aberto
+    ValueKey* keys;
+    int key_count;
+    int key_capacity;
+    int value_count;
+
+    // Valor atual de cada variável: endereçamento aberto pelo ponteiro
+    SymbolValue* symbols;
+    int symbol_count;
+    int symbol_capacity;
+
+    // Expressões disponíveis, empilhadas por escopo
+    AvailableExpression* entries;
+    int entry_count;
+    int entry_capacity;
+    int* available;        // Valor -> entrada disponível (-1 se nenhuma)
+    int available_capacity;
+    ScopeMark* scopes;
+    int scope_count;
+    int scope_capacity;
+
+    // Atribuições desfeitas ao fim de ramos e laços
+    AssignmentLog* log;
+    int log_count;
+    int log_capacity;
+
+    // Locais visíveis, em ordem de declaração (nomes sombreados)
+    Symbol** declared;
+    int declared_count;
+    int declared_capacity;
+
+    // Comandos extraídos, inseridos antes do comando atual
+    ASTNode** pending;
+    int pending_count;
+    int pending_capacity;
+
+    // Temporários criados (ordenados no fim da função)
+    PointerSet temporaries;
+    PointerSet extracted;  // Gravados num comando antes da expressão
+    int* read_counts;
+    ASTNode** inlined;     // Valor devolvido ao único uso
+    int holder_reuses;
+    int reused;
+
+    // Expressão completa atual
+    int expression;
+    int extractable;       // Pode receber comandos antes dela
+    int conditional;
+    PointerSet assigned;   // Variáveis atribuídas nela
+    int has_calls;
+    int frozen;            // Dentro de um laço deixado para o vetorizador
+} ValueNumbering;
+
+static void* grow_array(void* items, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return items;
+    while (*capacity < needed) {
+        *capacity = *capacity ? *capacity * 2 : 16;
+    }
+    return realloc(items, *capacity * size);
+}
+
+static int new_value(ValueNumbering* vn) {
+    return vn->value_count++;
+}
+
+static unsigned int text_hash(const char* text) {
+    unsigned int hash = 2166136261u;
+    for (; *text; text++) {
+        hash = (hash ^ (unsigned char)*text) * 16777619u;
+    }
+    return hash;
+}
+
+static ValueKey* find_key(ValueKey* keys, int capacity, const char* text) {
+    unsigned int index = text_hash(text) & (capacity - 1);
+    while (keys[index].text && strcmp(keys[index].text, text) != 0) {
+        index = (index + 1) & (capacity - 1);
+    }
+    return &keys[index];
+}
+
+// Número de valor associado à chave (um novo na primeira vez)
+static int intern_value(ValueNumbering* vn, const char* text) {
+    if ((vn->key_count + 1) * 10 >= vn->key_capacity * 7) {
+        int old_capacity = vn->key_capacity;
+        ValueKey* old = vn->keys;
+        vn->key_capacity = old_capacity ? old_capacity * 2 : 64;
+        vn->keys = calloc(vn->key_capacity, sizeof(ValueKey));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].text) *find_key(vn->keys, vn->key_capacity, old[i].text) = old[i];
+        }
+        free(old);
+    }
+
+    ValueKey* key = find_key(vn->keys, vn->key_capacity, text);
+    if (!key->text) {
+        key->text = strdup(text);
+        key->value = new_value(vn);
+        vn->key_count++;
+    }
+    return key->value;
+}
+
+static SymbolValue* find_symbol_value(SymbolValue* symbols, int capacity, const Symbol* symbol) {
+    unsigned int index = (unsigned int)(((uintptr_t)symbol >> 4) & (capacity - 1));
+    while (symbols[index].symbol && symbols[index].symbol != symbol) {
+        index = (index + 1) & (capacity - 1);
+    }
+    return &symbols[index];
+}
+
+// Valor atual da variável (um novo no primeiro uso)
+static SymbolValue* symbol_value_entry(ValueNumbering* vn, Symbol* symbol) {
+    if ((vn->symbol_count + 1) * 10 >= vn->symbol_capacity * 7) {
+        int old_capacity = vn->symbol_capacity;
+        SymbolValue* old = vn->symbols;
+        vn->symbol_capacity = old_capacity ? old_capacity * 2 : 64;
+        vn->symbols = calloc(vn->symbol_capacity, sizeof(SymbolValue));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].symbol) *find_symbol_value(vn->symbols, vn->symbol_capacity, old[i].symbol) = old[i];
+        }
+        free(old);
+    }
+
+    SymbolValue* entry = find_symbol_value(vn->symbols, vn->symbol_capacity, symbol);
+    if (!entry->symbol) {
+        entry->symbol = symbol;
+        entry->value = new_value(vn);
+        vn->symbol_count++;
+    }
+    return entry;
+}
+
+static int symbol_value(ValueNumbering* vn, Symbol* symbol) {
+    return symbol_value_entry(vn, symbol)->value;
+}
+
+static void assign_value(ValueNumbering* vn, Symbol* symbol, int value) {
+    SymbolValue* entry = symbol_value_entry(vn, symbol);
+    vn->log = grow_array(vn->log, &vn->log_capacity, vn->log_count + 1, sizeof(AssignmentLog));
+    vn->log[vn->log_count].symbol = symbol;
+    vn->log[vn->log_count].previous = entry->value;
+    vn->log_count++;
+    entry->value = value;
+}
+
+static void invalidate_shared(ValueNumbering* vn) {
+    for (int i = 0; i < vn->symbol_capacity; i++) {
+        Symbol* symbol = vn->symbols[i].symbol;
+        if (symbol && is_shared_variable(symbol)) assign_value(vn, symbol, new_value(vn));
+    }
+}
+
+// Desfaz as atribuições feitas desde mark, anotando as variáveis tocadas
+static void undo_assignments(ValueNumbering* vn, int mark, PointerSet* touched) {
+    while (vn->log_count > mark) {
+        AssignmentLog* entry = &vn->log[--vn->log_count];
+        symbol_value_entry(vn, entry->symbol)->value = entry->previous;
+        pointer_set_add(touched, entry->symbol);
+    }
+}
+
+// Variáveis que chegam por mais de um caminho ganham valor desconhecido
+static void refresh_symbols(ValueNumbering* vn, PointerSet* touched) {
+    pointer_set_sort(touched);
+    int count = 0;
+    for (int i = 0; i < touched->count; i++) {
+        if (count > 0 && touched->items[count - 1] == touched->items[i]) continue;
+        touched->items[count++] = touched->items[i];
+        assign_value(vn, (Symbol*)touched->items[i], new_value(vn));
+    }
+    touched->count = count;
+}
+
+static int available_entry(ValueNumbering* vn, int value) {
+    return value >= 0 && value < vn->available_capacity ? vn->available[value] : -1;
+}
+
+static void make_available(ValueNumbering* vn, int value, ASTNode** slot) {
+    if (value >= vn->available_capacity) {
+        int old_capacity = vn->available_capacity;
+        vn->available = grow_array(vn->available, &vn->available_capacity, vn->value_count, sizeof(int));
+        for (int i = old_capacity; i < vn->available_capacity; i++) vn->available[i] = -1;
+    }
+
+    vn->entries = grow_array(vn->entries, &vn->entry_capacity, vn->entry_count + 1,
+                             sizeof(AvailableExpression));
+    AvailableExpression* entry = &vn->entries[vn->entry_count];
+    entry->value = value;
+    entry->slot = slot;
+    entry->temporary = NULL;
+    entry->holder = NULL;
+    entry->expression = vn->expression;
+    entry->conditional = vn->conditional > 0;
+    vn->available[value] = vn->entry_count++;
+}
+
+static void truncate_entries(ValueNumbering* vn, int count) {
+    while (vn->entry_count > count) {
+        vn->available[vn->entries[--vn->entry_count].value] = -1;
+    }
+}
+
+static void push_scope(ValueNumbering* vn) {
+    vn->scopes = grow_array(vn->scopes, &vn->scope_capacity, vn->scope_count + 1, sizeof(ScopeMark));
+    vn->scopes[vn->scope_count].entries = vn->entry_count;
+    vn->scopes[vn->scope_count].declared = vn->declared_count;
+    vn->scope_count++;
+}
+
+static void pop_scope(ValueNumbering* vn) {
+    ScopeMark mark = vn->scopes[--vn->scope_count];
+    truncate_entries(vn, mark.entries);
+    vn->declared_count = mark.declared;
+}
+
+static void declare_local(ValueNumbering* vn, Symbol* symbol) {
+    vn->declared = grow_array(vn->declared, &vn->declared_capacity, vn->declared_count + 1, sizeof(Symbol*));
+    vn->declared[vn->declared_count++] = symbol;
+}
+
+// A saída em C refere-se às variáveis pelo nome: a que guarda o valor
+// só serve se ainda for visível e não estiver sombreada
+static int holder_visible(ValueNumbering* vn, const Symbol* holder) {
+    for (int i = vn->declared_count - 1; i >= 0; i--) {
+        if (vn->declared[i] == holder) return 1;
+        if (strcmp(vn->declared[i]->name, holder->name) == 0) return 0;
+    }
+    return 0;
+}
+
+// Antes do laço, tudo o que ele atribui (e as globais, se houver
+// chamadas) perde o valor conhecido: a volta traz valores novos
+static void enter_loop(ValueNumbering* vn, const ASTNode* loop) {
+    PointerSet assigned = {0};
+    int has_calls = 0;
+    collect_assignments(loop, &assigned, &has_calls);
+    refresh_symbols(vn, &assigned);
+    if (has_calls) invalidate_shared(vn);
+    free(assigned.items);
+}
+
+static void begin_expression(ValueNumbering* vn, const ASTNode* expression, int extractable) {
+    vn->expression++;
+    vn->extractable = extractable;
+    vn->assigned.count = 0;
+    vn->has_calls = 0;
+    if (extractable) {
+        collect_assignments(expression, &vn->assigned, &vn->has_calls);
+        pointer_set_sort(&vn->assigned);
+    }
+}
+
+static int is_value_operator(TokenType op) {
+    switch (op) {
+        case TOKEN_PLUS: case TOKEN_MINUS: case TOKEN_MULTIPLY:
+        case TOKEN_DIVIDE: case TOKEN_MODULO:
+        case TOKEN_EQUAL: case TOKEN_NOT_EQUAL:
+        case TOKEN_LESS: case TOKEN_GREATER:
+        case TOKEN_LESS_EQUAL: case TOKEN_GREATER_EQUAL:
+        case TOKEN_BITWISE_AND: case TOKEN_BITWISE_OR: case TOKEN_BITWISE_XOR:
+        case TOKEN_LEFT_SHIFT: case TOKEN_RIGHT_SHIFT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int is_commutative(TokenType op) {
+    return op == TOKEN_PLUS || op == TOKEN_MULTIPLY || op == TOKEN_EQUAL || op == TOKEN_NOT_EQUAL ||
+           op == TOKEN_BITWISE_AND || op == TOKEN_BITWISE_OR || op == TOKEN_BITWISE_XOR;
+}
+
+static int is_scalar_operand(const ASTNode* node) {
+    return node && is_arithmetic(node->data_type);
+}
+
+// Operações aritméticas puras sobre int/char/float, que valem a pena
+// guardar num temporário
+static int is_value_candidate(const ASTNode* node) {
+    if (node->data_type != TYPE_INT && node->data_type != TYPE_FLOAT) return 0;
+    if (node->type_id < 0 || has_side_effects(node)) return 0;
+
+    if (node->type == AST_BINARY_EXPRESSION) {
+        return is_value_operator(node->data.binary_expr.operator) &&
+               is_scalar_operand(node->data.binary_expr.left) &&
+               is_scalar_operand(node->data.binary_expr.right);
+    }
+    if (node->type == AST_UNARY_EXPRESSION) {
+        const ASTNode* operand = node->data.unary_expr.operand;
+        UnaryOperator op = node->data.unary_expr.operator;
+        ConstantValue constant;
+        return (op == UNARY_MINUS || op == UNARY_NOT || op == UNARY_BITWISE_NOT) &&
+               is_scalar_operand(operand) && !optimizer_constant_value((ASTNode*)operand, &constant);
+    }
+    return 0;
+}
+
+// Calcular a expressão antes do comando dá o mesmo resultado se nenhum
+// operando muda dentro dele e se nada que ele chama pode interferir
+static int can_hoist(ValueNumbering* vn, const ASTNode* node) {
+    if (!node) return 1;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            if (!node->ref.symbol) return 0;
+            if (pointer_set_contains(&vn->assigned, node->ref.symbol)) return 0;
+            return !vn->has_calls || !is_shared_variable(node->ref.symbol);
+
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+        case AST_CHAR_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+            return 1;
+
+        case AST_BINARY_EXPRESSION: {
+            TokenType op = node->data.binary_expr.operator;
+            // Uma divisão adiantada poderia falhar antes das chamadas
+            if (vn->has_calls && (op == TOKEN_DIVIDE || op == TOKEN_MODULO)) return 0;
+            return is_value_operator(op) &&
+                   can_hoist(vn, node->data.binary_expr.left) &&
+                   can_hoist(vn, node->data.binary_expr.right);
+        }
+
+        case AST_UNARY_EXPRESSION:
+            return is_value_candidate(node) && can_hoist(vn, node->data.unary_expr.operand);
+
+        default:
+            return 0;
+    }
+}
+
+static Symbol* create_temporary(ValueNumbering* vn, const ASTNode* expression) {
+    Symbol* symbol = create_temporary_symbol(vn->optimizer, expression);
+    pointer_set_add(&vn->temporaries, symbol);
+    return symbol;
+}
+
+// Troca a ocorrência em *slot pela leitura do valor já calculado.
+// Na primeira reutilização a ocorrência original passa a gravar um
+// temporário: no lugar, se estiver num comando anterior, ou num comando
+// novo logo antes do atual (os operandos de uma mesma expressão não têm
+// ordem de avaliação definida em C).
+static int reuse_expression(ValueNumbering* vn, int index, ASTNode** slot) {
+    AvailableExpression* entry = &vn->entries[index];
+    int same_expression = entry->expression == vn->expression;
+    Symbol* source = entry->temporary;
+
+    if (!source && !same_expression && entry->holder &&
+        symbol_value(vn, entry->holder) == entry->value && holder_visible(vn, entry->holder)) {
+        source = entry->holder;
+        vn->holder_reuses++;
+    }
+
+    if (!source) {
+        ASTNode* expression = *entry->slot;
+        if (same_expression && (!vn->extractable || entry->conditional || !can_hoist(vn, expression))) {
+            return 0;
+        }
+
+        source = create_temporary(vn, expression);
+        if (same_expression) {
+            ASTNode* stmt = ast_create_node(AST_EXPRESSION_STATEMENT);
+            *entry->slot = make_variable_reference(source, expression);
+            ast_add_child(stmt, make_temporary_assignment(source, expression));
+            pointer_set_add(&vn->extracted, source);
+            vn->pending = grow_array(vn->pending, &vn->pending_capacity, vn->pending_count + 1, sizeof(ASTNode*));
+            vn->pending[vn->pending_count++] = stmt;
+        } else {
+            *entry->slot = make_temporary_assignment(source, expression);
+        }
+        entry->temporary = source;
+        entry->slot = NULL;
+    }
+
+    ASTNode* origin = *slot;
+    *slot = make_variable_reference(source, origin);
+    ast_destroy(origin);
+    return 1;
+}
+
+static int number_expression(ValueNumbering* vn, ASTNode** slot);
+
+static int number_operation(ValueNumbering* vn, ASTNode** slot) {
+    ASTNode* node = *slot;
+    int mark = vn->entry_count;
+    char key[96];
+
+    if (node->type == AST_BINARY_EXPRESSION) {
+        TokenType op = node->data.binary_expr.operator;
+        int left = number_expression(vn, &node->data.binary_expr.left);
+        int right = number_expression(vn, &node->data.binary_expr.right);
+        if (is_commutative(op) && left > right) {
+            int swap = left;
+            left = right;
+            right = swap;
+        }
+        snprintf(key, sizeof(key), "b%d:%d:%d:%d", (int)op, node->type_id, left, right);
+    } else {
+        int operand = number_expression(vn, &node->data.unary_expr.operand);
+        snprintf(key, sizeof(key), "u%d:%d:%d", (int)node->data.unary_expr.operator, node->type_id, operand);
+    }
+
+    int value = intern_value(vn, key);
+    int index = available_entry(vn, value);
+    if (index < 0) {
+        make_available(vn, value, slot);
+    } else if (!vn->frozen && reuse_expression(vn, index, slot)) {
+        // O que foi registrado dentro da ocorrência descartada some com ela
+        truncate_entries(vn, mark);
+    }
+    return value;
+}
+
+static int literal_value(ValueNumbering* vn, const ASTNode* node) {
+    const char* text = node->data.literal.value;
+    char key[96];
+    if (!text || strlen(text) > 64) return new_value(vn);
+    snprintf(key, sizeof(key), "l%d:%d:%s", (int)node->type, node->type_id, text);
+    return intern_value(vn, key);
+}
+
+// Atribuição a uma variável: ela passa a ter o valor do lado direito
+// (se o tipo for o mesmo) e pode servir de fonte para reutilizações
+static int record_assignment(ValueNumbering* vn, Symbol* symbol, ASTNode** value_slot, int value) {
+    if (!symbol) return new_value(vn);
+
+    ASTNode* value_node = value_slot ? *value_slot : NULL;
+    if (value < 0 || !value_node || value_node->type_id != symbol->type_id) {
+        value = new_value(vn);
+    }
+    assign_value(vn, symbol, value);
+
+    int index = available_entry(vn, value);
+    if (index >= 0 && !is_shared_variable(symbol)) {
+        AvailableExpression* entry = &vn->entries[index];
+        if (entry->slot == value_slot && !entry->holder) entry->holder = symbol;
+    }
+    return value;
+}
+
+// Trechos avaliados só às vezes: o que calculam não fica disponível
+// depois, e as variáveis que atribuem ficam com valor desconhecido
+static void number_conditional(ValueNumbering* vn, ASTNode** slot) {
+    PointerSet touched = {0};
+    int mark = vn->log_count;
+
+    vn->conditional++;
+    push_scope(vn);
+    number_expression(vn, slot);
+    pop_scope(vn);
+    vn->conditional--;
+
+    undo_assignments(vn, mark, &touched);
+    refresh_symbols(vn, &touched);
+    free(touched.items);
+}
+
+// Retorna o número de valor da expressão em *slot
+static int number_expression(ValueNumbering* vn, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return -1;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return node->ref.symbol ? symbol_value(vn, node->ref.symbol) : new_value(vn);
+
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+        case AST_CHAR_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+            return literal_value(vn, node);
+
+        case AST_ASSIGNMENT_EXPRESSION: {
+            ASTNode* target = node->data.binary_expr.left;
+            int value = number_expression(vn, &node->data.binary_expr.right);
+            if (target->type != AST_IDENTIFIER) {
+                number_expression(vn, &node->data.binary_expr.left);
+                return new_value(vn);
+            }
+            return record_assignment(vn, target->ref.symbol, &node->data.binary_expr.right, value);
+        }
+
+        case AST_UNARY_EXPRESSION: {
+            ASTNode* operand = node->data.unary_expr.operand;
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT:
+                    if (operand->type == AST_IDENTIFIER && operand->ref.symbol) {
+                        assign_value(vn, operand->ref.symbol, new_value(vn));
+                    } else {
+                        number_expression(vn, &node->data.unary_expr.operand);
+                    }
+                    return new_value(vn);
+                default:
+                    break;
+            }
+            if (is_value_candidate(node)) return number_operation(vn, slot);
+            number_expression(vn, &node->data.unary_expr.operand);
+            return new_value(vn);
+        }
+
+        case AST_BINARY_EXPRESSION: {
+            TokenType op = node->data.binary_expr.operator;
+            if (op == TOKEN_AND || op == TOKEN_OR) {
+                number_expression(vn, &node->data.binary_expr.left);
+                number_conditional(vn, &node->data.binary_expr.right);
+                return new_value(vn);
+            }
+            if (is_value_candidate(node)) return number_operation(vn, slot);
+            number_expression(vn, &node->data.binary_expr.left);
+            number_expression(vn, &node->data.binary_expr.right);
+            return new_value(vn);
+        }
+
+        case AST_TERNARY_EXPRESSION:
+            number_expression(vn, &node->data.ternary_expr.condition);
+            number_conditional(vn, &node->data.ternary_expr.true_expr);
+            number_conditional(vn, &node->data.ternary_expr.false_expr);
+            return new_value(vn);
+
+        case AST_FUNCTION_CALL:
+            for (int i = 0; i < node->child_count; i++) {
+                number_expression(vn, &node->children[i]);
+            }
+            if (call_writes_memory(node)) invalidate_shared(vn);
+            return new_value(vn);
+
+        default:
+            return new_value(vn);
+    }
+}
+
+static void number_statement(ValueNumbering* vn, ASTNode** slot);
+
+// Numera a lista e insere os comandos extraídos antes de cada comando
+static void number_list(ValueNumbering* vn, ASTNode* list) {
+    int base = vn->pending_count;
+
+    for (int i = 0; i < list->child_count; i++) {
+        number_statement(vn, &list->children[i]);
+
+        int extra = vn->pending_count - base;
+        if (extra == 0) continue;
+        insert_children(list, i, &vn->pending[base], extra);
+        vn->pending_count = base;
+        i += extra;
+    }
+}
+
+// Comando num ramo ou corpo de laço, com escopo próprio. Os comandos
+// extraídos das suas expressões vão para um bloco junto com ele.
+static void number_branch(ValueNumbering* vn, ASTNode** slot) {
+    int base = vn->pending_count;
+
+    push_scope(vn);
+    number_statement(vn, slot);
+    pop_scope(vn);
+
+    if (vn->pending_count > base && *slot) {
+        ASTNode* block = ast_create_node(AST_COMPOUND_STATEMENT);
+        for (int i = base; i < vn->pending_count; i++) {
+            ast_add_child(block, vn->pending[i]);
+        }
+        ast_add_child(block, *slot);
+        *slot = block;
+    }
+    vn->pending_count = base;
+}
+
+static void number_statement(ValueNumbering* vn, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+    PointerSet touched = {0};
+    int mark;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+            push_scope(vn);
+            number_list(vn, stmt);
+            pop_scope(vn);
+            break;
+
+        case AST_VARIABLE_DECLARATION: {
+            ASTNode** initializer = &stmt->data.var_decl.initializer;
+            int value = -1;
+            if (*initializer) {
+                begin_expression(vn, *initializer, 1);
+                value = number_expression(vn, initializer);
+            }
+            if (stmt->ref.symbol) {
+                declare_local(vn, stmt->ref.symbol);
+                record_assignment(vn, stmt->ref.symbol, *initializer ? initializer : NULL, value);
+            }
+            break;
+        }
+
+        case AST_EXPRESSION_STATEMENT:
+            if (stmt->child_count > 0) {
+                begin_expression(vn, stmt->children[0], 1);
+                number_expression(vn, &stmt->children[0]);
+            }
+            break;
+
+        case AST_RETURN_STATEMENT:
+            if (stmt->data.return_stmt.expression) {
+                begin_expression(vn, stmt->data.return_stmt.expression, 1);
+                number_expression(vn, &stmt->data.return_stmt.expression);
+            }
+            break;
+
+        case AST_IF_STATEMENT:
+            begin_expression(vn, stmt->data.if_stmt.condition, 1);
+            number_expression(vn, &stmt->data.if_stmt.condition);
+            mark = vn->log_count;
+            number_branch(vn, &stmt->data.if_stmt.then_stmt);
+            undo_assignments(vn, mark, &touched);
+            number_branch(vn, &stmt->data.if_stmt.else_stmt);
+            undo_assignments(vn, mark, &touched);
+            refresh_symbols(vn, &touched);
+            break;
+
+        // A condição de um laço é reavaliada a cada volta: nada dela pode
+        // ser calculado antes do laço
+        case AST_WHILE_STATEMENT:
+            mark = vn->log_count;
+            enter_loop(vn, stmt);
+            push_scope(vn);
+            begin_expression(vn, stmt->data.while_stmt.condition, 0);
+            number_expression(vn, &stmt->data.while_stmt.condition);
+            number_branch(vn, &stmt->data.while_stmt.body);
+            pop_scope(vn);
+            undo_assignments(vn, mark, &touched);
+            refresh_symbols(vn, &touched);
+            break;
+
+        case AST_DO_WHILE_STATEMENT: {
+            mark = vn->log_count;
+            enter_loop(vn, stmt);
+            int body_mark = vn->log_count;
+            push_scope(vn);
+            number_branch(vn, &stmt->data.while_stmt.body);
+            // continue salta para a condição de qualquer ponto do corpo
+            undo_assignments(vn, body_mark, &touched);
+            refresh_symbols(vn, &touched);
+            begin_expression(vn, stmt->data.while_stmt.condition, 0);
+            number_expression(vn, &stmt->data.while_stmt.condition);
+            pop_scope(vn);
+            touched.count = 0;
+            undo_assignments(vn, mark, &touched);
+            refresh_symbols(vn, &touched);
+            break;
+        }
+
+        case AST_FOR_STATEMENT: {
+            int frozen = vn->frozen;
+            push_scope(vn);
+            number_statement(vn, &stmt->data.for_stmt.init);
+            mark = vn->log_count;
+            enter_loop(vn, stmt);
+            int body_mark = vn->log_count;
+            if (left_for_vectorizer(vn->optimizer, stmt)) vn->frozen = 1;
+            begin_expression(vn, stmt->data.for_stmt.condition, 0);
+            number_expression(vn, &stmt->data.for_stmt.condition);
+            number_branch(vn, &stmt->data.for_stmt.body);
+            undo_assignments(vn, body_mark, &touched);
+            refresh_symbols(vn, &touched);
+            begin_expression(vn, stmt->data.for_stmt.update, 0);
+            number_expression(vn, &stmt->data.for_stmt.update);
+            vn->frozen = frozen;
+            pop_scope(vn);
+            touched.count = 0;
+            undo_assignments(vn, mark, &touched);
+            refresh_symbols(vn, &touched);
+            break;
+        }
+
+        // Um rótulo pode ser alcançado direto ou pelo anterior: só o que
+        // vem antes do switch vale em todos eles
+        case AST_SWITCH_STATEMENT: {
+            ASTNode* cases = stmt->data.switch_stmt.cases;
+            begin_expression(vn, stmt->data.switch_stmt.expression, 1);
+            number_expression(vn, &stmt->data.switch_stmt.expression);
+            mark = vn->log_count;
+            for (int i = 0; cases && i < cases->child_count; i++) {
+                refresh_symbols(vn, &touched);
+                push_scope(vn);
+                number_list(vn, cases->children[i]);
+                pop_scope(vn);
+                undo_assignments(vn, mark, &touched);
+            }
+            refresh_symbols(vn, &touched);
+            break;
+        }
+
+        default:
+            break;
+    }
+    free(touched.items);
+}
+
+// Chama visit em cada posição filha (comandos e expressões) do nó
+static void visit_children(ValueNumbering* vn, ASTNode* node,
+                           void (*visit)(ValueNumbering*, ASTNode**)) {
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            visit(vn, &node->data.var_decl.initializer);
+            return;
+        case AST_IF_STATEMENT:
+            visit(vn, &node->data.if_stmt.condition);
+            visit(vn, &node->data.if_stmt.then_stmt);
+            visit(vn, &node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            visit(vn, &node->data.while_stmt.condition);
+            visit(vn, &node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            visit(vn, &node->data.for_stmt.init);
+            visit(vn, &node->data.for_stmt.condition);
+            visit(vn, &node->data.for_stmt.update);
+            visit(vn, &node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            visit(vn, &node->data.switch_stmt.expression);
+            visit(vn, &node->data.switch_stmt.cases);
+            return;
+        case AST_RETURN_STATEMENT:
+            visit(vn, &node->data.return_stmt.expression);
+            return;
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            visit(vn, &node->data.binary_expr.left);
+            visit(vn, &node->data.binary_expr.right);
+            return;
+        case AST_UNARY_EXPRESSION:
+            visit(vn, &node->data.unary_expr.operand);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            visit(vn, &node->data.ternary_expr.condition);
+            visit(vn, &node->data.ternary_expr.true_expr);
+            visit(vn, &node->data.ternary_expr.false_expr);
+            return;
+        default:
+            // Blocos, rótulos de case, comandos de expressão e chamadas
+            for (int i = 0; i < node->child_count; i++) {
+                visit(vn, &node->children[i]);
+            }
+            return;
+    }
+}
+
+static int temporary_index(ValueNumbering* vn, const Symbol* symbol) {
+    if (!symbol || vn->temporaries.count == 0) return -1;
+    const void** found = bsearch(&symbol, vn->temporaries.items, vn->temporaries.count,
+                                 sizeof(void*), compare_pointers);
+    return found ? (int)(found - vn->temporaries.items) : -1;
+}
+
+static void collect_temporary_reads(ValueNumbering* vn, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    if (node->type == AST_IDENTIFIER) {
+        int index = temporary_index(vn, node->ref.symbol);
+        if (index >= 0) vn->read_counts[index]++;
+    } else if (node->type == AST_ASSIGNMENT_EXPRESSION &&
+               node->data.binary_expr.left->type == AST_IDENTIFIER) {
+        collect_temporary_reads(vn, &node->data.binary_expr.right);
+        return;
+    }
+    visit_children(vn, node, collect_temporary_reads);
+}
+
+// Um temporário extraído para antes do comando e lido uma só vez volta
+// para o lugar da leitura: guardá-lo não economiza nada
+static int is_inlined_temporary(ValueNumbering* vn, int index) {
+    return vn->read_counts[index] == 1 && pointer_set_contains(&vn->extracted, vn->temporaries.items[index]);
+}
+
+static int is_live_temporary(ValueNumbering* vn, int index) {
+    return vn->read_counts[index] > 0 && !is_inlined_temporary(vn, index);
+}
+
+static int assigned_temporary(ValueNumbering* vn, const ASTNode* node) {
+    if (node->type != AST_ASSIGNMENT_EXPRESSION || node->data.binary_expr.left->type != AST_IDENTIFIER) {
+        return -1;
+    }
+    return temporary_index(vn, node->data.binary_expr.left->ref.symbol);
+}
+
+// Temporários cujas leituras foram absorvidas por uma reutilização
+// maior deixam de ser gravados; os demais recebem o slot definitivo
+static void rewrite_temporaries(ValueNumbering* vn, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    if (node->type == AST_COMPOUND_STATEMENT || node->type == AST_CASE_STATEMENT ||
+        node->type == AST_DEFAULT_STATEMENT) {
+        int count = 0;
+        for (int i = 0; i < node->child_count; i++) {
+            ASTNode* child = node->children[i];
+            int index = child->type == AST_EXPRESSION_STATEMENT && child->child_count > 0
+                            ? assigned_temporary(vn, child->children[0]) : -1;
+            if (index >= 0 && !is_live_temporary(vn, index)) {
+                if (vn->read_counts[index] > 0) {
+                    vn->inlined[index] = child->children[0]->data.binary_expr.right;
+                    child->children[0]->data.binary_expr.right = NULL;
+                }
+                ast_destroy(child);
+                continue;
+            }
+            node->children[count++] = child;
+        }
+        node->child_count = count;
+    }
+
+    visit_children(vn, node, rewrite_temporaries);
+
+    int index = node->type == AST_IDENTIFIER ? temporary_index(vn, node->ref.symbol)
+                                             : assigned_temporary(vn, node);
+    if (index < 0) return;
+
+    if (node->type == AST_IDENTIFIER) {
+        if (vn->inlined[index]) {
+            *slot = vn->inlined[index];
+            vn->inlined[index] = NULL;
+            ast_destroy(node);
+            rewrite_temporaries(vn, slot);
+        } else {
+            node->ref.slot = node->ref.symbol->info.variable.slot;
+        }
+    } else if (!is_live_temporary(vn, index)) {
+        *slot = node->data.binary_expr.right;
+        node->data.binary_expr.right = NULL;
+        ast_destroy(node);
+    }
+}
+
+// Os temporários lidos ganham slot no frame, símbolo na tabela e
+// declaração no início do corpo da função
+static void finish_temporaries(ValueNumbering* vn, ASTNode* decl) {
+    ASTFunctionDecl* function = &decl->data.function_decl;
+    int count = vn->temporaries.count;
+    if (count == 0) return;
+
+    // Ordem de criação, para slots crescentes
+    Symbol** temporaries = malloc(count * sizeof(Symbol*));
+    memcpy(temporaries, vn->temporaries.items, count * sizeof(Symbol*));
+    pointer_set_sort(&vn->temporaries);
+    pointer_set_sort(&vn->extracted);
+
+    vn->read_counts = calloc(count, sizeof(int));
+    vn->inlined = calloc(count, sizeof(ASTNode*));
+    collect_temporary_reads(vn, &function->body);
+
+    int used = 0;
+    for (int i = 0; i < count; i++) {
+        Symbol* symbol = temporaries[i];
+        if (!is_live_temporary(vn, temporary_index(vn, symbol))) continue;
+
+        allocate_temporary(vn->optimizer, decl, symbol);
+        temporaries[used++] = symbol;
+    }
+
+    rewrite_temporaries(vn, &function->body);
+
+    declare_temporaries(vn->optimizer, decl, temporaries, used);
+
+    for (int i = 0; i < count; i++) {
+        ast_destroy(vn->inlined[i]);
+        if (is_live_temporary(vn, i)) {
+            vn->reused += vn->read_counts[i];
+            continue;
+        }
+        Symbol* symbol = (Symbol*)vn->temporaries.items[i];
+        free(symbol->name);
+        free(symbol);
+    }
+    vn->optimizer->temporaries += used;
+    free(vn->read_counts);
+    free(vn->inlined);
+    free(temporaries);
+}
+
+static void number_function(Optimizer* optimizer, ASTNode* decl) {
+    ValueNumbering vn = {0};
+    vn.optimizer = optimizer;
+
+    ASTNode* parameters = decl->data.function_decl.parameters;
+    for (int i = 0; parameters && i < parameters->child_count; i++) {
+        if (parameters->children[i]->ref.symbol) declare_local(&vn, parameters->children[i]->ref.symbol);
+    }
+
+    push_scope(&vn);
+    number_list(&vn, decl->data.function_decl.body);
+    pop_scope(&vn);
+    finish_temporaries(&vn, decl);
+    optimizer->reused_expressions += vn.reused + vn.holder_reuses;
+
+    for (int i = 0; i < vn.key_capacity; i++) {
+        free(vn.keys[i].text);
+    }
+    free(vn.keys);
+    free(vn.symbols);
+    free(vn.entries);
+    free(vn.available);
+    free(vn.scopes);
+    free(vn.log);
+    free(vn.declared);
+    free(vn.pending);
+    free(vn.temporaries.items);
+    free(vn.extracted.items);
+    free(vn.assigned.items);
+}
+
+// Eliminação de subexpressões comuns em cada função
+void eliminate_common_subexpressions(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+        number_function(optimizer, decl);
+    }
+}
+
+// ------------------------------------------------------------
+// Pureza das funções
+//
+// Ponto fixo otimista sobre o grafo de chamadas das funções definidas:
+// todas começam CONST e descem ao efeito mais forte encontrado no corpo.
+// Escrever globais, estáticas ou memória e chamar funções impuras (ou
+// apenas declaradas, como as de E/S) torna a função IMPURE; ler globais
+// ou chamar funções READS_MEMORY a deixa READS_MEMORY. Quando a pureza de
+// uma função cai, só quem a chama volta para a lista de trabalho.
+// Funções recursivas podem continuar puras; as que chamam a si mesmas
+// ficam marcadas (FunctionInfo.self_recursive) para a memoização.
+// ------------------------------------------------------------
+
+static FunctionPurity weaker_purity(FunctionPurity a, FunctionPurity b) {
+    return a < b ? a : b;
+}
+
+static FunctionPurity statement_purity(const ASTNode* node) {
+    if (!node) return FUNCTION_CONST;
+
+    FunctionPurity purity = FUNCTION_CONST;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return node->ref.symbol && is_shared_variable(node->ref.symbol) ? FUNCTION_READS_MEMORY
+                                                                            : FUNCTION_CONST;
+
+        case AST_ASSIGNMENT_EXPRESSION: {
+            const ASTNode* target = node->data.binary_expr.left;
+            if (target->type != AST_IDENTIFIER || !target->ref.symbol ||
+                is_shared_variable(target->ref.symbol)) {
+                return FUNCTION_IMPURE;
+            }
+            return statement_purity(node->data.binary_expr.right);
+        }
+
+        case AST_UNARY_EXPRESSION: {
+            const ASTNode* operand = node->data.unary_expr.operand;
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT:
+                    if (operand->type != AST_IDENTIFIER || !operand->ref.symbol ||
+                        is_shared_variable(operand->ref.symbol)) {
+                        return FUNCTION_IMPURE;
+                    }
+                    return FUNCTION_CONST;
+                case UNARY_DEREFERENCE:
+                    purity = FUNCTION_READS_MEMORY;
+                    break;
+                default:
+                    break;
+            }
+            return weaker_purity(purity, statement_purity(operand));
+        }
+
+        case AST_BINARY_EXPRESSION:
+            return weaker_purity(statement_purity(node->data.binary_expr.left),
+                                 statement_purity(node->data.binary_expr.right));
+
+        case AST_TERNARY_EXPRESSION:
+            purity = weaker_purity(statement_purity(node->data.ternary_expr.condition),
+                                   statement_purity(node->data.ternary_expr.true_expr));
+            return weaker_purity(purity, statement_purity(node->data.ternary_expr.false_expr));
+
+        case AST_FUNCTION_CALL: {
+            const Symbol* function = symbol_ref_target(&node->ref);
+            if (!function || function->kind != SYMBOL_FUNCTION) return FUNCTION_IMPURE;
+            purity = function->info.function.purity;
+            break;
+        }
+
+        case AST_ARRAY_ACCESS:
+        case AST_MEMBER_ACCESS:
+        case AST_POINTER_ACCESS:
+            purity = FUNCTION_READS_MEMORY;
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            return statement_purity(node->data.var_decl.initializer);
+
+        case AST_IF_STATEMENT:
+            purity = weaker_purity(statement_purity(node->data.if_stmt.condition),
+                                   statement_purity(node->data.if_stmt.then_stmt));
+            return weaker_purity(purity, statement_purity(node->data.if_stmt.else_stmt));
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return weaker_purity(statement_purity(node->data.while_stmt.condition),
+                                 statement_purity(node->data.while_stmt.body));
+
+        case AST_FOR_STATEMENT:
+            purity = weaker_purity(statement_purity(node->data.for_stmt.init),
+                                   statement_purity(node->data.for_stmt.condition));
+            purity = weaker_purity(purity, statement_purity(node->data.for_stmt.update));
+            return weaker_purity(purity, statement_purity(node->data.for_stmt.body));
+
+        case AST_SWITCH_STATEMENT:
+            return weaker_purity(statement_purity(node->data.switch_stmt.expression),
+                                 statement_purity(node->data.switch_stmt.cases));
+
+        case AST_RETURN_STATEMENT:
+            return statement_purity(node->data.return_stmt.expression);
+
+        default:
+            break;
+    }
+
+    for (int i = 0; i < node->child_count && purity != FUNCTION_IMPURE; i++) {
+        purity = weaker_purity(purity, statement_purity(node->children[i]));
+    }
+    return purity;
+}
+
+typedef struct PurityNode {
+    ASTNode* decl;
+    int* callers;             // Funções definidas que chamam esta
+    int caller_count;
+    int caller_capacity;
+    int queued;
+} PurityNode;
+
+static int find_purity_node(const PurityNode* nodes, int count, const Symbol* symbol) {
+    for (int i = 0; symbol && i < count; i++) {
+        if (nodes[i].decl->ref.symbol == symbol) return i;
+    }
+    return -1;
+}
+
+static void add_caller(PurityNode* nodes, int callee, int caller) {
+    PurityNode* node = &nodes[callee];
+    for (int i = 0; i < node->caller_count; i++) {
+        if (node->callers[i] == caller) return;
+    }
+    node->callers = grow_array(node->callers, &node->caller_capacity, node->caller_count + 1, sizeof(int));
+    node->callers[node->caller_count++] = caller;
+}
+
+// Arestas caller -> funções definidas chamadas no trecho
+static void collect_call_edges(PurityNode* nodes, int count, int caller, const ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL: {
+            int callee = find_purity_node(nodes, count, node->ref.symbol);
+            if (callee >= 0) add_caller(nodes, callee, caller);
+            if (callee == caller) node->ref.symbol->info.function.self_recursive = 1;
+            break;
+        }
+        case AST_VARIABLE_DECLARATION:
+            collect_call_edges(nodes, count, caller, node->data.var_decl.initializer);
+            return;
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            collect_call_edges(nodes, count, caller, node->data.binary_expr.left);
+            collect_call_edges(nodes, count, caller, node->data.binary_expr.right);
+            return;
+        case AST_UNARY_EXPRESSION:
+            collect_call_edges(nodes, count, caller, node->data.unary_expr.operand);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            collect_call_edges(nodes, count, caller, node->data.ternary_expr.condition);
+            collect_call_edges(nodes, count, caller, node->data.ternary_expr.true_expr);
+            collect_call_edges(nodes, count, caller, node->data.ternary_expr.false_expr);
+            return;
+        case AST_IF_STATEMENT:
+            collect_call_edges(nodes, count, caller, node->data.if_stmt.condition);
+            collect_call_edges(nodes, count, caller, node->data.if_stmt.then_stmt);
+            collect_call_edges(nodes, count, caller, node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            collect_call_edges(nodes, count, caller, node->data.while_stmt.condition);
+            collect_call_edges(nodes, count, caller, node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            collect_call_edges(nodes, count, caller, node->data.for_stmt.init);
+            collect_call_edges(nodes, count, caller, node->data.for_stmt.condition);
+            collect_call_edges(nodes, count, caller, node->data.for_stmt.update);
+            collect_call_edges(nodes, count, caller, node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            collect_call_edges(nodes, count, caller, node->data.switch_stmt.expression);
+            collect_call_edges(nodes, count, caller, node->data.switch_stmt.cases);
+            return;
+        case AST_RETURN_STATEMENT:
+            collect_call_edges(nodes, count, caller, node->data.return_stmt.expression);
+            return;
+        default:
+            break;
+    }
+
+    for (int i = 0; i < node->child_count; i++) {
+        collect_call_edges(nodes, count, caller, node->children[i]);
+    }
+}
+
+// Preenche FunctionInfo.purity das funções definidas no programa
+void analyze_function_purity(ASTNode* program) {
+    if (!program) return;
+
+    PurityNode* nodes = calloc(program->child_count + 1, sizeof(PurityNode));
+    int count = 0;
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type == AST_FUNCTION_DECLARATION && decl->data.function_decl.body && decl->ref.symbol) {
+            decl->ref.symbol->info.function.purity = FUNCTION_CONST;
+            decl->ref.symbol->info.function.self_recursive = 0;
+            nodes[count++].decl = decl;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        collect_call_edges(nodes, count, i, nodes[i].decl->data.function_decl.body);
+    }
+
+    // Lista de trabalho: todas uma vez, depois quem chama as que caíram
+    int* worklist = malloc((count + 1) * sizeof(int));
+    int pending = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        worklist[pending++] = i;
+        nodes[i].queued = 1;
+    }
+    while (pending > 0) {
+        PurityNode* node = &nodes[worklist[--pending]];
+        node->queued = 0;
+
+        FunctionInfo* info = &node->decl->ref.symbol->info.function;
+        FunctionPurity purity = weaker_purity(info->purity, statement_purity(node->decl->data.function_decl.body));
+        if (purity == info->purity) continue;
+        info->purity = purity;
+        for (int c = 0; c < node->caller_count; c++) {
+            if (nodes[node->callers[c]].queued) continue;
+            nodes[node->callers[c]].queued = 1;
+            worklist[pending++] = node->callers[c];
+        }
+    }
+
+    for (int i = 0; i < count; i++) free(nodes[i].callers);
+    free(nodes);
+    free(worklist);
+}
+
+// ------------------------------------------------------------
+// Invariantes de laço
+//
+// Uma expressão cujos operandos não mudam dentro do laço é calculada
+// uma vez num pré-cabeçalho: comandos `_temp_N = expr;` inseridos logo
+// antes do laço, que os backends emitem como código comum. Os laços são
+// visitados de fora para dentro, e cada um leva as expressões
+// invariantes maximais de todo o seu corpo (laços internos inclusive).
+// Aritmética sem risco sobe de qualquer ponto; divisões e chamadas
+// (só de funções puras) podem falhar ou não terminar e sobem apenas do
+// que o laço executa sempre que é alcançado: a condição de while/for e
+// o início do corpo de do-while.
+// ------------------------------------------------------------
+
+typedef struct HoistedExpression {
+    ASTNode* expression;   // Lado direito do comando no pré-cabeçalho
+    Symbol* temporary;
+} HoistedExpression;
+
+typedef struct LoopHoisting {
+    Optimizer* optimizer;
+    ASTNode* function;
+
+    // Laço atual
+    PointerSet assigned;   // Variáveis atribuídas ou declaradas nele
+    int writes_memory;     // Chamadas impuras ou escritas por ponteiro
+    HoistedExpression* hoisted;
+    int hoisted_count;
+    int hoisted_capacity;
+
+    // Pré-cabeçalhos, inseridos antes do laço que os gerou
+    ASTNode** pending;
+    int pending_count;
+    int pending_capacity;
+
+    // Temporários da função, declarados no fim
+    Symbol** temporaries;
+    int temporary_count;
+    int temporary_capacity;
+} LoopHoisting;
+
+static int is_invariant(LoopHoisting* lh, const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+        case AST_CHAR_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_STRING_LITERAL:
+            return 1;
+
+        case AST_IDENTIFIER: {
+            const Symbol* symbol = node->ref.symbol;
+            if (!symbol || (symbol->kind != SYMBOL_VARIABLE && symbol->kind != SYMBOL_PARAMETER)) return 0;
+            if (pointer_set_contains(&lh->assigned, symbol)) return 0;
+            return !lh->writes_memory || !is_shared_variable(symbol);
+        }
+
+        case AST_BINARY_EXPRESSION: {
+            TokenType op = node->data.binary_expr.operator;
+            return (is_value_operator(op) || op == TOKEN_AND || op == TOKEN_OR) &&
+                   is_invariant(lh, node->data.binary_expr.left) &&
+                   is_invariant(lh, node->data.binary_expr.right);
+        }
+
+        case AST_UNARY_EXPRESSION:
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PLUS:
+                case UNARY_MINUS:
+                case UNARY_NOT:
+                case UNARY_BITWISE_NOT:
+                    return is_invariant(lh, node->data.unary_expr.operand);
+                default:
+                    return 0;
+            }
+
+        case AST_TERNARY_EXPRESSION:
+            return is_invariant(lh, node->data.ternary_expr.condition) &&
+                   is_invariant(lh, node->data.ternary_expr.true_expr) &&
+                   is_invariant(lh, node->data.ternary_expr.false_expr);
+
+        case AST_FUNCTION_CALL: {
+            const Symbol* function = symbol_ref_target(&node->ref);
+            if (!function || function->kind != SYMBOL_FUNCTION) return 0;
+            FunctionPurity purity = function->info.function.purity;
+            if (purity == FUNCTION_IMPURE || (purity == FUNCTION_READS_MEMORY && lh->writes_memory)) return 0;
+            for (int i = 0; i < node->child_count; i++) {
+                if (!is_invariant(lh, node->children[i])) return 0;
+            }
+            return 1;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+// Divisões e chamadas: só sobem de pontos executados sempre
+static int may_trap(const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL:
+            return 1;
+        case AST_BINARY_EXPRESSION:
+            if (node->data.binary_expr.operator == TOKEN_DIVIDE ||
+                node->data.binary_expr.operator == TOKEN_MODULO) {
+                return 1;
+            }
+            return may_trap(node->data.binary_expr.left) || may_trap(node->data.binary_expr.right);
+        case AST_UNARY_EXPRESSION:
+            return may_trap(node->data.unary_expr.operand);
+        case AST_TERNARY_EXPRESSION:
+            return may_trap(node->data.ternary_expr.condition) ||
+                   may_trap(node->data.ternary_expr.true_expr) ||
+                   may_trap(node->data.ternary_expr.false_expr);
+        default:
+            return 0;
+    }
+}
+
+// Operações (não folhas nem constantes) com resultado escalar
+static int is_hoist_candidate(const ASTNode* node) {
+    if (node->type != AST_BINARY_EXPRESSION && node->type != AST_UNARY_EXPRESSION &&
+        node->type != AST_TERNARY_EXPRESSION && node->type != AST_FUNCTION_CALL) {
+        return 0;
+    }
+    if (!is_arithmetic(node->data_type) && node->data_type != TYPE_POINTER) return 0;
+
+    ConstantValue constant;
+    return node->type_id >= 0 && !optimizer_constant_value((ASTNode*)node, &constant);
+}
+
+static int same_expression(const ASTNode* a, const ASTNode* b) {
+    if (a->type != b->type || a->data_type != b->data_type || a->type_id != b->type_id) return 0;
+
+    switch (a->type) {
+        case AST_IDENTIFIER:
+            return a->ref.symbol == b->ref.symbol;
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+        case AST_CHAR_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_STRING_LITERAL:
+            return a->data.literal.value && b->data.literal.value &&
+                   strcmp(a->data.literal.value, b->data.literal.value) == 0;
+        case AST_BINARY_EXPRESSION:
+            return a->data.binary_expr.operator == b->data.binary_expr.operator &&
+                   same_expression(a->data.binary_expr.left, b->data.binary_expr.left) &&
+                   same_expression(a->data.binary_expr.right, b->data.binary_expr.right);
+        case AST_UNARY_EXPRESSION:
+            return a->data.unary_expr.operator == b->data.unary_expr.operator &&
+                   same_expression(a->data.unary_expr.operand, b->data.unary_expr.operand);
+        case AST_TERNARY_EXPRESSION:
+            return same_expression(a->data.ternary_expr.condition, b->data.ternary_expr.condition) &&
+                   same_expression(a->data.ternary_expr.true_expr, b->data.ternary_expr.true_expr) &&
+                   same_expression(a->data.ternary_expr.false_expr, b->data.ternary_expr.false_expr);
+        case AST_FUNCTION_CALL:
+            if (a->ref.symbol != b->ref.symbol || a->child_count != b->child_count) return 0;
+            for (int i = 0; i < a->child_count; i++) {
+                if (!same_expression(a->children[i], b->children[i])) return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Troca a expressão pela leitura do temporário do pré-cabeçalho
+static void hoist_to_preheader(LoopHoisting* lh, ASTNode** slot) {
+    ASTNode* expression = *slot;
+    Symbol* temporary = NULL;
+
+    for (int i = 0; i < lh->hoisted_count && !temporary; i++) {
+        if (same_expression(lh->hoisted[i].expression, expression)) temporary = lh->hoisted[i].temporary;
+    }
+
+    if (temporary) {
+        *slot = make_variable_reference(temporary, expression);
+        ast_destroy(expression);
+    } else {
+        temporary = create_temporary_symbol(lh->optimizer, expression);
+        allocate_temporary(lh->optimizer, lh->function, temporary);
+        lh->temporaries = grow_array(lh->temporaries, &lh->temporary_capacity, lh->temporary_count + 1,
+                                     sizeof(Symbol*));
+        lh->temporaries[lh->temporary_count++] = temporary;
+
+        lh->hoisted = grow_array(lh->hoisted, &lh->hoisted_capacity, lh->hoisted_count + 1,
+                                 sizeof(HoistedExpression));
+        lh->hoisted[lh->hoisted_count].expression = expression;
+        lh->hoisted[lh->hoisted_count].temporary = temporary;
+        lh->hoisted_count++;
+
+        ASTNode* stmt = ast_create_node(AST_EXPRESSION_STATEMENT);
+        *slot = make_variable_reference(temporary, expression);
+        ast_add_child(stmt, make_temporary_assignment(temporary, expression));
+        lh->pending = grow_array(lh->pending, &lh->pending_capacity, lh->pending_count + 1, sizeof(ASTNode*));
+        lh->pending[lh->pending_count++] = stmt;
+    }
+    lh->optimizer->hoisted_expressions++;
+}
+
+// always: a expressão é avaliada sempre que o laço é alcançado
+static void hoist_expression(LoopHoisting* lh, ASTNode** slot, int always) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    if (is_hoist_candidate(node) && is_invariant(lh, node) && (always || !may_trap(node))) {
+        hoist_to_preheader(lh, slot);
+        return;
+    }
+
+    switch (node->type) {
+        case AST_BINARY_EXPRESSION: {
+            TokenType op = node->data.binary_expr.operator;
+            hoist_expression(lh, &node->data.binary_expr.left, always);
+            hoist_expression(lh, &node->data.binary_expr.right, always && op != TOKEN_AND && op != TOKEN_OR);
+            return;
+        }
+        case AST_ASSIGNMENT_EXPRESSION:
+            hoist_expression(lh, &node->data.binary_expr.right, always);
+            return;
+        case AST_UNARY_EXPRESSION:
+            hoist_expression(lh, &node->data.unary_expr.operand, always);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            hoist_expression(lh, &node->data.ternary_expr.condition, always);
+            hoist_expression(lh, &node->data.ternary_expr.true_expr, 0);
+            hoist_expression(lh, &node->data.ternary_expr.false_expr, 0);
+            return;
+        case AST_FUNCTION_CALL:
+            for (int i = 0; i < node->child_count; i++) {
+                hoist_expression(lh, &node->children[i], always);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+// Expressões de qualquer ponto do corpo (nenhuma avaliada sempre)
+static void hoist_from_statement(LoopHoisting* lh, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            hoist_expression(lh, &node->data.var_decl.initializer, 0);
+            return;
+        case AST_IF_STATEMENT:
+            hoist_expression(lh, &node->data.if_stmt.condition, 0);
+            hoist_from_statement(lh, &node->data.if_stmt.then_stmt);
+            hoist_from_statement(lh, &node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            hoist_expression(lh, &node->data.while_stmt.condition, 0);
+            hoist_from_statement(lh, &node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            hoist_from_statement(lh, &node->data.for_stmt.init);
+            hoist_expression(lh, &node->data.for_stmt.condition, 0);
+            hoist_expression(lh, &node->data.for_stmt.update, 0);
+            hoist_from_statement(lh, &node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            hoist_expression(lh, &node->data.switch_stmt.expression, 0);
+            hoist_from_statement(lh, &node->data.switch_stmt.cases);
+            return;
+        case AST_RETURN_STATEMENT:
+            hoist_expression(lh, &node->data.return_stmt.expression, 0);
+            return;
+        case AST_EXPRESSION_STATEMENT:
+            if (node->child_count > 0) hoist_expression(lh, &node->children[0], 0);
+            return;
+        default:
+            // Blocos e rótulos de case
+            for (int i = 0; i < node->child_count; i++) {
+                hoist_from_statement(lh, &node->children[i]);
+            }
+            return;
+    }
+}
+
+// Chamada impura ou escrita por ponteiro: pode encerrar o programa antes
+// do que vem depois
+static int writes_memory_in(const ASTNode* node) {
+    PointerSet assigned = {0};
+    int writes = 0;
+    collect_assignments(node, &assigned, &writes);
+    free(assigned.items);
+    return writes;
+}
+
+static int contains_exit(const ASTNode* node) {
+    if (!node) return 0;
+    if (node->type == AST_BREAK_STATEMENT || node->type == AST_RETURN_STATEMENT) return 1;
+
+    switch (node->type) {
+        case AST_IF_STATEMENT:
+            return contains_exit(node->data.if_stmt.then_stmt) || contains_exit(node->data.if_stmt.else_stmt);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return contains_exit(node->data.while_stmt.body);
+        case AST_FOR_STATEMENT:
+            return contains_exit(node->data.for_stmt.body);
+        case AST_SWITCH_STATEMENT:
+            return contains_exit(node->data.switch_stmt.cases);
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                if (contains_exit(node->children[i])) return 1;
+            }
+            return 0;
+    }
+}
+
+// Comandos simples do início do corpo de do-while rodam na primeira
+// volta, até o primeiro desvio ou chamada que possa encerrar o programa
+static int hoist_do_prefix(LoopHoisting* lh, ASTNode* body) {
+    ASTNode** items = &body;
+    int count = 1;
+    if (body->type == AST_COMPOUND_STATEMENT) {
+        items = body->children;
+        count = body->child_count;
+    }
+
+    for (int i = 0; i < count; i++) {
+        ASTNode* stmt = items[i];
+        ASTNode** expression;
+        if (stmt->type == AST_EXPRESSION_STATEMENT && stmt->child_count > 0) {
+            expression = &stmt->children[0];
+        } else if (stmt->type == AST_VARIABLE_DECLARATION) {
+            expression = &stmt->data.var_decl.initializer;
+        } else {
+            return 0;
+        }
+
+        hoist_expression(lh, expression, 1);
+        if (writes_memory_in(*expression)) return 0;
+    }
+    return 1;
+}
+
+static void hoist_loop(LoopHoisting* lh, ASTNode* loop) {
+    int writes = 0;
+    lh->assigned.count = 0;
+    collect_assignments(loop, &lh->assigned, &writes);
+    pointer_set_sort(&lh->assigned);
+    lh->writes_memory = writes;
+    lh->hoisted_count = 0;
+
+    switch (loop->type) {
+        case AST_WHILE_STATEMENT:
+            hoist_expression(lh, &loop->data.while_stmt.condition,
+                             !writes_memory_in(loop->data.while_stmt.condition));
+            hoist_from_statement(lh, &loop->data.while_stmt.body);
+            break;
+
+        case AST_DO_WHILE_STATEMENT: {
+            ASTNode* body = loop->data.while_stmt.body;
+            int whole = body && hoist_do_prefix(lh, body);
+            int reaches_condition = whole || (!lh->writes_memory && !contains_exit(body));
+            hoist_expression(lh, &loop->data.while_stmt.condition,
+                             reaches_condition && !writes_memory_in(loop->data.while_stmt.condition));
+            hoist_from_statement(lh, &loop->data.while_stmt.body);
+            break;
+        }
+
+        case AST_FOR_STATEMENT: {
+            // A inicialização roda antes da condição
+            int always = !writes_memory_in(loop->data.for_stmt.init) &&
+                         !writes_memory_in(loop->data.for_stmt.condition);
+            hoist_expression(lh, &loop->data.for_stmt.condition, always);
+            hoist_expression(lh, &loop->data.for_stmt.update, 0);
+            hoist_from_statement(lh, &loop->data.for_stmt.body);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void hoist_statement(LoopHoisting* lh, ASTNode** slot);
+
+// Cada laço da lista recebe o seu pré-cabeçalho logo antes dele
+static void hoist_list(LoopHoisting* lh, ASTNode* list) {
+    int base = lh->pending_count;
+
+    for (int i = 0; i < list->child_count; i++) {
+        hoist_statement(lh, &list->children[i]);
+
+        int extra = lh->pending_count - base;
+        if (extra == 0) continue;
+        insert_children(list, i, &lh->pending[base], extra);
+        lh->pending_count = base;
+        i += extra;
+    }
+}
+
+// Laço num ramo ou corpo: vai para um bloco junto com o pré-cabeçalho
+static void hoist_branch(LoopHoisting* lh, ASTNode** slot) {
+    int base = lh->pending_count;
+    hoist_statement(lh, slot);
+
+    if (lh->pending_count > base && *slot) {
+        ASTNode* block = ast_create_node(AST_COMPOUND_STATEMENT);
+        for (int i = base; i < lh->pending_count; i++) {
+            ast_add_child(block, lh->pending[i]);
+        }
+        ast_add_child(block, *slot);
+        *slot = block;
+    }
+    lh->pending_count = base;
+}
+
+static void hoist_statement(LoopHoisting* lh, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            hoist_list(lh, stmt);
+            return;
+
+        case AST_IF_STATEMENT:
+            hoist_branch(lh, &stmt->data.if_stmt.then_stmt);
+            hoist_branch(lh, &stmt->data.if_stmt.else_stmt);
+            return;
+
+        case AST_SWITCH_STATEMENT:
+            hoist_statement(lh, &stmt->data.switch_stmt.cases);
+            return;
+
+        // O pré-cabeçalho do laço fica pendente; os dos internos entram
+        // no corpo
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            hoist_loop(lh, stmt);
+            hoist_branch(lh, &stmt->data.while_stmt.body);
+            return;
+
+        case AST_FOR_STATEMENT:
+            hoist_loop(lh, stmt);
+            hoist_branch(lh, &stmt->data.for_stmt.body);
+            return;
+
+        default:
+            return;
+    }
+}
+
+// Movimentação de código invariante para fora dos laços
+void hoist_loop_invariants(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+
+        LoopHoisting lh = {0};
+        lh.optimizer = optimizer;
+        lh.function = decl;
+        hoist_list(&lh, decl->data.function_decl.body);
+        declare_temporaries(optimizer, decl, lh.temporaries, lh.temporary_count);
+        optimizer->hoisted_temporaries += lh.temporary_count;
+
+        free(lh.assigned.items);
+        free(lh.hoisted);
+        free(lh.pending);
+        free(lh.temporaries);
+    }
+}
+
+// ------------------------------------------------------------
+// Laços contados: desenrolamento e variáveis de indução
+//
+// Um contador é um local int que o laço só altera por incrementos
+// constantes no nível do comando (i = i + K, i = i - K, i++, --i...).
+// Um for com início, limite e passo constantes tem número de voltas
+// conhecido: com corpo pequeno, ele é desenrolado pelo fator de
+// -funroll=N (as voltas que sobram viram cópias depois do laço). Depois,
+// cada produto i * C (C constante ou local invariante) dentro de um laço
+// passa a ser um temporário iniciado com i * C antes dele e somado de
+// K * C a cada incremento de i: a multiplicação por volta vira uma soma.
+// Se i só existia para isso, o teste passa a comparar o temporário e os
+// incrementos de i somem.
+// ------------------------------------------------------------
+
+#define UNROLL_BODY_LIMIT 40      // Nós da AST no corpo de um laço desenrolado
+#define UNROLL_CODE_LIMIT 160     // Nós somando todas as cópias
+
+static int is_counter_variable(const Symbol* symbol) {
+    return symbol && (symbol->kind == SYMBOL_VARIABLE || symbol->kind == SYMBOL_PARAMETER) &&
+           symbol->type == TYPE_INT && !is_shared_variable(symbol);
+}
+
+// Reconhece um incremento constante do contador como expressão completa
+static int counter_increment(const ASTNode* node, Symbol** counter, long* step) {
+    if (!node) return 0;
+
+    if (node->type == AST_UNARY_EXPRESSION) {
+        const ASTNode* operand = node->data.unary_expr.operand;
+        UnaryOperator op = node->data.unary_expr.operator;
+        if (operand->type != AST_IDENTIFIER || !is_counter_variable(operand->ref.symbol)) return 0;
+        if (op == UNARY_PRE_INCREMENT || op == UNARY_POST_INCREMENT) {
+            *step = 1;
+        } else if (op == UNARY_PRE_DECREMENT || op == UNARY_POST_DECREMENT) {
+            *step = -1;
+        } else {
+            return 0;
+        }
+        *counter = operand->ref.symbol;
+        return 1;
+    }
+
+    if (node->type != AST_ASSIGNMENT_EXPRESSION || node->data.binary_expr.operator != TOKEN_ASSIGN) return 0;
+    const ASTNode* target = node->data.binary_expr.left;
+    const ASTNode* value = node->data.binary_expr.right;
+    if (target->type != AST_IDENTIFIER || !is_counter_variable(target->ref.symbol)) return 0;
+    if (value->type != AST_BINARY_EXPRESSION) return 0;
+
+    TokenType op = value->data.binary_expr.operator;
+    const ASTNode* left = value->data.binary_expr.left;
+    const ASTNode* right = value->data.binary_expr.right;
+    long constant;
+    if (op == TOKEN_PLUS && left->type == AST_IDENTIFIER && left->ref.symbol == target->ref.symbol &&
+        ast_integer_constant(right, &constant)) {
+        *step = constant;
+    } else if (op == TOKEN_PLUS && right->type == AST_IDENTIFIER && right->ref.symbol == target->ref.symbol &&
+               ast_integer_constant(left, &constant)) {
+        *step = constant;
+    } else if (op == TOKEN_MINUS && left->type == AST_IDENTIFIER && left->ref.symbol == target->ref.symbol &&
+               ast_integer_constant(right, &constant)) {
+        *step = -constant;
+    } else {
+        return 0;
+    }
+    *counter = target->ref.symbol;
+    return *step != 0;
+}
+
+// Atribuições (e declarações) do símbolo no trecho
+static int count_assignments(const ASTNode* node, const Symbol* symbol) {
+    PointerSet assigned = {0};
+    int writes = 0;
+    collect_assignments(node, &assigned, &writes);
+    int count = 0;
+    for (int i = 0; i < assigned.count; i++) {
+        if (assigned.items[i] == symbol) count++;
+    }
+    free(assigned.items);
+    return count;
+}
+
+// Leituras e escritas do símbolo no trecho (declarações não contam)
+static int count_uses(const ASTNode* node, const Symbol* symbol) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return node->ref.symbol == symbol;
+        case AST_VARIABLE_DECLARATION:
+            return count_uses(node->data.var_decl.initializer, symbol);
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            return count_uses(node->data.binary_expr.left, symbol) + count_uses(node->data.binary_expr.right, symbol);
+        case AST_UNARY_EXPRESSION:
+            return count_uses(node->data.unary_expr.operand, symbol);
+        case AST_TERNARY_EXPRESSION:
+            return count_uses(node->data.ternary_expr.condition, symbol) +
+                   count_uses(node->data.ternary_expr.true_expr, symbol) +
+                   count_uses(node->data.ternary_expr.false_expr, symbol);
+        case AST_IF_STATEMENT:
+            return count_uses(node->data.if_stmt.condition, symbol) +
+                   count_uses(node->data.if_stmt.then_stmt, symbol) +
+                   count_uses(node->data.if_stmt.else_stmt, symbol);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return count_uses(node->data.while_stmt.condition, symbol) +
+                   count_uses(node->data.while_stmt.body, symbol);
+        case AST_FOR_STATEMENT:
+            return count_uses(node->data.for_stmt.init, symbol) +
+                   count_uses(node->data.for_stmt.condition, symbol) +
+                   count_uses(node->data.for_stmt.update, symbol) +
+                   count_uses(node->data.for_stmt.body, symbol);
+        case AST_SWITCH_STATEMENT:
+            return count_uses(node->data.switch_stmt.expression, symbol) +
+                   count_uses(node->data.switch_stmt.cases, symbol);
+        case AST_RETURN_STATEMENT:
+            return count_uses(node->data.return_stmt.expression, symbol);
+        default: {
+            int count = 0;
+            for (int i = 0; i < node->child_count; i++) {
+                count += count_uses(node->children[i], symbol);
+            }
+            return count;
+        }
+    }
+}
+
+// Nós da AST no trecho; limit interrompe a contagem cedo
+static int count_nodes(const ASTNode* node, int limit) {
+    if (!node || limit <= 0) return 0;
+
+    int count = 1;
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            return count + count_nodes(node->data.var_decl.initializer, limit - count);
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            count += count_nodes(node->data.binary_expr.left, limit - count);
+            return count + count_nodes(node->data.binary_expr.right, limit - count);
+        case AST_UNARY_EXPRESSION:
+            return count + count_nodes(node->data.unary_expr.operand, limit - count);
+        case AST_TERNARY_EXPRESSION:
+            count += count_nodes(node->data.ternary_expr.condition, limit - count);
+            count += count_nodes(node->data.ternary_expr.true_expr, limit - count);
+            return count + count_nodes(node->data.ternary_expr.false_expr, limit - count);
+        case AST_IF_STATEMENT:
+            count += count_nodes(node->data.if_stmt.condition, limit - count);
+            count += count_nodes(node->data.if_stmt.then_stmt, limit - count);
+            return count + count_nodes(node->data.if_stmt.else_stmt, limit - count);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            count += count_nodes(node->data.while_stmt.condition, limit - count);
+            return count + count_nodes(node->data.while_stmt.body, limit - count);
+        case AST_FOR_STATEMENT:
+            count += count_nodes(node->data.for_stmt.init, limit - count);
+            count += count_nodes(node->data.for_stmt.condition, limit - count);
+            count += count_nodes(node->data.for_stmt.update, limit - count);
+            return count + count_nodes(node->data.for_stmt.body, limit - count);
+        case AST_SWITCH_STATEMENT:
+            count += count_nodes(node->data.switch_stmt.expression, limit - count);
+            return count + count_nodes(node->data.switch_stmt.cases, limit - count);
+        case AST_RETURN_STATEMENT:
+            return count + count_nodes(node->data.return_stmt.expression, limit - count);
+        default:
+            for (int i = 0; i < node->child_count && count < limit; i++) {
+                count += count_nodes(node->children[i], limit - count);
+            }
+            return count;
+    }
+}
+
+// Corpos que podem ser copiados: sem desvios para fora da volta e sem
+// estáticas (declaradas uma vez só no programa)
+static int is_copyable_body(const ASTNode* node) {
+    if (!node) return 1;
+
+    switch (node->type) {
+        case AST_BREAK_STATEMENT:
+        case AST_CONTINUE_STATEMENT:
+        case AST_RETURN_STATEMENT:
+            return 0;
+        case AST_VARIABLE_DECLARATION:
+            return !(node->data.var_decl.modifiers & MOD_STATIC);
+        case AST_IF_STATEMENT:
+            return is_copyable_body(node->data.if_stmt.then_stmt) &&
+                   is_copyable_body(node->data.if_stmt.else_stmt);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return is_copyable_body(node->data.while_stmt.body);
+        case AST_FOR_STATEMENT:
+            return is_copyable_body(node->data.for_stmt.init) && is_copyable_body(node->data.for_stmt.body);
+        case AST_SWITCH_STATEMENT:
+            return is_copyable_body(node->data.switch_stmt.cases);
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                if (!is_copyable_body(node->children[i])) return 0;
+            }
+            return 1;
+    }
+}
+
+static ASTNode* make_int_literal(long value, const ASTNode* origin) {
+    ConstantValue constant = { TYPE_INT, (int)value, 0 };
+    return make_literal(&constant, origin);
+}
+
+static ASTNode* make_binary(TokenType op, ASTNode* left, ASTNode* right, const ASTNode* origin) {
+    ASTNode* node = ast_create_node(op == TOKEN_ASSIGN ? AST_ASSIGNMENT_EXPRESSION : AST_BINARY_EXPRESSION);
+    node->data.binary_expr.operator = op;
+    node->data.binary_expr.left = left;
+    node->data.binary_expr.right = right;
+    node->data_type = op == TOKEN_COMMA || op == TOKEN_ASSIGN ? right->data_type : TYPE_INT;
+    node->type_id = op == TOKEN_COMMA || op == TOKEN_ASSIGN ? right->type_id : TYPE_ID_INT;
+    node->line = origin->line;
+    node->column = origin->column;
+    return node;
+}
+
+static ASTNode* make_statement(ASTNode* expression) {
+    ASTNode* stmt = ast_create_node(AST_EXPRESSION_STATEMENT);
+    stmt->line = expression->line;
+    stmt->column = expression->column;
+    ast_add_child(stmt, expression);
+    return stmt;
+}
+
+// a < b equivale a b > a (e a -a > -b)
+static TokenType mirror_comparison(TokenType op) {
+    switch (op) {
+        case TOKEN_LESS: return TOKEN_GREATER;
+        case TOKEN_LESS_EQUAL: return TOKEN_GREATER_EQUAL;
+        case TOKEN_GREATER: return TOKEN_LESS;
+        case TOKEN_GREATER_EQUAL: return TOKEN_LESS_EQUAL;
+        default: return op;
+    }
+}
+
+// Número de voltas de um for contado (0 se não for possível saber)
+static long trip_count(const ASTNode* loop, Symbol** counter, long* start, long* step) {
+    const ASTNode* init = loop->data.for_stmt.init;
+    const ASTNode* condition = loop->data.for_stmt.condition;
+    if (!init || !condition || !counter_increment(loop->data.for_stmt.update, counter, step)) return 0;
+
+    // Início: int i = A ou i = A
+    const ASTNode* initial = NULL;
+    if (init->type == AST_VARIABLE_DECLARATION && init->ref.symbol == *counter) {
+        initial = init->data.var_decl.initializer;
+    } else if (init->type == AST_EXPRESSION_STATEMENT && init->child_count > 0 &&
+               init->children[0]->type == AST_ASSIGNMENT_EXPRESSION &&
+               init->children[0]->data.binary_expr.operator == TOKEN_ASSIGN &&
+               init->children[0]->data.binary_expr.left->type == AST_IDENTIFIER &&
+               init->children[0]->data.binary_expr.left->ref.symbol == *counter) {
+        initial = init->children[0]->data.binary_expr.right;
+    }
+    if (!initial || !ast_integer_constant(initial, start)) return 0;
+
+    // Limite: i < B, i <= B, i > B, i >= B, i != B (ou com os lados trocados)
+    if (condition->type != AST_BINARY_EXPRESSION) return 0;
+    TokenType op = condition->data.binary_expr.operator;
+    const ASTNode* left = condition->data.binary_expr.left;
+    const ASTNode* right = condition->data.binary_expr.right;
+    long bound;
+    if (right->type == AST_IDENTIFIER && right->ref.symbol == *counter) {
+        const ASTNode* swap = left;
+        left = right;
+        right = swap;
+        op = mirror_comparison(op);
+    }
+    if (left->type != AST_IDENTIFIER || left->ref.symbol != *counter || !ast_integer_constant(right, &bound)) {
+        return 0;
+    }
+
+    long distance;
+    switch (op) {
+        case TOKEN_LESS: distance = *step > 0 ? bound - *start : -1; break;
+        case TOKEN_LESS_EQUAL: distance = *step > 0 ? bound - *start + 1 : -1; break;
+        case TOKEN_GREATER: distance = *step < 0 ? *start - bound : -1; break;
+        case TOKEN_GREATER_EQUAL: distance = *step < 0 ? *start - bound + 1 : -1; break;
+        case TOKEN_NOT_EQUAL:
+            if ((bound - *start) % *step != 0 || (bound - *start) / *step < 0) return 0;
+            return (bound - *start) / *step;
+        default:
+            return 0;
+    }
+    if (distance <= 0) return 0;
+
+    long magnitude = *step > 0 ? *step : -*step;
+    long trips = (distance + magnitude - 1) / magnitude;
+    long final = *start + trips * *step;
+    return final >= INT_MIN && final <= INT_MAX ? trips : 0;
+}
+
+// Cópia do corpo seguida do incremento do contador
+static void append_iteration(ASTNode* block, const ASTNode* body, const ASTNode* update) {
+    ast_add_child(block, ast_clone(body));
+    ast_add_child(block, make_statement(ast_clone(update)));
+}
+
+static void unroll_for(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* loop = *slot;
+    ASTNode* body = loop->data.for_stmt.body;
+    Symbol* counter;
+    long start, step;
+    long trips = trip_count(loop, &counter, &start, &step);
+    int factor = optimizer->unroll_factor;
+    if (trips < 2 || factor < 2 || !body || !is_copyable_body(body)) return;
+    if (left_for_vectorizer(optimizer, loop)) return;
+    if (count_assignments(body, counter) > 0) return;
+
+    int size = count_nodes(body, UNROLL_BODY_LIMIT + 1);
+    if (size > UNROLL_BODY_LIMIT) return;
+    if (factor > trips) factor = (int)trips;
+    if (factor * size > UNROLL_CODE_LIMIT) factor = UNROLL_CODE_LIMIT / size;
+    if (factor < 2) return;
+
+    ASTNode* update = loop->data.for_stmt.update;
+    long rounds = trips / factor;
+    long remainder = trips % factor;
+    ASTNode* block = ast_create_node(AST_COMPOUND_STATEMENT);
+    block->line = loop->line;
+    block->column = loop->column;
+
+    if (rounds == 1) {
+        // Uma rodada só: as cópias, sem laço
+        if (trips * size > UNROLL_CODE_LIMIT) {
+            ast_destroy(block);
+            return;
+        }
+        ast_add_child(block, loop->data.for_stmt.init);
+        loop->data.for_stmt.init = NULL;
+        for (long i = 0; i < trips; i++) append_iteration(block, body, update);
+        ast_destroy(loop);
+        *slot = block;
+        optimizer->unrolled_loops++;
+        return;
+    }
+
+    // Corpo com factor cópias; o limite passa a ser o início da última
+    // rodada completa
+    ASTNode* unrolled = ast_create_node(AST_COMPOUND_STATEMENT);
+    unrolled->line = body->line;
+    unrolled->column = body->column;
+    for (int i = 0; i < factor - 1; i++) append_iteration(unrolled, body, update);
+    ast_add_child(unrolled, body);
+    loop->data.for_stmt.body = unrolled;
+
+    ASTNode* condition = loop->data.for_stmt.condition;
+    ASTNode* reference = make_variable_reference(counter, condition);
+    ASTNode* limit = make_int_literal(start + rounds * factor * step, condition);
+    loop->data.for_stmt.condition = make_binary(step > 0 ? TOKEN_LESS : TOKEN_GREATER, reference, limit, condition);
+    ast_destroy(condition);
+
+    if (remainder > 0) {
+        // As voltas restantes ficam depois do laço, junto com o início
+        // (uma declaração no for não seria visível fora dele)
+        if (loop->data.for_stmt.init->type == AST_VARIABLE_DECLARATION) {
+            ast_add_child(block, loop->data.for_stmt.init);
+            loop->data.for_stmt.init = NULL;
+        }
+        ast_add_child(block, loop);
+        for (long i = 0; i < remainder; i++) append_iteration(block, body, update);
+        *slot = block;
+    } else {
+        ast_destroy(block);
+    }
+    optimizer->unrolled_loops++;
+}
+
+static void unroll_statement(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                unroll_statement(optimizer, &stmt->children[i]);
+            }
+            return;
+        case AST_IF_STATEMENT:
+            unroll_statement(optimizer, &stmt->data.if_stmt.then_stmt);
+            unroll_statement(optimizer, &stmt->data.if_stmt.else_stmt);
+            return;
+        case AST_SWITCH_STATEMENT:
+            unroll_statement(optimizer, &stmt->data.switch_stmt.cases);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            unroll_statement(optimizer, &stmt->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            // Internos primeiro: o corpo desenrolado já sai pronto
+            unroll_statement(optimizer, &stmt->data.for_stmt.body);
+            unroll_for(optimizer, slot);
+            return;
+        default:
+            return;
+    }
+}
+
+// Desenrolamento parcial de laços for contados com corpo pequeno
+void unroll_loops(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program || optimizer->unroll_factor < 2) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+        unroll_statement(optimizer, &decl->data.function_decl.body);
+    }
+}
+
+// Produto contador * fator (ou fator * contador) candidato à redução
+typedef struct DerivedProduct {
+    ASTNode** slot;
+    Symbol* counter;
+    const ASTNode* factor;    // Literal inteiro ou local invariante
+} DerivedProduct;
+
+typedef struct CounterUpdate {
+    ASTNode** slot;           // Expressão completa do incremento
+    Symbol* counter;
+    long step;
+} CounterUpdate;
+
+typedef struct InductionVariables {
+    Optimizer* optimizer;
+    ASTNode* function;
+
+    // Laço atual
+    DerivedProduct* products;
+    int product_count;
+    int product_capacity;
+    CounterUpdate* updates;
+    int update_count;
+    int update_capacity;
+    PointerSet assigned;
+    Symbol* tested;           // Contador de um for contado que só é usado no laço
+    long tested_start;
+    long tested_step;
+
+    // Inícios dos temporários, inseridos antes do laço
+    ASTNode** pending;
+    int pending_count;
+    int pending_capacity;
+
+    Symbol** temporaries;
+    int temporary_count;
+    int temporary_capacity;
+} InductionVariables;
+
+static int is_product_factor(const ASTNode* node) {
+    long constant;
+    if (ast_integer_constant(node, &constant)) return constant != 0 && constant != 1;
+    return node->type == AST_IDENTIFIER && is_counter_variable(node->ref.symbol);
+}
+
+static void find_products(InductionVariables* iv, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_BINARY_EXPRESSION: {
+            ASTNode* left = node->data.binary_expr.left;
+            ASTNode* right = node->data.binary_expr.right;
+            if (node->data.binary_expr.operator == TOKEN_MULTIPLY && node->data_type == TYPE_INT) {
+                ASTNode* counter = NULL;
+                const ASTNode* factor = NULL;
+                if (left->type == AST_IDENTIFIER && is_counter_variable(left->ref.symbol) &&
+                    is_product_factor(right)) {
+                    counter = left;
+                    factor = right;
+                } else if (right->type == AST_IDENTIFIER && is_counter_variable(right->ref.symbol) &&
+                           is_product_factor(left)) {
+                    counter = right;
+                    factor = left;
+                }
+                if (counter) {
+                    iv->products = grow_array(iv->products, &iv->product_capacity, iv->product_count + 1,
+                                              sizeof(DerivedProduct));
+                    iv->products[iv->product_count].slot = slot;
+                    iv->products[iv->product_count].counter = counter->ref.symbol;
+                    iv->products[iv->product_count].factor = factor;
+                    iv->product_count++;
+                    return;
+                }
+            }
+            find_products(iv, &node->data.binary_expr.left);
+            find_products(iv, &node->data.binary_expr.right);
+            return;
+        }
+        case AST_ASSIGNMENT_EXPRESSION:
+            find_products(iv, &node->data.binary_expr.left);
+            find_products(iv, &node->data.binary_expr.right);
+            return;
+        case AST_UNARY_EXPRESSION:
+            find_products(iv, &node->data.unary_expr.operand);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            find_products(iv, &node->data.ternary_expr.condition);
+            find_products(iv, &node->data.ternary_expr.true_expr);
+            find_products(iv, &node->data.ternary_expr.false_expr);
+            return;
+        case AST_VARIABLE_DECLARATION:
+            find_products(iv, &node->data.var_decl.initializer);
+            return;
+        case AST_IF_STATEMENT:
+            find_products(iv, &node->data.if_stmt.condition);
+            find_products(iv, &node->data.if_stmt.then_stmt);
+            find_products(iv, &node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            find_products(iv, &node->data.while_stmt.condition);
+            find_products(iv, &node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            find_products(iv, &node->data.for_stmt.init);
+            find_products(iv, &node->data.for_stmt.condition);
+            find_products(iv, &node->data.for_stmt.update);
+            find_products(iv, &node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            find_products(iv, &node->data.switch_stmt.expression);
+            find_products(iv, &node->data.switch_stmt.cases);
+            return;
+        case AST_RETURN_STATEMENT:
+            find_products(iv, &node->data.return_stmt.expression);
+            return;
+        default:
+            // Blocos, rótulos de case, comandos de expressão e chamadas
+            for (int i = 0; i < node->child_count; i++) {
+                find_products(iv, &node->children[i]);
+            }
+            return;
+    }
+}
+
+static void add_update(InductionVariables* iv, ASTNode** slot) {
+    Symbol* counter;
+    long step;
+    if (!counter_increment(*slot, &counter, &step)) return;
+    iv->updates = grow_array(iv->updates, &iv->update_capacity, iv->update_count + 1, sizeof(CounterUpdate));
+    iv->updates[iv->update_count].slot = slot;
+    iv->updates[iv->update_count].counter = counter;
+    iv->updates[iv->update_count].step = step;
+    iv->update_count++;
+}
+
+// Incrementos no nível do comando e nas atualizações de for
+static void find_updates(InductionVariables* iv, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_EXPRESSION_STATEMENT:
+            if (node->child_count > 0) add_update(iv, &node->children[0]);
+            return;
+        case AST_IF_STATEMENT:
+            find_updates(iv, node->data.if_stmt.then_stmt);
+            find_updates(iv, node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            find_updates(iv, node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            find_updates(iv, node->data.for_stmt.init);
+            add_update(iv, &node->data.for_stmt.update);
+            find_updates(iv, node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            find_updates(iv, node->data.switch_stmt.cases);
+            return;
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                find_updates(iv, node->children[i]);
+            }
+            return;
+    }
+}
+
+// O contador só muda pelos incrementos encontrados
+static int is_induction_variable(InductionVariables* iv, ASTNode* loop, Symbol* counter) {
+    int updates = 0;
+    for (int i = 0; i < iv->update_count; i++) {
+        if (iv->updates[i].counter == counter) updates++;
+    }
+    if (updates == 0) return 0;
+
+    int assignments = 0;
+    if (loop->type == AST_FOR_STATEMENT) {
+        // O início do for roda antes do laço
+        assignments = count_assignments(loop->data.for_stmt.condition, counter) +
+                      count_assignments(loop->data.for_stmt.update, counter) +
+                      count_assignments(loop->data.for_stmt.body, counter);
+    } else {
+        assignments = count_assignments(loop, counter);
+    }
+    return assignments == updates;
+}
+
+// Passo do temporário: step * fator, constante ou (com passo ±1) o próprio local
+static ASTNode* product_step(long step, const ASTNode* factor, TokenType* op) {
+    long constant;
+    *op = TOKEN_PLUS;
+    if (ast_integer_constant(factor, &constant)) {
+        long product = step * constant;
+        if (product < INT_MIN + 1 || product > INT_MAX) return NULL;
+        if (product < 0) {
+            *op = TOKEN_MINUS;
+            product = -product;
+        }
+        return make_int_literal(product, factor);
+    }
+    if (step != 1 && step != -1) return NULL;
+    if (step < 0) *op = TOKEN_MINUS;
+    return ast_clone(factor);
+}
+
+static int same_factor(const ASTNode* a, const ASTNode* b) {
+    long x, y;
+    if (ast_integer_constant(a, &x)) return ast_integer_constant(b, &y) && x == y;
+    return a->type == AST_IDENTIFIER && b->type == AST_IDENTIFIER && a->ref.symbol == b->ref.symbol;
+}
+
+// Com os produtos do grupo reduzidos, o contador testado sobra só para o
+// teste e para os próprios incrementos: o teste i < B vira t < B * C (fator
+// constante, sem estouro em nenhum valor que t assume) e os incrementos de
+// i deixam de ser necessários
+static int can_replace_test(InductionVariables* iv, ASTNode* loop, Symbol* counter, const ASTNode* factor,
+                            int products, long* bound) {
+    long constant;
+    if (counter != iv->tested || !ast_integer_constant(factor, &constant)) return 0;
+
+    ASTNode* condition = loop->data.for_stmt.condition;
+    ASTNode* left = condition->data.binary_expr.left;
+    ASTNode* limit = left->type == AST_IDENTIFIER && left->ref.symbol == counter ? condition->data.binary_expr.right
+                                                                               : left;
+    if (!ast_integer_constant(limit, bound)) return 0;
+
+    // Usos no laço: um no teste, um por produto e os dos incrementos
+    int expected = 1 + products;
+    long reach = 0;
+    for (int i = 0; i < iv->update_count; i++) {
+        if (iv->updates[i].counter != counter) continue;
+        long step = iv->updates[i].step;
+        if ((step > 0) != (iv->tested_step > 0)) return 0;
+        expected += count_uses(*iv->updates[i].slot, counter);
+        reach += step > 0 ? step : -step;
+    }
+    int inside = count_uses(condition, counter) + count_uses(loop->data.for_stmt.update, counter) +
+                 count_uses(loop->data.for_stmt.body, counter);
+    if (inside != expected) return 0;
+
+    // O contador vai do início até passar do limite em no máximo reach
+    long extreme = (*bound < 0 ? -*bound : *bound) + reach;
+    long start = iv->tested_start < 0 ? -iv->tested_start : iv->tested_start;
+    if (start > extreme) extreme = start;
+    long magnitude = constant < 0 ? -constant : constant;
+    return extreme <= INT_MAX / magnitude;
+}
+
+static void replace_test(InductionVariables* iv, ASTNode* loop, Symbol* counter, Symbol* temporary,
+                         const ASTNode* factor, long bound) {
+    long constant;
+    ast_integer_constant(factor, &constant);
+
+    ASTNode* condition = loop->data.for_stmt.condition;
+    ASTNode** left = &condition->data.binary_expr.left;
+    ASTNode** right = &condition->data.binary_expr.right;
+    ASTNode** counter_slot = (*left)->type == AST_IDENTIFIER && (*left)->ref.symbol == counter ? left : right;
+    ASTNode** limit_slot = counter_slot == left ? right : left;
+
+    ASTNode* old = *counter_slot;
+    *counter_slot = make_variable_reference(temporary, old);
+    ast_destroy(old);
+    old = *limit_slot;
+    *limit_slot = make_int_literal(bound * constant, old);
+    ast_destroy(old);
+    if (constant < 0) {
+        condition->data.binary_expr.operator = mirror_comparison(condition->data.binary_expr.operator);
+    }
+
+    // ((i = i + K, t = t + K * C), ...) fica só com os avanços dos temporários
+    for (int i = 0; i < iv->update_count; i++) {
+        if (iv->updates[i].counter != counter) continue;
+        ASTNode** slot = iv->updates[i].slot;
+        while ((*slot)->data.binary_expr.left->type == AST_BINARY_EXPRESSION &&
+               (*slot)->data.binary_expr.left->data.binary_expr.operator == TOKEN_COMMA) {
+            slot = &(*slot)->data.binary_expr.left;
+        }
+        ASTNode* pair = *slot;
+        *slot = pair->data.binary_expr.right;
+        pair->data.binary_expr.right = NULL;
+        ast_destroy(pair);
+    }
+    iv->optimizer->replaced_tests++;
+}
+
+// Reduz os produtos do grupo (contador, fator) do produto index
+static void reduce_product(InductionVariables* iv, ASTNode* loop, int index, ASTNode** init_slot) {
+    DerivedProduct* product = &iv->products[index];
+    Symbol* counter = product->counter;
+    const ASTNode* factor = product->factor;
+
+    // Fator local: não pode mudar dentro do laço
+    if (factor->type == AST_IDENTIFIER && pointer_set_contains(&iv->assigned, factor->ref.symbol)) return;
+    if (factor->type == AST_IDENTIFIER && factor->ref.symbol == counter) return;
+
+    // Os passos precisam caber antes de qualquer mudança
+    for (int i = 0; i < iv->update_count; i++) {
+        if (iv->updates[i].counter != counter) continue;
+        TokenType op;
+        ASTNode* step = product_step(iv->updates[i].step, factor, &op);
+        if (!step) return;
+        ast_destroy(step);
+    }
+
+    int products = 0;
+    for (int i = index; i < iv->product_count; i++) {
+        DerivedProduct* other = &iv->products[i];
+        if (other->slot && other->counter == counter && same_factor(other->factor, factor)) products++;
+    }
+    long bound;
+    int replace = can_replace_test(iv, loop, counter, factor, products, &bound);
+
+    // O fator mora dentro do produto, que é destruído ao ser trocado
+    ASTNode* origin = *product->slot;
+    factor = ast_clone(factor);
+    Symbol* temporary = create_temporary_symbol(iv->optimizer, origin);
+    allocate_temporary(iv->optimizer, iv->function, temporary);
+    iv->temporaries = grow_array(iv->temporaries, &iv->temporary_capacity, iv->temporary_count + 1,
+                                 sizeof(Symbol*));
+    iv->temporaries[iv->temporary_count++] = temporary;
+
+    // Início: t = i * C, logo depois do início do for ou antes do laço
+    ASTNode* start = make_temporary_assignment(temporary,
+        make_binary(TOKEN_MULTIPLY, make_variable_reference(counter, origin), ast_clone(factor), origin));
+    if (init_slot) {
+        *init_slot = make_binary(TOKEN_COMMA, *init_slot, start, origin);
+    } else {
+        iv->pending = grow_array(iv->pending, &iv->pending_capacity, iv->pending_count + 1, sizeof(ASTNode*));
+        iv->pending[iv->pending_count++] = make_statement(start);
+    }
+
+    // Cada incremento de i soma step * C em t
+    for (int i = 0; i < iv->update_count; i++) {
+        if (iv->updates[i].counter != counter) continue;
+        TokenType op;
+        ASTNode* step = product_step(iv->updates[i].step, factor, &op);
+        ASTNode** slot = iv->updates[i].slot;
+        ASTNode* advance = make_temporary_assignment(temporary,
+            make_binary(op, make_variable_reference(temporary, *slot), step, *slot));
+        *slot = make_binary(TOKEN_COMMA, *slot, advance, *slot);
+    }
+
+    // Os produtos viram leituras de t
+    for (int i = index; i < iv->product_count; i++) {
+        DerivedProduct* other = &iv->products[i];
+        if (!other->slot || other->counter != counter || !same_factor(other->factor, factor)) continue;
+        ASTNode* node = *other->slot;
+        *other->slot = make_variable_reference(temporary, node);
+        ast_destroy(node);
+        other->slot = NULL;
+        iv->optimizer->reduced_products++;
+    }
+    if (replace) {
+        replace_test(iv, loop, counter, temporary, factor, bound);
+        iv->tested = NULL;
+    }
+    ast_destroy((ASTNode*)factor);
+}
+
+static void reduce_loop(InductionVariables* iv, ASTNode** slot) {
+    ASTNode* loop = *slot;
+    if (left_for_vectorizer(iv->optimizer, loop)) return;
+    iv->product_count = 0;
+    iv->update_count = 0;
+    iv->assigned.count = 0;
+
+    // Partes repetidas do laço: o início do for fica de fora
+    ASTNode** init_slot = NULL;
+    iv->tested = NULL;
+    if (loop->type == AST_FOR_STATEMENT) {
+        Symbol* counter;
+        long start, step;
+        if (trip_count(loop, &counter, &start, &step) > 0 &&
+            count_uses(iv->function->data.function_decl.body, counter) == count_uses(loop, counter)) {
+            iv->tested = counter;
+            iv->tested_start = start;
+            iv->tested_step = step;
+        }
+
+        find_products(iv, &loop->data.for_stmt.condition);
+        find_products(iv, &loop->data.for_stmt.update);
+        find_products(iv, &loop->data.for_stmt.body);
+        add_update(iv, &loop->data.for_stmt.update);
+        find_updates(iv, loop->data.for_stmt.body);
+
+        int writes = 0;
+        collect_assignments(loop->data.for_stmt.condition, &iv->assigned, &writes);
+        collect_assignments(loop->data.for_stmt.update, &iv->assigned, &writes);
+        collect_assignments(loop->data.for_stmt.body, &iv->assigned, &writes);
+
+        ASTNode* init = loop->data.for_stmt.init;
+        if (init && init->type == AST_EXPRESSION_STATEMENT && init->child_count > 0) {
+            init_slot = &init->children[0];
+        }
+    } else {
+        find_products(iv, &loop->data.while_stmt.condition);
+        find_products(iv, &loop->data.while_stmt.body);
+        find_updates(iv, loop->data.while_stmt.body);
+
+        int writes = 0;
+        collect_assignments(loop, &iv->assigned, &writes);
+    }
+    pointer_set_sort(&iv->assigned);
+    if (iv->product_count == 0) return;
+
+    // Com declaração no início do for, o laço vai para um bloco com ela
+    ASTNode* block = NULL;
+    int base = iv->pending_count;
+    if (loop->type == AST_FOR_STATEMENT && loop->data.for_stmt.init && !init_slot &&
+        loop->data.for_stmt.init->type == AST_VARIABLE_DECLARATION) {
+        block = ast_create_node(AST_COMPOUND_STATEMENT);
+        block->line = loop->line;
+        block->column = loop->column;
+        ast_add_child(block, loop->data.for_stmt.init);
+        loop->data.for_stmt.init = NULL;
+    }
+
+    int temporaries = iv->temporary_count;
+    for (int i = 0; i < iv->product_count; i++) {
+        DerivedProduct* product = &iv->products[i];
+        if (!product->slot || !is_induction_variable(iv, loop, product->counter)) continue;
+        reduce_product(iv, loop, i, init_slot);
+    }
+
+    if (block && iv->temporary_count == temporaries) {
+        loop->data.for_stmt.init = block->children[0];
+        block->child_count = 0;
+        ast_destroy(block);
+    } else if (block) {
+        for (int i = base; i < iv->pending_count; i++) {
+            ast_add_child(block, iv->pending[i]);
+        }
+        iv->pending_count = base;
+        ast_add_child(block, loop);
+        *slot = block;
+    }
+}
+
+static void reduce_statement(InductionVariables* iv, ASTNode** slot);
+
+static void reduce_list(InductionVariables* iv, ASTNode* list) {
+    int base = iv->pending_count;
+
+    for (int i = 0; i < list->child_count; i++) {
+        reduce_statement(iv, &list->children[i]);
+
+        int extra = iv->pending_count - base;
+        if (extra == 0) continue;
+        insert_children(list, i, &iv->pending[base], extra);
+        iv->pending_count = base;
+        i += extra;
+    }
+}
+
+static void reduce_branch(InductionVariables* iv, ASTNode** slot) {
+    int base = iv->pending_count;
+    reduce_statement(iv, slot);
+
+    if (iv->pending_count > base && *slot) {
+        ASTNode* block = ast_create_node(AST_COMPOUND_STATEMENT);
+        for (int i = base; i < iv->pending_count; i++) {
+            ast_add_child(block, iv->pending[i]);
+        }
+        ast_add_child(block, *slot);
+        *slot = block;
+    }
+    iv->pending_count = base;
+}
+
+static void reduce_statement(InductionVariables* iv, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            reduce_list(iv, stmt);
+            return;
+        case AST_IF_STATEMENT:
+            reduce_branch(iv, &stmt->data.if_stmt.then_stmt);
+            reduce_branch(iv, &stmt->data.if_stmt.else_stmt);
+            return;
+        case AST_SWITCH_STATEMENT:
+            reduce_statement(iv, &stmt->data.switch_stmt.cases);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            reduce_loop(iv, slot);
+            reduce_branch(iv, &stmt->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            reduce_loop(iv, slot);
+            reduce_branch(iv, &stmt->data.for_stmt.body);
+            return;
+        default:
+            return;
+    }
+}
+
+// Redução de força: produtos do contador de um laço viram somas
+void reduce_induction_variables(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+
+        InductionVariables iv = {0};
+        iv.optimizer = optimizer;
+        iv.function = decl;
+        reduce_list(&iv, decl->data.function_decl.body);
+        declare_temporaries(optimizer, decl, iv.temporaries, iv.temporary_count);
+        optimizer->induction_temporaries += iv.temporary_count;
+
+        free(iv.products);
+        free(iv.updates);
+        free(iv.assigned.items);
+        free(iv.pending);
+        free(iv.temporaries);
+    }
+}
+
+// ------------------------------------------------------------
+// Conversão de desvios em seleções (if-conversion)
+//
+// Um diamante pequeno, if/else em que os dois ramos só atribuem à mesma
+// local int/char, vira x = c ? a : b (um if sem else vira x = c ? a : x).
+// Ternários int/char que passam no modelo de custo são marcados
+// branchless, e o backend os gera sem desvio: cmov ou setcc no assembly,
+// ISELECT no bytecode. Os dois lados passam a ser calculados sempre, e a
+// condição depois deles: os lados precisam ser baratos e seguros de
+// calcular à toa (sem efeitos colaterais, chamadas, divisões ou acessos
+// por ponteiro), e a condição só pode escrever em variáveis que os lados
+// não leem (caso dos temporários das subexpressões comuns).
+//
+// Um desvio bem previsto custa quase nada, e o cmov prende o resultado à
+// condição; desvios previsíveis ficam como estão: os que o perfil
+// (-fprofile-use) mostra tendenciosos e, sem perfil, as igualdades com
+// constante, que costumam dar falso (heurística de Ball e Larus).
+// Escolher entre duas constantes não perde para o desvio em caso algum.
+// ------------------------------------------------------------
+
+#define SELECT_MAX_COST 4         // Operações somando os dois lados
+#define SELECT_UNSAFE (-1)
+
+static int is_integer_type(DataType type) {
+    return type == TYPE_INT || type == TYPE_CHAR;
+}
+
+// Custo de calcular a expressão mesmo quando o valor não é usado, ou
+// SELECT_UNSAFE se isso não é seguro
+static int speculation_cost(const ASTNode* node) {
+    if (!node || !is_integer_type(node->data_type)) return SELECT_UNSAFE;
+
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_CHAR_LITERAL:
+            return 0;
+
+        case AST_IDENTIFIER: {
+            const Symbol* symbol = node->ref.symbol;
+            return symbol && (symbol->kind == SYMBOL_VARIABLE || symbol->kind == SYMBOL_PARAMETER)
+                   ? 0 : SELECT_UNSAFE;
+        }
+
+        case AST_UNARY_EXPRESSION: {
+            UnaryOperator op = node->data.unary_expr.operator;
+            if (op != UNARY_PLUS && op != UNARY_MINUS && op != UNARY_NOT && op != UNARY_BITWISE_NOT) {
+                return SELECT_UNSAFE;
+            }
+            int cost = speculation_cost(node->data.unary_expr.operand);
+            return cost == SELECT_UNSAFE ? cost : cost + 1;
+        }
+
+        case AST_BINARY_EXPRESSION: {
+            int cost;
+            switch (node->data.binary_expr.operator) {
+                case TOKEN_PLUS:
+                case TOKEN_MINUS:
+                case TOKEN_BITWISE_AND:
+                case TOKEN_BITWISE_OR:
+                case TOKEN_BITWISE_XOR:
+                case TOKEN_LEFT_SHIFT:
+                case TOKEN_RIGHT_SHIFT:
+                case TOKEN_EQUAL:
+                case TOKEN_NOT_EQUAL:
+                case TOKEN_LESS:
+                case TOKEN_GREATER:
+                case TOKEN_LESS_EQUAL:
+                case TOKEN_GREATER_EQUAL:
+                    cost = 1;
+                    break;
+                case TOKEN_MULTIPLY:
+                    cost = 3;
+                    break;
+                default:
+                    // Divisões podem falhar; && e || desviam
+                    return SELECT_UNSAFE;
+            }
+            int left = speculation_cost(node->data.binary_expr.left);
+            int right = speculation_cost(node->data.binary_expr.right);
+            if (left == SELECT_UNSAFE || right == SELECT_UNSAFE) return SELECT_UNSAFE;
+            return cost + left + right;
+        }
+
+        case AST_TERNARY_EXPRESSION: {
+            // Só os já convertidos: o de dentro também não desvia
+            if (!node->data.ternary_expr.branchless) return SELECT_UNSAFE;
+            int condition = speculation_cost(node->data.ternary_expr.condition);
+            int true_cost = speculation_cost(node->data.ternary_expr.true_expr);
+            int false_cost = speculation_cost(node->data.ternary_expr.false_expr);
+            if (condition == SELECT_UNSAFE || true_cost == SELECT_UNSAFE || false_cost == SELECT_UNSAFE) {
+                return SELECT_UNSAFE;
+            }
+            return 1 + condition + true_cost + false_cost;
+        }
+
+        default:
+            return SELECT_UNSAFE;
+    }
+}
+
+// x == K e x != K: costumam dar falso, e o preditor acerta
+static int is_constant_equality(const ASTNode* condition) {
+    if (condition->type != AST_BINARY_EXPRESSION) return 0;
+    TokenType op = condition->data.binary_expr.operator;
+    long value;
+    return (op == TOKEN_EQUAL || op == TOKEN_NOT_EQUAL) &&
+           (ast_integer_constant(condition->data.binary_expr.left, &value) ||
+            ast_integer_constant(condition->data.binary_expr.right, &value));
+}
+
+// A condição pode ser calculada depois dos lados: sem chamadas nem ++/--,
+// e as variáveis que ela atribui não aparecem nos lados
+static int commutes_with_arms(const ASTNode* node, const ASTNode* true_expr, const ASTNode* false_expr) {
+    if (!node) return 1;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL:
+            return 0;
+        case AST_ASSIGNMENT_EXPRESSION: {
+            const Symbol* target = node->data.binary_expr.left->ref.symbol;
+            if (node->data.binary_expr.left->type != AST_IDENTIFIER || !target ||
+                count_uses(true_expr, target) || count_uses(false_expr, target)) return 0;
+            return commutes_with_arms(node->data.binary_expr.right, true_expr, false_expr);
+        }
+        case AST_UNARY_EXPRESSION:
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT:
+                    return 0;
+                default:
+                    return commutes_with_arms(node->data.unary_expr.operand, true_expr, false_expr);
+            }
+        case AST_BINARY_EXPRESSION:
+            return commutes_with_arms(node->data.binary_expr.left, true_expr, false_expr) &&
+                   commutes_with_arms(node->data.binary_expr.right, true_expr, false_expr);
+        case AST_TERNARY_EXPRESSION:
+            return commutes_with_arms(node->data.ternary_expr.condition, true_expr, false_expr) &&
+                   commutes_with_arms(node->data.ternary_expr.true_expr, true_expr, false_expr) &&
+                   commutes_with_arms(node->data.ternary_expr.false_expr, true_expr, false_expr);
+        default:
+            return 1;
+    }
+}
+
+// Modelo de custo; branch é o if de onde a seleção viria (NULL para um
+// ternário do programa, que não tem ponto no perfil)
+static int select_pays_off(Optimizer* optimizer, const ASTNode* branch, const ASTNode* condition,
+                           const ASTNode* true_expr, const ASTNode* false_expr) {
+    int true_cost = speculation_cost(true_expr);
+    int false_cost = speculation_cost(false_expr);
+    if (true_cost == SELECT_UNSAFE || false_cost == SELECT_UNSAFE) return 0;
+    if (!commutes_with_arms(condition, true_expr, false_expr) || !is_integer_type(condition->data_type)) return 0;
+    if (condition->type == AST_BINARY_EXPRESSION &&
+        (condition->data.binary_expr.operator == TOKEN_AND || condition->data.binary_expr.operator == TOKEN_OR)) {
+        return 0;
+    }
+
+    long value;
+    if (ast_integer_constant(true_expr, &value) && ast_integer_constant(false_expr, &value)) return 1;
+    if (true_cost + false_cost > SELECT_MAX_COST) {
+        optimizer->expensive_selects++;
+        return 0;
+    }
+
+    int predictable = profile_lookup(optimizer->profile, branch)
+                      ? profile_branch_bias(optimizer->profile, branch) != 0
+                      : is_constant_equality(condition);
+    if (predictable) {
+        optimizer->predictable_branches++;
+        return 0;
+    }
+    return 1;
+}
+
+// x = a como comando (sozinho ou num bloco de um comando só), com x
+// local int/char
+static ASTNode** single_assignment(ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return NULL;
+    if (stmt->type == AST_COMPOUND_STATEMENT) {
+        return stmt->child_count == 1 ? single_assignment(&stmt->children[0]) : NULL;
+    }
+    if (stmt->type != AST_EXPRESSION_STATEMENT || stmt->child_count != 1) return NULL;
+
+    ASTNode* expression = stmt->children[0];
+    if (expression->type != AST_ASSIGNMENT_EXPRESSION ||
+        expression->data.binary_expr.operator != TOKEN_ASSIGN) return NULL;
+    ASTNode* target = expression->data.binary_expr.left;
+    Symbol* symbol = target->type == AST_IDENTIFIER ? target->ref.symbol : NULL;
+    if (!symbol || (symbol->kind != SYMBOL_VARIABLE && symbol->kind != SYMBOL_PARAMETER) ||
+        is_shared_variable(symbol) || !is_integer_type(symbol->type)) return NULL;
+    return &stmt->children[0];
+}
+
+static void convert_if(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    // Na compilação instrumentada o contador do desvio precisa continuar lá
+    if (optimizer->profile && optimizer->profile->generate_path) return;
+
+    ASTNode** then_slot = single_assignment(&stmt->data.if_stmt.then_stmt);
+    if (!then_slot) return;
+    ASTNode* assignment = *then_slot;
+    Symbol* target = assignment->data.binary_expr.left->ref.symbol;
+
+    ASTNode** else_slot = NULL;
+    ASTNode* false_expr = assignment->data.binary_expr.left;
+    if (stmt->data.if_stmt.else_stmt) {
+        else_slot = single_assignment(&stmt->data.if_stmt.else_stmt);
+        if (!else_slot || (*else_slot)->data.binary_expr.left->ref.symbol != target) return;
+        false_expr = (*else_slot)->data.binary_expr.right;
+    }
+    ASTNode* condition = stmt->data.if_stmt.condition;
+    if (!select_pays_off(optimizer, stmt, condition, assignment->data.binary_expr.right, false_expr)) return;
+
+    ASTNode* select = ast_create_node(AST_TERNARY_EXPRESSION);
+    select->data.ternary_expr.condition = condition;
+    select->data.ternary_expr.true_expr = assignment->data.binary_expr.right;
+    select->data.ternary_expr.false_expr = else_slot ? false_expr : ast_clone(false_expr);
+    select->data.ternary_expr.branchless = 1;
+    select->data_type = target->type;
+    select->type_id = target->type_id;
+    select->line = stmt->line;
+    select->column = stmt->column;
+
+    assignment->data.binary_expr.right = select;
+    stmt->data.if_stmt.condition = NULL;
+    if (else_slot) (*else_slot)->data.binary_expr.right = NULL;
+    *then_slot = NULL;
+    *slot = make_statement(assignment);
+    ast_destroy(stmt);
+
+    optimizer->converted_branches++;
+    optimizer->branchless_selects++;
+}
+
+// De baixo para cima: um ternário interno convertido ainda é barato
+static void convert_expression(Optimizer* optimizer, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            convert_expression(optimizer, node->data.binary_expr.left);
+            convert_expression(optimizer, node->data.binary_expr.right);
+            return;
+        case AST_UNARY_EXPRESSION:
+            convert_expression(optimizer, node->data.unary_expr.operand);
+            return;
+        case AST_ARRAY_ACCESS:
+            convert_expression(optimizer, node->data.array_access.array);
+            convert_expression(optimizer, node->data.array_access.index);
+            return;
+        case AST_TERNARY_EXPRESSION: {
+            ASTTernaryExpr* ternary = &node->data.ternary_expr;
+            convert_expression(optimizer, ternary->condition);
+            convert_expression(optimizer, ternary->true_expr);
+            convert_expression(optimizer, ternary->false_expr);
+            if (!ternary->branchless && is_integer_type(node->data_type) &&
+                select_pays_off(optimizer, NULL, ternary->condition, ternary->true_expr, ternary->false_expr)) {
+                ternary->branchless = 1;
+                optimizer->branchless_selects++;
+            }
+            return;
+        }
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                convert_expression(optimizer, node->children[i]);
+            }
+            return;
+    }
+}
+
+static void convert_statement(Optimizer* optimizer, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                convert_statement(optimizer, &stmt->children[i]);
+            }
+            return;
+        case AST_EXPRESSION_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                convert_expression(optimizer, stmt->children[i]);
+            }
+            return;
+        case AST_VARIABLE_DECLARATION:
+            convert_expression(optimizer, stmt->data.var_decl.initializer);
+            return;
+        case AST_RETURN_STATEMENT:
+            convert_expression(optimizer, stmt->data.return_stmt.expression);
+            return;
+        case AST_IF_STATEMENT:
+            convert_expression(optimizer, stmt->data.if_stmt.condition);
+            convert_statement(optimizer, &stmt->data.if_stmt.then_stmt);
+            convert_statement(optimizer, &stmt->data.if_stmt.else_stmt);
+            convert_if(optimizer, slot);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            if (left_for_vectorizer(optimizer, stmt)) return;
+            convert_expression(optimizer, stmt->data.while_stmt.condition);
+            convert_statement(optimizer, &stmt->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            if (left_for_vectorizer(optimizer, stmt)) return;
+            convert_statement(optimizer, &stmt->data.for_stmt.init);
+            convert_expression(optimizer, stmt->data.for_stmt.condition);
+            convert_expression(optimizer, stmt->data.for_stmt.update);
+            convert_statement(optimizer, &stmt->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            convert_expression(optimizer, stmt->data.switch_stmt.expression);
+            convert_statement(optimizer, &stmt->data.switch_stmt.cases);
+            return;
+        default:
+            return;
+    }
+}
+
+// If-conversion: diamantes pequenos e ternários baratos viram seleções
+void convert_branches_to_selects(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body) continue;
+        convert_statement(optimizer, &decl->data.function_decl.body);
+    }
+}
+
+#define INLINE_MAX_GROWTH 8      // Crescimento de cada função: até 8x o limite
+
+// ------------------------------------------------------------
+// Expansão de funções em linha (inlining)
+//
+// O grafo de chamadas sai dos nós AST_FUNCTION_CALL e é percorrido por
+// componentes fortemente conexas (Tarjan), que saem na ordem "chamadas
+// antes de quem chama": o corpo copiado já traz as próprias expansões, e
+// uma função num ciclo do grafo (recursiva) nunca é expandida.
+//
+// De cada função expansível sai um modelo: cópia do corpo com as
+// declarações trocadas por atribuições e cada return trocado por
+// "resultado = valor" (o que segue um if com return é movido para dentro
+// dos ramos que continuam). Em cada chamada o modelo é copiado com
+// símbolos novos no frame de quem chama; argumentos literais e locais
+// não alterados entram direto no lugar do parâmetro, o que deixa o
+// dobramento de constantes seguinte trabalhar no corpo expandido.
+//
+// Um modelo sem laços vira uma expressão (vírgulas e ?:) e substitui a
+// chamada onde ela estiver; os demais só substituem chamadas que formam
+// o comando inteiro (f(x);  v = f(x);  T v = f(x);  return f(x);), com o
+// bloco inserido antes do comando.
+//
+// No meio de uma expressão, o corpo de uma chamada roda sem se misturar
+// com o resto; expandido, não. Lá só entram funções que não tocam a
+// memória, ou que só a leem quando nada na expressão escreve (nem
+// atribuição nem chamada impura); as que escrevem continuam chamadas.
+// ------------------------------------------------------------
+
+typedef struct InlineFunction {
+    ASTNode* decl;
+    int* callees;             // Índices das funções chamadas no corpo
+    int callee_count;
+    int callee_capacity;
+    int index;                // Tarjan: ordem de visita (-1 = não visitada)
+    int low;
+    int on_stack;
+    int recursive;
+
+    // Modelo (body NULL se a função não é expansível)
+    ASTNode* body;            // Bloco sem return
+    ASTNode* value;           // O mesmo como expressão (NULL se não cabe)
+    Symbol** locals;          // Parâmetros, locais e resultado do modelo
+    int local_count;
+    int local_capacity;
+    int param_count;
+    Symbol* result;           // NULL em funções void
+    PointerSet outer;         // Globais e funções que o modelo usa pelo nome
+    int size;                 // Nós do modelo
+    const char* reason;       // Por que não é expansível
+} InlineFunction;
+
+typedef struct Inliner {
+    Optimizer* optimizer;
+    InlineFunction* functions;
+    int function_count;
+
+    // Tarjan
+    int* stack;
+    int stack_count;
+    int visit_counter;
+
+    // Função sendo reescrita
+    InlineFunction* caller;
+    int loop_depth;
+    int growth;               // Nós acrescentados ao corpo
+    ASTNode* pending;         // Bloco a inserir antes do comando atual
+    int expression_writes;    // A expressão do comando atual escreve na memória
+    Symbol** temporaries;     // Símbolos novos, declarados no fim
+    int temporary_count;
+    int temporary_capacity;
+} Inliner;
+
+// Decisões iguais (mesma chamadora, chamada e motivo) viram uma linha
+static void record_inline_decision(Optimizer* optimizer, const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    for (int i = 0; i < optimizer->inline_decision_count; i++) {
+        if (strcmp(optimizer->inline_decisions[i], text) == 0) {
+            optimizer->inline_decision_counts[i]++;
+            return;
+        }
+    }
+    int capacity = optimizer->inline_decision_capacity;
+    optimizer->inline_decisions = grow_array(optimizer->inline_decisions, &optimizer->inline_decision_capacity,
+                                             optimizer->inline_decision_count + 1, sizeof(char*));
+    optimizer->inline_decision_counts = grow_array(optimizer->inline_decision_counts, &capacity,
+                                                   optimizer->inline_decision_count + 1, sizeof(int));
+    optimizer->inline_decisions[optimizer->inline_decision_count] = strdup(text);
+    optimizer->inline_decision_counts[optimizer->inline_decision_count++] = 1;
+}
+
+static int find_inline_function(Inliner* in, const Symbol* symbol) {
+    for (int i = 0; i < in->function_count; i++) {
+        if (in->functions[i].decl->ref.symbol == symbol) return i;
+    }
+    return -1;
+}
+
+static void collect_callees(Inliner* in, InlineFunction* function, const ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL: {
+            int callee = find_inline_function(in, node->ref.symbol);
+            if (callee >= 0) {
+                function->callees = grow_array(function->callees, &function->callee_capacity,
+                                               function->callee_count + 1, sizeof(int));
+                function->callees[function->callee_count++] = callee;
+            }
+            break;
+        }
+        case AST_VARIABLE_DECLARATION:
+            collect_callees(in, function, node->data.var_decl.initializer);
+            return;
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            collect_callees(in, function, node->data.binary_expr.left);
+            collect_callees(in, function, node->data.binary_expr.right);
+            return;
+        case AST_UNARY_EXPRESSION:
+            collect_callees(in, function, node->data.unary_expr.operand);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            collect_callees(in, function, node->data.ternary_expr.condition);
+            collect_callees(in, function, node->data.ternary_expr.true_expr);
+            collect_callees(in, function, node->data.ternary_expr.false_expr);
+            return;
+        case AST_IF_STATEMENT:
+            collect_callees(in, function, node->data.if_stmt.condition);
+            collect_callees(in, function, node->data.if_stmt.then_stmt);
+            collect_callees(in, function, node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            collect_callees(in, function, node->data.while_stmt.condition);
+            collect_callees(in, function, node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            collect_callees(in, function, node->data.for_stmt.init);
+            collect_callees(in, function, node->data.for_stmt.condition);
+            collect_callees(in, function, node->data.for_stmt.update);
+            collect_callees(in, function, node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            collect_callees(in, function, node->data.switch_stmt.expression);
+            collect_callees(in, function, node->data.switch_stmt.cases);
+            return;
+        case AST_RETURN_STATEMENT:
+            collect_callees(in, function, node->data.return_stmt.expression);
+            return;
+        default:
+            break;
+    }
+
+    for (int i = 0; i < node->child_count; i++) {
+        collect_callees(in, function, node->children[i]);
+    }
+}
+
+// ============================================================
+// Modelo da função expandida
+// ============================================================
+
+static int contains_return(const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_RETURN_STATEMENT:
+            return 1;
+        case AST_IF_STATEMENT:
+            return contains_return(node->data.if_stmt.then_stmt) || contains_return(node->data.if_stmt.else_stmt);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return contains_return(node->data.while_stmt.body);
+        case AST_FOR_STATEMENT:
+            return contains_return(node->data.for_stmt.body);
+        case AST_SWITCH_STATEMENT:
+            return contains_return(node->data.switch_stmt.cases);
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                if (contains_return(node->children[i])) return 1;
+            }
+            return 0;
+    }
+}
+
+static int declares_static(const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            return (node->data.var_decl.modifiers & MOD_STATIC) != 0;
+        case AST_IF_STATEMENT:
+            return declares_static(node->data.if_stmt.then_stmt) || declares_static(node->data.if_stmt.else_stmt);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return declares_static(node->data.while_stmt.body);
+        case AST_FOR_STATEMENT:
+            return declares_static(node->data.for_stmt.init) || declares_static(node->data.for_stmt.body);
+        case AST_SWITCH_STATEMENT:
+            return declares_static(node->data.switch_stmt.cases);
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                if (declares_static(node->children[i])) return 1;
+            }
+            return 0;
+    }
+}
+
+// Algum local declarado no trecho tem esse nome?
+static int declares_name(const ASTNode* node, const char* name) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            return strcmp(node->data.var_decl.name, name) == 0;
+        case AST_IF_STATEMENT:
+            return declares_name(node->data.if_stmt.then_stmt, name) ||
+                   declares_name(node->data.if_stmt.else_stmt, name);
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            return declares_name(node->data.while_stmt.body, name);
+        case AST_FOR_STATEMENT:
+            return declares_name(node->data.for_stmt.init, name) ||
+                   declares_name(node->data.for_stmt.body, name);
+        case AST_SWITCH_STATEMENT:
+            return declares_name(node->data.switch_stmt.cases, name);
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                if (declares_name(node->children[i], name)) return 1;
+            }
+            return 0;
+    }
+}
+
+static int is_template_local(const InlineFunction* function, const Symbol* symbol) {
+    for (int i = 0; i < function->local_count; i++) {
+        if (function->locals[i] == symbol) return 1;
+    }
+    return 0;
+}
+
+// O backend C escreve os nomes: um parâmetro ou local de quem chama com o
+// nome de uma global lida pelo modelo a esconderia do corpo expandido
+static const char* shadowed_outer_name(const InlineFunction* callee, const ASTNode* caller) {
+    const ASTNode* params = caller->data.function_decl.parameters;
+    for (int i = 0; i < callee->outer.count; i++) {
+        const char* name = ((const Symbol*)callee->outer.items[i])->name;
+        for (int p = 0; params && p < params->child_count; p++) {
+            if (strcmp(params->children[p]->data.parameter.name, name) == 0) return name;
+        }
+        if (declares_name(caller->data.function_decl.body, name)) return name;
+    }
+    return NULL;
+}
+
+static void add_template_local(InlineFunction* function, Symbol* symbol) {
+    function->locals = grow_array(function->locals, &function->local_capacity,
+                                  function->local_count + 1, sizeof(Symbol*));
+    function->locals[function->local_count++] = symbol;
+}
+
+static ASTNode* make_assignment(Symbol* target, ASTNode* value, const ASTNode* origin) {
+    ASTNode* node = ast_create_node(AST_ASSIGNMENT_EXPRESSION);
+    node->data.binary_expr.operator = TOKEN_ASSIGN;
+    node->data.binary_expr.left = make_variable_reference(target, origin);
+    node->data.binary_expr.right = value;
+    node->data_type = target->type;
+    node->type_id = target->type_id;
+    node->line = origin->line;
+    node->column = origin->column;
+    return node;
+}
+
+// Declarações viram atribuições (os locais passam a ser do frame de quem
+// chama); sem inicializador, viram um bloco vazio
+static void lower_declarations(InlineFunction* function, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION: {
+            add_template_local(function, node->ref.symbol);
+            ASTNode* initializer = node->data.var_decl.initializer;
+            node->data.var_decl.initializer = NULL;
+            *slot = initializer ? make_statement(make_assignment(node->ref.symbol, initializer, node))
+                                : ast_create_node(AST_COMPOUND_STATEMENT);
+            ast_destroy(node);
+            return;
+        }
+        case AST_IF_STATEMENT:
+            lower_declarations(function, &node->data.if_stmt.then_stmt);
+            lower_declarations(function, &node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            lower_declarations(function, &node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT: {
+            // Na inicialização do for a atribuição fica como expressão
+            ASTNode* init = node->data.for_stmt.init;
+            if (init && init->type == AST_VARIABLE_DECLARATION) {
+                add_template_local(function, init->ref.symbol);
+                ASTNode* initializer = init->data.var_decl.initializer;
+                init->data.var_decl.initializer = NULL;
+                node->data.for_stmt.init = initializer ? make_assignment(init->ref.symbol, initializer, init) : NULL;
+                ast_destroy(init);
+            }
+            lower_declarations(function, &node->data.for_stmt.body);
+            return;
+        }
+        case AST_SWITCH_STATEMENT:
+            lower_declarations(function, &node->data.switch_stmt.cases);
+            return;
+        case AST_COMPOUND_STATEMENT:
+        case AST_CASE_STATEMENT:
+        case AST_DEFAULT_STATEMENT:
+            for (int i = 0; i < node->child_count; i++) {
+                lower_declarations(function, &node->children[i]);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+static ASTNode* as_block(ASTNode* stmt) {
+    if (stmt && stmt->type == AST_COMPOUND_STATEMENT) return stmt;
+    ASTNode* block = ast_create_node(AST_COMPOUND_STATEMENT);
+    if (stmt) {
+        block->line = stmt->line;
+        block->column = stmt->column;
+        ast_add_child(block, stmt);
+    }
+    return block;
+}
+
+static void append_children(ASTNode* block, ASTNode* rest) {
+    for (int i = 0; i < rest->child_count; i++) {
+        ast_add_child(block, rest->children[i]);
+    }
+    rest->child_count = 0;
+    ast_destroy(rest);
+}
+
+// Troca os return de uma lista que termina a função por "resultado =
+// valor". O que segue um comando com return passa para dentro dele, nos
+// caminhos que continuam. Retorna 0 se algum return fica num laço ou
+// switch, onde não há como reescrevê-lo.
+static int rewrite_returns(InlineFunction* function, ASTNode* list) {
+    for (int i = 0; i < list->child_count; i++) {
+        ASTNode* stmt = list->children[i];
+        if (!contains_return(stmt)) continue;
+
+        ASTNode* rest = ast_create_node(AST_COMPOUND_STATEMENT);
+        for (int j = i + 1; j < list->child_count; j++) {
+            ast_add_child(rest, list->children[j]);
+        }
+        list->child_count = i + 1;
+
+        switch (stmt->type) {
+            case AST_RETURN_STATEMENT: {
+                ASTNode* value = stmt->data.return_stmt.expression;
+                stmt->data.return_stmt.expression = NULL;
+                list->children[i] = value && function->result
+                                    ? make_statement(make_assignment(function->result, value, stmt))
+                                    : ast_create_node(AST_COMPOUND_STATEMENT);
+                if (value && !function->result) ast_destroy(value);
+                ast_destroy(stmt);
+                ast_destroy(rest);
+                return 1;
+            }
+
+            case AST_COMPOUND_STATEMENT:
+                append_children(stmt, rest);
+                return rewrite_returns(function, stmt);
+
+            case AST_IF_STATEMENT: {
+                ASTNode* then_block = as_block(stmt->data.if_stmt.then_stmt);
+                ASTNode* else_block = as_block(stmt->data.if_stmt.else_stmt);
+                stmt->data.if_stmt.then_stmt = then_block;
+                stmt->data.if_stmt.else_stmt = else_block;
+                int then_continues = falls_through(then_block);
+                if (falls_through(else_block)) {
+                    append_children(else_block, then_continues ? ast_clone(rest) : rest);
+                    if (!then_continues) rest = NULL;
+                }
+                if (then_continues) {
+                    append_children(then_block, rest);
+                    rest = NULL;
+                }
+                ast_destroy(rest);
+                return rewrite_returns(function, then_block) && rewrite_returns(function, else_block);
+            }
+
+            default:
+                ast_destroy(rest);
+                return 0;
+        }
+    }
+    return 1;
+}
+
+// Comando sem laços como expressão (NULL em *expression se não faz nada)
+static int statement_expression(const ASTNode* stmt, ASTNode** expression) {
+    *expression = NULL;
+    if (!stmt) return 1;
+
+    switch (stmt->type) {
+        case AST_EXPRESSION_STATEMENT:
+            if (stmt->child_count > 0) *expression = ast_clone(stmt->children[0]);
+            return 1;
+
+        case AST_COMPOUND_STATEMENT:
+            for (int i = 0; i < stmt->child_count; i++) {
+                ASTNode* part;
+                if (!statement_expression(stmt->children[i], &part)) {
+                    ast_destroy(*expression);
+                    *expression = NULL;
+                    return 0;
+                }
+                if (part) *expression = *expression ? make_binary(TOKEN_COMMA, *expression, part, part) : part;
+            }
+            return 1;
+
+        case AST_IF_STATEMENT: {
+            ASTNode* true_expr;
+            ASTNode* false_expr;
+            if (!statement_expression(stmt->data.if_stmt.then_stmt, &true_expr)) return 0;
+            if (!statement_expression(stmt->data.if_stmt.else_stmt, &false_expr)) {
+                ast_destroy(true_expr);
+                return 0;
+            }
+            ASTNode* condition = ast_clone(stmt->data.if_stmt.condition);
+            if (!true_expr && !false_expr) {
+                *expression = condition;
+                return 1;
+            }
+            // Um ramo vazio vale 0: só quando o outro é inteiro
+            ASTNode* typed = true_expr ? true_expr : false_expr;
+            int mismatch = true_expr && false_expr ? true_expr->type_id != false_expr->type_id
+                                                   : typed->data_type != TYPE_INT && typed->data_type != TYPE_CHAR;
+            if (mismatch) {
+                ast_destroy(condition);
+                ast_destroy(true_expr);
+                ast_destroy(false_expr);
+                return 0;
+            }
+            ASTNode* ternary = ast_create_node(AST_TERNARY_EXPRESSION);
+            ternary->data.ternary_expr.condition = condition;
+            ternary->data.ternary_expr.true_expr = true_expr ? true_expr : make_int_literal(0, stmt);
+            ternary->data.ternary_expr.false_expr = false_expr ? false_expr : make_int_literal(0, stmt);
+            ternary->data_type = typed->data_type;
+            ternary->type_id = typed->type_id;
+            ternary->line = stmt->line;
+            ternary->column = stmt->column;
+            *expression = ternary;
+            return 1;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+// A expressão termina gravando o resultado em todos os caminhos?
+static int ends_in_result(const InlineFunction* function, const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_ASSIGNMENT_EXPRESSION:
+            return node->data.binary_expr.left->ref.symbol == function->result &&
+                   node->data.binary_expr.right->type_id == function->result->type_id;
+        case AST_BINARY_EXPRESSION:
+            return node->data.binary_expr.operator == TOKEN_COMMA &&
+                   ends_in_result(function, node->data.binary_expr.right);
+        case AST_TERNARY_EXPRESSION:
+            return ends_in_result(function, node->data.ternary_expr.true_expr) &&
+                   ends_in_result(function, node->data.ternary_expr.false_expr);
+        default:
+            return 0;
+    }
+}
+
+// Tira a gravação final do resultado: a expressão passa a valer o resultado
+static void strip_result(ASTNode** slot) {
+    ASTNode* node = *slot;
+    switch (node->type) {
+        case AST_ASSIGNMENT_EXPRESSION:
+            *slot = node->data.binary_expr.right;
+            node->data.binary_expr.right = NULL;
+            ast_destroy(node);
+            return;
+        case AST_BINARY_EXPRESSION:
+            strip_result(&node->data.binary_expr.right);
+            node->data_type = node->data.binary_expr.right->data_type;
+            node->type_id = node->data.binary_expr.right->type_id;
+            return;
+        case AST_TERNARY_EXPRESSION:
+            strip_result(&node->data.ternary_expr.true_expr);
+            strip_result(&node->data.ternary_expr.false_expr);
+            return;
+        default:
+            return;
+    }
+}
+
+// Valor da chamada como expressão: "c ? (r = a) : (r = b)" vira
+// "c ? a : b"; sem isso, a expressão é seguida de ", r"
+static ASTNode* template_value(InlineFunction* function) {
+    ASTNode* value;
+    if (!function->result || !statement_expression(function->body, &value)) return NULL;
+
+    if (ends_in_result(function, value)) {
+        strip_result(&value);
+        return value;
+    }
+    ASTNode* result = make_variable_reference(function->result, function->decl);
+    return value ? make_binary(TOKEN_COMMA, value, result, result) : result;
+}
+
+static void build_template(Inliner* in, InlineFunction* function) {
+    ASTFunctionDecl* decl = &function->decl->data.function_decl;
+    Optimizer* optimizer = in->optimizer;
+
+    if (function->recursive) {
+        function->reason = "recursiva";
+        return;
+    }
+    if (decl->is_variadic) {
+        function->reason = "variádica";
+        return;
+    }
+    if (declares_static(decl->body)) {
+        function->reason = "declara estáticas";
+        return;
+    }
+
+    ASTNode* params = decl->parameters;
+    for (int i = 0; params && i < params->child_count; i++) {
+        add_template_local(function, params->children[i]->ref.symbol);
+    }
+    function->param_count = function->local_count;
+    if (function->decl->data_type != TYPE_VOID) {
+        function->result = symbol_create_variable("_resultado", function->decl->data_type,
+                                                  function->decl->line, function->decl->column);
+        function->result->type_id = function->decl->type_id;
+    }
+
+    ASTNode* body = ast_clone(decl->body);
+    lower_declarations(function, &body);
+    if (!rewrite_returns(function, body)) {
+        function->reason = "return dentro de laço ou switch";
+        ast_destroy(body);
+        return;
+    }
+    if (function->result) add_template_local(function, function->result);
+
+    // Dentro de laço o limite dobra; com perfil, as chamadas quentes ainda
+    // o multiplicam
+    int largest = 2 * optimizer->inline_limit;
+    if (optimizer->profile && optimizer->profile->use_path) largest *= PROFILE_HOT_INLINE_FACTOR;
+    function->size = count_nodes(body, 2 * largest + 1);
+    if (function->size > largest) {
+        function->reason = "corpo grande";
+        ast_destroy(body);
+        return;
+    }
+    function->body = body;
+    function->value = template_value(function);
+
+    PointerSet references = {0};
+    collect_references(body, &references);
+    pointer_set_sort(&references);
+    for (int i = 0; i < references.count; i++) {
+        if (i > 0 && references.items[i] == references.items[i - 1]) continue;
+        if (!is_template_local(function, references.items[i])) {
+            pointer_set_add(&function->outer, references.items[i]);
+        }
+    }
+    free(references.items);
+}
+
+// ============================================================
+// Expansão nas chamadas
+// ============================================================
+
+typedef struct InlineSite {
+    InlineFunction* callee;
+    Symbol** fresh;           // Símbolo no frame de quem chama, por local do modelo
+    ASTNode** direct;         // Argumento usado no lugar do parâmetro (NULL = cópia)
+} InlineSite;
+
+static Symbol* create_inline_symbol(Inliner* in, const InlineFunction* callee, const Symbol* original) {
+    char name[128];
+    const char* base = original == callee->result ? "resultado" : original->name;
+    if (base[0] == '_') {
+        snprintf(name, sizeof(name), "%s_%d", base, in->optimizer->symbol_table->temp_counter++);
+    } else {
+        snprintf(name, sizeof(name), "_%s_%s_%d", callee->decl->data.function_decl.name, base,
+                 in->optimizer->symbol_table->temp_counter++);
+    }
+    Symbol* symbol = symbol_create_variable(name, original->type, original->line, original->column);
+    symbol->type_id = original->type_id;
+    symbol->scope_level = 1;
+    symbol->info.variable.is_initialized = 1;
+    symbol->info.variable.is_modified = 1;
+    allocate_temporary(in->optimizer, in->caller->decl, symbol);
+
+    in->temporaries = grow_array(in->temporaries, &in->temporary_capacity,
+                                 in->temporary_count + 1, sizeof(Symbol*));
+    in->temporaries[in->temporary_count++] = symbol;
+    return symbol;
+}
+
+// Literal ou local de quem chama: pode ser lido no lugar do parâmetro
+// (o corpo expandido não escreve nos locais de quem chama)
+static int is_direct_argument(const ASTNode* arg, const Symbol* param) {
+    if (arg->type_id != param->type_id) return 0;
+
+    switch (arg->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_FLOAT_LITERAL:
+        case AST_CHAR_LITERAL:
+            return 1;
+        case AST_IDENTIFIER:
+            return arg->ref.symbol && arg->ref.symbol->kind != SYMBOL_FUNCTION &&
+                   !is_shared_variable(arg->ref.symbol);
+        default:
+            return 0;
+    }
+}
+
+static void rename_locals(InlineSite* site, ASTNode** slot) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER: {
+            InlineFunction* callee = site->callee;
+            for (int i = 0; i < callee->local_count; i++) {
+                if (node->ref.symbol != callee->locals[i]) continue;
+                if (site->direct[i]) {
+                    *slot = ast_clone(site->direct[i]);
+                    ast_destroy(node);
+                    return;
+                }
+                Symbol* symbol = site->fresh[i];
+                free(node->data.identifier.name);
+                node->data.identifier.name = strdup(symbol->name);
+                node->ref.symbol = symbol;
+                node->ref.depth = symbol->scope_level;
+                node->ref.slot = symbol->info.variable.slot;
+                return;
+            }
+            return;
+        }
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            rename_locals(site, &node->data.binary_expr.left);
+            rename_locals(site, &node->data.binary_expr.right);
+            return;
+        case AST_UNARY_EXPRESSION:
+            rename_locals(site, &node->data.unary_expr.operand);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            rename_locals(site, &node->data.ternary_expr.condition);
+            rename_locals(site, &node->data.ternary_expr.true_expr);
+            rename_locals(site, &node->data.ternary_expr.false_expr);
+            return;
+        case AST_IF_STATEMENT:
+            rename_locals(site, &node->data.if_stmt.condition);
+            rename_locals(site, &node->data.if_stmt.then_stmt);
+            rename_locals(site, &node->data.if_stmt.else_stmt);
+            return;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            rename_locals(site, &node->data.while_stmt.condition);
+            rename_locals(site, &node->data.while_stmt.body);
+            return;
+        case AST_FOR_STATEMENT:
+            rename_locals(site, &node->data.for_stmt.init);
+            rename_locals(site, &node->data.for_stmt.condition);
+            rename_locals(site, &node->data.for_stmt.update);
+            rename_locals(site, &node->data.for_stmt.body);
+            return;
+        case AST_SWITCH_STATEMENT:
+            rename_locals(site, &node->data.switch_stmt.expression);
+            rename_locals(site, &node->data.switch_stmt.cases);
+            return;
+        case AST_RETURN_STATEMENT:
+            rename_locals(site, &node->data.return_stmt.expression);
+            return;
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                rename_locals(site, &node->children[i]);
+            }
+            return;
+    }
+}
+
+// Símbolos do local e cópias dos argumentos (na ordem dos argumentos).
+// Os argumentos copiados saem da chamada; os usados direto, não.
+static int bind_arguments(Inliner* in, InlineSite* site, ASTNode* call, ASTNode** copies) {
+    InlineFunction* callee = site->callee;
+    int pure_arguments = 1;
+    for (int i = 0; i < call->child_count; i++) {
+        if (has_side_effects(call->children[i])) pure_arguments = 0;
+    }
+
+    PointerSet assigned = {0};
+    int has_calls = 0;
+    collect_assignments(callee->body, &assigned, &has_calls);
+    pointer_set_sort(&assigned);
+
+    int copy_count = 0;
+    for (int i = 0; i < callee->local_count; i++) {
+        Symbol* local = callee->locals[i];
+        site->direct[i] = NULL;
+        site->fresh[i] = NULL;
+        if (i < callee->param_count && pure_arguments && !pointer_set_contains(&assigned, local) &&
+            is_direct_argument(call->children[i], local)) {
+            site->direct[i] = call->children[i];
+            continue;
+        }
+        site->fresh[i] = create_inline_symbol(in, callee, local);
+        if (i < callee->param_count) {
+            copies[copy_count++] = make_assignment(site->fresh[i], call->children[i], call->children[i]);
+            call->children[i] = NULL;
+        }
+    }
+    free(assigned.items);
+    return copy_count;
+}
+
+static int expansion_limit(Inliner* in) {
+    return in->loop_depth > 0 ? 2 * in->optimizer->inline_limit : in->optimizer->inline_limit;
+}
+
+// Decide e expande a chamada em *slot. Na posição de comando
+// (at_statement), um corpo que não cabe numa expressão vai para
+// in->pending e a chamada vira a leitura do resultado (NULL se void).
+static void expand_call(Inliner* in, ASTNode** slot, int at_statement) {
+    ASTNode* call = *slot;
+    int index = find_inline_function(in, call->ref.symbol);
+    if (index < 0) return;
+
+    InlineFunction* callee = &in->functions[index];
+    if (callee->body && call->child_count != callee->param_count) return;
+    Optimizer* optimizer = in->optimizer;
+    const char* caller = in->caller->decl->data.function_decl.name;
+    const char* name = call->data.function_call.name;
+    int limit = expansion_limit(in);
+
+    if (!callee->body) {
+        record_inline_decision(optimizer, "%s: %s mantida: %s", caller, name,
+                               callee->reason);
+        return;
+    }
+    // Com perfil, a chamada que nunca rodou fica como está e a quente
+    // aceita um corpo maior
+    if (profile_never_executed(optimizer->profile, call)) {
+        record_inline_decision(optimizer, "%s: %s mantida: não executada no perfil", caller, name);
+        optimizer->profile->cold_calls++;
+        return;
+    }
+    int hot = profile_hot_call(optimizer->profile, call) && callee->size > limit;
+    if (hot) limit *= PROFILE_HOT_INLINE_FACTOR;
+    if (callee->size > limit) {
+        record_inline_decision(optimizer, "%s: %s mantida: %d nós > limite %d", caller, name,
+                               callee->size, limit);
+        return;
+    }
+    if (in->growth + callee->size > INLINE_MAX_GROWTH * optimizer->inline_limit) {
+        record_inline_decision(optimizer, "%s: %s mantida: crescimento de %s esgotado", caller,
+                               name, caller);
+        return;
+    }
+    if (!callee->value && !at_statement) {
+        record_inline_decision(optimizer, "%s: %s mantida: o corpo não cabe numa expressão",
+                               caller, name);
+        return;
+    }
+    const char* shadowed = shadowed_outer_name(callee, in->caller->decl);
+    if (shadowed) {
+        record_inline_decision(optimizer, "%s: %s mantida: '%s' é local em %s", caller, name,
+                               shadowed, caller);
+        return;
+    }
+    FunctionPurity purity = callee->decl->ref.symbol->info.function.purity;
+    if (!at_statement && (purity == FUNCTION_IMPURE ||
+                          (purity == FUNCTION_READS_MEMORY && in->expression_writes))) {
+        record_inline_decision(optimizer, "%s: %s mantida: %s memória no meio de uma expressão",
+                               caller, name, purity == FUNCTION_IMPURE ? "escreve na" : "lê a");
+        return;
+    }
+
+    Symbol** fresh = malloc((callee->local_count + 1) * sizeof(Symbol*));
+    ASTNode** direct = malloc((callee->local_count + 1) * sizeof(ASTNode*));
+    ASTNode** copies = malloc((callee->param_count + 1) * sizeof(ASTNode*));
+    InlineSite site = { callee, fresh, direct };
+    int copy_count = bind_arguments(in, &site, call, copies);
+
+    if (callee->value) {
+        ASTNode* value = ast_clone(callee->value);
+        rename_locals(&site, &value);
+        ASTNode* expression = NULL;
+        for (int i = 0; i < copy_count; i++) {
+            expression = expression ? make_binary(TOKEN_COMMA, expression, copies[i], copies[i]) : copies[i];
+        }
+        *slot = expression ? make_binary(TOKEN_COMMA, expression, value, call) : value;
+    } else {
+        ASTNode* block = ast_create_node(AST_COMPOUND_STATEMENT);
+        block->line = call->line;
+        block->column = call->column;
+        for (int i = 0; i < copy_count; i++) {
+            ast_add_child(block, make_statement(copies[i]));
+        }
+        ASTNode* body = ast_clone(callee->body);
+        rename_locals(&site, &body);
+        append_children(block, body);
+        in->pending = block;
+        *slot = callee->result ? make_variable_reference(fresh[callee->local_count - 1], call) : NULL;
+    }
+
+    in->growth += callee->size;
+    optimizer->inlined_calls++;
+    if (hot) optimizer->profile->hot_inlines++;
+    record_inline_decision(optimizer, "%s: %s expandida, %d nós%s%s", caller, name,
+                           callee->size, callee->value ? "" : " (bloco)", hot ? ", quente no perfil" : "");
+    ast_destroy(call);
+    free(fresh);
+    free(direct);
+    free(copies);
+}
+
+// Atribuição, ++, -- ou chamada impura em qualquer ponto da expressão
+static int writes_in(const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_ASSIGNMENT_EXPRESSION:
+            return 1;
+        case AST_UNARY_EXPRESSION:
+            switch (node->data.unary_expr.operator) {
+                case UNARY_PRE_INCREMENT:
+                case UNARY_PRE_DECREMENT:
+                case UNARY_POST_INCREMENT:
+                case UNARY_POST_DECREMENT:
+                    return 1;
+                default:
+                    return writes_in(node->data.unary_expr.operand);
+            }
+        case AST_BINARY_EXPRESSION:
+            return writes_in(node->data.binary_expr.left) || writes_in(node->data.binary_expr.right);
+        case AST_TERNARY_EXPRESSION:
+            return writes_in(node->data.ternary_expr.condition) ||
+                   writes_in(node->data.ternary_expr.true_expr) ||
+                   writes_in(node->data.ternary_expr.false_expr);
+        case AST_FUNCTION_CALL: {
+            const Symbol* function = symbol_ref_target(&node->ref);
+            if (!function || function->info.function.purity == FUNCTION_IMPURE) return 1;
+            for (int i = 0; i < node->child_count; i++) {
+                if (writes_in(node->children[i])) return 1;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+static void inline_expression(Inliner* in, ASTNode** slot, const ASTNode* statement_call) {
+    ASTNode* node = *slot;
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL:
+            for (int i = 0; i < node->child_count; i++) {
+                inline_expression(in, &node->children[i], NULL);
+            }
+            if (node != statement_call) expand_call(in, slot, 0);
+            return;
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            inline_expression(in, &node->data.binary_expr.left, statement_call);
+            inline_expression(in, &node->data.binary_expr.right, statement_call);
+            return;
+        case AST_UNARY_EXPRESSION:
+            inline_expression(in, &node->data.unary_expr.operand, statement_call);
+            return;
+        case AST_TERNARY_EXPRESSION:
+            inline_expression(in, &node->data.ternary_expr.condition, statement_call);
+            inline_expression(in, &node->data.ternary_expr.true_expr, statement_call);
+            inline_expression(in, &node->data.ternary_expr.false_expr, statement_call);
+            return;
+        default:
+            return;
+    }
+}
+
+// Expressão inteira de um comando. A atribuição "v = ..." no topo só
+// grava depois de calculado o lado direito e não conta como escrita.
+static void inline_full_expression(Inliner* in, ASTNode** slot, const ASTNode* statement_call) {
+    const ASTNode* node = *slot;
+    if (!node) return;
+    if (node->type == AST_ASSIGNMENT_EXPRESSION) {
+        in->expression_writes = writes_in(node->data.binary_expr.left) ||
+                                writes_in(node->data.binary_expr.right);
+    } else {
+        in->expression_writes = writes_in(node);
+    }
+    inline_expression(in, slot, statement_call);
+}
+
+// Expressão de um comando simples
+static ASTNode** statement_value(ASTNode* stmt) {
+    switch (stmt->type) {
+        case AST_EXPRESSION_STATEMENT:
+            return stmt->child_count > 0 ? &stmt->children[0] : NULL;
+        case AST_VARIABLE_DECLARATION:
+            return &stmt->data.var_decl.initializer;
+        case AST_RETURN_STATEMENT:
+            return &stmt->data.return_stmt.expression;
+        default:
+            return NULL;
+    }
+}
+
+// Chamada que forma o comando inteiro (a que pode virar bloco)
+static ASTNode** statement_call(ASTNode* stmt) {
+    ASTNode** slot = statement_value(stmt);
+    if (!slot || !*slot) return NULL;
+    if (stmt->type == AST_EXPRESSION_STATEMENT && (*slot)->type == AST_ASSIGNMENT_EXPRESSION &&
+        (*slot)->data.binary_expr.left->type == AST_IDENTIFIER) {
+        slot = &(*slot)->data.binary_expr.right;
+    }
+    return (*slot)->type == AST_FUNCTION_CALL ? slot : NULL;
+}
+
+static void inline_statement(Inliner* in, ASTNode** slot);
+
+static void inline_list(Inliner* in, ASTNode* list) {
+    for (int i = 0; i < list->child_count; i++) {
+        in->pending = NULL;
+        inline_statement(in, &list->children[i]);
+        if (in->pending) {
+            insert_children(list, i, &in->pending, 1);
+            in->pending = NULL;
+            i++;
+        }
+    }
+}
+
+// Ramo ou corpo de laço: o bloco pendente vai junto num bloco novo
+static void inline_branch(Inliner* in, ASTNode** slot) {
+    if (!*slot) return;
+    in->pending = NULL;
+    inline_statement(in, slot);
+    if (in->pending) {
+        ASTNode* block = as_block(in->pending);
+        ast_add_child(block, *slot);
+        *slot = block;
+        in->pending = NULL;
+    }
+}
+
+static void inline_statement(Inliner* in, ASTNode** slot) {
+    ASTNode* stmt = *slot;
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case AST_EXPRESSION_STATEMENT:
+        case AST_VARIABLE_DECLARATION:
+        case AST_RETURN_STATEMENT: {
+            ASTNode** call = statement_call(stmt);
+            ASTNode** value = statement_value(stmt);
+            if (value) inline_full_expression(in, value, call ? *call : NULL);
+            if (!call) return;
+
+            expand_call(in, call, 1);
+            if (!*call && stmt->type == AST_EXPRESSION_STATEMENT) {
+                // f(x); de uma função void: o bloco toma o lugar do comando
+                ast_destroy(stmt);
+                *slot = in->pending;
+                in->pending = NULL;
+            }
+            return;
+        }
+
+        case AST_COMPOUND_STATEMENT:
+            inline_list(in, stmt);
+            return;
+
+        case AST_IF_STATEMENT:
+            inline_full_expression(in, &stmt->data.if_stmt.condition, NULL);
+            inline_branch(in, &stmt->data.if_stmt.then_stmt);
+            inline_branch(in, &stmt->data.if_stmt.else_stmt);
+            return;
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            in->loop_depth++;
+            inline_full_expression(in, &stmt->data.while_stmt.condition, NULL);
+            inline_branch(in, &stmt->data.while_stmt.body);
+            in->loop_depth--;
+            return;
+
+        case AST_FOR_STATEMENT: {
+            // A inicialização roda uma vez: seu bloco fica antes do for
+            ASTNode* pending = NULL;
+            if (stmt->data.for_stmt.init && stmt->data.for_stmt.init->type == AST_VARIABLE_DECLARATION) {
+                inline_statement(in, &stmt->data.for_stmt.init);
+                pending = in->pending;
+                in->pending = NULL;
+            } else {
+                inline_full_expression(in, &stmt->data.for_stmt.init, NULL);
+            }
+            in->loop_depth++;
+            inline_full_expression(in, &stmt->data.for_stmt.condition, NULL);
+            inline_full_expression(in, &stmt->data.for_stmt.update, NULL);
+            inline_branch(in, &stmt->data.for_stmt.body);
+            in->loop_depth--;
+            in->pending = pending;
+            return;
+        }
+
+        case AST_SWITCH_STATEMENT: {
+            inline_full_expression(in, &stmt->data.switch_stmt.expression, NULL);
+            ASTNode* cases = stmt->data.switch_stmt.cases;
+            for (int i = 0; cases && i < cases->child_count; i++) {
+                inline_list(in, cases->children[i]);
+            }
+            return;
+        }
+
+        default:
+            return;
+    }
+}
+
+static void inline_into(Inliner* in, InlineFunction* function) {
+    in->caller = function;
+    in->loop_depth = 0;
+    in->growth = 0;
+    in->pending = NULL;
+    in->temporary_count = 0;
+    inline_list(in, function->decl->data.function_decl.body);
+    declare_temporaries(in->optimizer, function->decl, in->temporaries, in->temporary_count);
+}
+
+// Tarjan: cada componente sai depois das que ela chama
+static void visit_call_graph(Inliner* in, int v) {
+    InlineFunction* function = &in->functions[v];
+    function->index = function->low = in->visit_counter++;
+    in->stack[in->stack_count++] = v;
+    function->on_stack = 1;
+
+    for (int i = 0; i < function->callee_count; i++) {
+        int w = function->callees[i];
+        InlineFunction* callee = &in->functions[w];
+        if (w == v) function->recursive = 1;
+        if (callee->index < 0) {
+            visit_call_graph(in, w);
+            if (callee->low < function->low) function->low = callee->low;
+        } else if (callee->on_stack && callee->index < function->low) {
+            function->low = callee->index;
+        }
+    }
+    if (function->low != function->index) return;
+
+    int first = in->stack_count - 1;
+    while (in->stack[first] != v) first--;
+    for (int i = first; i < in->stack_count; i++) {
+        InlineFunction* member = &in->functions[in->stack[i]];
+        member->on_stack = 0;
+        if (in->stack_count - first > 1) member->recursive = 1;
+        if (member->recursive) member->reason = "recursiva";
+    }
+    for (int i = first; i < in->stack_count; i++) {
+        inline_into(in, &in->functions[in->stack[i]]);
+    }
+    for (int i = first; i < in->stack_count; i++) {
+        build_template(in, &in->functions[in->stack[i]]);
+    }
+    in->stack_count = first;
+}
+
+// Expansão de chamadas a funções pequenas e não recursivas
+void inline_functions(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program || optimizer->inline_limit <= 0) return;
+
+    Inliner in = {0};
+    in.optimizer = optimizer;
+    in.functions = calloc(program->child_count + 1, sizeof(InlineFunction));
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body || !decl->ref.symbol) continue;
+        InlineFunction* function = &in.functions[in.function_count++];
+        function->decl = decl;
+        function->index = -1;
+    }
+    for (int i = 0; i < in.function_count; i++) {
+        collect_callees(&in, &in.functions[i], in.functions[i].decl->data.function_decl.body);
+    }
+
+    in.stack = malloc((in.function_count + 1) * sizeof(int));
+    for (int i = 0; i < in.function_count; i++) {
+        if (in.functions[i].index < 0) visit_call_graph(&in, i);
+    }
+
+    for (int i = 0; i < in.function_count; i++) {
+        InlineFunction* function = &in.functions[i];
+        ast_destroy(function->body);
+        ast_destroy(function->value);
+        if (function->result) {
+            free(function->result->name);
+            free(function->result);
+        }
+        free(function->locals);
+        free(function->outer.items);
+        free(function->callees);
+    }
+    free(in.functions);
+    free(in.stack);
+    free(in.temporaries);
+}
+
+// ------------------------------------------------------------
+// Memoização de funções puras recursivas (-fmemoize)
+//
+// Uma função CONST (o resultado depende só dos argumentos) que chama a
+// si mesma e recebe e devolve int ganha uma tabela de resultados de
+// tamanho fixo, indexada por um hash dos argumentos. Os backends emitem
+// o corpo com outro nome (_memo_corpo_f) e, no lugar de f, um invólucro
+// que procura os argumentos na tabela antes de chamar o corpo e guarda o
+// resultado depois; as chamadas recursivas do corpo passam pelo
+// invólucro, o que torna fib(n) linear. READS_MEMORY não serve: o valor
+// guardado ficaria velho quando a global lida mudasse.
+//
+// Só há o que reaproveitar quando algum caminho do corpo faz duas ou mais
+// chamadas recursivas. Com uma por caminho (recursão linear, e toda
+// recursão de cauda) cada argumento aparece uma vez: a tabela não ganha
+// nada, e o invólucro ainda impede a chamada de cauda e estoura a pilha.
+// ------------------------------------------------------------
+
+static void record_memo_decision(Optimizer* optimizer, const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    optimizer->memo_decisions = grow_array(optimizer->memo_decisions, &optimizer->memo_decision_capacity,
+                                           optimizer->memo_decision_count + 1, sizeof(char*));
+    optimizer->memo_decisions[optimizer->memo_decision_count++] = strdup(text);
+}
+
+static int max_calls(int a, int b) {
+    return a > b ? a : b;
+}
+
+// Chamadas a self num caminho da expressão (o maior, no ?:)
+static int self_calls_in(const ASTNode* node, const Symbol* self) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case AST_FUNCTION_CALL: {
+            int calls = node->ref.symbol == self;
+            for (int i = 0; i < node->child_count; i++) calls += self_calls_in(node->children[i], self);
+            return calls;
+        }
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            return self_calls_in(node->data.binary_expr.left, self) +
+                   self_calls_in(node->data.binary_expr.right, self);
+        case AST_UNARY_EXPRESSION:
+            return self_calls_in(node->data.unary_expr.operand, self);
+        case AST_TERNARY_EXPRESSION:
+            return self_calls_in(node->data.ternary_expr.condition, self) +
+                   max_calls(self_calls_in(node->data.ternary_expr.true_expr, self),
+                             self_calls_in(node->data.ternary_expr.false_expr, self));
+        default:
+            return 0;
+    }
+}
+
+// Maior número de chamadas a self entre os caminhos que seguem depois do
+// comando (through) e entre os que terminam num return (exit); -1 quando
+// não há caminho daquele tipo
+typedef struct PathCalls {
+    int through;
+    int exit;
+} PathCalls;
+
+static PathCalls self_calls_on_paths(const ASTNode* stmt, const Symbol* self);
+
+static PathCalls self_calls_in_list(ASTNode* const* items, int count, const Symbol* self) {
+    PathCalls paths = {0, -1};
+    for (int i = 0; i < count && paths.through >= 0; i++) {
+        PathCalls item = self_calls_on_paths(items[i], self);
+        if (item.exit >= 0) paths.exit = max_calls(paths.exit, paths.through + item.exit);
+        paths.through = item.through >= 0 ? paths.through + item.through : -1;
+    }
+    return paths;
+}
+
+static PathCalls self_calls_on_paths(const ASTNode* stmt, const Symbol* self) {
+    PathCalls paths = {0, -1};
+    if (!stmt) return paths;
+
+    switch (stmt->type) {
+        case AST_RETURN_STATEMENT:
+            paths.through = -1;
+            paths.exit = self_calls_in(stmt->data.return_stmt.expression, self);
+            return paths;
+
+        case AST_EXPRESSION_STATEMENT:
+            paths.through = stmt->child_count > 0 ? self_calls_in(stmt->children[0], self) : 0;
+            return paths;
+
+        case AST_VARIABLE_DECLARATION:
+            paths.through = self_calls_in(stmt->data.var_decl.initializer, self);
+            return paths;
+
+        case AST_COMPOUND_STATEMENT:
+            return self_calls_in_list(stmt->children, stmt->child_count, self);
+
+        case AST_IF_STATEMENT: {
+            int condition = self_calls_in(stmt->data.if_stmt.condition, self);
+            PathCalls then_paths = self_calls_on_paths(stmt->data.if_stmt.then_stmt, self);
+            PathCalls else_paths = self_calls_on_paths(stmt->data.if_stmt.else_stmt, self);
+            int through = max_calls(then_paths.through, else_paths.through);
+            int exit = max_calls(then_paths.exit, else_paths.exit);
+            paths.through = through >= 0 ? condition + through : -1;
+            paths.exit = exit >= 0 ? condition + exit : -1;
+            return paths;
+        }
+
+        case AST_SWITCH_STATEMENT: {
+            // Cada rótulo conta sozinho (sem seguir para o próximo)
+            int expression = self_calls_in(stmt->data.switch_stmt.expression, self);
+            const ASTNode* cases = stmt->data.switch_stmt.cases;
+            for (int i = 0; cases && i < cases->child_count; i++) {
+                const ASTNode* label = cases->children[i];
+                PathCalls body = self_calls_in_list(label->children, label->child_count, self);
+                paths.through = max_calls(paths.through, body.through);
+                paths.exit = max_calls(paths.exit, body.exit);
+            }
+            paths.through += expression;
+            if (paths.exit >= 0) paths.exit += expression;
+            return paths;
+        }
+
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+        case AST_FOR_STATEMENT: {
+            // Uma chamada no laço se repete a cada volta: vale por duas
+            int calls;
+            int before = 0;
+            if (stmt->type == AST_FOR_STATEMENT) {
+                const ASTNode* init = stmt->data.for_stmt.init;
+                before = self_calls_in(init && init->type == AST_VARIABLE_DECLARATION
+                                       ? init->data.var_decl.initializer : init, self);
+                calls = self_calls_in(stmt->data.for_stmt.condition, self) +
+                        self_calls_in(stmt->data.for_stmt.update, self);
+            } else {
+                calls = self_calls_in(stmt->data.while_stmt.condition, self);
+            }
+            const ASTNode* body = stmt->type == AST_FOR_STATEMENT ? stmt->data.for_stmt.body
+                                                                 : stmt->data.while_stmt.body;
+            PathCalls body_paths = self_calls_on_paths(body, self);
+            calls += max_calls(max_calls(body_paths.through, body_paths.exit), 0);
+            paths.through = before + (calls > 0 ? 2 : 0);
+            if (contains_return(body)) paths.exit = paths.through;
+            return paths;
+        }
+
+        default:
+            return paths;
+    }
+}
+
+// Por que a função recursiva fica sem tabela (NULL: pode ser memoizada)
+static const char* memo_rejection(const FunctionInfo* info) {
+    if (info->purity == FUNCTION_IMPURE) return "escreve memória ou faz E/S";
+    if (info->purity == FUNCTION_READS_MEMORY) return "lê globais ou memória";
+    if (info->return_type_id != TYPE_ID_INT) return "não devolve int";
+    if (info->is_variadic || info->parameter_count == 0) return "sem argumentos fixos";
+    if (info->parameter_count > MEMO_MAX_ARGS) return "argumentos demais";
+    for (int i = 0; i < info->parameter_count; i++) {
+        if (info->parameter_types[i] != TYPE_ID_INT) return "argumento que não é int";
+    }
+    return NULL;
+}
+
+void memoize_functions(Optimizer* optimizer, ASTNode* program) {
+    if (!optimizer || !program) return;
+
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        if (decl->type != AST_FUNCTION_DECLARATION || !decl->data.function_decl.body || !decl->ref.symbol ||
+            !decl->ref.symbol->info.function.self_recursive) {
+            continue;
+        }
+
+        const char* name = decl->data.function_decl.name;
+        const FunctionInfo* info = &decl->ref.symbol->info.function;
+        const char* reason = memo_rejection(info);
+        PathCalls paths = self_calls_on_paths(decl->data.function_decl.body, decl->ref.symbol);
+        if (!reason && max_calls(paths.through, paths.exit) < 2) {
+            reason = "uma chamada recursiva por caminho (recursão linear)";
+        }
+        if (reason) {
+            record_memo_decision(optimizer, "%s: mantida: %s", name, reason);
+            continue;
+        }
+        decl->data.function_decl.memoized = 1;
+        optimizer->memoized_functions++;
+        record_memo_decision(optimizer, "%s: memoizada (%d argumento%s)", name, info->parameter_count,
+                             info->parameter_count > 1 ? "s" : "");
+    }
+}
+
+void optimizer_print_memoization(Optimizer* optimizer) {
+    printf("Memoização: %d funções recursivas puras com tabela de resultados\n", optimizer->memoized_functions);
+    for (int i = 0; i < optimizer->memo_decision_count; i++) {
+        printf("  - %s\n", optimizer->memo_decisions[i]);
+    }
+}
+
+void optimizer_print_stats(Optimizer* optimizer) {
+    printf("Inlining: %d chamadas expandidas (limite %d nós, o dobro dentro de laços)\n",
+           optimizer->inlined_calls, optimizer->inline_limit);
+    for (int i = 0; i < optimizer->inline_decision_count; i++) {
+        int count = optimizer->inline_decision_counts[i];
+        printf(count > 1 ? "  - %s (%d chamadas)\n" : "  - %s\n", optimizer->inline_decisions[i], count);
+    }
+    printf("Otimização: %d expressões constantes dobradas, %d usos de constantes propagados\n",
+           optimizer->folded_expressions, optimizer->propagated_constants);
+    printf("Código morto: %d comandos inalcançáveis, %d atribuições mortas removidos\n",
+           optimizer->removed_statements, optimizer->removed_stores);
+    for (int i = 0; i < optimizer->removal_count; i++) {
+        printf("  - %s\n", optimizer->removals[i]);
+    }
+    printf("Invariantes de laço: %d expressões movidas para pré-cabeçalhos (%d temporários)\n",
+           optimizer->hoisted_expressions, optimizer->hoisted_temporaries);
+    printf("Laços desenrolados: %d (fator %d)\n", optimizer->unrolled_loops, optimizer->unroll_factor);
+    printf("Variáveis de indução: %d multiplicações trocadas por somas (%d temporários, %d testes trocados)\n",
+           optimizer->reduced_products, optimizer->induction_temporaries, optimizer->replaced_tests);
+    printf("Subexpressões comuns: %d reutilizações, %d temporários criados\n",
+           optimizer->reused_expressions, optimizer->temporaries);
+    printf("If-conversion: %d seleções sem desvio (%d vindas de if/else), "
+           "%d desvios previsíveis e %d caros mantidos\n",
+           optimizer->branchless_selects, optimizer->converted_branches,
+           optimizer->predictable_branches, optimizer->expensive_selects);
+    optimizer_print_memoization(optimizer);
+}
@@ -0,0 +1,109 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "ast.h"
+#include "symbol_table.h"
+#include "profile.h"
+
+// Valor conhecido em tempo de compilação (int/char ou float)
+typedef struct ConstantValue {
+    DataType type;
+    int int_value;
+    float float_value;
+} ConstantValue;
+
+// Associação símbolo -> literal para a propagação de constantes
+typedef struct ConstantBinding {
+    Symbol* symbol;
+    ASTNode* literal;
+} ConstantBinding;
+
+#define DEFAULT_UNROLL_FACTOR 4
+#define DEFAULT_INLINE_LIMIT 40    // Nós da AST
+#define MEMO_MAX_ARGS 4            // Argumentos int de uma função memoizada
+
+typedef struct Optimizer {
+    SymbolTable* symbol_table;
+
+    // Propagação: endereçamento aberto indexado pelo ponteiro do símbolo
+    ConstantBinding* bindings;
+    int binding_count;
+    int binding_capacity;
+
+    // Estatísticas (modo verboso)
+    int folded_expressions;
+    int propagated_constants;
+    int removed_statements;
+    int removed_stores;
+
+    // Comandos removidos pela eliminação de código morto (relatório -v)
+    char** removals;
+    int removal_count;
+    int removal_capacity;
+    const char* current_function;
+
+    // Subexpressões comuns
+    int reused_expressions;
+    int temporaries;
+
+    // Invariantes de laço
+    int hoisted_expressions;
+    int hoisted_temporaries;
+
+    // Laços contados
+    int unroll_factor;     // Cópias do corpo por volta (-funroll=N; < 2 desliga)
+    int unrolled_loops;
+    int reduced_products;
+    int induction_temporaries;
+    int replaced_tests;    // Testes do laço que passaram a usar o temporário
+
+    // Inlining
+    int inline_limit;      // Tamanho máximo expandido (-finline-limit=N; 0 desliga)
+    int inlined_calls;
+    char** inline_decisions;  // Relatório -v: decisão e quantas chamadas
+    int* inline_decision_counts;
+    int inline_decision_count;
+    int inline_decision_capacity;
+    Profile* profile;      // -fprofile-use: chamadas quentes e as que nunca rodaram
+
+    // Laços que o backend assembly vetoriza ficam intactos (-S -O)
+    int vectorize;
+
+    // If-conversion
+    int branchless_selects;    // Ternários marcados para geração sem desvio
+    int converted_branches;    // Dos quais vieram de if/else
+    int predictable_branches;  // Mantidos: desvio previsível
+    int expensive_selects;     // Mantidos: lados caros demais para calcular sempre
+
+    // Memoização (-fmemoize)
+    int memoized_functions;
+    char** memo_decisions;     // Relatório: memoizadas e recursivas recusadas
+    int memo_decision_count;
+    int memo_decision_capacity;
+} Optimizer;
+
+// Criação e destruição
+Optimizer* optimizer_create(SymbolTable* symbols);
+void optimizer_destroy(Optimizer* optimizer);
+
+// Passes (executados sob -O, depois da análise semântica)
+void inline_functions(Optimizer* optimizer, ASTNode* program);
+void fold_constants(Optimizer* optimizer, ASTNode* program);
+void eliminate_dead_code(Optimizer* optimizer, ASTNode* program);
+void hoist_loop_invariants(Optimizer* optimizer, ASTNode* program);
+void unroll_loops(Optimizer* optimizer, ASTNode* program);
+void reduce_induction_variables(Optimizer* optimizer, ASTNode* program);
+void eliminate_common_subexpressions(Optimizer* optimizer, ASTNode* program);
+void convert_branches_to_selects(Optimizer* optimizer, ASTNode* program);
+void memoize_functions(Optimizer* optimizer, ASTNode* program);
+
+// Preenche a pureza das funções definidas. LICM e CSE a consultam; quem
+// roda os passes (o gerenciador de passes) a calcula antes deles
+void analyze_function_purity(ASTNode* program);
+
+// Utilitários
+int optimizer_constant_value(ASTNode* node, ConstantValue* value);
+void optimizer_print_stats(Optimizer* optimizer);
+void optimizer_print_memoization(Optimizer* optimizer);
+
+#endif
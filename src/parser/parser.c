@@ -127,6 +127,29 @@ void parser_skip_to_recovery_point(Parser *parser)
     }
 }
 
+// Conta os '*' de um declarador (int **p -> 2)
+static int parse_nivel_ponteiro(Parser *parser)
+{
+    int nivel = 0;
+    while (parser_match(parser, TOKEN_MULTIPLY))
+    {
+        nivel++;
+        parser_advance(parser);
+    }
+    return nivel;
+}
+
+// Consome um 'const' opcional antes do tipo
+static int parse_qualificador_const(Parser *parser)
+{
+    if (parser_match(parser, TOKEN_CONST))
+    {
+        parser_advance(parser);
+        return 1;
+    }
+    return 0;
+}
+
 ASTNode *parser_parse(Parser *parser)
 {
     ASTNode *programa = parse_programa(parser);
@@ -261,7 +284,8 @@ ASTNode *parse_declaracao_global(Parser *parser)
     }
 
     if (parser_match(parser, TOKEN_INT) || parser_match(parser, TOKEN_FLOAT_KW) ||
-        parser_match(parser, TOKEN_CHAR_KW) || parser_match(parser, TOKEN_VOID))
+        parser_match(parser, TOKEN_CHAR_KW) || parser_match(parser, TOKEN_VOID) ||
+        parser_match(parser, TOKEN_CONST))
     {
         return parse_declaracao_com_tipo(parser);
     }
@@ -272,6 +296,14 @@ ASTNode *parse_declaracao_global(Parser *parser)
 
 ASTNode *parse_declaracao_com_tipo(Parser *parser)
 {
+    int constante = parse_qualificador_const(parser);
+    if (constante && !parser_match(parser, TOKEN_INT) && !parser_match(parser, TOKEN_FLOAT_KW) &&
+        !parser_match(parser, TOKEN_CHAR_KW) && !parser_match(parser, TOKEN_VOID))
+    {
+        parser_error(parser, "Esperado tipo após 'const'");
+        return NULL;
+    }
+
     DataType tipo = TYPE_VOID;
     if (parser_match(parser, TOKEN_INT))
         tipo = TYPE_INT;
@@ -283,6 +315,7 @@ ASTNode *parse_declaracao_com_tipo(Parser *parser)
         tipo = TYPE_VOID;
 
     parser_advance(parser);
+    int nivel_ponteiro = parse_nivel_ponteiro(parser);
 
     if (!parser_match(parser, TOKEN_IDENTIFIER))
     {
@@ -307,6 +340,10 @@ ASTNode *parse_declaracao_com_tipo(Parser *parser)
         {
             parser->has_error = 0; // Reseta para continuar
         }
+        if (funcao)
+        {
+            funcao->data.function_decl.pointer_level = nivel_ponteiro;
+        }
         return funcao;
     }
     else
@@ -316,6 +353,12 @@ ASTNode *parse_declaracao_com_tipo(Parser *parser)
         {
             parser->has_error = 0; // Reseta para continuar
         }
+        if (var)
+        {
+            var->data.var_decl.pointer_level = nivel_ponteiro;
+            if (constante)
+                var->data.var_decl.modifiers |= MOD_CONST;
+        }
         return var;
     }
 }
@@ -354,6 +397,7 @@ ASTNode *parse_definicao_funcao_com_info(Parser *parser, DataType tipo_retorno,
                     break;
                 }
                 parser_advance(parser);
+                int nivel_ponteiro = parse_nivel_ponteiro(parser);
 
                 if (!parser_match(parser, TOKEN_IDENTIFIER))
                 {
@@ -366,6 +410,7 @@ ASTNode *parse_definicao_funcao_com_info(Parser *parser, DataType tipo_retorno,
                 ASTNode *param = ast_create_node(AST_PARAMETER);
                 param->data.parameter.name = strdup(parser->current_token.value);
                 param->data.parameter.param_type = param_type;
+                param->data.parameter.pointer_level = nivel_ponteiro;
                 parser_advance(parser);
                 ast_add_child(param_list, param);
 
@@ -417,6 +462,30 @@ ASTNode *parse_declaracao_variavel_com_info(Parser *parser, DataType tipo, char
     var->data.var_decl.var_type = tipo;
     var->data.var_decl.initializer = NULL;
 
+    // Dimensão de array: int v[10];
+    if (parser_match(parser, TOKEN_LBRACKET))
+    {
+        parser_advance(parser);
+        if (!parser_match(parser, TOKEN_NUMBER))
+        {
+            parser_error(parser, "Esperado tamanho constante do array");
+            ast_destroy(var);
+            return NULL;
+        }
+        ASTNode *tamanho = ast_create_node(AST_NUMBER_LITERAL);
+        tamanho->data.literal.value = strdup(parser->current_token.value);
+        var->data.var_decl.array_size = tamanho;
+        parser_advance(parser);
+
+        if (!parser_match(parser, TOKEN_RBRACKET))
+        {
+            parser_error(parser, "Esperado ']' após tamanho do array");
+            ast_destroy(var);
+            return NULL;
+        }
+        parser_advance(parser);
+    }
+
     if (parser_match(parser, TOKEN_ASSIGN))
     {
         parser_advance(parser);
@@ -482,11 +551,13 @@ ASTNode *parse_bloco(Parser *parser)
 
 ASTNode *parse_item_bloco(Parser *parser)
 {
+    int constante = parse_qualificador_const(parser);
     if (parser_match(parser, TOKEN_INT) || parser_match(parser, TOKEN_FLOAT_KW) ||
         parser_match(parser, TOKEN_CHAR_KW) || parser_match(parser, TOKEN_VOID))
     {
         TokenType tipo_token = parser->current_token.type;
         parser_advance(parser);
+        int nivel_ponteiro = parse_nivel_ponteiro(parser);
 
         if (parser_match(parser, TOKEN_IDENTIFIER))
         {
@@ -509,7 +580,14 @@ ASTNode *parse_item_bloco(Parser *parser)
 
             char *nome = strdup(parser->current_token.value);
             parser_advance(parser);
-            return parse_declaracao_variavel_com_info(parser, tipo, nome);
+            ASTNode *var = parse_declaracao_variavel_com_info(parser, tipo, nome);
+            if (var)
+            {
+                var->data.var_decl.pointer_level = nivel_ponteiro;
+                if (constante)
+                    var->data.var_decl.modifiers |= MOD_CONST;
+            }
+            return var;
         }
         else if (parser_match(parser, TOKEN_SEMICOLON))
         {
@@ -522,6 +600,11 @@ ASTNode *parse_item_bloco(Parser *parser)
             return NULL;
         }
     }
+    if (constante)
+    {
+        parser_error(parser, "Esperado tipo após 'const'");
+        return NULL;
+    }
 
     return parse_comando(parser);
 }
@@ -548,6 +631,18 @@ ASTNode *parse_comando_sem_if(Parser *parser)
     {
         return parse_comando_while(parser);
     }
+    else if (parser_match(parser, TOKEN_FOR))
+    {
+        return parse_comando_for(parser);
+    }
+    else if (parser_match(parser, TOKEN_DO))
+    {
+        return parse_comando_do(parser);
+    }
+    else if (parser_match(parser, TOKEN_SWITCH))
+    {
+        return parse_comando_switch(parser);
+    }
     else if (parser_match(parser, TOKEN_RETURN))
     {
         return parse_comando_return(parser);
@@ -658,6 +753,238 @@ ASTNode *parse_comando_while(Parser *parser)
     return while_stmt;
 }
 
+ASTNode *parse_comando_for(Parser *parser)
+{
+    ASTNode *for_stmt = ast_create_node(AST_FOR_STATEMENT);
+    parser_advance(parser);
+
+    if (!parser_match(parser, TOKEN_LPAREN))
+    {
+        parser_error(parser, "Esperado '(' após 'for'");
+        ast_destroy(for_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    // Inicialização: declaração ou comando de expressão (ambos consomem o ';')
+    for_stmt->data.for_stmt.init = parse_item_bloco(parser);
+    if (!for_stmt->data.for_stmt.init && parser->has_error)
+    {
+        parser->has_error = 0; // Reseta para continuar
+        ast_destroy(for_stmt);
+        return NULL;
+    }
+
+    if (!parser_match(parser, TOKEN_SEMICOLON))
+    {
+        for_stmt->data.for_stmt.condition = parse_expressao(parser);
+        if (!for_stmt->data.for_stmt.condition && parser->has_error)
+        {
+            parser->has_error = 0; // Reseta para continuar
+            ast_destroy(for_stmt);
+            return NULL;
+        }
+    }
+    if (!parser_match(parser, TOKEN_SEMICOLON))
+    {
+        parser_error(parser, "Esperado ';' após condição do 'for'");
+        ast_destroy(for_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    if (!parser_match(parser, TOKEN_RPAREN))
+    {
+        for_stmt->data.for_stmt.update = parse_expressao(parser);
+        if (!for_stmt->data.for_stmt.update && parser->has_error)
+        {
+            parser->has_error = 0; // Reseta para continuar
+            ast_destroy(for_stmt);
+            return NULL;
+        }
+    }
+    if (!parser_match(parser, TOKEN_RPAREN))
+    {
+        parser_error(parser, "Esperado ')' após cláusulas do 'for'");
+        ast_destroy(for_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    for_stmt->data.for_stmt.body = parse_comando(parser);
+    if (!for_stmt->data.for_stmt.body && parser->has_error)
+    {
+        parser->has_error = 0; // Reseta para continuar
+        ast_destroy(for_stmt);
+        return NULL;
+    }
+
+    return for_stmt;
+}
+
+ASTNode *parse_comando_do(Parser *parser)
+{
+    ASTNode *do_stmt = ast_create_node(AST_DO_WHILE_STATEMENT);
+    parser_advance(parser);
+
+    do_stmt->data.while_stmt.body = parse_comando(parser);
+    if (!do_stmt->data.while_stmt.body && parser->has_error)
+    {
+        parser->has_error = 0; // Reseta para continuar
+        ast_destroy(do_stmt);
+        return NULL;
+    }
+
+    if (!parser_match(parser, TOKEN_WHILE))
+    {
+        parser_error(parser, "Esperado 'while' após corpo do 'do'");
+        ast_destroy(do_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    if (!parser_match(parser, TOKEN_LPAREN))
+    {
+        parser_error(parser, "Esperado '(' após 'while'");
+        ast_destroy(do_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    do_stmt->data.while_stmt.condition = parse_expressao(parser);
+    if (!do_stmt->data.while_stmt.condition && parser->has_error)
+    {
+        parser->has_error = 0; // Reseta para continuar
+        ast_destroy(do_stmt);
+        return NULL;
+    }
+
+    if (!parser_match(parser, TOKEN_RPAREN))
+    {
+        parser_error(parser, "Esperado ')' após condição");
+        ast_destroy(do_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    if (!parser_match(parser, TOKEN_SEMICOLON))
+    {
+        parser_error(parser, "Esperado ';' após 'do ... while'");
+        ast_destroy(do_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    return do_stmt;
+}
+
+// Corpo do switch: sequência de rótulos case/default, cada um seguido dos
+// comandos que executa (em C, a execução continua no rótulo seguinte)
+ASTNode *parse_comando_switch(Parser *parser)
+{
+    ASTNode *switch_stmt = ast_create_node(AST_SWITCH_STATEMENT);
+    parser_advance(parser);
+
+    if (!parser_match(parser, TOKEN_LPAREN))
+    {
+        parser_error(parser, "Esperado '(' após 'switch'");
+        ast_destroy(switch_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    switch_stmt->data.switch_stmt.expression = parse_expressao(parser);
+    if (!switch_stmt->data.switch_stmt.expression && parser->has_error)
+    {
+        parser->has_error = 0; // Reseta para continuar
+        ast_destroy(switch_stmt);
+        return NULL;
+    }
+
+    if (!parser_match(parser, TOKEN_RPAREN))
+    {
+        parser_error(parser, "Esperado ')' após expressão do 'switch'");
+        ast_destroy(switch_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    if (!parser_match(parser, TOKEN_LBRACE))
+    {
+        parser_error(parser, "Esperado '{' após 'switch'");
+        ast_destroy(switch_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    ASTNode *cases = ast_create_node(AST_COMPOUND_STATEMENT);
+    switch_stmt->data.switch_stmt.cases = cases;
+    ASTNode *current = NULL;
+
+    while (!parser_match(parser, TOKEN_RBRACE) && !parser_match(parser, TOKEN_EOF))
+    {
+        if (parser_match(parser, TOKEN_CASE) || parser_match(parser, TOKEN_DEFAULT))
+        {
+            int is_case = parser_match(parser, TOKEN_CASE);
+            current = ast_create_node(is_case ? AST_CASE_STATEMENT : AST_DEFAULT_STATEMENT);
+            ast_add_child(cases, current);
+            parser_advance(parser);
+
+            if (is_case)
+            {
+                current->data.case_stmt.value = parse_condicional(parser);
+                if (!current->data.case_stmt.value)
+                {
+                    parser->has_error = 0; // Reseta para continuar
+                    ast_destroy(switch_stmt);
+                    return NULL;
+                }
+            }
+
+            if (!parser_match(parser, TOKEN_COLON))
+            {
+                parser_error(parser, "Esperado ':' após rótulo do 'switch'");
+                ast_destroy(switch_stmt);
+                return NULL;
+            }
+            parser_advance(parser);
+            continue;
+        }
+
+        if (!current)
+        {
+            parser_error(parser, "Esperado 'case' ou 'default' no corpo do 'switch'");
+            ast_destroy(switch_stmt);
+            return NULL;
+        }
+
+        ASTNode *item = parse_item_bloco(parser);
+        if (item)
+        {
+            ast_add_child(current, item);
+        }
+        else if (parser->has_error)
+        {
+            parser->has_error = 0; // Reseta para continuar
+            parser_skip_to_recovery_point(parser);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (!parser_match(parser, TOKEN_RBRACE))
+    {
+        parser_error(parser, "Esperado '}' ao final do 'switch'");
+        ast_destroy(switch_stmt);
+        return NULL;
+    }
+    parser_advance(parser);
+
+    return switch_stmt;
+}
+
 ASTNode *parse_comando_return(Parser *parser)
 {
     ASTNode *return_stmt = ast_create_node(AST_RETURN_STATEMENT);
@@ -771,6 +1098,7 @@ ASTNode *parse_expressao_virgula(Parser *parser)
         if (!comma_expr->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            comma_expr->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(comma_expr);
             return expr;
         }
@@ -869,6 +1197,7 @@ ASTNode *parse_logico_ou(Parser *parser)
         if (!binary->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            binary->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(binary);
             return expr;
         }
@@ -897,6 +1226,7 @@ ASTNode *parse_logico_e(Parser *parser)
         if (!binary->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            binary->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(binary);
             return expr;
         }
@@ -925,6 +1255,7 @@ ASTNode *parse_igualdade(Parser *parser)
         if (!binary->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            binary->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(binary);
             return expr;
         }
@@ -954,6 +1285,7 @@ ASTNode *parse_relacional(Parser *parser)
         if (!binary->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            binary->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(binary);
             return expr;
         }
@@ -982,6 +1314,7 @@ ASTNode *parse_soma(Parser *parser)
         if (!binary->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            binary->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(binary);
             return expr;
         }
@@ -1011,6 +1344,7 @@ ASTNode *parse_produto(Parser *parser)
         if (!binary->data.binary_expr.right && parser->has_error)
         {
             parser->has_error = 0; // Reseta para continuar
+            binary->data.binary_expr.left = NULL; // expr continua em uso
             ast_destroy(binary);
             return expr;
         }
@@ -49,6 +49,9 @@ ASTNode* parse_comando(Parser* parser);
 ASTNode* parse_comando_if(Parser* parser);
 ASTNode* parse_comando_sem_if(Parser* parser);
 ASTNode* parse_comando_while(Parser* parser);
+ASTNode* parse_comando_for(Parser* parser);
+ASTNode* parse_comando_do(Parser* parser);
+ASTNode* parse_comando_switch(Parser* parser);
 ASTNode* parse_comando_return(Parser* parser);
 ASTNode* parse_comando_break(Parser* parser);
 ASTNode* parse_comando_continue(Parser* parser);
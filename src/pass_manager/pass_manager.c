@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "pass_manager.h"
+
+const PassInfo pass_table[PASS_COUNT] = {
+#define PASS(id, name, run, levels, requires, invalidates, instrumentable, description) \
+    {name, run, levels, requires, invalidates, instrumentable, description},
+#include "passes.def"
+#undef PASS
+};
+
+static const char* level_names[OPT_LEVEL_COUNT] = {"-O0", "-O1", "-O2", "-Os"};
+
+// ============================================================
+// Análises
+// ============================================================
+
+typedef struct AnalysisInfo {
+    const char* name;
+    void (*compute)(ASTNode* program);
+} AnalysisInfo;
+
+static const AnalysisInfo analysis_table[ANALYSIS_COUNT] = {
+    {"purity", analyze_function_purity}
+};
+
+// ============================================================
+// Pipeline
+// ============================================================
+
+PassManager* pass_manager_create(OptimizationLevel level) {
+    PassManager* manager = calloc(1, sizeof(PassManager));
+    manager->level = level;
+    for (int p = 0; p < PASS_COUNT; p++) {
+        manager->enabled[p] = (pass_table[p].levels & (1u << level)) != 0;
+    }
+    return manager;
+}
+
+void pass_manager_destroy(PassManager* manager) {
+    if (!manager) return;
+    free(manager->timings);
+    free(manager);
+}
+
+int pass_manager_parse_level(const char* flag, OptimizationLevel* level) {
+    // -O sozinho continua valendo o pipeline completo
+    if (strcmp(flag, "-O") == 0) {
+        *level = OPT_LEVEL_2;
+        return 1;
+    }
+    for (int l = 0; l < OPT_LEVEL_COUNT; l++) {
+        if (strcmp(flag, level_names[l]) == 0) {
+            *level = (OptimizationLevel)l;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char* pass_manager_level_name(OptimizationLevel level) {
+    return level >= 0 && level < OPT_LEVEL_COUNT ? level_names[level] : "?";
+}
+
+int pass_lookup(const char* name) {
+    for (int p = 0; p < PASS_COUNT; p++) {
+        if (strcmp(pass_table[p].name, name) == 0) return p;
+    }
+    return -1;
+}
+
+void pass_manager_set(PassManager* manager, PassId pass, int enabled) {
+    manager->enabled[pass] = enabled;
+}
+
+int pass_enabled(const PassManager* manager, PassId pass) {
+    return manager && manager->enabled[pass];
+}
+
+void pass_manager_exclude_uninstrumentable(PassManager* manager) {
+    for (int p = 0; p < PASS_COUNT; p++) {
+        if (!pass_table[p].instrumentable) manager->enabled[p] = 0;
+    }
+}
+
+// ============================================================
+// Medição
+// ============================================================
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Bytes alocados no heap (0 fora da glibc)
+static long heap_in_use(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return (long)mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static long peak_rss_kb(void) {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+PassTimer pass_timer_start(void) {
+    PassTimer timer = {now_ms(), heap_in_use()};
+    return timer;
+}
+
+void pass_manager_record(PassManager* manager, const char* name, const char* kind, PassTimer timer) {
+    if (!manager || !manager->time_passes) return;
+    if (manager->timing_count == manager->timing_capacity) {
+        manager->timing_capacity = manager->timing_capacity ? manager->timing_capacity * 2 : 32;
+        manager->timings = realloc(manager->timings, manager->timing_capacity * sizeof(PassTiming));
+    }
+    PassTiming* timing = &manager->timings[manager->timing_count++];
+    timing->name = name;
+    timing->kind = kind;
+    timing->wall_ms = now_ms() - timer.start_ms;
+    timing->heap_bytes = heap_in_use() - timer.start_heap;
+    timing->peak_rss_kb = peak_rss_kb();
+}
+
+// ============================================================
+// Execução
+// ============================================================
+
+static void ensure_analyses(PassManager* manager, unsigned required, ASTNode* program) {
+    for (int a = 0; a < ANALYSIS_COUNT; a++) {
+        unsigned bit = 1u << a;
+        if (!(required & bit) || (manager->valid_analyses & bit)) continue;
+        PassTimer timer = pass_timer_start();
+        analysis_table[a].compute(program);
+        pass_manager_record(manager, analysis_table[a].name, "análise", timer);
+        manager->valid_analyses |= bit;
+        manager->analysis_runs[a]++;
+    }
+}
+
+void pass_manager_run(PassManager* manager, Optimizer* optimizer, ASTNode* program) {
+    if (!manager || !program) return;
+
+    for (int p = 0; p < PASS_COUNT; p++) {
+        const PassInfo* pass = &pass_table[p];
+        if (!pass->run || !manager->enabled[p]) continue;
+
+        ensure_analyses(manager, pass->requires, program);
+        PassTimer timer = pass_timer_start();
+        pass->run(optimizer, program);
+        pass_manager_record(manager, pass->name, "passe", timer);
+        manager->valid_analyses &= ~pass->invalidates;
+    }
+}
+
+// ============================================================
+// Relatórios
+// ============================================================
+
+void pass_manager_print_pipeline(const PassManager* manager) {
+    printf("Pipeline %s:", pass_manager_level_name(manager->level));
+    int any = 0;
+    for (int p = 0; p < PASS_COUNT; p++) {
+        if (!manager->enabled[p]) continue;
+        printf(" %s", pass_table[p].name);
+        any = 1;
+    }
+    printf(any ? "\n" : " (nenhum passe)\n");
+
+    // O que as flags -f mudaram em relação ao nível
+    for (int p = 0; p < PASS_COUNT; p++) {
+        int by_level = (pass_table[p].levels & (1u << manager->level)) != 0;
+        if (by_level != manager->enabled[p]) {
+            printf("  %s %s\n", manager->enabled[p] ? "+" : "-", pass_table[p].name);
+        }
+    }
+    for (int a = 0; a < ANALYSIS_COUNT; a++) {
+        if (manager->analysis_runs[a]) {
+            printf("Análise %s calculada %d vez(es)\n", analysis_table[a].name, manager->analysis_runs[a]);
+        }
+    }
+}
+
+// %-*s conta bytes; aqui a largura é em caracteres (nomes com acento)
+static void print_column(const char* text, int width) {
+    int length = 0;
+    for (const char* c = text; *c; c++) {
+        if ((*c & 0xC0) != 0x80) length++;
+    }
+    printf("%s%*s ", text, width > length ? width - length : 0, "");
+}
+
+void pass_manager_print_timings(const PassManager* manager) {
+    if (!manager || !manager->time_passes) return;
+
+    double total = 0;
+    for (int i = 0; i < manager->timing_count; i++) total += manager->timings[i].wall_ms;
+
+    printf("\n=== TEMPO DOS PASSES (%s) ===\n", pass_manager_level_name(manager->level));
+    printf("%-20s %-8s %12s %7s %14s %12s\n", "nome", "tipo", "parede (ms)", "%", "heap (KiB)", "pico RSS (KiB)");
+    for (int i = 0; i < manager->timing_count; i++) {
+        const PassTiming* timing = &manager->timings[i];
+        print_column(timing->name, 20);
+        print_column(timing->kind, 8);
+        printf("%12.3f %6.1f%% %14.1f %12ld\n", timing->wall_ms,
+               total > 0 ? 100.0 * timing->wall_ms / total : 0.0, timing->heap_bytes / 1024.0,
+               timing->peak_rss_kb);
+    }
+    printf("%-20s %-8s %12.3f\n", "total", "", total);
+}
+
+void pass_manager_print_passes(void) {
+    printf("\nPasses (-f<passe> liga, -fno-<passe> desliga):\n");
+    for (int p = 0; p < PASS_COUNT; p++) {
+        char levels[32] = "";
+        for (int l = OPT_LEVEL_1; l < OPT_LEVEL_COUNT; l++) {
+            if (pass_table[p].levels & (1u << l)) {
+                strcat(levels, levels[0] ? " " : "");
+                strcat(levels, level_names[l]);
+            }
+        }
+        printf("  %-16s %-12s %s\n", pass_table[p].name, levels[0] ? levels : "opcional",
+               pass_table[p].description);
+    }
+}
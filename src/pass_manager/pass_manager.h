@@ -0,0 +1,112 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include <stddef.h>
+#include "ast.h"
+#include "optimizer.h"
+
+// ------------------------------------------------------------
+// Gerenciador de passes de otimização
+//
+// Os passes estão em passes.def, numa ordem fixa; um nível (-O0, -O1,
+// -O2, -Os) escolhe quais rodam e -f<passe>/-fno-<passe> muda a escolha
+// de um passe. O mesmo nível e as mesmas flags dão sempre o mesmo
+// pipeline, então o custo e o ganho de cada passe podem ser medidos no
+// corpus de benchmark ligando e desligando um de cada vez.
+//
+// As análises (hoje, a pureza das funções) são calculadas sob demanda
+// antes do primeiro passe que as requer e recalculadas depois de um
+// passe que as invalida. Com --time-passes, cada passe, cada análise e
+// as fases do driver registram tempo de parede e memória.
+// ------------------------------------------------------------
+
+typedef enum {
+    OPT_LEVEL_0,
+    OPT_LEVEL_1,
+    OPT_LEVEL_2,
+    OPT_LEVEL_SIZE,        // -Os: -O2 sem os passes que aumentam o código
+    OPT_LEVEL_COUNT
+} OptimizationLevel;
+
+// Pipelines que incluem um passe (coluna "níveis" de passes.def)
+#define PIPELINE_O1 (1u << OPT_LEVEL_1)
+#define PIPELINE_O2 (1u << OPT_LEVEL_2)
+#define PIPELINE_OS (1u << OPT_LEVEL_SIZE)
+#define PIPELINE_ALL (PIPELINE_O1 | PIPELINE_O2 | PIPELINE_OS)
+
+// Análises que os passes requerem ou invalidam
+#define ANALYSIS_PURITY (1u << 0)
+#define ANALYSIS_COUNT 1
+
+typedef enum {
+#define PASS(id, ...) PASS_##id,
+#include "passes.def"
+#undef PASS
+    PASS_COUNT
+} PassId;
+
+typedef struct PassInfo {
+    const char* name;
+    void (*run)(Optimizer* optimizer, ASTNode* program);  // NULL: etapa do gerador
+    unsigned levels;
+    unsigned requires;
+    unsigned invalidates;
+    int instrumentable;
+    const char* description;
+} PassInfo;
+
+typedef struct PassTiming {
+    const char* name;
+    const char* kind;      // "passe", "análise" ou "fase"
+    double wall_ms;
+    long heap_bytes;       // Variação da memória alocada no heap
+    long peak_rss_kb;      // Pico de memória residente do processo ao fim
+} PassTiming;
+
+// Início de uma medição (--time-passes)
+typedef struct PassTimer {
+    double start_ms;
+    long start_heap;
+} PassTimer;
+
+typedef struct PassManager {
+    OptimizationLevel level;
+    int enabled[PASS_COUNT];
+    unsigned valid_analyses;
+    int analysis_runs[ANALYSIS_COUNT];
+
+    int time_passes;
+    PassTiming* timings;
+    int timing_count;
+    int timing_capacity;
+} PassManager;
+
+extern const PassInfo pass_table[PASS_COUNT];
+
+PassManager* pass_manager_create(OptimizationLevel level);
+void pass_manager_destroy(PassManager* manager);
+
+// -O<x> para o nível; 0 se a flag não é um nível
+int pass_manager_parse_level(const char* flag, OptimizationLevel* level);
+const char* pass_manager_level_name(OptimizationLevel level);
+
+// Índice do passe com esse nome; -1 se não existe
+int pass_lookup(const char* name);
+void pass_manager_set(PassManager* manager, PassId pass, int enabled);
+int pass_enabled(const PassManager* manager, PassId pass);
+
+// Desliga os passes não instrumentáveis (-fprofile-generate)
+void pass_manager_exclude_uninstrumentable(PassManager* manager);
+
+// Roda os passes da AST habilitados, na ordem da tabela
+void pass_manager_run(PassManager* manager, Optimizer* optimizer, ASTNode* program);
+
+// Medição de uma fase do driver (parser, semântica, geração de código)
+PassTimer pass_timer_start(void);
+void pass_manager_record(PassManager* manager, const char* name, const char* kind, PassTimer timer);
+
+void pass_manager_print_pipeline(const PassManager* manager);
+void pass_manager_print_timings(const PassManager* manager);
+void pass_manager_print_passes(void);
+
+#endif
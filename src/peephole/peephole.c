@@ -0,0 +1,488 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "peephole.h"
+
+#define DEAD_SCAN_BUDGET 8     // Instruções examinadas para provar %eax morto
+
+// ============================================================
+// Lista de linhas
+// ============================================================
+
+static AsmLine* append_line(AsmList* list) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 256;
+        list->lines = realloc(list->lines, list->capacity * sizeof(AsmLine));
+    }
+    AsmLine* line = &list->lines[list->count++];
+    memset(line, 0, sizeof(AsmLine));
+    return line;
+}
+
+static char* copy_range(const char* start, size_t length) {
+    char* text = malloc(length + 1);
+    memcpy(text, start, length);
+    text[length] = '\0';
+    return text;
+}
+
+// Separa mnemônico e operandos; devolve 0 se a linha não cabe na estrutura
+// (ela então é copiada como está e nenhuma regra a toca)
+static int parse_instruction(AsmLine* line, const char* text) {
+    size_t length = 0;
+    while (text[length] && !isspace((unsigned char)text[length])) length++;
+    if (length >= sizeof(line->mnemonic)) return 0;
+    memcpy(line->mnemonic, text, length);
+    line->mnemonic[length] = '\0';
+
+    const char* rest = text + length;
+    while (isspace((unsigned char)*rest)) rest++;
+    if (strchr(rest, '"')) return 0;
+
+    // # começa um comentário em AT&T; ele volta na escrita
+    const char* comment = strchr(rest, '#');
+    const char* stop = comment ? comment : rest + strlen(rest);
+    while (stop > rest && isspace((unsigned char)stop[-1])) stop--;
+
+    line->operand_count = 0;
+    while (rest < stop) {
+        const char* end = rest;
+        int depth = 0;
+        while (end < stop && !(*end == ',' && depth == 0)) {
+            if (*end == '(') depth++;
+            if (*end == ')') depth--;
+            end++;
+        }
+        const char* last = end;
+        while (last > rest && isspace((unsigned char)last[-1])) last--;
+        if (line->operand_count == ASM_MAX_OPERANDS || last - rest >= ASM_OPERAND_SIZE) return 0;
+        char* operand = line->operands[line->operand_count++];
+        memcpy(operand, rest, last - rest);
+        operand[last - rest] = '\0';
+
+        rest = end < stop ? end + 1 : end;
+        while (isspace((unsigned char)*rest)) rest++;
+    }
+    line->text = comment ? strdup(comment) : NULL;
+    return 1;
+}
+
+static void parse_line(AsmList* list, const char* start, size_t length) {
+    AsmLine* line = append_line(list);
+    char* text = copy_range(start, length);
+    const char* trimmed = text;
+    while (isspace((unsigned char)*trimmed)) trimmed++;
+
+    if (!isspace((unsigned char)text[0]) && length > 1 && text[length - 1] == ':' && !strchr(text, ' ')) {
+        line->kind = ASM_LABEL;
+        text[length - 1] = '\0';
+        line->text = text;
+    } else if (*trimmed == '\0' || *trimmed == '.' || *trimmed == '#') {
+        line->kind = ASM_OTHER;
+        line->text = text;
+    } else if (!parse_instruction(line, trimmed)) {
+        line->kind = ASM_OTHER;
+        line->operand_count = 0;
+        line->text = text;
+        list->unstructured++;
+    } else {
+        line->kind = ASM_INSTRUCTION;
+        free(text);
+    }
+}
+
+AsmList* asm_list_parse(const char* text) {
+    AsmList* list = calloc(1, sizeof(AsmList));
+    while (text && *text) {
+        const char* end = strchr(text, '\n');
+        size_t length = end ? (size_t)(end - text) : strlen(text);
+        parse_line(list, text, length);
+        text += length + (end ? 1 : 0);
+    }
+    return list;
+}
+
+void asm_list_write(const AsmList* list, FILE* output) {
+    for (int i = 0; i < list->count; i++) {
+        const AsmLine* line = &list->lines[i];
+        if (line->kind == ASM_LABEL) {
+            fprintf(output, "%s:\n", line->text);
+        } else if (line->kind == ASM_OTHER) {
+            fprintf(output, "%s\n", line->text);
+        } else {
+            fprintf(output, "    %s", line->mnemonic);
+            for (int j = 0; j < line->operand_count; j++) {
+                fprintf(output, "%s%s", j == 0 ? " " : ", ", line->operands[j]);
+            }
+            if (line->text) fprintf(output, "  %s", line->text);
+            fputc('\n', output);
+        }
+    }
+}
+
+static void free_lines(AsmLine* lines, int count) {
+    for (int i = 0; i < count; i++) free(lines[i].text);
+    free(lines);
+}
+
+void asm_list_destroy(AsmList* list) {
+    if (!list) return;
+    free_lines(list->lines, list->count);
+    free(list);
+}
+
+// ============================================================
+// Operandos
+// ============================================================
+
+static int is_instruction(const AsmLine* line, const char* mnemonic) {
+    return line && line->kind == ASM_INSTRUCTION && strcmp(line->mnemonic, mnemonic) == 0;
+}
+
+static int is_one_of(const char* mnemonic, const char* const* names) {
+    for (int i = 0; names[i]; i++) {
+        if (strcmp(mnemonic, names[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+static int is_register(const char* operand) {
+    return operand[0] == '%';
+}
+
+static int is_accumulator(const char* operand) {
+    return strcmp(operand, "%eax") == 0 || strcmp(operand, "%rax") == 0;
+}
+
+// Qualquer parte de %rax aparece no operando
+static int mentions_accumulator(const char* operand) {
+    return strstr(operand, "%rax") || strstr(operand, "%eax") || strstr(operand, "%ax") ||
+           strstr(operand, "%al") || strstr(operand, "%ah");
+}
+
+static const char* const accumulator_readers[] = {
+    "cltd", "cqto", "cltq", "idivl", "idivq", "divl", "divq", "call", "ret", NULL
+};
+
+static int reads_accumulator(const AsmLine* line) {
+    if (is_one_of(line->mnemonic, accumulator_readers)) return 1;
+    for (int i = 0; i < line->operand_count; i++) {
+        if (mentions_accumulator(line->operands[i])) return 1;
+    }
+    return 0;
+}
+
+// mov/lea/pop/xor que só escrevem %eax/%rax inteiro
+static int overwrites_accumulator(const AsmLine* line) {
+    const char* m = line->mnemonic;
+    if (strcmp(m, "pop") == 0) return line->operand_count == 1 && strcmp(line->operands[0], "%rax") == 0;
+    if (line->operand_count != 2 || !is_accumulator(line->operands[1])) return 0;
+    if (strcmp(m, "xorl") == 0) return strcmp(line->operands[0], "%eax") == 0;
+    int writes = strncmp(m, "mov", 3) == 0 || strncmp(m, "lea", 3) == 0 || strncmp(m, "cvtt", 4) == 0;
+    return writes && !mentions_accumulator(line->operands[0]);
+}
+
+// Condição do setcc/jcc e sua negação
+static const char* const conditions[][2] = {
+    {"e", "ne"}, {"ne", "e"}, {"l", "ge"}, {"ge", "l"}, {"g", "le"}, {"le", "g"},
+    {"a", "be"}, {"be", "a"}, {"b", "ae"}, {"ae", "b"}, {NULL, NULL}
+};
+
+static const char* negate_condition(const char* condition) {
+    for (int i = 0; conditions[i][0]; i++) {
+        if (strcmp(conditions[i][0], condition) == 0) return conditions[i][1];
+    }
+    return NULL;
+}
+
+// ============================================================
+// Passe
+// ============================================================
+
+typedef struct Peephole {
+    const AsmList* input;
+    int next;              // Próxima linha da entrada (a seguinte à que acabou de entrar)
+    AsmList* out;
+
+    // Rótulo -> índice na entrada (endereçamento aberto)
+    int* labels;
+    int label_capacity;
+} Peephole;
+
+static unsigned int string_hash(const char* text, int capacity) {
+    unsigned int hash = 2166136261u;
+    for (; *text; text++) hash = (hash ^ (unsigned char)*text) * 16777619u;
+    return hash & (capacity - 1);
+}
+
+static void index_labels(Peephole* p) {
+    int count = 0;
+    for (int i = 0; i < p->input->count; i++) count += p->input->lines[i].kind == ASM_LABEL;
+    p->label_capacity = 16;
+    while (p->label_capacity < count * 2) p->label_capacity *= 2;
+    p->labels = malloc(p->label_capacity * sizeof(int));
+    for (int i = 0; i < p->label_capacity; i++) p->labels[i] = -1;
+
+    for (int i = 0; i < p->input->count; i++) {
+        if (p->input->lines[i].kind != ASM_LABEL) continue;
+        unsigned int slot = string_hash(p->input->lines[i].text, p->label_capacity);
+        while (p->labels[slot] >= 0) slot = (slot + 1) & (p->label_capacity - 1);
+        p->labels[slot] = i;
+    }
+}
+
+static int find_label(const Peephole* p, const char* name) {
+    unsigned int slot = string_hash(name, p->label_capacity);
+    while (p->labels[slot] >= 0) {
+        if (strcmp(p->input->lines[p->labels[slot]].text, name) == 0) return p->labels[slot];
+        slot = (slot + 1) & (p->label_capacity - 1);
+    }
+    return -1;
+}
+
+// %eax é reescrito antes de ser lido a partir de index, em todos os
+// caminhos? Olha poucas instruções (seguindo saltos) e, na dúvida, diz não.
+static int accumulator_dead(const Peephole* p, int index, int budget) {
+    for (int i = index; i < p->input->count; i++) {
+        const AsmLine* line = &p->input->lines[i];
+        if (line->kind != ASM_INSTRUCTION) continue;
+        if (budget-- <= 0) return 0;
+
+        if (line->mnemonic[0] == 'j') {
+            int target = line->operand_count == 1 ? find_label(p, line->operands[0]) : -1;
+            if (target < 0 || !accumulator_dead(p, target, budget)) return 0;
+            if (strcmp(line->mnemonic, "jmp") == 0) return 1;
+            continue;
+        }
+        if (overwrites_accumulator(line)) return 1;
+        if (reads_accumulator(line) || strcmp(line->mnemonic, "leave") == 0) return 0;
+    }
+    return 0;
+}
+
+// k-ésima linha a partir do fim da saída (0: a última)
+static AsmLine* tail(Peephole* p, int k) {
+    return k < p->out->count ? &p->out->lines[p->out->count - 1 - k] : NULL;
+}
+
+// Descarta as k linhas anteriores à última, que desce para o lugar delas
+static void drop_before_last(Peephole* p, int k) {
+    AsmLine* lines = p->out->lines;
+    int last = p->out->count - 1;
+    for (int i = last - k; i < last; i++) free(lines[i].text);
+    lines[last - k] = lines[last];
+    p->out->count -= k;
+}
+
+static void drop_last(Peephole* p, int k) {
+    for (int i = 0; i < k; i++) free(p->out->lines[--p->out->count].text);
+}
+
+// ============================================================
+// Regras
+// ============================================================
+
+static const char* const operand_loads[] = {"movl", "movq", "movsbl", "movzbl", "movslq", "leaq", NULL};
+
+// push %rax; mov X, %eax; movl %eax, %ecx; pop %rax  =>  mov X, %ecx
+// (o operando direito de uma operação binária, quando é uma folha)
+static int rule_operand_push(Peephole* p) {
+    AsmLine* push = tail(p, 3);
+    AsmLine* load = tail(p, 2);
+    AsmLine* copy = tail(p, 1);
+    if (!is_instruction(tail(p, 0), "pop") || strcmp(tail(p, 0)->operands[0], "%rax") != 0) return 0;
+    if (!is_instruction(push, "push") || strcmp(push->operands[0], "%rax") != 0) return 0;
+    if (load->kind != ASM_INSTRUCTION || !is_one_of(load->mnemonic, operand_loads) ||
+        load->operand_count != 2 || strstr(load->operands[0], "%rsp")) return 0;
+
+    const char* target;
+    if (strcmp(load->operands[1], "%eax") == 0 && is_instruction(copy, "movl") &&
+        strcmp(copy->operands[0], "%eax") == 0 && strcmp(copy->operands[1], "%ecx") == 0) {
+        target = "%ecx";
+    } else if (strcmp(load->operands[1], "%rax") == 0 && is_instruction(copy, "movq") &&
+               strcmp(copy->operands[0], "%rax") == 0 && strcmp(copy->operands[1], "%rcx") == 0) {
+        target = "%rcx";
+    } else {
+        return 0;
+    }
+
+    *push = *load;
+    strcpy(push->operands[1], target);
+    drop_last(p, 3);
+    return 1;
+}
+
+// push %rax; pop R  =>  movq %rax, R (ou nada, se R é %rax)
+static int rule_push_pop(Peephole* p) {
+    AsmLine* push = tail(p, 1);
+    AsmLine* pop = tail(p, 0);
+    if (!is_instruction(pop, "pop") || !is_instruction(push, "push") ||
+        strcmp(push->operands[0], "%rax") != 0 || !is_register(pop->operands[0])) return 0;
+
+    if (strcmp(pop->operands[0], "%rax") == 0) {
+        drop_last(p, 2);
+    } else {
+        strcpy(push->mnemonic, "movq");
+        strcpy(push->operands[1], pop->operands[0]);
+        push->operand_count = 2;
+        drop_last(p, 1);
+    }
+    return 1;
+}
+
+static const char* const plain_moves[] = {"movl", "movq", "movss", NULL};
+
+// mov A, B; mov B, A  =>  mov A, B
+static int rule_store_reload(Peephole* p) {
+    AsmLine* store = tail(p, 1);
+    AsmLine* reload = tail(p, 0);
+    if (!store || store->kind != ASM_INSTRUCTION || reload->kind != ASM_INSTRUCTION) return 0;
+    if (!is_one_of(reload->mnemonic, plain_moves) || strcmp(store->mnemonic, reload->mnemonic) != 0) return 0;
+    if (store->operand_count != 2 || reload->operand_count != 2) return 0;
+    if (strcmp(store->operands[0], reload->operands[1]) != 0 ||
+        strcmp(store->operands[1], reload->operands[0]) != 0) return 0;
+
+    drop_last(p, 1);
+    return 1;
+}
+
+// movl %r, %r zera a metade alta e não entra aqui
+static const char* const full_moves[] = {"movq", "movss", "movaps", NULL};
+
+static int rule_self_move(Peephole* p) {
+    AsmLine* move = tail(p, 0);
+    if (move->kind != ASM_INSTRUCTION || !is_one_of(move->mnemonic, full_moves) || move->operand_count != 2) return 0;
+    if (!is_register(move->operands[0]) || strcmp(move->operands[0], move->operands[1]) != 0) return 0;
+
+    drop_last(p, 1);
+    return 1;
+}
+
+static const char* const additive[] = {"add", "addl", "addq", "sub", "subl", "subq", NULL};
+static const char* const multiplicative[] = {"imull", "imulq", NULL};
+
+// add/sub $0 e imul $1 (o gerador nunca lê as flags dessas instruções)
+static int rule_neutral_arithmetic(Peephole* p) {
+    AsmLine* line = tail(p, 0);
+    if (line->kind != ASM_INSTRUCTION || line->operand_count != 2) return 0;
+    int neutral = (is_one_of(line->mnemonic, additive) && strcmp(line->operands[0], "$0") == 0) ||
+                  (is_one_of(line->mnemonic, multiplicative) && strcmp(line->operands[0], "$1") == 0);
+    if (!neutral) return 0;
+
+    drop_last(p, 1);
+    return 1;
+}
+
+// setcc %al; movzbl %al, %eax; cmpl $0, %eax; je/jne L  =>  jcc L
+// (com testl %eax, %eax no lugar do cmpl, como sai da seleção de instruções)
+// O booleano em %eax some: só vale se ninguém o lê depois do salto,
+// nem em L nem na instrução seguinte.
+static int rule_compare_branch(Peephole* p) {
+    AsmLine* set = tail(p, 3);
+    AsmLine* widen = tail(p, 2);
+    AsmLine* compare = tail(p, 1);
+    AsmLine* branch = tail(p, 0);
+    int when_zero = is_instruction(branch, "je");
+    if (!when_zero && !is_instruction(branch, "jne")) return 0;
+    int tests_zero = (is_instruction(compare, "cmpl") && strcmp(compare->operands[0], "$0") == 0) ||
+                     (is_instruction(compare, "testl") && strcmp(compare->operands[0], "%eax") == 0);
+    if (!tests_zero || strcmp(compare->operands[1], "%eax") != 0) return 0;
+    if (!is_instruction(widen, "movzbl") || strcmp(widen->operands[0], "%al") != 0 ||
+        strcmp(widen->operands[1], "%eax") != 0) return 0;
+    if (!set || set->kind != ASM_INSTRUCTION || strncmp(set->mnemonic, "set", 3) != 0 ||
+        set->operand_count != 1 || strcmp(set->operands[0], "%al") != 0) return 0;
+
+    const char* condition = set->mnemonic + 3;
+    const char* negated = negate_condition(condition);
+    if (!negated) return 0;
+    int target = find_label(p, branch->operands[0]);
+    if (target < 0 || !accumulator_dead(p, p->next, DEAD_SCAN_BUDGET) ||
+        !accumulator_dead(p, target, DEAD_SCAN_BUDGET)) return 0;
+
+    snprintf(set->mnemonic, sizeof(set->mnemonic), "j%s", when_zero ? negated : condition);
+    strcpy(set->operands[0], branch->operands[0]);
+    drop_last(p, 3);
+    return 1;
+}
+
+// jmp/jcc L; L:  =>  L:
+static int rule_jump_to_next(Peephole* p) {
+    AsmLine* label = tail(p, 0);
+    AsmLine* jump = tail(p, 1);
+    if (label->kind != ASM_LABEL || !jump || jump->kind != ASM_INSTRUCTION ||
+        jump->mnemonic[0] != 'j' || jump->operand_count != 1 ||
+        strcmp(jump->operands[0], label->text) != 0) return 0;
+
+    drop_before_last(p, 1);
+    return 1;
+}
+
+typedef struct PeepholeRuleEntry {
+    const char* name;
+    int (*apply)(Peephole* p);
+} PeepholeRuleEntry;
+
+// Na ordem de PeepholeRule
+static const PeepholeRuleEntry rule_table[PEEPHOLE_RULE_COUNT] = {
+    {"operando empilhado por mov direto", rule_operand_push},
+    {"push/pop por mov", rule_push_pop},
+    {"releitura após gravação", rule_store_reload},
+    {"mov para o próprio registrador", rule_self_move},
+    {"aritmética neutra", rule_neutral_arithmetic},
+    {"comparação fundida ao salto", rule_compare_branch},
+    {"salto para a instrução seguinte", rule_jump_to_next},
+};
+
+static int count_instructions(const AsmList* list) {
+    int count = 0;
+    for (int i = 0; i < list->count; i++) count += list->lines[i].kind == ASM_INSTRUCTION;
+    return count;
+}
+
+void peephole_optimize(AsmList* list, PeepholeStats* stats) {
+    Peephole p = {0};
+    AsmList out = {0};
+    p.input = list;
+    p.out = &out;
+    index_labels(&p);
+    stats->instructions_before += count_instructions(list);
+    stats->unstructured += list->unstructured;
+
+    // Cada linha entra na saída e as regras reescrevem o fim dela até
+    // nenhuma casar. Toda regra encolhe a saída: no máximo uma aplicação
+    // por linha da entrada.
+    for (int i = 0; i < list->count; i++) {
+        AsmLine* line = append_line(&out);
+        *line = list->lines[i];
+        line->text = list->lines[i].text ? strdup(list->lines[i].text) : NULL;
+        p.next = i + 1;
+
+        int applied = 1;
+        while (applied) {
+            applied = 0;
+            for (int r = 0; r < PEEPHOLE_RULE_COUNT && !applied; r++) {
+                if (rule_table[r].apply(&p)) {
+                    stats->hits[r]++;
+                    applied = 1;
+                }
+            }
+        }
+    }
+
+    free(p.labels);
+    free_lines(list->lines, list->count);
+    *list = out;
+    stats->instructions_after += count_instructions(list);
+}
+
+void peephole_print_stats(const PeepholeStats* stats) {
+    printf("\n=== OTIMIZAÇÃO PEEPHOLE ===\n");
+    printf("Instruções: %d -> %d\n", stats->instructions_before, stats->instructions_after);
+    for (int r = 0; r < PEEPHOLE_RULE_COUNT; r++) {
+        printf("  %s: %d\n", rule_table[r].name, stats->hits[r]);
+    }
+    if (stats->unstructured) {
+        printf("Instruções copiadas como texto (fora das regras): %d\n", stats->unstructured);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stdio.h>
+
+// ------------------------------------------------------------
+// Otimização peephole do assembly x86-64
+//
+// O texto de cada função emitido pelo gerador vira uma lista de linhas
+// estruturadas (rótulo, instrução com mnemônico e operandos, ou outra
+// coisa copiada como está). As regras olham para o fim da lista de
+// saída à medida que as instruções entram: toda troca encolhe a lista,
+// então o passe é linear no número de instruções.
+//
+// A lista é montada a partir do texto, não emitida direto pelo backend:
+// o assembly sai por emit_code, como o C e o bytecode, e o gerador só
+// desvia a saída da função para a memória. O formato é o que o próprio
+// gerador escreve (uma instrução por linha, operandos separados por
+// vírgula). Comentários no fim da linha são separados e devolvidos na
+// escrita. Instruções que não cabem na estrutura (operando com aspas,
+// mais de ASM_MAX_OPERANDS operandos ou operando maior que
+// ASM_OPERAND_SIZE) são copiadas sem passar pelas regras e contadas em
+// PeepholeStats.unstructured, que o modo verboso mostra.
+// ------------------------------------------------------------
+
+typedef enum {
+    ASM_INSTRUCTION,
+    ASM_LABEL,
+    ASM_OTHER               // Diretivas, comentários e linhas em branco
+} AsmLineKind;
+
+#define ASM_MAX_OPERANDS 3
+#define ASM_OPERAND_SIZE 128
+
+typedef struct AsmLine {
+    AsmLineKind kind;
+    char mnemonic[16];
+    char operands[ASM_MAX_OPERANDS][ASM_OPERAND_SIZE];
+    int operand_count;
+    char* text;             // Nome do rótulo, a linha original (ASM_OTHER) ou o comentário da instrução
+} AsmLine;
+
+typedef struct AsmList {
+    AsmLine* lines;
+    int count;
+    int capacity;
+    int unstructured;       // Instruções copiadas como texto
+} AsmList;
+
+typedef enum {
+    PEEPHOLE_OPERAND_PUSH,        // push/mov/mov/pop do operando direito
+    PEEPHOLE_PUSH_POP,            // push %rax seguido de pop
+    PEEPHOLE_STORE_RELOAD,        // Gravação seguida da releitura do mesmo lugar
+    PEEPHOLE_SELF_MOVE,           // mov de um registrador para ele mesmo
+    PEEPHOLE_NEUTRAL_ARITHMETIC,  // add/sub $0, imul $1
+    PEEPHOLE_COMPARE_BRANCH,      // setcc/movzbl/cmp $0/jcc vira um jcc
+    PEEPHOLE_JUMP_TO_NEXT,        // Salto para o rótulo seguinte
+    PEEPHOLE_RULE_COUNT
+} PeepholeRule;
+
+typedef struct PeepholeStats {
+    int hits[PEEPHOLE_RULE_COUNT];
+    int instructions_before;
+    int instructions_after;
+    int unstructured;       // Instruções que as regras não viram
+} PeepholeStats;
+
+// Lista a partir do texto emitido (uma linha por item)
+AsmList* asm_list_parse(const char* text);
+void asm_list_write(const AsmList* list, FILE* output);
+void asm_list_destroy(AsmList* list);
+
+// Reescreve a lista no lugar e acumula as regras aplicadas em stats
+void peephole_optimize(AsmList* list, PeepholeStats* stats);
+void peephole_print_stats(const PeepholeStats* stats);
+
+#endif
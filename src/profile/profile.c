@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+
+static const char* kind_names[PROFILE_KIND_COUNT] = {"entry", "branch", "call"};
+
+// ============================================================
+// Numeração dos pontos
+// ============================================================
+
+typedef struct Numbering {
+    Profile* profile;
+    const char* function;
+    int ordinals[PROFILE_KIND_COUNT];
+} Numbering;
+
+static void add_point(Numbering* numbering, ASTNode* node, ProfileKind kind) {
+    Profile* profile = numbering->profile;
+    if (profile->count == profile->capacity) {
+        profile->capacity = profile->capacity ? profile->capacity * 2 : 32;
+        profile->points = realloc(profile->points, profile->capacity * sizeof(ProfilePoint));
+    }
+
+    ProfilePoint* point = &profile->points[profile->count];
+    point->function = strdup(numbering->function);
+    point->kind = kind;
+    point->ordinal = numbering->ordinals[kind]++;
+    point->counts[0] = 0;
+    point->counts[1] = 0;
+    point->known = 0;
+    node->profile_point = profile->count++;
+    profile->kind_counts[kind]++;
+}
+
+// Pré-ordem, na ordem do código-fonte: o ponto do comando antes dos da
+// sua condição e do seu corpo, a chamada antes dos argumentos
+static void number_node(Numbering* numbering, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_VARIABLE_DECLARATION:
+            number_node(numbering, node->data.var_decl.initializer);
+            break;
+        case AST_BINARY_EXPRESSION:
+        case AST_ASSIGNMENT_EXPRESSION:
+            number_node(numbering, node->data.binary_expr.left);
+            number_node(numbering, node->data.binary_expr.right);
+            break;
+        case AST_UNARY_EXPRESSION:
+            number_node(numbering, node->data.unary_expr.operand);
+            break;
+        case AST_TERNARY_EXPRESSION:
+            number_node(numbering, node->data.ternary_expr.condition);
+            number_node(numbering, node->data.ternary_expr.true_expr);
+            number_node(numbering, node->data.ternary_expr.false_expr);
+            break;
+        case AST_FUNCTION_CALL:
+            add_point(numbering, node, PROFILE_CALL);
+            for (int i = 0; i < node->child_count; i++) {
+                number_node(numbering, node->children[i]);
+            }
+            break;
+        case AST_IF_STATEMENT:
+            add_point(numbering, node, PROFILE_BRANCH);
+            number_node(numbering, node->data.if_stmt.condition);
+            number_node(numbering, node->data.if_stmt.then_stmt);
+            number_node(numbering, node->data.if_stmt.else_stmt);
+            break;
+        case AST_WHILE_STATEMENT:
+        case AST_DO_WHILE_STATEMENT:
+            add_point(numbering, node, PROFILE_BRANCH);
+            number_node(numbering, node->data.while_stmt.condition);
+            number_node(numbering, node->data.while_stmt.body);
+            break;
+        case AST_FOR_STATEMENT:
+            // for sem condição não desvia
+            if (node->data.for_stmt.condition) add_point(numbering, node, PROFILE_BRANCH);
+            number_node(numbering, node->data.for_stmt.init);
+            number_node(numbering, node->data.for_stmt.condition);
+            number_node(numbering, node->data.for_stmt.update);
+            number_node(numbering, node->data.for_stmt.body);
+            break;
+        case AST_SWITCH_STATEMENT:
+            number_node(numbering, node->data.switch_stmt.expression);
+            number_node(numbering, node->data.switch_stmt.cases);
+            break;
+        case AST_RETURN_STATEMENT:
+            number_node(numbering, node->data.return_stmt.expression);
+            break;
+        default:
+            for (int i = 0; i < node->child_count; i++) {
+                number_node(numbering, node->children[i]);
+            }
+            break;
+    }
+}
+
+Profile* profile_create(ASTNode* program) {
+    Profile* profile = calloc(1, sizeof(Profile));
+
+    for (int i = 0; program && i < program->child_count; i++) {
+        ASTNode* function = program->children[i];
+        if (function->type != AST_FUNCTION_DECLARATION || !function->data.function_decl.body) continue;
+
+        Numbering numbering = { profile, function->data.function_decl.name, {0} };
+        add_point(&numbering, function, PROFILE_ENTRY);
+        number_node(&numbering, function->data.function_decl.body);
+    }
+    return profile;
+}
+
+void profile_destroy(Profile* profile) {
+    if (!profile) return;
+    for (int i = 0; i < profile->count; i++) {
+        free(profile->points[i].function);
+    }
+    free(profile->points);
+    free(profile);
+}
+
+// ============================================================
+// Arquivo de perfil
+// ============================================================
+
+const char* profile_kind_name(ProfileKind kind) {
+    return kind >= 0 && kind < PROFILE_KIND_COUNT ? kind_names[kind] : "?";
+}
+
+void profile_point_key(const ProfilePoint* point, char* buffer, size_t size) {
+    snprintf(buffer, size, "%s %s %d", point->function, profile_kind_name(point->kind), point->ordinal);
+}
+
+static ProfilePoint* find_point(Profile* profile, const char* function, const char* kind, int ordinal) {
+    for (int i = 0; i < profile->count; i++) {
+        ProfilePoint* point = &profile->points[i];
+        if (point->ordinal == ordinal && strcmp(kind_names[point->kind], kind) == 0 &&
+            strcmp(point->function, function) == 0) {
+            return point;
+        }
+    }
+    return NULL;
+}
+
+int profile_load(Profile* profile, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char function[256];
+        char kind[16];
+        int ordinal;
+        long counts[PROFILE_COUNTERS];
+        if (sscanf(line, "%255s %15s %d %ld %ld", function, kind, &ordinal, &counts[0], &counts[1]) != 5) {
+            continue;
+        }
+
+        // Contagem incoerente (mais verdadeiros que avaliações) não vale como dado
+        ProfilePoint* point = find_point(profile, function, kind, ordinal);
+        if (!point || point->known || counts[0] < 0 || counts[1] < 0 ||
+            (point->kind == PROFILE_BRANCH && counts[1] > counts[0])) {
+            profile->stale_lines++;
+            continue;
+        }
+        point->counts[0] = counts[0];
+        point->counts[1] = counts[1];
+        point->known = 1;
+        profile->matched_points++;
+        if (point->kind == PROFILE_CALL && counts[0] > profile->hottest_call) {
+            profile->hottest_call = counts[0];
+        }
+    }
+
+    fclose(file);
+    profile->use_path = path;
+    return 1;
+}
+
+// ============================================================
+// Consultas
+// ============================================================
+
+const ProfilePoint* profile_lookup(const Profile* profile, const ASTNode* node) {
+    if (!profile || !node || node->profile_point < 0 || node->profile_point >= profile->count) return NULL;
+    const ProfilePoint* point = &profile->points[node->profile_point];
+    return point->known ? point : NULL;
+}
+
+int profile_branch_bias(const Profile* profile, const ASTNode* node) {
+    const ProfilePoint* point = profile_lookup(profile, node);
+    if (!point || point->kind != PROFILE_BRANCH || point->counts[0] < PROFILE_MIN_EVALUATIONS) return 0;
+
+    long evaluations = point->counts[0];
+    long taken = point->counts[1];
+    if (taken * 100 >= evaluations * PROFILE_BIAS_PERCENT) return 1;
+    if ((evaluations - taken) * 100 >= evaluations * PROFILE_BIAS_PERCENT) return -1;
+    return 0;
+}
+
+int profile_never_executed(const Profile* profile, const ASTNode* node) {
+    const ProfilePoint* point = profile_lookup(profile, node);
+    return point && point->counts[0] == 0;
+}
+
+int profile_hot_call(const Profile* profile, const ASTNode* call) {
+    const ProfilePoint* point = profile_lookup(profile, call);
+    return point && point->kind == PROFILE_CALL && point->counts[0] >= PROFILE_MIN_EVALUATIONS &&
+           point->counts[0] * PROFILE_HOT_SHARE >= profile->hottest_call;
+}
+
+void profile_print_stats(const Profile* profile) {
+    if (!profile) return;
+
+    printf("\n=== PERFIL DE EXECUÇÃO ===\n");
+    printf("Pontos: %d (%d entradas de função, %d desvios, %d chamadas)\n", profile->count,
+           profile->kind_counts[PROFILE_ENTRY], profile->kind_counts[PROFILE_BRANCH],
+           profile->kind_counts[PROFILE_CALL]);
+    if (profile->generate_path) {
+        printf("Instrumentado: os contadores vão para %s ao fim da execução\n", profile->generate_path);
+    }
+    if (profile->use_path) {
+        printf("Perfil lido de %s: %d pontos reconhecidos, %d linhas sem ponto correspondente\n",
+               profile->use_path, profile->matched_points, profile->stale_lines);
+        printf("Desvios com dica de probabilidade: %d\n", profile->hinted_branches);
+        printf("Blocos frios fora da linha: %d\n", profile->cold_blocks);
+        printf("Funções frias: %d\n", profile->cold_functions);
+        printf("Inlining: %d chamadas quentes além do limite, %d chamadas não executadas mantidas\n",
+               profile->hot_inlines, profile->cold_calls);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+#include "ast.h"
+
+// ------------------------------------------------------------
+// Perfil de execução (-fprofile-generate / -fprofile-use)
+//
+// Os pontos medidos são a entrada de cada função, os desvios (condições
+// de if, while, do-while e for) e as chamadas. A chave de um ponto é o
+// nome da função, o tipo e a ordem entre os pontos desse tipo na função
+// ("main branch 2"): mexer em outra função, ou em comandos que não são
+// desvios nem chamadas, não muda as chaves dos demais. A numeração roda
+// depois da análise semântica e antes de -O; o índice fica em
+// ASTNode.profile_point, e as cópias feitas pelo otimizador herdam o
+// ponto do original.
+//
+// O programa instrumentado grava, ao terminar, uma linha por ponto:
+// "<função> <tipo> <ordem> <contador0> <contador1>". Entradas e chamadas
+// usam só o primeiro contador (execuções); os desvios contam as
+// avaliações da condição e quantas deram verdadeiro.
+// ------------------------------------------------------------
+
+#define PROFILE_DEFAULT_FILE "default.profile"
+#define PROFILE_COUNTERS 2            // Contadores por ponto
+#define PROFILE_MIN_EVALUATIONS 10    // Avaliações para confiar na tendência de um desvio
+#define PROFILE_BIAS_PERCENT 90       // Tendência a partir da qual o desvio ganha dica
+#define PROFILE_HOT_SHARE 10          // Chamada quente: pelo menos 1/10 da mais executada
+#define PROFILE_HOT_INLINE_FACTOR 4   // Limite de inlining multiplicado nas chamadas quentes
+
+typedef enum {
+    PROFILE_ENTRY,
+    PROFILE_BRANCH,
+    PROFILE_CALL,
+    PROFILE_KIND_COUNT
+} ProfileKind;
+
+typedef struct ProfilePoint {
+    char* function;
+    ProfileKind kind;
+    int ordinal;                      // Ordem entre os pontos do mesmo tipo na função
+    long counts[PROFILE_COUNTERS];
+    int known;                        // Lido do arquivo (-fprofile-use)
+} ProfilePoint;
+
+typedef struct Profile {
+    ProfilePoint* points;
+    int count;
+    int capacity;
+    int kind_counts[PROFILE_KIND_COUNT];
+
+    const char* generate_path;        // Arquivo gravado pelo programa instrumentado (NULL: sem instrumentação)
+    const char* use_path;             // Perfil lido (NULL: sem perfil)
+    int matched_points;
+    int stale_lines;                  // Linhas do arquivo sem ponto correspondente
+    long hottest_call;
+
+    // Decisões tomadas com o perfil (relatório -v)
+    int hinted_branches;
+    int cold_blocks;
+    int cold_functions;
+    int hot_inlines;
+    int cold_calls;
+} Profile;
+
+// Numera os pontos do programa (preenche profile_point nos nós)
+Profile* profile_create(ASTNode* program);
+void profile_destroy(Profile* profile);
+
+// Lê os contadores gravados por uma execução instrumentada; 0 se o
+// arquivo não abre. Pontos que o arquivo não menciona ficam desconhecidos.
+int profile_load(Profile* profile, const char* path);
+
+const char* profile_kind_name(ProfileKind kind);
+
+// Chave do ponto, a parte da linha do arquivo antes dos contadores
+void profile_point_key(const ProfilePoint* point, char* buffer, size_t size);
+
+// Consultas (-fprofile-use); sem dados, respondem como se não houvesse perfil
+const ProfilePoint* profile_lookup(const Profile* profile, const ASTNode* node);
+int profile_branch_bias(const Profile* profile, const ASTNode* node);  // 1: quase sempre verdadeiro; -1: quase sempre falso
+int profile_never_executed(const Profile* profile, const ASTNode* node);
+int profile_hot_call(const Profile* profile, const ASTNode* call);
+
+void profile_print_stats(const Profile* profile);
+
+#endif
@@ -0,0 +1,489 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "register_allocator.h"
+
+static const char* names_64[] = {"%rbx", "%r12", "%r13", "%r14", "%r15", "%r10", "%r11"};
+static const char* names_32[] = {"%ebx", "%r12d", "%r13d", "%r14d", "%r15d", "%r10d", "%r11d"};
+static const char* names_8[] = {"%bl", "%r12b", "%r13b", "%r14b", "%r15b", "%r10b", "%r11b"};
+
+#define MAX_WEIGHT_DEPTH 4     // Laços além disso não pesam mais (8^4 por referência)
+#define SPILL_SLOT_SIZE 8
+
+const char* register_name(int reg, DataType type) {
+    if (reg < 0 || reg >= REGISTER_COUNT) return "?";
+    return type == TYPE_POINTER ? names_64[reg] : names_32[reg];
+}
+
+const char* register_name_8(int reg) {
+    if (reg < 0 || reg >= REGISTER_COUNT) return "?";
+    return names_8[reg];
+}
+
+// ============================================================
+// Intervalos de vida
+// ============================================================
+
+typedef struct Positions {
+    int* items;            // Posições das referências, em ordem crescente
+    int count;
+    int capacity;
+} Positions;
+
+typedef struct LoopRange {
+    int start;
+    int end;
+} LoopRange;
+
+typedef struct IntervalBuilder {
+    LiveInterval* intervals;
+    Positions* uses;       // Paralelo a intervals
+    int count;
+    int capacity;
+
+    // Símbolo -> índice do intervalo (endereçamento aberto)
+    Symbol** keys;
+    int* values;
+    int table_capacity;
+
+    LoopRange* loops;
+    int loop_count;
+    int loop_capacity;
+    int* calls;            // Posições das chamadas, em ordem crescente
+    int call_count;
+    int call_capacity;
+
+    int position;
+    int depth;             // Laços abertos na posição atual
+} IntervalBuilder;
+
+static void* grow(void* items, int* capacity, int needed, size_t size) {
+    if (needed <= *capacity) return items;
+    while (*capacity < needed) *capacity = *capacity ? *capacity * 2 : 16;
+    return realloc(items, *capacity * size);
+}
+
+static unsigned int symbol_hash(const Symbol* symbol, int capacity) {
+    unsigned long value = (unsigned long)symbol;
+    value ^= value >> 17;
+    value *= 0x9E3779B1UL;
+    return (unsigned int)(value >> 7) & (capacity - 1);
+}
+
+static int find_slot(IntervalBuilder* b, const Symbol* symbol) {
+    unsigned int i = symbol_hash(symbol, b->table_capacity);
+    while (b->keys[i] && b->keys[i] != symbol) i = (i + 1) & (b->table_capacity - 1);
+    return (int)i;
+}
+
+static void grow_table(IntervalBuilder* b) {
+    Symbol** old_keys = b->keys;
+    int* old_values = b->values;
+    int old_capacity = b->table_capacity;
+
+    b->table_capacity = old_capacity ? old_capacity * 2 : 64;
+    b->keys = calloc(b->table_capacity, sizeof(Symbol*));
+    b->values = malloc(b->table_capacity * sizeof(int));
+    for (int i = 0; i < old_capacity; i++) {
+        if (!old_keys[i]) continue;
+        int slot = find_slot(b, old_keys[i]);
+        b->keys[slot] = old_keys[i];
+        b->values[slot] = old_values[i];
+    }
+    free(old_keys);
+    free(old_values);
+}
+
+static int is_local(const Symbol* symbol) {
+    return symbol && (symbol->kind == SYMBOL_VARIABLE || symbol->kind == SYMBOL_PARAMETER) &&
+           symbol->scope_level > 0;
+}
+
+static void reference(IntervalBuilder* b, Symbol* symbol) {
+    if (!is_local(symbol)) return;
+
+    if (2 * (b->count + 1) > b->table_capacity) grow_table(b);
+    int slot = find_slot(b, symbol);
+    if (!b->keys[slot]) {
+        b->intervals = grow(b->intervals, &b->capacity, b->count + 1, sizeof(LiveInterval));
+        b->uses = realloc(b->uses, b->capacity * sizeof(Positions));
+        LiveInterval* interval = &b->intervals[b->count];
+        interval->symbol = symbol;
+        interval->start = interval->end = b->position;
+        interval->crosses_call = 0;
+        interval->weight = 0;
+        interval->reg = NO_REGISTER;
+        memset(&b->uses[b->count], 0, sizeof(Positions));
+        b->keys[slot] = symbol;
+        b->values[slot] = b->count++;
+    }
+
+    int index = b->values[slot];
+    Positions* uses = &b->uses[index];
+    uses->items = grow(uses->items, &uses->capacity, uses->count + 1, sizeof(int));
+    uses->items[uses->count++] = b->position++;
+    b->intervals[index].weight += 1 << (3 * (b->depth < MAX_WEIGHT_DEPTH ? b->depth : MAX_WEIGHT_DEPTH));
+}
+
+static void open_loop(IntervalBuilder* b, int* start) {
+    *start = b->position++;
+    b->depth++;
+}
+
+static void close_loop(IntervalBuilder* b, int start) {
+    b->depth--;
+    b->loops = grow(b->loops, &b->loop_capacity, b->loop_count + 1, sizeof(LoopRange));
+    b->loops[b->loop_count].start = start;
+    b->loops[b->loop_count].end = b->position++;
+    b->loop_count++;
+}
+
+// Percorre a função na ordem de emissão do backend assembly
+static void walk(IntervalBuilder* b, ASTNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            reference(b, node->ref.symbol);
+            break;
+
+        case AST_VARIABLE_DECLARATION:
+            walk(b, node->data.var_decl.initializer);
+            reference(b, node->ref.symbol);
+            break;
+
+        case AST_BINARY_EXPRESSION: {
+            // A seleção de instruções pode ler um operando folha depois de
+            // calcular o outro lado: se ali houve chamada, ele a atravessa
+            int calls = b->call_count;
+            walk(b, node->data.binary_expr.left);
+            walk(b, node->data.binary_expr.right);
+            if (b->call_count == calls) break;
+            if (node->data.binary_expr.left->type == AST_IDENTIFIER) {
+                reference(b, node->data.binary_expr.left->ref.symbol);
+            }
+            if (node->data.binary_expr.right->type == AST_IDENTIFIER) {
+                reference(b, node->data.binary_expr.right->ref.symbol);
+            }
+            break;
+        }
+
+        case AST_ASSIGNMENT_EXPRESSION:
+            // O valor é calculado antes de ser gravado no alvo
+            walk(b, node->data.binary_expr.right);
+            walk(b, node->data.binary_expr.left);
+            break;
+
+        case AST_UNARY_EXPRESSION:
+            walk(b, node->data.unary_expr.operand);
+            break;
+
+        case AST_TERNARY_EXPRESSION:
+            walk(b, node->data.ternary_expr.condition);
+            walk(b, node->data.ternary_expr.true_expr);
+            walk(b, node->data.ternary_expr.false_expr);
+            break;
+
+        case AST_FUNCTION_CALL:
+            for (int i = 0; i < node->child_count; i++) {
+                walk(b, node->children[i]);
+            }
+            b->calls = grow(b->calls, &b->call_capacity, b->call_count + 1, sizeof(int));
+            b->calls[b->call_count++] = b->position++;
+            break;
+
+        case AST_IF_STATEMENT:
+            walk(b, node->data.if_stmt.condition);
+            walk(b, node->data.if_stmt.then_stmt);
+            walk(b, node->data.if_stmt.else_stmt);
+            break;
+
+        case AST_WHILE_STATEMENT: {
+            int start;
+            open_loop(b, &start);
+            walk(b, node->data.while_stmt.condition);
+            walk(b, node->data.while_stmt.body);
+            close_loop(b, start);
+            break;
+        }
+
+        case AST_DO_WHILE_STATEMENT: {
+            int start;
+            open_loop(b, &start);
+            walk(b, node->data.while_stmt.body);
+            walk(b, node->data.while_stmt.condition);
+            close_loop(b, start);
+            break;
+        }
+
+        case AST_FOR_STATEMENT: {
+            int start;
+            walk(b, node->data.for_stmt.init);
+            open_loop(b, &start);
+            walk(b, node->data.for_stmt.condition);
+            walk(b, node->data.for_stmt.body);
+            walk(b, node->data.for_stmt.update);
+            close_loop(b, start);
+            break;
+        }
+
+        case AST_SWITCH_STATEMENT:
+            walk(b, node->data.switch_stmt.expression);
+            walk(b, node->data.switch_stmt.cases);
+            break;
+
+        case AST_RETURN_STATEMENT:
+            walk(b, node->data.return_stmt.expression);
+            break;
+
+        default:
+            // Blocos, rótulos de case e comandos de expressão
+            for (int i = 0; i < node->child_count; i++) {
+                walk(b, node->children[i]);
+            }
+            break;
+    }
+}
+
+// Primeiro índice com items[i] >= value
+static int lower_bound(const int* items, int count, int value) {
+    int low = 0, high = count;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (items[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void finish_intervals(IntervalBuilder* b) {
+    for (int i = 0; i < b->count; i++) {
+        LiveInterval* interval = &b->intervals[i];
+        Positions* uses = &b->uses[i];
+        interval->start = uses->items[0];
+        interval->end = uses->items[uses->count - 1];
+
+        // Usada num laço em que já entra viva: o valor volta pela aresta
+        // de retorno, então fica viva no laço inteiro
+        for (int l = 0; l < b->loop_count; l++) {
+            const LoopRange* loop = &b->loops[l];
+            if (interval->start >= loop->start || loop->end <= interval->end) continue;
+            int first = lower_bound(uses->items, uses->count, loop->start);
+            if (first < uses->count && uses->items[first] <= loop->end) interval->end = loop->end;
+        }
+
+        int call = lower_bound(b->calls, b->call_count, interval->start);
+        interval->crosses_call = call < b->call_count && b->calls[call] < interval->end;
+    }
+}
+
+// ============================================================
+// Varredura linear
+// ============================================================
+
+static int is_register_candidate(const Symbol* symbol) {
+    return (symbol->type == TYPE_INT || symbol->type == TYPE_CHAR || symbol->type == TYPE_POINTER) &&
+           !symbol->info.variable.is_static;
+}
+
+// Escalares que podem dividir um slot de spill com outra local
+static int is_colorable(const Symbol* symbol) {
+    return (is_register_candidate(symbol) || symbol->type == TYPE_FLOAT) && !symbol->info.variable.is_static;
+}
+
+static int compare_starts(const void* a, const void* b) {
+    const LiveInterval* x = *(const LiveInterval* const*)a;
+    const LiveInterval* y = *(const LiveInterval* const*)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return x < y ? -1 : x > y;
+}
+
+static LiveInterval** sorted_by_start(LiveInterval* intervals, int count, int (*keep)(const LiveInterval*),
+                                      int* kept) {
+    LiveInterval** order = malloc((count > 0 ? count : 1) * sizeof(LiveInterval*));
+    *kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (keep(&intervals[i])) order[(*kept)++] = &intervals[i];
+    }
+    qsort(order, *kept, sizeof(LiveInterval*), compare_starts);
+    return order;
+}
+
+static int keeps_candidate(const LiveInterval* interval) {
+    return is_register_candidate(interval->symbol);
+}
+
+static int keeps_spilled(const LiveInterval* interval) {
+    return interval->reg == NO_REGISTER && is_colorable(interval->symbol);
+}
+
+// Quem perde o registrador: menos referências ponderadas e, no empate,
+// o intervalo que ainda vai mais longe
+static int lighter(const LiveInterval* a, const LiveInterval* b) {
+    return a->weight < b->weight || (a->weight == b->weight && a->end > b->end);
+}
+
+// Um registrador livre que sirva ao intervalo; sem chamadas no meio,
+// prefere os caller-saved (não custam salvamento no prólogo)
+static int pick_free(const int* in_use, const LiveInterval* interval) {
+    if (!interval->crosses_call) {
+        for (int r = CALLEE_SAVED_COUNT; r < REGISTER_COUNT; r++) {
+            if (!in_use[r]) return r;
+        }
+    }
+    for (int r = 0; r < CALLEE_SAVED_COUNT; r++) {
+        if (!in_use[r]) return r;
+    }
+    return NO_REGISTER;
+}
+
+static void linear_scan(LiveInterval* intervals, int count) {
+    int candidates;
+    LiveInterval** order = sorted_by_start(intervals, count, keeps_candidate, &candidates);
+    LiveInterval* active[REGISTER_COUNT];
+    int active_count = 0;
+    int in_use[REGISTER_COUNT] = {0};
+
+    for (int k = 0; k < candidates; k++) {
+        LiveInterval* current = order[k];
+
+        // Intervalos que já terminaram devolvem o registrador
+        for (int a = 0; a < active_count; a++) {
+            if (active[a]->end < current->start) {
+                in_use[active[a]->reg] = 0;
+                active[a--] = active[--active_count];
+            }
+        }
+
+        int reg = pick_free(in_use, current);
+        if (reg == NO_REGISTER) {
+            // Sem registrador livre: fica na memória a mais leve entre a
+            // atual e as ativas cujo registrador lhe serviria (no empate,
+            // a que vive mais)
+            int victim = -1;
+            for (int a = 0; a < active_count; a++) {
+                if (current->crosses_call && active[a]->reg >= CALLEE_SAVED_COUNT) continue;
+                if (victim < 0 || lighter(active[a], active[victim])) victim = a;
+            }
+            if (victim >= 0 && lighter(active[victim], current)) {
+                reg = active[victim]->reg;
+                active[victim]->reg = NO_REGISTER;
+                active[victim] = active[--active_count];
+            }
+        }
+
+        if (reg != NO_REGISTER) {
+            current->reg = reg;
+            in_use[reg] = 1;
+            active[active_count++] = current;
+        }
+    }
+    free(order);
+}
+
+// Locais na memória com intervalos disjuntos dividem o mesmo slot
+// (coloração gulosa na ordem de início, ótima para grafos de intervalos)
+static int color_spill_slots(LiveInterval* intervals, int count, int* slot_of) {
+    int spilled;
+    LiveInterval** order = sorted_by_start(intervals, count, keeps_spilled, &spilled);
+    int* slot_end = malloc((spilled > 0 ? spilled : 1) * sizeof(int));
+    int slots = 0;
+
+    for (int k = 0; k < spilled; k++) {
+        const LiveInterval* interval = order[k];
+        int slot = 0;
+        while (slot < slots && slot_end[slot] >= interval->start) slot++;
+        if (slot == slots) slots++;
+        slot_end[slot] = interval->end;
+        slot_of[interval - intervals] = slot;
+    }
+
+    free(slot_end);
+    free(order);
+    return slots;
+}
+
+// ============================================================
+// Entrada
+// ============================================================
+
+RegisterAllocation* register_allocation_create(ASTNode* function, TypeTable* types) {
+    IntervalBuilder builder = {0};
+
+    // Parâmetros chegam definidos na entrada
+    ASTNode* params = function->data.function_decl.parameters;
+    for (int i = 0; params && i < params->child_count; i++) {
+        reference(&builder, params->children[i]->ref.symbol);
+    }
+    walk(&builder, function->data.function_decl.body);
+    finish_intervals(&builder);
+
+    RegisterAllocation* allocation = calloc(1, sizeof(RegisterAllocation));
+    allocation->intervals = builder.intervals;
+    allocation->interval_count = builder.count;
+    linear_scan(allocation->intervals, allocation->interval_count);
+
+    int* slot_of = malloc((builder.count > 0 ? builder.count : 1) * sizeof(int));
+    allocation->spill_slots = color_spill_slots(allocation->intervals, allocation->interval_count, slot_of);
+
+    // Frame: salvamentos, depois locais fixas (arrays e estáticas), depois
+    // os slots de spill
+    int offset = 0;
+    int used[CALLEE_SAVED_COUNT] = {0};
+    for (int i = 0; i < allocation->interval_count; i++) {
+        int reg = allocation->intervals[i].reg;
+        if (reg != NO_REGISTER && reg < CALLEE_SAVED_COUNT) used[reg] = 1;
+    }
+    for (int r = 0; r < CALLEE_SAVED_COUNT; r++) {
+        if (!used[r]) continue;
+        offset += 8;
+        allocation->save_offsets[r] = -offset;
+    }
+
+    for (int i = 0; i < allocation->interval_count; i++) {
+        LiveInterval* interval = &allocation->intervals[i];
+        Symbol* symbol = interval->symbol;
+        symbol->info.variable.reg = interval->reg;
+        if (interval->reg != NO_REGISTER) {
+            allocation->in_registers++;
+        } else if (is_colorable(symbol)) {
+            allocation->memory_locals++;
+            if (is_register_candidate(symbol)) allocation->spilled++;
+        } else {
+            int size = type_size(types, symbol->type_id);
+            int align = type_alignment(types, symbol->type_id);
+            if (size <= 0) size = 1;
+            if (align <= 0) align = 1;
+            offset = (offset + size + align - 1) / align * align;
+            symbol->info.variable.offset = -offset;
+        }
+    }
+
+    int spill_base = (offset + SPILL_SLOT_SIZE - 1) / SPILL_SLOT_SIZE * SPILL_SLOT_SIZE;
+    for (int i = 0; i < allocation->interval_count; i++) {
+        LiveInterval* interval = &allocation->intervals[i];
+        if (!keeps_spilled(interval)) continue;
+        interval->symbol->info.variable.offset = -(spill_base + (slot_of[i] + 1) * SPILL_SLOT_SIZE);
+    }
+    allocation->frame_size = spill_base + allocation->spill_slots * SPILL_SLOT_SIZE;
+
+    for (int i = 0; i < builder.count; i++) {
+        free(builder.uses[i].items);
+    }
+    free(builder.uses);
+    free(builder.keys);
+    free(builder.values);
+    free(builder.loops);
+    free(builder.calls);
+    free(slot_of);
+    return allocation;
+}
+
+void register_allocation_destroy(RegisterAllocation* allocation) {
+    if (!allocation) return;
+    free(allocation->intervals);
+    free(allocation);
+}
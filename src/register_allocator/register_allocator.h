@@ -0,0 +1,67 @@
+#ifndef REGISTER_ALLOCATOR_H
+#define REGISTER_ALLOCATOR_H
+
+#include "ast.h"
+#include "symbol_table.h"
+
+// ------------------------------------------------------------
+// Alocação de registradores por varredura linear (Poletto e Sarkar)
+//
+// As posições seguem a ordem em que o backend assembly emite o código
+// da função. O intervalo de cada local vai da primeira à última
+// referência; se ela é usada num laço e já existia antes dele, o
+// intervalo cobre o laço inteiro (o valor atravessa a volta). Locais
+// int, char e ponteiro disputam os registradores; as que sobram, e os
+// floats, dividem slots de 8 bytes no frame quando os intervalos não se
+// sobrepõem (coloração dos slots de spill).
+// ------------------------------------------------------------
+
+// Registradores inteiros usados para locais. Os preservados pela função
+// chamada (callee-saved) servem a qualquer intervalo e são salvos no
+// prólogo; %r10 e %r11 (caller-saved) só a intervalos sem chamadas.
+// Os demais ficam com o gerador: %rax/%rcx/%rdx nas expressões e os de
+// argumento nas chamadas.
+typedef enum {
+    REG_RBX,
+    REG_R12,
+    REG_R13,
+    REG_R14,
+    REG_R15,
+    REG_R10,
+    REG_R11,
+    REGISTER_COUNT
+} Register;
+
+#define CALLEE_SAVED_COUNT 5   // REG_RBX..REG_R15
+#define NO_REGISTER -1
+
+typedef struct LiveInterval {
+    Symbol* symbol;
+    int start;             // Primeira posição em que a local está viva
+    int end;               // Última
+    int crosses_call;      // Alguma chamada acontece dentro do intervalo
+    int weight;            // Referências, 8x mais pesadas a cada nível de laço
+    int reg;               // Register ou NO_REGISTER
+} LiveInterval;
+
+typedef struct RegisterAllocation {
+    LiveInterval* intervals;
+    int interval_count;
+    int save_offsets[CALLEE_SAVED_COUNT];  // Onde o prólogo salva cada um (0: não usado)
+    int frame_size;        // Frame refeito: salvamentos, locais fixas e slots de spill
+    int in_registers;      // Locais que ficaram em registradores
+    int spilled;           // Candidatas a registrador que ficaram no frame
+    int memory_locals;     // Locais no frame (spills e floats)
+    int spill_slots;       // Slots que elas ocupam depois da coloração
+} RegisterAllocation;
+
+// Aloca as locais e parâmetros da função: preenche reg e offset dos
+// símbolos (info.variable) e o tamanho do novo frame
+RegisterAllocation* register_allocation_create(ASTNode* function, TypeTable* types);
+void register_allocation_destroy(RegisterAllocation* allocation);
+
+// Nome AT&T do registrador na largura do tipo (64 bits para ponteiros)
+const char* register_name(int reg, DataType type);
+const char* register_name_8(int reg);
+
+#endif
@@ -2,6 +2,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Preenche a assinatura completa de uma função (tipos, nomes e tipo canônico)
+static void set_function_signature(TypeTable* types, Symbol* symbol, TypeId return_id,
+                                   TypeId* param_types, char** param_names,
+                                   int param_count, int is_variadic) {
+    FunctionInfo* info = &symbol->info.function;
+    info->return_type_id = return_id;
+    info->parameter_types = param_types;
+    info->parameter_names = param_names;
+    info->parameter_count = param_count;
+    info->is_variadic = is_variadic;
+    info->signature = type_function(types, return_id, param_types, param_count, is_variadic);
+}
 
 SemanticAnalyzer* semantic_analyzer_create() {
     SemanticAnalyzer* analyzer = malloc(sizeof(SemanticAnalyzer));
@@ -9,32 +24,350 @@ SemanticAnalyzer* semantic_analyzer_create() {
     analyzer->has_error = 0;
     analyzer->error_message[0] = '\0';
     analyzer->current_function_return_type = TYPE_VOID;
+    analyzer->current_return_type_id = TYPE_ID_VOID;
     analyzer->in_loop = 0;
+    analyzer->in_switch = 0;
+    analyzer->local_count = 0;
+    analyzer->frame_size = 0;
+    analyzer->max_local_count = 0;
+    analyzer->max_frame_size = 0;
     analyzer->error_count = 0;
     analyzer->warning_count = 0;
-    
-    // Adicionar funções built-in
-    Symbol* printf_sym = symbol_create_function("printf", TYPE_INT, 0, 0);
-    symbol_table_insert(analyzer->symbol_table, printf_sym);
-    
-    Symbol* scanf_sym = symbol_create_function("scanf", TYPE_INT, 0, 0);
-    symbol_table_insert(analyzer->symbol_table, scanf_sym);
+    analyzer->decl_order = 0;
+    analyzer->thread_count = 0;
+    analyzer->diagnostics = NULL;
+    analyzer->diagnostic_count = 0;
+    analyzer->diagnostic_capacity = 0;
     
     return analyzer;
 }
 
+static void free_diagnostics(SemanticAnalyzer* analyzer) {
+    for (int i = 0; i < analyzer->diagnostic_count; i++) {
+        free(analyzer->diagnostics[i].message);
+    }
+    free(analyzer->diagnostics);
+    analyzer->diagnostics = NULL;
+    analyzer->diagnostic_count = 0;
+    analyzer->diagnostic_capacity = 0;
+}
+
 void semantic_analyzer_destroy(SemanticAnalyzer* analyzer) {
     if (analyzer) {
         symbol_table_destroy(analyzer->symbol_table);
+        free_diagnostics(analyzer);
         free(analyzer);
     }
 }
 
+static void append_diagnostic(SemanticAnalyzer* analyzer, SemanticDiagnostic diagnostic) {
+    if (analyzer->diagnostic_count >= analyzer->diagnostic_capacity) {
+        analyzer->diagnostic_capacity = analyzer->diagnostic_capacity == 0 ? 8 : analyzer->diagnostic_capacity * 2;
+        analyzer->diagnostics = realloc(analyzer->diagnostics,
+                                        analyzer->diagnostic_capacity * sizeof(SemanticDiagnostic));
+    }
+    analyzer->diagnostics[analyzer->diagnostic_count++] = diagnostic;
+}
+
+static void record_diagnostic(SemanticAnalyzer* analyzer, int is_error, const char* text,
+                              int line, int column) {
+    SemanticDiagnostic diagnostic;
+    diagnostic.is_error = is_error;
+    diagnostic.line = line;
+    diagnostic.column = column;
+    diagnostic.order = analyzer->decl_order;
+    diagnostic.message = strdup(text);
+    append_diagnostic(analyzer, diagnostic);
+}
+
 void semantic_error(SemanticAnalyzer* analyzer, const char* message, int line, int column) {
+    char text[512];
+    snprintf(text, sizeof(text), "Erro semântico na linha %d, coluna %d: %s", line, column, message);
+    
+    // error_message guarda o primeiro erro, o mais próximo do início do arquivo
+    if (!analyzer->has_error) {
+        snprintf(analyzer->error_message, sizeof(analyzer->error_message), "%s", text);
+    }
     analyzer->has_error = 1;
     analyzer->error_count++;
-    snprintf(analyzer->error_message, sizeof(analyzer->error_message),
-             "Erro semântico na linha %d, coluna %d: %s", line, column, message);
+    record_diagnostic(analyzer, 1, text, line, column);
+}
+
+// Anota o nó com o símbolo resolvido, o nível do escopo e o slot no frame
+static void annotate_symbol(ASTNode* node, Symbol* symbol) {
+    node->ref.symbol = symbol;
+    node->ref.depth = symbol->scope_level;
+    if (symbol->kind == SYMBOL_VARIABLE || symbol->kind == SYMBOL_PARAMETER) {
+        node->ref.slot = symbol->info.variable.slot;
+    } else {
+        node->ref.slot = -1;
+    }
+}
+
+// Built-ins ficam na tabela estática, somente leitura: o nó guarda a
+// referência const e ref.symbol continua NULL
+static void annotate_builtin(ASTNode* node, const Symbol* builtin) {
+    node->ref.builtin = builtin;
+    node->ref.depth = 0;
+    node->ref.slot = -1;
+}
+
+// Reserva um slot no frame da função atual, alinhado ao tipo. Os slots
+// são liberados ao fim do bloco e reaproveitados por blocos irmãos.
+static void allocate_local(SemanticAnalyzer* analyzer, Symbol* symbol) {
+    TypeTable* types = analyzer->symbol_table->types;
+    int size = type_size(types, symbol->type_id);
+    int align = type_alignment(types, symbol->type_id);
+    if (size <= 0) size = 1;
+    
+    analyzer->frame_size = (analyzer->frame_size + size + align - 1) / align * align;
+    symbol->info.variable.slot = analyzer->local_count++;
+    symbol->info.variable.offset = -analyzer->frame_size;
+    
+    if (analyzer->local_count > analyzer->max_local_count) {
+        analyzer->max_local_count = analyzer->local_count;
+    }
+    if (analyzer->frame_size > analyzer->max_frame_size) {
+        analyzer->max_frame_size = analyzer->frame_size;
+    }
+}
+
+// Atribui ao símbolo o tipo canônico e o DataType correspondente
+static void set_symbol_type(SemanticAnalyzer* analyzer, Symbol* symbol, TypeId id) {
+    symbol->type_id = id;
+    symbol->type = type_data_type(analyzer->symbol_table->types, id);
+}
+
+// Tipo canônico de um declarador: tipo base + nível de ponteiro (+ dimensão)
+static TypeId declarator_type(SemanticAnalyzer* analyzer, DataType base, int pointer_level,
+                              ASTNode* array_size) {
+    TypeTable* types = analyzer->symbol_table->types;
+    TypeId id = type_pointer_to_level(types, type_primitive(base), pointer_level);
+    if (array_size) {
+        id = type_array(types, id, atoi(array_size->data.literal.value));
+    }
+    return id;
+}
+
+// Literal 0 pode ser atribuído a qualquer ponteiro
+static int is_null_pointer_constant(ASTNode* expr) {
+    return expr->type == AST_NUMBER_LITERAL && expr->data.literal.value &&
+           strcmp(expr->data.literal.value, "0") == 0;
+}
+
+// Registra uma escrita em uma variável: rejeita const e marca locais
+// modificados (globais são compartilhados entre os workers e não são marcados)
+static void check_modifiable(SemanticAnalyzer* analyzer, ASTNode* target) {
+    Symbol* symbol = target->type == AST_IDENTIFIER ? target->ref.symbol : NULL;
+    if (!symbol || (symbol->kind != SYMBOL_VARIABLE && symbol->kind != SYMBOL_PARAMETER)) return;
+    
+    if (symbol->info.variable.is_const) {
+        semantic_error(analyzer, "Atribuição a variável const", target->line, target->column);
+    }
+    if (symbol->scope_level > 0) {
+        symbol->info.variable.is_modified = 1;
+    }
+}
+
+static int is_assignable(SemanticAnalyzer* analyzer, TypeId target, ASTNode* source) {
+    if (!source) return 0;
+    TypeTable* types = analyzer->symbol_table->types;
+    TypeId source_type = source->type_id;
+    if (type_compatible(types, target, source_type)) return 1;
+    
+    const TypeInfo* info = type_info(types, target);
+    return info && info->kind == TYPEKIND_POINTER && is_null_pointer_constant(source);
+}
+
+// Analisa um operando e devolve o seu tipo. Operando ausente (erro
+// sintático) vale void, como uma expressão sem valor.
+static TypeId analyze_operand(SemanticAnalyzer* analyzer, ASTNode* operand) {
+    if (!operand) return TYPE_ID_VOID;
+    analyze_expression(analyzer, operand);
+    return operand->type_id;
+}
+
+// Confere os argumentos contra a assinatura: um passo por argumento
+static void check_call_arguments(SemanticAnalyzer* analyzer, ASTNode* call, const FunctionInfo* info) {
+    int argc = call->child_count;
+    char message[256];
+    
+    if (argc < info->parameter_count || (!info->is_variadic && argc > info->parameter_count)) {
+        snprintf(message, sizeof(message),
+                 "Número de argumentos incorreto na chamada de '%s' (esperado %s%d, recebido %d)",
+                 call->data.function_call.name, info->is_variadic ? "ao menos " : "",
+                 info->parameter_count, argc);
+        semantic_error(analyzer, message, call->line, call->column);
+    }
+    
+    for (int i = 0; i < argc; i++) {
+        ASTNode* arg = call->children[i];
+        analyze_expression(analyzer, arg);
+        if (arg->type_id == TYPE_ID_INVALID) continue;
+        
+        if (i < info->parameter_count) {
+            if (!is_assignable(analyzer, info->parameter_types[i], arg)) {
+                snprintf(message, sizeof(message),
+                         "Tipo incompatível no argumento %d da chamada de '%s'",
+                         i + 1, call->data.function_call.name);
+                semantic_error(analyzer, message, arg->line, arg->column);
+            }
+        } else if (arg->type_id == TYPE_ID_VOID) {
+            semantic_error(analyzer, "Argumento void em chamada variádica", arg->line, arg->column);
+        }
+    }
+}
+
+static Symbol* declare_function(SemanticAnalyzer* analyzer, ASTNode* decl);
+static void analyze_function_body(SemanticAnalyzer* analyzer, ASTNode* decl, Symbol* function_symbol);
+
+// ------------------------------------------------------------
+// Análise paralela dos corpos de função
+//
+// Uma passada serial preenche o escopo global (variáveis globais e
+// assinaturas); em seguida cada corpo de função é analisado por um worker
+// com seu próprio analisador: visão da tabela de símbolos (pilha de escopos
+// sobre o escopo global, somente leitura) e lista de diagnósticos. Ao final
+// os resultados são juntados na ordem do código-fonte.
+// ------------------------------------------------------------
+
+typedef struct FunctionTask {
+    ASTNode* decl;
+    Symbol* symbol;
+    SemanticAnalyzer worker;
+} FunctionTask;
+
+typedef struct TaskQueue {
+    FunctionTask* tasks;
+    int count;
+    int next;  // Próxima tarefa livre (incrementado atomicamente)
+} TaskQueue;
+
+static void worker_init(SemanticAnalyzer* worker, SemanticAnalyzer* parent, int decl_order) {
+    memset(worker, 0, sizeof(*worker));
+    worker->symbol_table = symbol_table_create_view(parent->symbol_table);
+    worker->current_function_return_type = TYPE_VOID;
+    worker->current_return_type_id = TYPE_ID_VOID;
+    worker->decl_order = decl_order;
+    worker->thread_count = 1;
+}
+
+static void* analysis_worker(void* arg) {
+    TaskQueue* queue = arg;
+    
+    for (;;) {
+        int index = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+        if (index >= queue->count) break;
+        
+        FunctionTask* task = &queue->tasks[index];
+        analyze_function_body(&task->worker, task->decl, task->symbol);
+    }
+    return NULL;
+}
+
+static int resolve_thread_count(SemanticAnalyzer* analyzer, int task_count) {
+    int threads = analyzer->thread_count;
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cores > 0 ? (int)cores : 1;
+    }
+    return threads < task_count ? threads : task_count;
+}
+
+static void run_function_tasks(SemanticAnalyzer* analyzer, TaskQueue* queue) {
+    int threads = resolve_thread_count(analyzer, queue->count);
+    
+    if (threads <= 1) {
+        analysis_worker(queue);
+        return;
+    }
+    
+    // A thread atual também consome tarefas
+    pthread_t* pool = malloc((threads - 1) * sizeof(pthread_t));
+    int started = 0;
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool[started], NULL, analysis_worker, queue) == 0) {
+            started++;
+        }
+    }
+    analysis_worker(queue);
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+}
+
+// Junta os diagnósticos da passada global com os dos workers, em ordem de declaração
+static void merge_diagnostics(SemanticAnalyzer* analyzer, TaskQueue* queue) {
+    SemanticAnalyzer merged;
+    memset(&merged, 0, sizeof(merged));
+    
+    int global_index = 0;
+    for (int t = 0; t < queue->count; t++) {
+        SemanticAnalyzer* worker = &queue->tasks[t].worker;
+        while (global_index < analyzer->diagnostic_count &&
+               analyzer->diagnostics[global_index].order <= worker->decl_order) {
+            append_diagnostic(&merged, analyzer->diagnostics[global_index++]);
+        }
+        for (int i = 0; i < worker->diagnostic_count; i++) {
+            append_diagnostic(&merged, worker->diagnostics[i]);
+        }
+        analyzer->error_count += worker->error_count;
+        analyzer->warning_count += worker->warning_count;
+        free(worker->diagnostics);
+    }
+    while (global_index < analyzer->diagnostic_count) {
+        append_diagnostic(&merged, analyzer->diagnostics[global_index++]);
+    }
+    
+    free(analyzer->diagnostics);
+    analyzer->diagnostics = merged.diagnostics;
+    analyzer->diagnostic_count = merged.diagnostic_count;
+    analyzer->diagnostic_capacity = merged.diagnostic_capacity;
+    
+    for (int i = 0; i < analyzer->diagnostic_count; i++) {
+        if (analyzer->diagnostics[i].is_error) {
+            analyzer->has_error = 1;
+            snprintf(analyzer->error_message, sizeof(analyzer->error_message), "%s",
+                     analyzer->diagnostics[i].message);
+            break;
+        }
+    }
+}
+
+static void analyze_program(SemanticAnalyzer* analyzer, ASTNode* program) {
+    TaskQueue queue;
+    queue.tasks = malloc((program->child_count > 0 ? program->child_count : 1) * sizeof(FunctionTask));
+    queue.count = 0;
+    queue.next = 0;
+    
+    // Passada global (serial): variáveis globais e assinaturas de funções
+    for (int i = 0; i < program->child_count; i++) {
+        ASTNode* decl = program->children[i];
+        analyzer->decl_order = i;
+        
+        if (decl->type != AST_FUNCTION_DECLARATION) {
+            analyze_declaration(analyzer, decl);
+            continue;
+        }
+        
+        Symbol* symbol = declare_function(analyzer, decl);
+        if (symbol && decl->data.function_decl.body) {
+            FunctionTask* task = &queue.tasks[queue.count++];
+            task->decl = decl;
+            task->symbol = symbol;
+            worker_init(&task->worker, analyzer, i);
+        }
+    }
+    
+    // Corpos de função em paralelo
+    run_function_tasks(analyzer, &queue);
+    
+    for (int t = 0; t < queue.count; t++) {
+        symbol_table_merge_view(analyzer->symbol_table, queue.tasks[t].worker.symbol_table);
+    }
+    merge_diagnostics(analyzer, &queue);
+    free(queue.tasks);
 }
 
 int semantic_analyze(SemanticAnalyzer* analyzer, ASTNode* ast) {
@@ -42,10 +375,7 @@ int semantic_analyze(SemanticAnalyzer* analyzer, ASTNode* ast) {
     
     switch (ast->type) {
         case AST_PROGRAM:
-            for (int i = 0; i < ast->child_count; i++) {
-                analyze_declaration(analyzer, ast->children[i]);
-                if (analyzer->has_error) return 0;
-            }
+            analyze_program(analyzer, ast);
             break;
             
         case AST_FUNCTION_DECLARATION:
@@ -61,55 +391,168 @@ int semantic_analyze(SemanticAnalyzer* analyzer, ASTNode* ast) {
             break;
     }
     
+    // Avisos são exibidos já na ordem do código-fonte
+    for (int i = 0; i < analyzer->diagnostic_count; i++) {
+        if (!analyzer->diagnostics[i].is_error) {
+            printf("%s\n", analyzer->diagnostics[i].message);
+        }
+    }
+    
     return !analyzer->has_error;
 }
 
+// Insere a função no escopo global com sua assinatura canônica
+static Symbol* declare_function(SemanticAnalyzer* analyzer, ASTNode* decl) {
+    const char* name = decl->data.function_decl.name;
+    TypeTable* types = analyzer->symbol_table->types;
+    TypeId return_id = declarator_type(analyzer, decl->data.function_decl.return_type,
+                                       decl->data.function_decl.pointer_level, NULL);
+    DataType return_type = type_data_type(types, return_id);
+    
+    // Verificar se função já foi declarada (inclusive como built-in)
+    if (symbol_lookup_builtin(name)) {
+        semantic_error(analyzer, "Função já declarada", decl->line, decl->column);
+        return NULL;
+    }
+    Symbol* function_symbol = symbol_create_function(name, return_type, decl->line, decl->column);
+    if (!symbol_table_insert(analyzer->symbol_table, function_symbol)) {
+        semantic_error(analyzer, "Função já declarada", decl->line, decl->column);
+        free(function_symbol->name);
+        free(function_symbol);
+        return NULL;
+    }
+    function_symbol->decl_order = analyzer->decl_order;
+    function_symbol->info.function.is_defined = decl->data.function_decl.body != NULL;
+    annotate_symbol(decl, function_symbol);
+    decl->data_type = return_type;
+    decl->type_id = return_id;
+    
+    // Assinatura: tipos canônicos e nomes dos parâmetros
+    ASTNode* params = decl->data.function_decl.parameters;
+    int param_count = params ? params->child_count : 0;
+    TypeId* param_types = param_count > 0 ? malloc(param_count * sizeof(TypeId)) : NULL;
+    char** param_names = param_count > 0 ? malloc(param_count * sizeof(char*)) : NULL;
+    for (int i = 0; i < param_count; i++) {
+        ASTNode* param = params->children[i];
+        param_types[i] = declarator_type(analyzer, param->data.parameter.param_type,
+                                         param->data.parameter.pointer_level, NULL);
+        param_names[i] = param->data.parameter.name ? strdup(param->data.parameter.name) : NULL;
+        param->type_id = param_types[i];
+    }
+    set_function_signature(types, function_symbol, return_id, param_types, param_names,
+                           param_count, decl->data.function_decl.is_variadic);
+    
+    return function_symbol;
+}
+
+// Analisa parâmetros e corpo em um escopo próprio; só lê o escopo global
+static void analyze_function_body(SemanticAnalyzer* analyzer, ASTNode* decl, Symbol* function_symbol) {
+    ASTNode* params = decl->data.function_decl.parameters;
+    int param_count = params ? params->child_count : 0;
+    
+    // Criar novo escopo para a função
+    symbol_table_enter_scope(analyzer->symbol_table, function_symbol->name);
+    analyzer->current_function_return_type = function_symbol->type;
+    analyzer->current_return_type_id = decl->type_id;
+    analyzer->local_count = 0;
+    analyzer->frame_size = 0;
+    analyzer->max_local_count = 0;
+    analyzer->max_frame_size = 0;
+    
+    // Parâmetros ocupam os primeiros slots do frame
+    for (int i = 0; i < param_count; i++) {
+        ASTNode* param = params->children[i];
+        if (param->type_id == TYPE_ID_VOID) {
+            semantic_error(analyzer, "Parâmetro não pode ter tipo void", param->line, param->column);
+            continue;
+        }
+        Symbol* param_symbol = symbol_create_variable(param->data.parameter.name,
+                                                      param->data.parameter.param_type,
+                                                      param->line, param->column);
+        set_symbol_type(analyzer, param_symbol, param->type_id);
+        param_symbol->kind = SYMBOL_PARAMETER;
+        param_symbol->info.variable.is_initialized = 1;
+        if (!symbol_table_insert(analyzer->symbol_table, param_symbol)) {
+            semantic_error(analyzer, "Parâmetro já declarado", param->line, param->column);
+            free(param_symbol->name);
+            free(param_symbol);
+            continue;
+        }
+        allocate_local(analyzer, param_symbol);
+        annotate_symbol(param, param_symbol);
+        param->data_type = param_symbol->type;
+    }
+    
+    // Analisar corpo da função
+    if (decl->data.function_decl.body) {
+        analyze_statement(analyzer, decl->data.function_decl.body);
+    }
+    
+    decl->data.function_decl.local_count = analyzer->max_local_count;
+    decl->data.function_decl.frame_size = analyzer->max_frame_size;
+    
+    // Restaurar escopo anterior
+    symbol_table_exit_scope(analyzer->symbol_table);
+}
+
 void analyze_declaration(SemanticAnalyzer* analyzer, ASTNode* decl) {
     switch (decl->type) {
         case AST_FUNCTION_DECLARATION: {
-            const char* name = decl->data.function_decl.name;
-            DataType return_type = decl->data.function_decl.return_type;
-            
-            // Verificar se função já foi declarada
-            Symbol* function_symbol = symbol_create_function(name, return_type, decl->line, decl->column);
-            if (!symbol_table_insert(analyzer->symbol_table, function_symbol)) {
-                semantic_error(analyzer, "Função já declarada", decl->line, decl->column);
-                free(function_symbol->name);
-                free(function_symbol);
-                return;
+            Symbol* function_symbol = declare_function(analyzer, decl);
+            if (function_symbol) {
+                analyze_function_body(analyzer, decl, function_symbol);
             }
-            
-            // Criar novo escopo para a função
-            symbol_table_enter_scope(analyzer->symbol_table, name);
-            analyzer->current_function_return_type = return_type;
-            
-            // Analisar corpo da função
-            if (decl->data.function_decl.body) {
-                analyze_statement(analyzer, decl->data.function_decl.body);
-            }
-            
-            // Restaurar escopo anterior
-            symbol_table_exit_scope(analyzer->symbol_table);
             break;
         }
         
         case AST_VARIABLE_DECLARATION: {
             const char* name = decl->data.var_decl.name;
-            DataType type = decl->data.var_decl.var_type;
+            TypeId type_id = declarator_type(analyzer, decl->data.var_decl.var_type,
+                                             decl->data.var_decl.pointer_level,
+                                             decl->data.var_decl.array_size);
+            DataType type = type_data_type(analyzer->symbol_table->types, type_id);
+            
+            if (type_id == TYPE_ID_VOID) {
+                semantic_error(analyzer, "Variável não pode ter tipo void", decl->line, decl->column);
+                return;
+            }
+            if (decl->data.var_decl.array_size &&
+                type_size(analyzer->symbol_table->types, type_id) <= 0) {
+                semantic_error(analyzer, "Tamanho de array inválido", decl->line, decl->column);
+                return;
+            }
             
             // Verificar se variável já foi declarada no escopo atual
-            Symbol* var_symbol = symbol_create_variable(name, type, decl->line, decl->column);
+            Symbol* var_symbol = symbol_create_variable(name, decl->data.var_decl.var_type,
+                                                        decl->line, decl->column);
+            set_symbol_type(analyzer, var_symbol, type_id);
             if (!symbol_table_insert(analyzer->symbol_table, var_symbol)) {
                 semantic_error(analyzer, "Variável já declarada", decl->line, decl->column);
                 free(var_symbol->name);
                 free(var_symbol);
                 return;
             }
+            if (analyzer->symbol_table->current_level == 0) {
+                var_symbol->decl_order = analyzer->decl_order;
+            }
+            var_symbol->info.variable.is_initialized = decl->data.var_decl.initializer != NULL;
+            var_symbol->info.variable.is_const = (decl->data.var_decl.modifiers & MOD_CONST) != 0;
+            if (analyzer->symbol_table->current_level > 0) {
+                allocate_local(analyzer, var_symbol);
+            }
+            annotate_symbol(decl, var_symbol);
+            decl->data_type = type;
+            decl->type_id = type_id;
             
             // Analisar inicializador se existir
-            if (decl->data.var_decl.initializer) {
-                DataType init_type = analyze_expression(analyzer, decl->data.var_decl.initializer);
-                if (!check_type_compatibility(type, init_type) && init_type != TYPE_VOID) {
+            ASTNode* initializer = decl->data.var_decl.initializer;
+            if (initializer) {
+                analyze_expression(analyzer, initializer);
+                if (type == TYPE_ARRAY) {
+                    semantic_error(analyzer, "Array não pode ser inicializado por expressão",
+                                 decl->line, decl->column);
+                } else if (initializer->type_id != TYPE_ID_INVALID &&
+                           !is_assignable(analyzer, type_id, initializer)) {
                     semantic_error(analyzer, "Tipo incompatível na inicialização", 
                                  decl->line, decl->column);
                 }
@@ -123,6 +566,65 @@ void analyze_declaration(SemanticAnalyzer* analyzer, ASTNode* decl) {
     }
 }
 
+// Switch: expressão inteira, rótulos constantes e distintos, no máximo um
+// default. O corpo é um único escopo; break sai do switch.
+static void analyze_switch(SemanticAnalyzer* analyzer, ASTNode* stmt) {
+    ASTNode* expression = stmt->data.switch_stmt.expression;
+    ASTNode* cases = stmt->data.switch_stmt.cases;
+    TypeId expression_type = analyze_operand(analyzer, expression);
+    
+    if (expression_type != TYPE_ID_INT && expression_type != TYPE_ID_CHAR &&
+        expression_type != TYPE_ID_INVALID) {
+        semantic_error(analyzer, "Expressão do switch deve ser inteira", stmt->line, stmt->column);
+    }
+    
+    long* values = malloc((cases->child_count + 1) * sizeof(long));
+    int value_count = 0;
+    int default_count = 0;
+    
+    symbol_table_enter_scope(analyzer->symbol_table, "switch");
+    int saved_local_count = analyzer->local_count;
+    int saved_frame_size = analyzer->frame_size;
+    analyzer->in_switch++;
+    
+    for (int i = 0; i < cases->child_count; i++) {
+        ASTNode* label = cases->children[i];
+        
+        if (label->type == AST_DEFAULT_STATEMENT) {
+            if (++default_count > 1) {
+                semantic_error(analyzer, "Mais de um 'default' no switch", label->line, label->column);
+            }
+        } else {
+            long value;
+            analyze_expression(analyzer, label->data.case_stmt.value);
+            if (!ast_constant_expression(label->data.case_stmt.value, &value)) {
+                semantic_error(analyzer, "Rótulo de 'case' deve ser uma constante inteira",
+                               label->line, label->column);
+            } else {
+                for (int j = 0; j < value_count; j++) {
+                    if (values[j] == value) {
+                        char message[128];
+                        snprintf(message, sizeof(message), "Valor de 'case' duplicado: %ld", value);
+                        semantic_error(analyzer, message, label->line, label->column);
+                        break;
+                    }
+                }
+                values[value_count++] = value;
+            }
+        }
+        
+        for (int j = 0; j < label->child_count; j++) {
+            analyze_statement(analyzer, label->children[j]);
+        }
+    }
+    
+    analyzer->in_switch--;
+    symbol_table_exit_scope(analyzer->symbol_table);
+    analyzer->local_count = saved_local_count;
+    analyzer->frame_size = saved_frame_size;
+    free(values);
+}
+
 void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
     if (!stmt) return;
     
@@ -130,14 +632,18 @@ void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
         case AST_COMPOUND_STATEMENT: {
             // Criar novo escopo para bloco
             symbol_table_enter_scope(analyzer->symbol_table, "block");
+            int saved_local_count = analyzer->local_count;
+            int saved_frame_size = analyzer->frame_size;
             
             for (int i = 0; i < stmt->child_count; i++) {
                 analyze_statement(analyzer, stmt->children[i]);
                 if (analyzer->has_error) break;
             }
             
-            // Restaurar escopo anterior
+            // Restaurar escopo anterior; os slots do bloco ficam livres
             symbol_table_exit_scope(analyzer->symbol_table);
+            analyzer->local_count = saved_local_count;
+            analyzer->frame_size = saved_frame_size;
             break;
         }
             
@@ -148,10 +654,8 @@ void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
             break;
             
         case AST_IF_STATEMENT: {
-            DataType cond_type = analyze_expression(analyzer, stmt->data.if_stmt.condition);
-            
-            // Condições válidas: qualquer tipo numérico (int, float, char)
-            if (cond_type == TYPE_VOID) {
+            // Condições válidas: qualquer tipo escalar (numérico ou ponteiro)
+            if (analyze_operand(analyzer, stmt->data.if_stmt.condition) == TYPE_ID_VOID) {
                 semantic_error(analyzer, "Condição inválida em if", stmt->line, stmt->column);
             }
             // Aceitar int, float, char como condições válidas
@@ -165,10 +669,8 @@ void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
         
         case AST_WHILE_STATEMENT: {
             analyzer->in_loop++;
-            DataType cond_type = analyze_expression(analyzer, stmt->data.while_stmt.condition);
-            
-            // Condições válidas: qualquer tipo numérico
-            if (cond_type == TYPE_VOID) {
+            // Condições válidas: qualquer tipo escalar
+            if (analyze_operand(analyzer, stmt->data.while_stmt.condition) == TYPE_ID_VOID) {
                 semantic_error(analyzer, "Condição inválida em while", stmt->line, stmt->column);
             }
             
@@ -177,13 +679,60 @@ void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
             break;
         }
         
+        case AST_DO_WHILE_STATEMENT: {
+            analyzer->in_loop++;
+            analyze_statement(analyzer, stmt->data.while_stmt.body);
+            if (analyze_operand(analyzer, stmt->data.while_stmt.condition) == TYPE_ID_VOID) {
+                semantic_error(analyzer, "Condição inválida em do-while", stmt->line, stmt->column);
+            }
+            analyzer->in_loop--;
+            break;
+        }
+        
+        case AST_FOR_STATEMENT: {
+            // A declaração da inicialização vale só para o laço
+            symbol_table_enter_scope(analyzer->symbol_table, "for");
+            int saved_local_count = analyzer->local_count;
+            int saved_frame_size = analyzer->frame_size;
+            
+            analyze_statement(analyzer, stmt->data.for_stmt.init);
+            if (stmt->data.for_stmt.condition) {
+                analyze_expression(analyzer, stmt->data.for_stmt.condition);
+                if (stmt->data.for_stmt.condition->type_id == TYPE_ID_VOID) {
+                    semantic_error(analyzer, "Condição inválida em for", stmt->line, stmt->column);
+                }
+            }
+            if (stmt->data.for_stmt.update) {
+                analyze_expression(analyzer, stmt->data.for_stmt.update);
+            }
+            
+            analyzer->in_loop++;
+            analyze_statement(analyzer, stmt->data.for_stmt.body);
+            analyzer->in_loop--;
+            
+            symbol_table_exit_scope(analyzer->symbol_table);
+            analyzer->local_count = saved_local_count;
+            analyzer->frame_size = saved_frame_size;
+            break;
+        }
+        
+        case AST_SWITCH_STATEMENT:
+            analyze_switch(analyzer, stmt);
+            break;
+        
         case AST_RETURN_STATEMENT: {
-            DataType return_type = TYPE_VOID;
-            if (stmt->data.return_stmt.expression) {
-                return_type = analyze_expression(analyzer, stmt->data.return_stmt.expression);
+            ASTNode* expression = stmt->data.return_stmt.expression;
+            TypeId expected = analyzer->current_return_type_id;
+            int compatible;
+            if (expression) {
+                analyze_expression(analyzer, expression);
+                compatible = expression->type_id == TYPE_ID_INVALID ||
+                             is_assignable(analyzer, expected, expression);
+            } else {
+                compatible = expected == TYPE_ID_VOID;
             }
             
-            if (!check_type_compatibility(return_type, analyzer->current_function_return_type)) {
+            if (!compatible) {
                 semantic_error(analyzer, "Tipo de retorno incompatível", 
                              stmt->line, stmt->column);
             }
@@ -191,8 +740,8 @@ void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
         }
 
         case AST_BREAK_STATEMENT:
-            if (analyzer->in_loop <= 0) {
-                semantic_error(analyzer, "Comando 'break' fora de um loop", stmt->line, stmt->column);
+            if (analyzer->in_loop <= 0 && analyzer->in_switch <= 0) {
+                semantic_error(analyzer, "Comando 'break' fora de um loop ou switch", stmt->line, stmt->column);
             }
             break;
         
@@ -212,77 +761,173 @@ void analyze_statement(SemanticAnalyzer* analyzer, ASTNode* stmt) {
     }
 }
 
+static TypeId compute_expression_type(SemanticAnalyzer* analyzer, ASTNode* expr);
+
+// Calcula o tipo da expressão e o grava no nó para as fases seguintes.
+// Expressões com erro recebem TYPE_ID_INVALID (e DataType void).
 DataType analyze_expression(SemanticAnalyzer* analyzer, ASTNode* expr) {
     if (!expr) return TYPE_VOID;
     
+    TypeId id = compute_expression_type(analyzer, expr);
+    expr->type_id = id;
+    expr->data_type = type_data_type(analyzer->symbol_table->types, id);
+    return expr->data_type;
+}
+
+static TypeId compute_expression_type(SemanticAnalyzer* analyzer, ASTNode* expr) {
+    TypeTable* types = analyzer->symbol_table->types;
+    
     switch (expr->type) {
         case AST_IDENTIFIER: {
             Symbol* symbol = symbol_table_lookup(analyzer->symbol_table, 
                                                expr->data.identifier.name);
-            if (!symbol) {
+            const Symbol* target = symbol ? symbol : symbol_lookup_builtin(expr->data.identifier.name);
+            // Globais só são visíveis após sua declaração (a passada global
+            // já inseriu todas antes da análise dos corpos de função)
+            if (!target || (target->kind == SYMBOL_VARIABLE && target->scope_level == 0 &&
+                            target->decl_order > analyzer->decl_order)) {
                 semantic_error(analyzer, "Identificador não declarado", 
                              expr->line, expr->column);
-                return TYPE_VOID;
+                return TYPE_ID_INVALID;
+            }
+            if (symbol) {
+                annotate_symbol(expr, symbol);
+            } else {
+                annotate_builtin(expr, target);
             }
-            return symbol->type;
+            return target->type_id;
         }
         
         case AST_NUMBER_LITERAL: {
             // Verificar se tem ponto decimal na string
             if (expr->data.literal.value && strchr(expr->data.literal.value, '.')) {
-                return TYPE_FLOAT;
+                return TYPE_ID_FLOAT;
             }
-            return TYPE_INT;
+            return TYPE_ID_INT;
         }
         
         case AST_FLOAT_LITERAL:
-            return TYPE_FLOAT;
+            return TYPE_ID_FLOAT;
             
         case AST_STRING_LITERAL:
-            return TYPE_CHAR; // Simplificado: string como char*
+            return type_pointer(types, TYPE_ID_CHAR);
             
         case AST_CHAR_LITERAL:
-            return TYPE_CHAR;
+            return TYPE_ID_CHAR;
             
         case AST_BINARY_EXPRESSION: {
-            DataType left_type = analyze_expression(analyzer, expr->data.binary_expr.left);
-            DataType right_type = analyze_expression(analyzer, expr->data.binary_expr.right);
+            TypeId left_type = analyze_operand(analyzer, expr->data.binary_expr.left);
+            TypeId right_type = analyze_operand(analyzer, expr->data.binary_expr.right);
             
-            // Se algum dos operandos é void, há erro anterior
-            if (left_type == TYPE_VOID || right_type == TYPE_VOID) {
-                return TYPE_VOID;
+            // Operando inválido: o erro já foi reportado
+            if (left_type == TYPE_ID_INVALID || right_type == TYPE_ID_INVALID) {
+                return TYPE_ID_INVALID;
             }
             
             TokenType op = expr->data.binary_expr.operator;
-            return get_binary_operation_result_type(left_type, right_type, op);
+            TypeId result = type_binary_result(types, left_type, right_type, op);
+            
+            // Ponteiro comparado com a constante nula
+            if (result == TYPE_ID_INVALID && (op == TOKEN_EQUAL || op == TOKEN_NOT_EQUAL) &&
+                (is_assignable(analyzer, left_type, expr->data.binary_expr.right) ||
+                 is_assignable(analyzer, right_type, expr->data.binary_expr.left))) {
+                result = TYPE_ID_INT;
+            }
+            if (result == TYPE_ID_INVALID) {
+                semantic_error(analyzer, "Operandos inválidos para o operador binário",
+                             expr->line, expr->column);
+            }
+            return result;
         }
         
         case AST_UNARY_EXPRESSION: {
-            DataType operand_type = analyze_expression(analyzer, expr->data.unary_expr.operand);
-            
-            // Para operações unárias, o tipo geralmente se mantém
-            if (operand_type == TYPE_VOID) {
-                return TYPE_VOID;
+            TypeId operand_type = analyze_operand(analyzer, expr->data.unary_expr.operand);
+            if (operand_type == TYPE_ID_INVALID) {
+                return TYPE_ID_INVALID;
             }
             
-            UnaryOperator op = expr->data.unary_expr.operator;
-            switch (op) {
+            const TypeInfo* info = type_info(types, operand_type);
+            int is_pointer = info->kind == TYPEKIND_POINTER;
+            TypeId result = TYPE_ID_INVALID;
+            switch (expr->data.unary_expr.operator) {
                 case UNARY_NOT:
-                    return TYPE_INT; // Resultado de ! é sempre int (0 ou 1)
+                    // Resultado de ! é sempre int (0 ou 1)
+                    if (type_is_arithmetic(operand_type) || is_pointer ||
+                        info->kind == TYPEKIND_ARRAY) {
+                        result = TYPE_ID_INT;
+                    }
+                    break;
                 case UNARY_MINUS:
                 case UNARY_PLUS:
-                    return operand_type; // Mantém o tipo original
+                    // Promoção aritmética: char vira int
+                    result = type_binary_result(types, operand_type, TYPE_ID_INT, TOKEN_PLUS);
+                    if (result != TYPE_ID_INVALID && !type_is_arithmetic(result)) {
+                        result = TYPE_ID_INVALID;
+                    }
+                    break;
+                case UNARY_BITWISE_NOT:
+                    result = type_binary_result(types, operand_type, TYPE_ID_INT, TOKEN_BITWISE_AND);
+                    break;
                 default:
-                    return operand_type;
+                    // Incremento e decremento mantêm o tipo do operando
+                    if (type_is_arithmetic(operand_type) || is_pointer) {
+                        result = operand_type;
+                        check_modifiable(analyzer, expr->data.unary_expr.operand);
+                    }
+                    break;
             }
+            
+            if (result == TYPE_ID_INVALID) {
+                semantic_error(analyzer, "Operando inválido para o operador unário",
+                             expr->line, expr->column);
+            }
+            return result;
+        }
+        
+        case AST_TERNARY_EXPRESSION: {
+            TypeId cond_type = analyze_operand(analyzer, expr->data.ternary_expr.condition);
+            TypeId true_type = analyze_operand(analyzer, expr->data.ternary_expr.true_expr);
+            TypeId false_type = analyze_operand(analyzer, expr->data.ternary_expr.false_expr);
+            
+            if (cond_type == TYPE_ID_INVALID || true_type == TYPE_ID_INVALID ||
+                false_type == TYPE_ID_INVALID) {
+                return TYPE_ID_INVALID;
+            }
+            if (cond_type == TYPE_ID_VOID) {
+                semantic_error(analyzer, "Condição inválida no operador ternário",
+                             expr->line, expr->column);
+                return TYPE_ID_INVALID;
+            }
+            if (true_type == false_type) {
+                return true_type;
+            }
+            if (!type_compatible(types, true_type, false_type)) {
+                semantic_error(analyzer, "Tipos incompatíveis no operador ternário",
+                             expr->line, expr->column);
+                return TYPE_ID_INVALID;
+            }
+            
+            if (type_is_arithmetic(true_type) && type_is_arithmetic(false_type)) {
+                return type_binary_result(types, true_type, false_type, TOKEN_PLUS);
+            }
+            return true_type;
         }
         
         case AST_ASSIGNMENT_EXPRESSION: {
-            DataType left_type = analyze_expression(analyzer, expr->data.binary_expr.left);
-            DataType right_type = analyze_expression(analyzer, expr->data.binary_expr.right);
+            TypeId left_type = analyze_operand(analyzer, expr->data.binary_expr.left);
+            TypeId right_type = analyze_operand(analyzer, expr->data.binary_expr.right);
             
-            if (left_type != TYPE_VOID && right_type != TYPE_VOID && 
-                !check_type_compatibility(left_type, right_type)) {
+            if (left_type == TYPE_ID_INVALID || !expr->data.binary_expr.left) {
+                return TYPE_ID_INVALID;
+            }
+            if (type_info(types, left_type)->kind == TYPEKIND_ARRAY) {
+                semantic_error(analyzer, "Array não pode ser atribuído",
+                             expr->line, expr->column);
+                return TYPE_ID_INVALID;
+            }
+            check_modifiable(analyzer, expr->data.binary_expr.left);
+            if (right_type != TYPE_ID_INVALID &&
+                !is_assignable(analyzer, left_type, expr->data.binary_expr.right)) {
                 semantic_error(analyzer, "Tipos incompatíveis na atribuição", 
                              expr->line, expr->column);
             }
@@ -293,90 +938,52 @@ DataType analyze_expression(SemanticAnalyzer* analyzer, ASTNode* expr) {
         case AST_FUNCTION_CALL: {
             Symbol* symbol = symbol_table_lookup(analyzer->symbol_table, 
                                                expr->data.function_call.name);
-            if (!symbol) {
-                // Para printf, não dar erro - tratar como built-in
-                if (strcmp(expr->data.function_call.name, "printf") == 0) {
-                    // Analisar argumentos
-                    for (int i = 0; i < expr->child_count; i++) {
-                        analyze_expression(analyzer, expr->children[i]);
-                    }
-                    return TYPE_INT; // printf retorna int
-                }
-                
+            const Symbol* target = symbol ? symbol : symbol_lookup_builtin(expr->data.function_call.name);
+            if (!target) {
                 semantic_error(analyzer, "Função não declarada", 
                              expr->line, expr->column);
-                return TYPE_VOID;
+                return TYPE_ID_INVALID;
             }
             
-            if (symbol->kind != SYMBOL_FUNCTION) {
+            if (target->kind != SYMBOL_FUNCTION) {
                 semantic_error(analyzer, "Identificador não é uma função", 
                              expr->line, expr->column);
-                return TYPE_VOID;
+                return TYPE_ID_INVALID;
             }
             
-            // Analisar argumentos
-            for (int i = 0; i < expr->child_count; i++) {
-                analyze_expression(analyzer, expr->children[i]);
+            if (symbol) {
+                annotate_symbol(expr, symbol);
+            } else {
+                annotate_builtin(expr, target);
             }
+            check_call_arguments(analyzer, expr, &target->info.function);
             
-            return symbol->type;
+            return target->info.function.return_type_id;
         }
         
         default:
-            return TYPE_INT; // Padrão conservador
+            return TYPE_ID_INT; // Padrão conservador
     }
 }
 
 void semantic_warning(SemanticAnalyzer* analyzer, const char* message, int line, int column) {
+    char text[512];
+    snprintf(text, sizeof(text), "Aviso semântico na linha %d, coluna %d: %s", line, column, message);
     analyzer->warning_count++;
-    printf("Aviso semântico na linha %d, coluna %d: %s\n", line, column, message);
+    record_diagnostic(analyzer, 0, text, line, column);
 }
 
+// Compatibilidade entre DataTypes planos: consulta à matriz da tabela de tipos
 int check_type_compatibility(DataType type1, DataType type2) {
     if (type1 == type2) return 1;
     
-    // Void não é compatível com nada (exceto void)
-    if (type1 == TYPE_VOID || type2 == TYPE_VOID) {
-        return 0;
-    }
-    
-    // Conversões implícitas permitidas entre tipos numéricos
-    if ((type1 == TYPE_INT && type2 == TYPE_FLOAT) ||
-        (type1 == TYPE_FLOAT && type2 == TYPE_INT)) {
-        return 1;
-    }
-    
-    if ((type1 == TYPE_INT && type2 == TYPE_CHAR) ||
-        (type1 == TYPE_CHAR && type2 == TYPE_INT)) {
-        return 1;
-    }
-    
-    if ((type1 == TYPE_FLOAT && type2 == TYPE_CHAR) ||
-        (type1 == TYPE_CHAR && type2 == TYPE_FLOAT)) {
-        return 1;
-    }
-    
-    return 0;
+    TypeId id1 = type_primitive(type1);
+    TypeId id2 = type_primitive(type2);
+    if (id1 == TYPE_ID_INVALID || id2 == TYPE_ID_INVALID) return 0;
+    return type_compatible(NULL, id1, id2);
 }
 
 DataType get_binary_operation_result_type(DataType left, DataType right, TokenType op) {
-    // Para operadores de comparação, sempre retorna int (0 ou 1)
-    if (op == TOKEN_EQUAL || op == TOKEN_NOT_EQUAL ||
-        op == TOKEN_LESS || op == TOKEN_GREATER ||
-        op == TOKEN_LESS_EQUAL || op == TOKEN_GREATER_EQUAL ||
-        op == TOKEN_AND || op == TOKEN_OR) {
-        return TYPE_INT;
-    }
-    
-    // Para operadores aritméticos, promover para o tipo "maior"
-    if (left == TYPE_FLOAT || right == TYPE_FLOAT) {
-        return TYPE_FLOAT;
-    }
-    
-    if (left == TYPE_INT || right == TYPE_INT) {
-        return TYPE_INT;
-    }
-    
-    // Se ambos são char, resultado é int (promoção automática em C)
-    return TYPE_INT;
-}
\ No newline at end of file
+    TypeId result = type_binary_result(NULL, type_primitive(left), type_primitive(right), op);
+    return result == TYPE_ID_INVALID ? TYPE_VOID : type_data_type(NULL, result);
+}
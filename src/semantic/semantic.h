@@ -4,14 +4,34 @@
 #include "ast.h"
 #include "symbol_table.h"
 
+// Diagnóstico registrado durante a análise; a lista final fica em ordem de código-fonte
+typedef struct SemanticDiagnostic {
+    int is_error;
+    int line;
+    int column;
+    int order;      // Declaração global em que ocorreu (ordena a junção dos workers)
+    char* message;
+} SemanticDiagnostic;
+
 typedef struct SemanticAnalyzer {
     SymbolTable* symbol_table;
     int has_error;
     char error_message[512];
     DataType current_function_return_type;
+    TypeId current_return_type_id;
     int in_loop;  // Para verificar break/continue
+    int in_switch;  // break também é válido dentro de switch
+    int local_count;  // Slots ocupados pelos escopos abertos da função atual
+    int frame_size;   // Bytes ocupados pelos escopos abertos da função atual
+    int max_local_count;  // Pico de slots (blocos disjuntos reutilizam slots)
+    int max_frame_size;   // Pico de bytes: tamanho final do frame
     int error_count;
     int warning_count;
+    int decl_order;   // Declaração global sendo analisada (visibilidade dos globais)
+    int thread_count; // Workers para os corpos de função (0 = um por núcleo)
+    SemanticDiagnostic* diagnostics;
+    int diagnostic_count;
+    int diagnostic_capacity;
 } SemanticAnalyzer;
 
 // Funções do analisador semântico
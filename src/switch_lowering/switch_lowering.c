@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include "switch_lowering.h"
+
+// ============================================================
+// Casos
+// ============================================================
+
+static int compare_cases(const void* a, const void* b) {
+    const SwitchCase* left = a;
+    const SwitchCase* right = b;
+    if (left->value != right->value) return left->value < right->value ? -1 : 1;
+    return left->target - right->target;
+}
+
+// Rótulos vazios caem no seguinte
+static int code_target(const ASTNode* cases, int index) {
+    while (index + 1 < cases->child_count && cases->children[index]->child_count == 0) index++;
+    return index;
+}
+
+// ============================================================
+// Clusters
+// ============================================================
+
+static int is_dense(const SwitchPlan* plan, int first, int last) {
+    long count = last - first + 1;
+    long range = plan->cases[last].value - plan->cases[first].value + 1;
+    return count >= SWITCH_MIN_TABLE_CASES && range > 0 && range <= SWITCH_MAX_TABLE_RANGE &&
+           count * 100 >= range * SWITCH_MIN_TABLE_DENSITY;
+}
+
+static void add_cluster(SwitchPlan* plan, SwitchClusterKind kind, int first, int count) {
+    SwitchCluster* cluster = &plan->clusters[plan->cluster_count++];
+    cluster->kind = kind;
+    cluster->first = first;
+    cluster->count = count;
+    cluster->low = plan->cases[first].value;
+    cluster->high = plan->cases[first + count - 1].value;
+}
+
+// Vale trocar os casos por um teste de bits quando ele poupa comparações:
+// um destino a partir de 3 casos, dois a partir de 5, três a partir de 6
+static int bitset_pays_off(int cases, int targets) {
+    return (targets == 1 && cases >= 3) || (targets == 2 && cases >= 5) || (targets == 3 && cases >= 6);
+}
+
+// Maior trecho de casos a partir de first que cabe num teste de bits
+static int bitset_extent(const SwitchPlan* plan, int first, int last) {
+    int targets[SWITCH_MAX_BITSET_TARGETS];
+    int target_count = 0;
+    int end = first;
+    for (; end <= last; end++) {
+        if (plan->cases[end].value - plan->cases[first].value >= SWITCH_BITSET_RANGE) break;
+        int target = plan->cases[end].target;
+        int known = 0;
+        for (int t = 0; t < target_count; t++) known |= targets[t] == target;
+        if (!known) {
+            if (target_count == SWITCH_MAX_BITSET_TARGETS) break;
+            targets[target_count++] = target;
+        }
+    }
+    return bitset_pays_off(end - first, target_count) ? end - first : 0;
+}
+
+// Casos isolados entre first e last: testes de bits onde compensam
+static void add_sparse_clusters(SwitchPlan* plan, int first, int last) {
+    while (first <= last) {
+        int extent = bitset_extent(plan, first, last);
+        if (extent > 0) {
+            add_cluster(plan, CLUSTER_BITSET, first, extent);
+            first += extent;
+        } else {
+            add_cluster(plan, CLUSTER_SINGLE, first, 1);
+            first++;
+        }
+    }
+}
+
+// Partição mínima em tabelas densas (programação dinâmica de trás para
+// frente); os trechos que não formam tabela ficam para os testes de bits
+static void build_clusters(SwitchPlan* plan) {
+    int n = plan->case_count;
+    int* parts = malloc((n + 1) * sizeof(int));
+    int* table_end = malloc((n + 1) * sizeof(int));
+
+    parts[n] = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        parts[i] = 1 + parts[i + 1];
+        table_end[i] = -1;
+        for (int j = n - 1; j > i; j--) {
+            if (1 + parts[j + 1] < parts[i] && is_dense(plan, i, j)) {
+                parts[i] = 1 + parts[j + 1];
+                table_end[i] = j;
+            }
+        }
+    }
+
+    plan->clusters = malloc((n + 1) * sizeof(SwitchCluster));
+    int sparse = 0;
+    for (int i = 0; i < n;) {
+        if (table_end[i] < 0) {
+            i++;
+            continue;
+        }
+        add_sparse_clusters(plan, sparse, i - 1);
+        add_cluster(plan, CLUSTER_TABLE, i, table_end[i] - i + 1);
+        i = sparse = table_end[i] + 1;
+    }
+    add_sparse_clusters(plan, sparse, n - 1);
+
+    free(parts);
+    free(table_end);
+}
+
+SwitchPlan* switch_plan_create(const ASTNode* node) {
+    const ASTNode* cases = node->data.switch_stmt.cases;
+    SwitchPlan* plan = calloc(1, sizeof(SwitchPlan));
+    plan->cases = malloc((cases->child_count + 1) * sizeof(SwitchCase));
+    plan->default_target = -1;
+
+    for (int i = 0; i < cases->child_count; i++) {
+        const ASTNode* label = cases->children[i];
+        long value;
+        if (label->type == AST_DEFAULT_STATEMENT) {
+            plan->default_target = code_target(cases, i);
+        } else if (ast_constant_expression(label->data.case_stmt.value, &value)) {
+            plan->cases[plan->case_count].value = value;
+            plan->cases[plan->case_count++].target = code_target(cases, i);
+        }
+    }
+
+    // Um valor repetido vale pelo primeiro rótulo, como na cadeia de comparações
+    qsort(plan->cases, plan->case_count, sizeof(SwitchCase), compare_cases);
+    int unique = 0;
+    for (int i = 0; i < plan->case_count; i++) {
+        if (unique == 0 || plan->cases[unique - 1].value != plan->cases[i].value) {
+            plan->cases[unique++] = plan->cases[i];
+        }
+    }
+    plan->case_count = unique;
+
+    build_clusters(plan);
+    return plan;
+}
+
+void switch_plan_destroy(SwitchPlan* plan) {
+    if (!plan) return;
+    free(plan->cases);
+    free(plan->clusters);
+    free(plan);
+}
+
+int switch_cluster_targets(const SwitchPlan* plan, const SwitchCluster* cluster, int* targets, int max) {
+    int count = 0;
+    for (int i = cluster->first; i < cluster->first + cluster->count; i++) {
+        int known = 0;
+        for (int t = 0; t < count; t++) known |= targets[t] == plan->cases[i].target;
+        if (!known && count < max) targets[count++] = plan->cases[i].target;
+    }
+    return count;
+}
+
+unsigned long long switch_bitset_mask(const SwitchPlan* plan, const SwitchCluster* cluster, int target) {
+    unsigned long long mask = 0;
+    for (int i = cluster->first; i < cluster->first + cluster->count; i++) {
+        if (plan->cases[i].target == target) mask |= 1ULL << (plan->cases[i].value - cluster->low);
+    }
+    return mask;
+}
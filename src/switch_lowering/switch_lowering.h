@@ -0,0 +1,60 @@
+#ifndef SWITCH_LOWERING_H
+#define SWITCH_LOWERING_H
+
+#include "ast.h"
+
+// ------------------------------------------------------------
+// Escolha de como despachar um switch
+//
+// Os casos são ordenados por valor e agrupados em clusters: uma tabela
+// de saltos para trechos densos, um teste de bits para muitos valores
+// próximos que vão para poucos rótulos, e casos isolados no resto. O
+// gerador faz uma busca binária sobre os clusters e, em cada um, o teste
+// do seu tipo. Um rótulo sem comandos cai no seguinte, então os casos
+// dele já apontam para o rótulo onde o código começa.
+// ------------------------------------------------------------
+
+#define SWITCH_MIN_TABLE_CASES 4
+#define SWITCH_MIN_TABLE_DENSITY 40    // % das entradas da tabela com caso
+#define SWITCH_MAX_TABLE_RANGE 4096    // Entradas
+#define SWITCH_BITSET_RANGE 64         // Bits de um registrador
+#define SWITCH_MAX_BITSET_TARGETS 3
+#define SWITCH_LINEAR_CLUSTERS 3       // Até isso, testes em sequência em vez de busca binária
+
+typedef enum {
+    CLUSTER_SINGLE,
+    CLUSTER_TABLE,
+    CLUSTER_BITSET
+} SwitchClusterKind;
+
+typedef struct SwitchCase {
+    long value;
+    int target;            // Índice do rótulo em switch_stmt.cases
+} SwitchCase;
+
+typedef struct SwitchCluster {
+    SwitchClusterKind kind;
+    long low;
+    long high;
+    int first;             // Casos cobertos: cases[first .. first + count - 1]
+    int count;
+} SwitchCluster;
+
+typedef struct SwitchPlan {
+    SwitchCase* cases;     // Ordenados por valor
+    int case_count;
+    int default_target;    // -1 sem default
+    SwitchCluster* clusters;
+    int cluster_count;
+} SwitchPlan;
+
+SwitchPlan* switch_plan_create(const ASTNode* node);
+void switch_plan_destroy(SwitchPlan* plan);
+
+// Destinos distintos de um cluster, na ordem do primeiro caso (máximo max)
+int switch_cluster_targets(const SwitchPlan* plan, const SwitchCluster* cluster, int* targets, int max);
+
+// Bits (valor - low) dos casos do cluster que vão para target
+unsigned long long switch_bitset_mask(const SwitchPlan* plan, const SwitchCluster* cluster, int target);
+
+#endif
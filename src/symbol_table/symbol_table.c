@@ -12,13 +12,47 @@ SymbolTable* symbol_table_create() {
     table->global_scope->parent = NULL;
     table->global_scope->level = 0;
     table->global_scope->name = strdup("global");
+    table->global_scope->next_closed = NULL;
     
     table->current_scope = table->global_scope;
+    table->closed_scopes = NULL;
+    table->types = type_table_create();
     table->current_level = 0;
+    table->temp_counter = 0;
+    table->is_view = 0;
     
     return table;
 }
 
+SymbolTable* symbol_table_create_view(SymbolTable* table) {
+    SymbolTable* view = malloc(sizeof(SymbolTable));
+    view->global_scope = table->global_scope;
+    view->current_scope = table->global_scope;
+    view->closed_scopes = NULL;
+    view->types = table->types;
+    view->current_level = 0;
+    view->temp_counter = 0;
+    view->is_view = 1;
+    return view;
+}
+
+// Transfere os escopos encerrados da visão (referenciados pela AST) para a
+// tabela principal e libera a visão
+void symbol_table_merge_view(SymbolTable* table, SymbolTable* view) {
+    while (view->current_scope != view->global_scope) {
+        symbol_table_exit_scope(view);
+    }
+    
+    Scope* scope = view->closed_scopes;
+    while (scope) {
+        Scope* next = scope->next_closed;
+        scope->next_closed = table->closed_scopes;
+        table->closed_scopes = scope;
+        scope = next;
+    }
+    free(view);
+}
+
 static void scope_destroy(Scope* scope) {
     if (!scope) return;
     
@@ -57,6 +91,20 @@ static void scope_destroy(Scope* scope) {
 
 void symbol_table_destroy(SymbolTable* table) {
     if (!table) return;
+    if (table->is_view) {
+        // Visão descartada sem merge: só os escopos próprios são liberados
+        while (table->current_scope != table->global_scope) {
+            symbol_table_exit_scope(table);
+        }
+        Scope* scope = table->closed_scopes;
+        while (scope) {
+            Scope* next = scope->next_closed;
+            scope_destroy(scope);
+            scope = next;
+        }
+        free(table);
+        return;
+    }
     
     // Destruir todos os escopos
     Scope* current = table->current_scope;
@@ -66,6 +114,15 @@ void symbol_table_destroy(SymbolTable* table) {
         current = parent;
     }
     
+    // Escopos encerrados continuam vivos até aqui porque a AST aponta para seus símbolos
+    current = table->closed_scopes;
+    while (current) {
+        Scope* next = current->next_closed;
+        scope_destroy(current);
+        current = next;
+    }
+    
+    type_table_destroy(table->types);
     free(table);
 }
 
@@ -75,6 +132,7 @@ void symbol_table_enter_scope(SymbolTable* table, const char* scope_name) {
     new_scope->parent = table->current_scope;
     new_scope->level = table->current_level + 1;
     new_scope->name = strdup(scope_name);
+    new_scope->next_closed = NULL;
     
     table->current_scope = new_scope;
     table->current_level++;
@@ -89,7 +147,87 @@ void symbol_table_exit_scope(SymbolTable* table) {
     table->current_scope = old_scope->parent;
     table->current_level--;
     
-    scope_destroy(old_scope);
+    old_scope->next_closed = table->closed_scopes;
+    table->closed_scopes = old_scope;
+}
+
+// ------------------------------------------------------------
+// Ambiente built-in
+//
+// Funções da biblioteca padrão disponíveis sem declaração. A tabela é
+// estática e somente leitura: não há custo de criação por compilação e
+// pode ser consultada por várias threads. Mantida em ordem alfabética
+// para a busca binária. A AST aponta para ela por ref.builtin, que é
+// const; nada escreve num built-in.
+// ------------------------------------------------------------
+
+static TypeId params_char_ptr[] = { TYPE_ID_CHAR_POINTER };
+static TypeId params_char_ptr_2[] = { TYPE_ID_CHAR_POINTER, TYPE_ID_CHAR_POINTER };
+static TypeId params_char_ptr_2_int[] = { TYPE_ID_CHAR_POINTER, TYPE_ID_CHAR_POINTER, TYPE_ID_INT };
+static TypeId params_char_ptr_int[] = { TYPE_ID_CHAR_POINTER, TYPE_ID_INT };
+static TypeId params_int[] = { TYPE_ID_INT };
+static TypeId params_int_2[] = { TYPE_ID_INT, TYPE_ID_INT };
+static TypeId params_void_ptr[] = { TYPE_ID_VOID_POINTER };
+static TypeId params_void_ptr_int[] = { TYPE_ID_VOID_POINTER, TYPE_ID_INT };
+static TypeId params_void_ptr_int_2[] = { TYPE_ID_VOID_POINTER, TYPE_ID_INT, TYPE_ID_INT };
+static TypeId params_void_ptr_2_int[] = { TYPE_ID_VOID_POINTER, TYPE_ID_VOID_POINTER, TYPE_ID_INT };
+
+#define BUILTIN(fname, ret, ret_id, params, count, variadic, effects) {         \
+        .name = fname, .kind = SYMBOL_FUNCTION, .type = ret, .type_id = TYPE_ID_INVALID, \
+        .scope_level = 0, .decl_order = -1,                                     \
+        .info.function = { .return_type = ret, .return_type_id = ret_id,        \
+                           .parameter_count = count, .parameter_types = params, \
+                           .signature = TYPE_ID_INVALID, .is_variadic = variadic, \
+                           .is_defined = 1, .purity = effects } }
+
+static const Symbol builtin_symbols[] = {
+    BUILTIN("abs",     TYPE_INT,     TYPE_ID_INT,          params_int,            1, 0, FUNCTION_CONST),
+    BUILTIN("atoi",    TYPE_INT,     TYPE_ID_INT,          params_char_ptr,       1, 0, FUNCTION_READS_MEMORY),
+    BUILTIN("calloc",  TYPE_POINTER, TYPE_ID_VOID_POINTER, params_int_2,          2, 0, FUNCTION_IMPURE),
+    BUILTIN("exit",    TYPE_VOID,    TYPE_ID_VOID,         params_int,            1, 0, FUNCTION_IMPURE),
+    BUILTIN("free",    TYPE_VOID,    TYPE_ID_VOID,         params_void_ptr,       1, 0, FUNCTION_IMPURE),
+    BUILTIN("getchar", TYPE_INT,     TYPE_ID_INT,          NULL,                  0, 0, FUNCTION_IMPURE),
+    BUILTIN("malloc",  TYPE_POINTER, TYPE_ID_VOID_POINTER, params_int,            1, 0, FUNCTION_IMPURE),
+    BUILTIN("memcpy",  TYPE_POINTER, TYPE_ID_VOID_POINTER, params_void_ptr_2_int, 3, 0, FUNCTION_IMPURE),
+    BUILTIN("memset",  TYPE_POINTER, TYPE_ID_VOID_POINTER, params_void_ptr_int_2, 3, 0, FUNCTION_IMPURE),
+    BUILTIN("printf",  TYPE_INT,     TYPE_ID_INT,          params_char_ptr,       1, 1, FUNCTION_IMPURE),
+    BUILTIN("putchar", TYPE_INT,     TYPE_ID_INT,          params_int,            1, 0, FUNCTION_IMPURE),
+    BUILTIN("puts",    TYPE_INT,     TYPE_ID_INT,          params_char_ptr,       1, 0, FUNCTION_IMPURE),
+    BUILTIN("rand",    TYPE_INT,     TYPE_ID_INT,          NULL,                  0, 0, FUNCTION_IMPURE),
+    BUILTIN("realloc", TYPE_POINTER, TYPE_ID_VOID_POINTER, params_void_ptr_int,   2, 0, FUNCTION_IMPURE),
+    BUILTIN("scanf",   TYPE_INT,     TYPE_ID_INT,          params_char_ptr,       1, 1, FUNCTION_IMPURE),
+    BUILTIN("sprintf", TYPE_INT,     TYPE_ID_INT,          params_char_ptr_2,     2, 1, FUNCTION_IMPURE),
+    BUILTIN("srand",   TYPE_VOID,    TYPE_ID_VOID,         params_int,            1, 0, FUNCTION_IMPURE),
+    BUILTIN("strcat",  TYPE_POINTER, TYPE_ID_CHAR_POINTER, params_char_ptr_2,     2, 0, FUNCTION_IMPURE),
+    BUILTIN("strchr",  TYPE_POINTER, TYPE_ID_CHAR_POINTER, params_char_ptr_int,   2, 0, FUNCTION_READS_MEMORY),
+    BUILTIN("strcmp",  TYPE_INT,     TYPE_ID_INT,          params_char_ptr_2,     2, 0, FUNCTION_READS_MEMORY),
+    BUILTIN("strcpy",  TYPE_POINTER, TYPE_ID_CHAR_POINTER, params_char_ptr_2,     2, 0, FUNCTION_IMPURE),
+    BUILTIN("strlen",  TYPE_INT,     TYPE_ID_INT,          params_char_ptr,       1, 0, FUNCTION_READS_MEMORY),
+    BUILTIN("strncmp", TYPE_INT,     TYPE_ID_INT,          params_char_ptr_2_int, 3, 0, FUNCTION_READS_MEMORY),
+    BUILTIN("strncpy", TYPE_POINTER, TYPE_ID_CHAR_POINTER, params_char_ptr_2_int, 3, 0, FUNCTION_IMPURE),
+};
+
+#define BUILTIN_COUNT ((int)(sizeof(builtin_symbols) / sizeof(builtin_symbols[0])))
+
+const Symbol* symbol_lookup_builtin(const char* name) {
+    int low = 0;
+    int high = BUILTIN_COUNT - 1;
+    
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int order = strcmp(name, builtin_symbols[middle].name);
+        if (order == 0) return &builtin_symbols[middle];
+        if (order < 0) {
+            high = middle - 1;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return NULL;
+}
+
+const Symbol* symbol_ref_target(const SymbolRef* ref) {
+    return ref->symbol ? ref->symbol : ref->builtin;
 }
 
 Symbol* symbol_table_lookup(SymbolTable* table, const char* name) {
@@ -139,15 +277,20 @@ Symbol* symbol_create_variable(const char* name, DataType type, int line, int co
     symbol->name = strdup(name);
     symbol->kind = SYMBOL_VARIABLE;
     symbol->type = type;
+    symbol->type_id = type_primitive(type);
     symbol->line = line;
     symbol->column = column;
+    symbol->decl_order = -1;
     symbol->next = NULL;
     
     // Inicializar informações da variável
     symbol->info.variable.is_initialized = 0;
     symbol->info.variable.is_const = 0;
     symbol->info.variable.is_static = 0;
+    symbol->info.variable.is_modified = 0;
+    symbol->info.variable.slot = -1;
     symbol->info.variable.offset = 0;
+    symbol->info.variable.reg = -1;
     
     return symbol;
 }
@@ -157,16 +300,23 @@ Symbol* symbol_create_function(const char* name, DataType return_type, int line,
     symbol->name = strdup(name);
     symbol->kind = SYMBOL_FUNCTION;
     symbol->type = return_type;
+    symbol->type_id = TYPE_ID_INVALID;
     symbol->line = line;
     symbol->column = column;
+    symbol->decl_order = -1;
     symbol->next = NULL;
     
     // Inicializar informações da função
     symbol->info.function.return_type = return_type;
+    symbol->info.function.return_type_id = type_primitive(return_type);
     symbol->info.function.parameter_count = 0;
     symbol->info.function.parameter_types = NULL;
     symbol->info.function.parameter_names = NULL;
+    symbol->info.function.signature = TYPE_ID_INVALID;
+    symbol->info.function.is_variadic = 0;
     symbol->info.function.is_defined = 0;
+    symbol->info.function.purity = FUNCTION_IMPURE;
+    symbol->info.function.self_recursive = 0;
     
     return symbol;
 }
@@ -176,8 +326,10 @@ Symbol* symbol_create_struct(const char* name, int line, int column) {
     symbol->name = strdup(name);
     symbol->kind = SYMBOL_STRUCT;
     symbol->type = TYPE_VOID; // Structs não têm tipo primitivo
+    symbol->type_id = TYPE_ID_INVALID;
     symbol->line = line;
     symbol->column = column;
+    symbol->decl_order = -1;
     symbol->next = NULL;
     
     // Inicializar informações da estrutura
@@ -201,7 +353,13 @@ void symbol_table_print(SymbolTable* table) {
             printf("  %s: %s", symbol->name, symbol_kind_to_string(symbol->kind));
             
             if (symbol->kind == SYMBOL_VARIABLE || symbol->kind == SYMBOL_FUNCTION) {
-                printf(" (tipo: %s)", data_type_to_string(symbol->type));
+                char type_name[256];
+                if (symbol->type_id != TYPE_ID_INVALID) {
+                    type_to_string(table->types, symbol->type_id, type_name, sizeof(type_name));
+                } else {
+                    snprintf(type_name, sizeof(type_name), "%s", data_type_to_string(symbol->type));
+                }
+                printf(" (tipo: %s)", type_name);
             }
             
             if (symbol->kind == SYMBOL_FUNCTION) {
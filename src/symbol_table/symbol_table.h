@@ -2,6 +2,7 @@
 #define SYMBOL_TABLE_H
 
 #include "ast.h"
+#include "type_table.h"
 
 // Tipos de símbolos
 typedef enum {
@@ -13,13 +14,27 @@ typedef enum {
     SYMBOL_TYPEDEF
 } SymbolKind;
 
+// Efeitos de uma função, do mais restrito ao mais livre: CONST depende só
+// dos argumentos; READS_MEMORY também lê globais ou memória apontada, mas
+// não escreve nada; IMPURE pode escrever ou fazer E/S
+typedef enum {
+    FUNCTION_IMPURE,
+    FUNCTION_READS_MEMORY,
+    FUNCTION_CONST
+} FunctionPurity;
+
 // Informações sobre função
 typedef struct FunctionInfo {
     DataType return_type;
+    TypeId return_type_id;  // Tipo canônico do retorno (ponteiros inclusive)
     int parameter_count;
-    DataType* parameter_types;
+    TypeId* parameter_types;
+    TypeId signature;  // Tipo canônico da função (TYPE_ID_INVALID nos built-ins)
     char** parameter_names;
+    int is_variadic;
     int is_defined;  // Se foi apenas declarada ou também definida
+    FunctionPurity purity;  // Calculada pelo otimizador (IMPURE até lá)
+    int self_recursive;     // Chama a si mesma (mesma análise)
 } FunctionInfo;
 
 // Informações sobre estrutura
@@ -35,16 +50,21 @@ typedef struct Symbol {
     char* name;
     SymbolKind kind;
     DataType type;
+    TypeId type_id;  // Tipo canônico completo (ponteiros, arrays, assinaturas)
     int line;
     int column;
     int scope_level;
+    int decl_order;  // Posição da declaração global no programa (-1 para locais)
     
     union {
         struct {
             int is_initialized;
             int is_const;
             int is_static;
-            int offset;  // Para geração de código
+            int is_modified;  // Local alvo de atribuição ou ++/-- (análise semântica)
+            int slot;    // Índice do slot no frame da função (-1 para globais)
+            int offset;  // Deslocamento em relação a %rbp (geração de código)
+            int reg;     // Registrador da local no assembly (-1: no frame)
         } variable;
         
         FunctionInfo function;
@@ -64,25 +84,38 @@ typedef struct Scope {
     struct Scope* parent;
     int level;
     char* name;  // Nome do escopo (função, bloco, etc.)
+    struct Scope* next_closed;  // Encadeamento dos escopos já encerrados
 } Scope;
 
 // Tabela de símbolos
 typedef struct SymbolTable {
     Scope* current_scope;
     Scope* global_scope;
+    Scope* closed_scopes;  // Escopos encerrados, mantidos para as anotações da AST
+    TypeTable* types;      // Tipos canônicos usados pelos símbolos
     int current_level;
+    int temp_counter;      // Temporários _temp_N do otimizador e do gerador de código
+    int is_view;           // Visão de worker: escopo global e tipos pertencem à tabela principal
 } SymbolTable;
 
 // Funções da tabela de símbolos
 SymbolTable* symbol_table_create();
 void symbol_table_destroy(SymbolTable* table);
 
+// Visões para análise paralela: cada worker empilha seus próprios escopos
+// sobre o escopo global compartilhado (somente leitura durante a análise)
+SymbolTable* symbol_table_create_view(SymbolTable* table);
+void symbol_table_merge_view(SymbolTable* table, SymbolTable* view);
+
 // Gerenciamento de escopos
 void symbol_table_enter_scope(SymbolTable* table, const char* scope_name);
 void symbol_table_exit_scope(SymbolTable* table);
 
-// Operações com símbolos
+// Operações com símbolos; os built-ins, somente leitura, ficam fora dos
+// escopos e são consultados à parte
 Symbol* symbol_table_lookup(SymbolTable* table, const char* name);
+const Symbol* symbol_lookup_builtin(const char* name);
+const Symbol* symbol_ref_target(const SymbolRef* ref);  // Símbolo do programa ou built-in
 Symbol* symbol_table_lookup_current_scope(SymbolTable* table, const char* name);
 int symbol_table_insert(SymbolTable* table, Symbol* symbol);
 
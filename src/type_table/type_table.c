@@ -0,0 +1,411 @@
+#include "type_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Compatibilidade de atribuição entre primitivos: [destino][origem]
+static const unsigned char compatibility_matrix[PRIMITIVE_TYPE_COUNT][PRIMITIVE_TYPE_COUNT] = {
+    /*            void int float char */
+    /* void  */ { 1,   0,  0,    0 },
+    /* int   */ { 0,   1,  1,    1 },
+    /* float */ { 0,   1,  1,    1 },
+    /* char  */ { 0,   1,  1,    1 }
+};
+
+// Tipo resultante de operações aritméticas (+ - * /): [esquerda][direita]
+static const TypeId arithmetic_promotion[PRIMITIVE_TYPE_COUNT][PRIMITIVE_TYPE_COUNT] = {
+    /*            void              int               float             char */
+    /* void  */ { TYPE_ID_INVALID,  TYPE_ID_INVALID,  TYPE_ID_INVALID,  TYPE_ID_INVALID },
+    /* int   */ { TYPE_ID_INVALID,  TYPE_ID_INT,      TYPE_ID_FLOAT,    TYPE_ID_INT },
+    /* float */ { TYPE_ID_INVALID,  TYPE_ID_FLOAT,    TYPE_ID_FLOAT,    TYPE_ID_FLOAT },
+    /* char  */ { TYPE_ID_INVALID,  TYPE_ID_INT,      TYPE_ID_FLOAT,    TYPE_ID_INT }
+};
+
+// Tipo resultante de operações só inteiras (% & | ^ << >>)
+static const TypeId integer_promotion[PRIMITIVE_TYPE_COUNT][PRIMITIVE_TYPE_COUNT] = {
+    /*            void              int               float             char */
+    /* void  */ { TYPE_ID_INVALID,  TYPE_ID_INVALID,  TYPE_ID_INVALID,  TYPE_ID_INVALID },
+    /* int   */ { TYPE_ID_INVALID,  TYPE_ID_INT,      TYPE_ID_INVALID,  TYPE_ID_INT },
+    /* float */ { TYPE_ID_INVALID,  TYPE_ID_INVALID,  TYPE_ID_INVALID,  TYPE_ID_INVALID },
+    /* char  */ { TYPE_ID_INVALID,  TYPE_ID_INT,      TYPE_ID_INVALID,  TYPE_ID_INT }
+};
+
+// Operandos válidos para comparações e operadores lógicos entre primitivos
+static const unsigned char comparable_matrix[PRIMITIVE_TYPE_COUNT][PRIMITIVE_TYPE_COUNT] = {
+    /*            void int float char */
+    /* void  */ { 0,   0,  0,    0 },
+    /* int   */ { 0,   1,  1,    1 },
+    /* float */ { 0,   1,  1,    1 },
+    /* char  */ { 0,   1,  1,    1 }
+};
+
+static const DataType primitive_data_types[PRIMITIVE_TYPE_COUNT] = {
+    TYPE_VOID, TYPE_INT, TYPE_FLOAT, TYPE_CHAR
+};
+
+static TypeInfo* type_slot(TypeTable* table, TypeId id) {
+    return &table->chunks[id >> TYPE_CHUNK_BITS][id & (TYPE_CHUNK_SIZE - 1)];
+}
+
+static int is_primitive(TypeId id) {
+    return id >= 0 && id < PRIMITIVE_TYPE_COUNT;
+}
+
+static unsigned int hash_combine(unsigned int hash, unsigned int value) {
+    return (hash ^ value) * 16777619u;
+}
+
+static unsigned int hash_type(const TypeInfo* info) {
+    unsigned int hash = 2166136261u;
+    hash = hash_combine(hash, (unsigned int)info->kind);
+    hash = hash_combine(hash, (unsigned int)info->base);
+    hash = hash_combine(hash, (unsigned int)info->element);
+    hash = hash_combine(hash, (unsigned int)info->count);
+    hash = hash_combine(hash, (unsigned int)info->is_variadic);
+    for (int i = 0; i < info->param_count; i++) {
+        hash = hash_combine(hash, (unsigned int)info->params[i]);
+    }
+    if (info->name) {
+        for (const char* p = info->name; *p; p++) {
+            hash = hash_combine(hash, (unsigned char)*p);
+        }
+    }
+    return hash;
+}
+
+static int types_equal(const TypeInfo* a, const TypeInfo* b) {
+    if (a->hash != b->hash || a->kind != b->kind || a->base != b->base ||
+        a->element != b->element || a->count != b->count ||
+        a->is_variadic != b->is_variadic || a->param_count != b->param_count) {
+        return 0;
+    }
+    for (int i = 0; i < a->param_count; i++) {
+        if (a->params[i] != b->params[i]) return 0;
+    }
+    if (a->name || b->name) {
+        return a->name && b->name && strcmp(a->name, b->name) == 0;
+    }
+    return 1;
+}
+
+static void rehash(TypeTable* table, int new_bucket_count) {
+    free(table->buckets);
+    table->bucket_count = new_bucket_count;
+    table->buckets = calloc(new_bucket_count, sizeof(int));
+
+    for (int id = 0; id < table->count; id++) {
+        int index = type_slot(table, id)->hash & (new_bucket_count - 1);
+        while (table->buckets[index]) {
+            index = (index + 1) & (new_bucket_count - 1);
+        }
+        table->buckets[index] = id + 1;
+    }
+}
+
+// Retorna o ID do tipo canônico equivalente, inserindo-o se for novo.
+// Os ponteiros de key (params, name) são copiados apenas na inserção.
+static TypeId intern(TypeTable* table, TypeInfo* key) {
+    key->hash = hash_type(key);
+    pthread_mutex_lock(&table->lock);
+
+    int index = key->hash & (table->bucket_count - 1);
+    while (table->buckets[index]) {
+        TypeId id = table->buckets[index] - 1;
+        if (types_equal(type_slot(table, id), key)) {
+            pthread_mutex_unlock(&table->lock);
+            return id;
+        }
+        index = (index + 1) & (table->bucket_count - 1);
+    }
+
+    TypeId id = table->count;
+    int chunk = id >> TYPE_CHUNK_BITS;
+    if (chunk >= TYPE_MAX_CHUNKS) {
+        fprintf(stderr, "Erro: limite de tipos distintos excedido\n");
+        exit(1);
+    }
+    if (!table->chunks[chunk]) {
+        table->chunks[chunk] = malloc(TYPE_CHUNK_SIZE * sizeof(TypeInfo));
+    }
+
+    TypeInfo* info = type_slot(table, id);
+    *info = *key;
+    if (key->param_count > 0) {
+        info->params = malloc(key->param_count * sizeof(TypeId));
+        memcpy(info->params, key->params, key->param_count * sizeof(TypeId));
+    } else {
+        info->params = NULL;
+    }
+    info->name = key->name ? strdup(key->name) : NULL;
+
+    // Publica o novo tipo para leitores sem trava (type_info)
+    __atomic_store_n(&table->count, id + 1, __ATOMIC_RELEASE);
+
+    // Manter fator de carga abaixo de 1/2
+    if (table->count * 2 > table->bucket_count) {
+        rehash(table, table->bucket_count * 2);
+    } else {
+        table->buckets[index] = id + 1;
+    }
+
+    pthread_mutex_unlock(&table->lock);
+    return id;
+}
+
+static TypeInfo make_key(TypeKind kind, DataType base) {
+    TypeInfo key;
+    memset(&key, 0, sizeof(key));
+    key.kind = kind;
+    key.base = base;
+    key.element = TYPE_ID_INVALID;
+    key.count = -1;
+    return key;
+}
+
+TypeTable* type_table_create() {
+    TypeTable* table = calloc(1, sizeof(TypeTable));
+    table->count = 0;
+    table->bucket_count = 64;
+    table->buckets = calloc(table->bucket_count, sizeof(int));
+    pthread_mutex_init(&table->lock, NULL);
+
+    // Primitivos na ordem dos IDs fixos
+    for (int i = 0; i < PRIMITIVE_TYPE_COUNT; i++) {
+        TypeInfo key = make_key(TYPEKIND_PRIMITIVE, primitive_data_types[i]);
+        intern(table, &key);
+    }
+    type_pointer(table, TYPE_ID_CHAR);
+    type_pointer(table, TYPE_ID_VOID);
+
+    return table;
+}
+
+void type_table_destroy(TypeTable* table) {
+    if (!table) return;
+
+    for (int i = 0; i < table->count; i++) {
+        free(type_slot(table, i)->params);
+        free(type_slot(table, i)->name);
+    }
+    for (int i = 0; i < TYPE_MAX_CHUNKS && table->chunks[i]; i++) {
+        free(table->chunks[i]);
+    }
+    free(table->buckets);
+    pthread_mutex_destroy(&table->lock);
+    free(table);
+}
+
+TypeId type_primitive(DataType type) {
+    switch (type) {
+        case TYPE_VOID: return TYPE_ID_VOID;
+        case TYPE_INT: return TYPE_ID_INT;
+        case TYPE_FLOAT: return TYPE_ID_FLOAT;
+        case TYPE_CHAR: return TYPE_ID_CHAR;
+        default: return TYPE_ID_INVALID;
+    }
+}
+
+TypeId type_pointer(TypeTable* table, TypeId target) {
+    TypeInfo key = make_key(TYPEKIND_POINTER, TYPE_POINTER);
+    key.element = target;
+    return intern(table, &key);
+}
+
+TypeId type_pointer_to_level(TypeTable* table, TypeId base, int level) {
+    TypeId id = base;
+    for (int i = 0; i < level; i++) {
+        id = type_pointer(table, id);
+    }
+    return id;
+}
+
+TypeId type_array(TypeTable* table, TypeId element, int count) {
+    TypeInfo key = make_key(TYPEKIND_ARRAY, TYPE_ARRAY);
+    key.element = element;
+    key.count = count;
+    return intern(table, &key);
+}
+
+TypeId type_function(TypeTable* table, TypeId return_type, const TypeId* params,
+                     int param_count, int is_variadic) {
+    TypeInfo key = make_key(TYPEKIND_FUNCTION, TYPE_FUNCTION);
+    key.element = return_type;
+    key.params = (TypeId*)params;
+    key.param_count = param_count;
+    key.is_variadic = is_variadic;
+    return intern(table, &key);
+}
+
+TypeId type_struct(TypeTable* table, const char* name) {
+    TypeInfo key = make_key(TYPEKIND_STRUCT, TYPE_STRUCT);
+    key.name = (char*)name;
+    return intern(table, &key);
+}
+
+const TypeInfo* type_info(TypeTable* table, TypeId id) {
+    if (!table || id < 0 || id >= __atomic_load_n(&table->count, __ATOMIC_ACQUIRE)) return NULL;
+    return type_slot(table, id);
+}
+
+DataType type_data_type(TypeTable* table, TypeId id) {
+    if (is_primitive(id)) return primitive_data_types[id];
+    const TypeInfo* info = type_info(table, id);
+    return info ? info->base : TYPE_VOID;
+}
+
+int type_size(TypeTable* table, TypeId id) {
+    if (is_primitive(id)) return data_type_size(primitive_data_types[id]);
+    const TypeInfo* info = type_info(table, id);
+    if (!info) return 0;
+
+    switch (info->kind) {
+        case TYPEKIND_PRIMITIVE:
+            return data_type_size(info->base);
+        case TYPEKIND_POINTER:
+            return 8;
+        case TYPEKIND_ARRAY:
+            return info->count > 0 ? info->count * type_size(table, info->element) : 0;
+        default:
+            return 0;
+    }
+}
+
+int type_alignment(TypeTable* table, TypeId id) {
+    const TypeInfo* info = type_info(table, id);
+    if (!info) return 1;
+    if (info->kind == TYPEKIND_ARRAY) return type_alignment(table, info->element);
+
+    int size = type_size(table, id);
+    return size > 0 ? size : 1;
+}
+
+int type_is_arithmetic(TypeId id) {
+    return id > TYPE_ID_VOID && id < PRIMITIVE_TYPE_COUNT;
+}
+
+// Arrays em expressões decaem para ponteiro para o elemento
+static TypeId decay(TypeTable* table, TypeId id) {
+    const TypeInfo* info = type_info(table, id);
+    if (info && info->kind == TYPEKIND_ARRAY) {
+        return type_pointer(table, info->element);
+    }
+    return id;
+}
+
+int type_compatible(TypeTable* table, TypeId target, TypeId source) {
+    if (target == source) return 1;
+    if (target < 0 || source < 0) return 0;
+    if (is_primitive(target) && is_primitive(source)) {
+        return compatibility_matrix[target][source];
+    }
+
+    source = decay(table, source);
+    if (target == source) return 1;
+
+    const TypeInfo* target_info = type_info(table, target);
+    const TypeInfo* source_info = type_info(table, source);
+    if (target_info->kind == TYPEKIND_POINTER && source_info->kind == TYPEKIND_POINTER) {
+        // void* converte implicitamente de e para qualquer ponteiro
+        return target_info->element == TYPE_ID_VOID || source_info->element == TYPE_ID_VOID;
+    }
+
+    return 0;
+}
+
+static int is_comparison_or_logic(TokenType op) {
+    return op == TOKEN_EQUAL || op == TOKEN_NOT_EQUAL ||
+           op == TOKEN_LESS || op == TOKEN_GREATER ||
+           op == TOKEN_LESS_EQUAL || op == TOKEN_GREATER_EQUAL ||
+           op == TOKEN_AND || op == TOKEN_OR;
+}
+
+static int is_integer_only(TokenType op) {
+    return op == TOKEN_MODULO || op == TOKEN_BITWISE_AND || op == TOKEN_BITWISE_OR ||
+           op == TOKEN_BITWISE_XOR || op == TOKEN_LEFT_SHIFT || op == TOKEN_RIGHT_SHIFT;
+}
+
+TypeId type_binary_result(TypeTable* table, TypeId left, TypeId right, TokenType op) {
+    if (left < 0 || right < 0) return TYPE_ID_INVALID;
+    if (op == TOKEN_COMMA) return right;
+
+    if (is_primitive(left) && is_primitive(right)) {
+        if (is_comparison_or_logic(op)) {
+            return comparable_matrix[left][right] ? TYPE_ID_INT : TYPE_ID_INVALID;
+        }
+        return is_integer_only(op) ? integer_promotion[left][right]
+                                   : arithmetic_promotion[left][right];
+    }
+
+    // Envolve ponteiros: aritmética de ponteiros e comparações
+    left = decay(table, left);
+    right = decay(table, right);
+    const TypeInfo* left_info = type_info(table, left);
+    const TypeInfo* right_info = type_info(table, right);
+    int left_pointer = left_info->kind == TYPEKIND_POINTER;
+    int right_pointer = right_info->kind == TYPEKIND_POINTER;
+    int left_integer = left == TYPE_ID_INT || left == TYPE_ID_CHAR;
+    int right_integer = right == TYPE_ID_INT || right == TYPE_ID_CHAR;
+
+    if (is_comparison_or_logic(op)) {
+        if (op == TOKEN_AND || op == TOKEN_OR) {
+            return (left_pointer || type_is_arithmetic(left)) &&
+                   (right_pointer || type_is_arithmetic(right)) ? TYPE_ID_INT : TYPE_ID_INVALID;
+        }
+        return left_pointer && right_pointer && type_compatible(table, left, right)
+               ? TYPE_ID_INT : TYPE_ID_INVALID;
+    }
+    if (op == TOKEN_PLUS) {
+        if (left_pointer && right_integer) return left;
+        if (left_integer && right_pointer) return right;
+    }
+    if (op == TOKEN_MINUS) {
+        if (left_pointer && right_integer) return left;
+        if (left_pointer && left == right) return TYPE_ID_INT;
+    }
+
+    return TYPE_ID_INVALID;
+}
+
+void type_to_string(TypeTable* table, TypeId id, char* buffer, int size) {
+    const TypeInfo* info = type_info(table, id);
+    if (!info) {
+        snprintf(buffer, size, "<inválido>");
+        return;
+    }
+
+    char inner[256];
+    switch (info->kind) {
+        case TYPEKIND_PRIMITIVE:
+            snprintf(buffer, size, "%s", data_type_to_string(info->base));
+            break;
+
+        case TYPEKIND_POINTER:
+            type_to_string(table, info->element, inner, sizeof(inner));
+            snprintf(buffer, size, "%s*", inner);
+            break;
+
+        case TYPEKIND_ARRAY:
+            type_to_string(table, info->element, inner, sizeof(inner));
+            snprintf(buffer, size, "%s[%d]", inner, info->count);
+            break;
+
+        case TYPEKIND_STRUCT:
+            snprintf(buffer, size, "struct %s", info->name);
+            break;
+
+        case TYPEKIND_FUNCTION: {
+            type_to_string(table, info->element, inner, sizeof(inner));
+            int length = snprintf(buffer, size, "%s(", inner);
+            for (int i = 0; i < info->param_count && length < size; i++) {
+                type_to_string(table, info->params[i], inner, sizeof(inner));
+                length += snprintf(buffer + length, size - length, "%s%s", i > 0 ? ", " : "", inner);
+            }
+            if (info->is_variadic && length < size) {
+                length += snprintf(buffer + length, size - length, "%s...",
+                                   info->param_count > 0 ? ", " : "");
+            }
+            if (length < size) snprintf(buffer + length, size - length, ")");
+            break;
+        }
+    }
+}
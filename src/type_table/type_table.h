@@ -0,0 +1,89 @@
+#ifndef TYPE_TABLE_H
+#define TYPE_TABLE_H
+
+#include <pthread.h>
+#include "ast.h"
+
+// Identificador canônico de tipo: dois tipos são iguais se e somente se
+// seus TypeIds são iguais (hash-consing na tabela de tipos)
+typedef int TypeId;
+
+#define TYPE_ID_INVALID -1
+
+// Tipos primitivos têm IDs fixos, indexando diretamente as matrizes
+// de compatibilidade e promoção
+#define TYPE_ID_VOID  0
+#define TYPE_ID_INT   1
+#define TYPE_ID_FLOAT 2
+#define TYPE_ID_CHAR  3
+#define PRIMITIVE_TYPE_COUNT 4
+
+// Ponteiros pré-internados com IDs fixos, usados pelas assinaturas estáticas
+// das funções built-in (ver symbol_table.c)
+#define TYPE_ID_CHAR_POINTER 4
+#define TYPE_ID_VOID_POINTER 5
+#define PREDEFINED_TYPE_COUNT 6
+
+typedef enum {
+    TYPEKIND_PRIMITIVE,
+    TYPEKIND_POINTER,
+    TYPEKIND_ARRAY,
+    TYPEKIND_FUNCTION,
+    TYPEKIND_STRUCT
+} TypeKind;
+
+// Descrição de um tipo canônico
+typedef struct TypeInfo {
+    TypeKind kind;
+    DataType base;         // Primitivo: o próprio tipo; derivados: TYPE_POINTER, TYPE_ARRAY...
+    TypeId element;        // Alvo do ponteiro, elemento do array ou retorno da função
+    int count;             // Dimensão do array (-1 se desconhecida)
+    TypeId* params;        // Tipos dos parâmetros (funções)
+    int param_count;
+    int is_variadic;
+    char* name;            // Nome da struct
+    unsigned int hash;
+} TypeInfo;
+
+// Tipos ficam em blocos de tamanho fixo que nunca são realocados, de modo
+// que um TypeInfo* continua válido enquanto outras threads internam tipos
+#define TYPE_CHUNK_BITS 8
+#define TYPE_CHUNK_SIZE (1 << TYPE_CHUNK_BITS)
+#define TYPE_MAX_CHUNKS 4096
+
+typedef struct TypeTable {
+    TypeInfo* chunks[TYPE_MAX_CHUNKS];  // Indexado por TypeId (bloco, posição)
+    int count;
+    int* buckets;          // Endereçamento aberto: TypeId + 1, 0 = vazio
+    int bucket_count;
+    pthread_mutex_t lock;  // Serializa a internação (análise paralela)
+} TypeTable;
+
+// Criação e destruição
+TypeTable* type_table_create();
+void type_table_destroy(TypeTable* table);
+
+// Construtores canônicos (retornam sempre o mesmo ID para o mesmo tipo)
+TypeId type_primitive(DataType type);
+TypeId type_pointer(TypeTable* table, TypeId target);
+TypeId type_pointer_to_level(TypeTable* table, TypeId base, int level);
+TypeId type_array(TypeTable* table, TypeId element, int count);
+TypeId type_function(TypeTable* table, TypeId return_type, const TypeId* params,
+                     int param_count, int is_variadic);
+TypeId type_struct(TypeTable* table, const char* name);
+
+// Consultas
+const TypeInfo* type_info(TypeTable* table, TypeId id);
+DataType type_data_type(TypeTable* table, TypeId id);
+int type_size(TypeTable* table, TypeId id);
+int type_alignment(TypeTable* table, TypeId id);
+int type_is_arithmetic(TypeId id);
+
+// Regras de tipos (consultas em matrizes pré-calculadas para primitivos)
+int type_compatible(TypeTable* table, TypeId target, TypeId source);
+TypeId type_binary_result(TypeTable* table, TypeId left, TypeId right, TokenType op);
+
+// Utilitários
+void type_to_string(TypeTable* table, TypeId id, char* buffer, int size);
+
+#endif
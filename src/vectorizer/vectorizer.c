@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vectorizer.h"
+
+// ============================================================
+// Expressões das lanes
+// ============================================================
+
+static int is_vector_leaf(const ASTNode* node) {
+    long constant;
+    return node->type == AST_IDENTIFIER || ast_integer_constant(node, &constant);
+}
+
+static int is_integer_symbol(const Symbol* symbol) {
+    return symbol && (symbol->kind == SYMBOL_VARIABLE || symbol->kind == SYMBOL_PARAMETER) &&
+           (symbol->type == TYPE_INT || symbol->type == TYPE_CHAR);
+}
+
+// +, -, * e menos unário sobre folhas inteiras; conta as leituras de symbol
+static int is_lane_expression(const ASTNode* node, const Symbol* symbol, int* reads) {
+    long constant;
+    if (!node) return 0;
+    if (ast_integer_constant(node, &constant)) return 1;
+
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            if (!is_integer_symbol(node->ref.symbol)) return 0;
+            if (node->ref.symbol == symbol) (*reads)++;
+            return 1;
+        case AST_UNARY_EXPRESSION:
+            return node->data.unary_expr.operator == UNARY_MINUS && node->data_type == TYPE_INT &&
+                   is_lane_expression(node->data.unary_expr.operand, symbol, reads);
+        case AST_BINARY_EXPRESSION: {
+            TokenType op = node->data.binary_expr.operator;
+            if (op != TOKEN_PLUS && op != TOKEN_MINUS && op != TOKEN_MULTIPLY) return 0;
+            return node->data_type == TYPE_INT &&
+                   is_lane_expression(node->data.binary_expr.left, symbol, reads) &&
+                   is_lane_expression(node->data.binary_expr.right, symbol, reads);
+        }
+        default:
+            return 0;
+    }
+}
+
+// O acumulador entra somado: só passa por +, e pelo lado esquerdo de -
+static int adds_accumulator(const ASTNode* node, const Symbol* accumulator) {
+    if (node->type == AST_IDENTIFIER) return node->ref.symbol == accumulator;
+    if (node->type != AST_BINARY_EXPRESSION) return 0;
+
+    TokenType op = node->data.binary_expr.operator;
+    if (op == TOKEN_PLUS) {
+        return adds_accumulator(node->data.binary_expr.left, accumulator) ||
+               adds_accumulator(node->data.binary_expr.right, accumulator);
+    }
+    return op == TOKEN_MINUS && adds_accumulator(node->data.binary_expr.left, accumulator);
+}
+
+static int same_tree(const ASTNode* a, const ASTNode* b) {
+    long x, y;
+    if (ast_integer_constant(a, &x)) return ast_integer_constant(b, &y) && x == y;
+    if (a->type != b->type) return 0;
+
+    switch (a->type) {
+        case AST_IDENTIFIER:
+            return a->ref.symbol == b->ref.symbol;
+        case AST_UNARY_EXPRESSION:
+            return a->data.unary_expr.operator == b->data.unary_expr.operator &&
+                   same_tree(a->data.unary_expr.operand, b->data.unary_expr.operand);
+        case AST_BINARY_EXPRESSION:
+            return a->data.binary_expr.operator == b->data.binary_expr.operator &&
+                   same_tree(a->data.binary_expr.left, b->data.binary_expr.left) &&
+                   same_tree(a->data.binary_expr.right, b->data.binary_expr.right);
+        default:
+            return 0;
+    }
+}
+
+int vector_expression_temporaries(const ASTNode* node) {
+    if (is_vector_leaf(node)) return 1;
+
+    if (node->type == AST_UNARY_EXPRESSION) {
+        int operand = vector_expression_temporaries(node->data.unary_expr.operand);
+        return operand > 2 ? operand : 2;
+    }
+
+    // A multiplicação do SSE2 usa dois auxiliares além do destino e da fonte
+    int multiply = node->data.binary_expr.operator == TOKEN_MULTIPLY;
+    int need = vector_expression_temporaries(node->data.binary_expr.left);
+    const ASTNode* right = node->data.binary_expr.right;
+    int operation = is_vector_leaf(right) ? (multiply ? 3 : 1) : (multiply ? 4 : 0);
+    if (!is_vector_leaf(right) && 1 + vector_expression_temporaries(right) > need) {
+        need = 1 + vector_expression_temporaries(right);
+    }
+    return operation > need ? operation : need;
+}
+
+// ============================================================
+// Laço
+// ============================================================
+
+// i = i + 1, i = 1 + i, ++i ou i++
+static Symbol* unit_increment(const ASTNode* node) {
+    if (!node) return NULL;
+
+    if (node->type == AST_UNARY_EXPRESSION) {
+        UnaryOperator op = node->data.unary_expr.operator;
+        const ASTNode* operand = node->data.unary_expr.operand;
+        if ((op != UNARY_PRE_INCREMENT && op != UNARY_POST_INCREMENT) || operand->type != AST_IDENTIFIER) {
+            return NULL;
+        }
+        return operand->ref.symbol;
+    }
+
+    if (node->type != AST_ASSIGNMENT_EXPRESSION || node->data.binary_expr.operator != TOKEN_ASSIGN) return NULL;
+    const ASTNode* target = node->data.binary_expr.left;
+    const ASTNode* value = node->data.binary_expr.right;
+    if (target->type != AST_IDENTIFIER || value->type != AST_BINARY_EXPRESSION ||
+        value->data.binary_expr.operator != TOKEN_PLUS) return NULL;
+
+    const ASTNode* left = value->data.binary_expr.left;
+    const ASTNode* right = value->data.binary_expr.right;
+    long constant;
+    if (left->type == AST_IDENTIFIER && left->ref.symbol == target->ref.symbol &&
+        ast_integer_constant(right, &constant) && constant == 1) return target->ref.symbol;
+    if (right->type == AST_IDENTIFIER && right->ref.symbol == target->ref.symbol &&
+        ast_integer_constant(left, &constant) && constant == 1) return target->ref.symbol;
+    return NULL;
+}
+
+// i < B ou i <= B (ou B > i, B >= i) com B literal ou variável inteira
+static int counted_condition(const ASTNode* condition, VectorLoop* info) {
+    if (!condition || condition->type != AST_BINARY_EXPRESSION) return 0;
+
+    TokenType op = condition->data.binary_expr.operator;
+    ASTNode* left = condition->data.binary_expr.left;
+    ASTNode* right = condition->data.binary_expr.right;
+    if (right->type == AST_IDENTIFIER && right->ref.symbol == info->counter) {
+        ASTNode* swap = left;
+        left = right;
+        right = swap;
+        op = op == TOKEN_GREATER ? TOKEN_LESS : op == TOKEN_GREATER_EQUAL ? TOKEN_LESS_EQUAL : TOKEN_EOF;
+    }
+    if ((op != TOKEN_LESS && op != TOKEN_LESS_EQUAL) || left->type != AST_IDENTIFIER ||
+        left->ref.symbol != info->counter || !is_vector_leaf(right)) return 0;
+    if (right->type == AST_IDENTIFIER &&
+        (!is_integer_symbol(right->ref.symbol) || right->ref.symbol == info->counter)) return 0;
+
+    info->bound = right;
+    info->inclusive = op == TOKEN_LESS_EQUAL;
+    return 1;
+}
+
+// Comando único de um ramo (sem chaves ou num bloco de um comando só)
+static ASTNode* single_statement(ASTNode* node) {
+    while (node && node->type == AST_COMPOUND_STATEMENT && node->child_count == 1) {
+        node = node->children[0];
+    }
+    return node;
+}
+
+static ASTNode* simple_assignment(ASTNode* stmt) {
+    stmt = single_statement(stmt);
+    if (!stmt || stmt->type != AST_EXPRESSION_STATEMENT || stmt->child_count != 1) return NULL;
+
+    ASTNode* expr = stmt->children[0];
+    if (expr->type != AST_ASSIGNMENT_EXPRESSION || expr->data.binary_expr.operator != TOKEN_ASSIGN ||
+        expr->data.binary_expr.left->type != AST_IDENTIFIER) return NULL;
+    Symbol* target = expr->data.binary_expr.left->ref.symbol;
+    return target && (target->kind == SYMBOL_VARIABLE || target->kind == SYMBOL_PARAMETER) &&
+           target->type == TYPE_INT ? expr : NULL;
+}
+
+// acc = <acc somado a uma expressão das lanes>
+static int sum_reduction(ASTNode* stmt, Reduction* reduction) {
+    ASTNode* assignment = simple_assignment(stmt);
+    if (!assignment) return 0;
+
+    Symbol* accumulator = assignment->data.binary_expr.left->ref.symbol;
+    ASTNode* value = assignment->data.binary_expr.right;
+    int reads = 0;
+    if (!is_lane_expression(value, accumulator, &reads) || reads != 1 || !adds_accumulator(value, accumulator)) {
+        return 0;
+    }
+    reduction->kind = REDUCTION_SUM;
+    reduction->accumulator = accumulator;
+    reduction->value = value;
+    return 1;
+}
+
+// if (e > m) m = e; e as variações com <, <= e >= ou com os lados trocados
+static int extreme_reduction(ASTNode* stmt, Reduction* reduction) {
+    if (stmt->type != AST_IF_STATEMENT || stmt->data.if_stmt.else_stmt) return 0;
+
+    ASTNode* condition = stmt->data.if_stmt.condition;
+    ASTNode* assignment = simple_assignment(stmt->data.if_stmt.then_stmt);
+    if (!assignment || condition->type != AST_BINARY_EXPRESSION) return 0;
+
+    Symbol* accumulator = assignment->data.binary_expr.left->ref.symbol;
+    TokenType op = condition->data.binary_expr.operator;
+    ASTNode* left = condition->data.binary_expr.left;
+    ASTNode* right = condition->data.binary_expr.right;
+    int greater = op == TOKEN_GREATER || op == TOKEN_GREATER_EQUAL;
+    if (!greater && op != TOKEN_LESS && op != TOKEN_LESS_EQUAL) return 0;
+
+    ASTNode* candidate;
+    if (right->type == AST_IDENTIFIER && right->ref.symbol == accumulator) {
+        candidate = left;
+    } else if (left->type == AST_IDENTIFIER && left->ref.symbol == accumulator) {
+        candidate = right;
+        greater = !greater;
+    } else {
+        return 0;
+    }
+
+    int reads = 0;
+    if (!is_lane_expression(candidate, accumulator, &reads) || reads != 0 ||
+        !same_tree(candidate, assignment->data.binary_expr.right)) return 0;
+
+    reduction->kind = greater ? REDUCTION_MAX : REDUCTION_MIN;
+    reduction->accumulator = accumulator;
+    reduction->value = candidate;
+    return 1;
+}
+
+int vector_invariant_index(const VectorLoop* info, const ASTNode* leaf) {
+    long value, other;
+    int constant = ast_integer_constant(leaf, &value);
+    for (int i = 0; i < info->invariant_count; i++) {
+        const ASTNode* known = info->invariants[i];
+        if (constant ? ast_integer_constant(known, &other) && other == value
+                     : known->type == AST_IDENTIFIER && known->ref.symbol == leaf->ref.symbol) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int is_accumulator(const VectorLoop* info, const Symbol* symbol) {
+    for (int i = 0; i < info->reduction_count; i++) {
+        if (info->reductions[i].accumulator == symbol) return 1;
+    }
+    return 0;
+}
+
+// Folhas que não são o contador nem o próprio acumulador precisam ser
+// invariantes: ninguém mais escreve no laço além dos acumuladores
+static int collect_invariants(VectorLoop* info, const ASTNode* node, const Symbol* own) {
+    if (is_vector_leaf(node)) {
+        if (node->type == AST_IDENTIFIER) {
+            Symbol* symbol = node->ref.symbol;
+            if (symbol == info->counter || symbol == own) return 1;
+            if (is_accumulator(info, symbol)) return 0;
+        }
+        if (vector_invariant_index(info, node) >= 0) return 1;
+        if (info->invariant_count == VECTOR_MAX_INVARIANTS) return 0;
+        info->invariants[info->invariant_count++] = (ASTNode*)node;
+        return 1;
+    }
+    if (node->type == AST_UNARY_EXPRESSION) {
+        return collect_invariants(info, node->data.unary_expr.operand, own);
+    }
+    return collect_invariants(info, node->data.binary_expr.left, own) &&
+           collect_invariants(info, node->data.binary_expr.right, own);
+}
+
+int vector_loop_analyze(ASTNode* loop, VectorLoop* info) {
+    memset(info, 0, sizeof(VectorLoop));
+    if (!loop || loop->type != AST_FOR_STATEMENT || !loop->data.for_stmt.body) return 0;
+
+    info->counter = unit_increment(loop->data.for_stmt.update);
+    if (!info->counter || info->counter->type != TYPE_INT ||
+        !counted_condition(loop->data.for_stmt.condition, info)) return 0;
+
+    ASTNode* body = loop->data.for_stmt.body;
+    ASTNode** statements = body->type == AST_COMPOUND_STATEMENT ? body->children : &loop->data.for_stmt.body;
+    int count = body->type == AST_COMPOUND_STATEMENT ? body->child_count : 1;
+    if (count == 0 || count > VECTOR_MAX_REDUCTIONS) return 0;
+
+    for (int i = 0; i < count; i++) {
+        Reduction* reduction = &info->reductions[info->reduction_count];
+        if (!sum_reduction(statements[i], reduction) && !extreme_reduction(statements[i], reduction)) return 0;
+        if (reduction->accumulator == info->counter || is_accumulator(info, reduction->accumulator)) return 0;
+        info->reduction_count++;
+    }
+    if (info->bound->type == AST_IDENTIFIER && is_accumulator(info, info->bound->ref.symbol)) return 0;
+
+    for (int i = 0; i < info->reduction_count; i++) {
+        Reduction* reduction = &info->reductions[i];
+        Symbol* own = reduction->kind == REDUCTION_SUM ? reduction->accumulator : NULL;
+        if (!collect_invariants(info, reduction->value, own)) return 0;
+
+        int need = vector_expression_temporaries(reduction->value);
+        if (reduction->kind != REDUCTION_SUM && need < 2) need = 2;
+        if (need > info->temporaries) info->temporaries = need;
+    }
+
+    // Contador e passo, acumuladores, invariantes e trabalho
+    return 2 + info->reduction_count + info->invariant_count + info->temporaries <= VECTOR_REGISTERS;
+}
@@ -0,0 +1,59 @@
+#ifndef VECTORIZER_H
+#define VECTORIZER_H
+
+#include "ast.h"
+#include "symbol_table.h"
+
+// ------------------------------------------------------------
+// Reconhecimento de laços vetorizáveis (assembly x86-64, -O)
+//
+// A linguagem ainda não indexa arrays, então os laços vetorizáveis são
+// as reduções sobre o contador: for (i = A; i < B; i = i + 1) cujo corpo
+// só acumula expressões inteiras (+, -, *) de i e de valores invariantes,
+// na forma acc = acc + e (o acumulador aparece uma vez, somado) ou
+// if (e > m) m = e (máximo; < dá o mínimo). Cada lane do registrador
+// vetorial executa uma volta; as lanes se combinam na saída e as voltas
+// que sobram ficam com o laço escalar. A soma inteira é associativa
+// (módulo 2^32), então o resultado é o mesmo do laço original.
+// ------------------------------------------------------------
+
+#define VECTOR_REGISTERS 16        // xmm0-15 / ymm0-15
+#define VECTOR_MAX_REDUCTIONS 8
+#define VECTOR_MAX_INVARIANTS 8
+
+typedef enum {
+    REDUCTION_SUM,
+    REDUCTION_MIN,
+    REDUCTION_MAX
+} ReductionKind;
+
+typedef struct Reduction {
+    ReductionKind kind;
+    Symbol* accumulator;
+    ASTNode* value;        // Soma: o lado direito (lê o acumulador); min/max: o candidato
+} Reduction;
+
+typedef struct VectorLoop {
+    Symbol* counter;
+    ASTNode* bound;        // Literal inteiro ou variável invariante
+    int inclusive;         // i <= B
+    Reduction reductions[VECTOR_MAX_REDUCTIONS];
+    int reduction_count;
+    ASTNode* invariants[VECTOR_MAX_INVARIANTS];  // Folhas invariantes distintas
+    int invariant_count;
+    int temporaries;       // Registradores de trabalho da expressão mais exigente
+} VectorLoop;
+
+// Reconhece o laço (AST_FOR_STATEMENT) e preenche info. O número de
+// registradores considera a multiplicação do SSE2, que não tem pmulld e
+// precisa de dois auxiliares; a decisão vale para qualquer largura.
+int vector_loop_analyze(ASTNode* loop, VectorLoop* info);
+
+// Índice da folha invariante (literal ou variável) em info->invariants; -1 se não for
+int vector_invariant_index(const VectorLoop* info, const ASTNode* leaf);
+
+// Registradores de trabalho que a expressão precisa, na ordem de avaliação
+// do gerador: esquerda no destino, direita (se não for folha) no seguinte
+int vector_expression_temporaries(const ASTNode* node);
+
+#endif